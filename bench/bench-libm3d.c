@@ -0,0 +1,1526 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "../src/mathematics.h"
+#include "../src/random.h"
+#include "../src/vec2.h"
+#include "../src/vec3.h"
+#include "../src/vec4.h"
+#include "../src/vec3-array.h"
+#include "../src/mat2.h"
+#include "../src/mat3.h"
+#include "../src/mat4.h"
+#include "../src/quat.h"
+#include "../src/quat-array.h"
+#include "../src/skinning.h"
+#include "../src/dual-quat.h"
+#include "../src/packed-transforms.h"
+#include "../src/transform-hierarchy.h"
+#include "../src/transforms.h"
+#include "../src/projections.h"
+#include "../src/geographic.h"
+#include "../src/geographic-index.h"
+#include "../src/web-mercator.h"
+#include "../src/numerical-methods.h"
+#include "../src/algorithms.h"
+#include "../src/fixed-point-decimal.h"
+#include "../src/simd.h"
+#include "bench.h"
+
+/*
+ * libm3d benchmark suite
+ *
+ * Every module is timed over the same fixed set of inputs, which are
+ * generated from a fixed seed so that runs (and the float, double and long
+ * double builds) can be compared.
+ *
+ *   bench-libm3d [--samples N] [--filter TEXT] [--json FILE|-] [--list]
+ */
+#define COUNT   (1024) /* inputs per type; a power of two */
+#define SEED    (20130101u)
+
+static struct {
+	vec2_t   v2a[ COUNT ], v2b[ COUNT ], v2r[ COUNT ];
+	vec3_t   v3a[ COUNT ], v3b[ COUNT ], v3r[ COUNT ];
+	vec4_t   v4a[ COUNT ], v4b[ COUNT ], v4r[ COUNT ];
+	mat2_t   m2a[ COUNT ], m2b[ COUNT ], m2r[ COUNT ];
+	mat3_t   m3a[ COUNT ], m3b[ COUNT ], m3r[ COUNT ];
+	mat4_t   m4a[ COUNT ], m4b[ COUNT ], m4r[ COUNT ];
+	mat4_t   rigid[ COUNT ], affine[ COUNT ];
+	quat_t   qa[ COUNT ], qb[ COUNT ], qr[ COUNT ];
+	scaler_t s[ COUNT ];
+	double   lon[ COUNT ], lat[ COUNT ], alt[ COUNT ];
+	double   x[ COUNT ], y[ COUNT ], z[ COUNT ];
+	double   d[ COUNT ];
+	float    f[ COUNT ];
+	int      n[ COUNT ];
+	fpdec_t  fa[ COUNT ], fb[ COUNT ], fr[ COUNT ];
+	vec3_array_t array_a, array_b, array_r, array_n;
+	quat_array_t quats_a, quats_b, quats_c, quats_r;
+	scaler_t     mask[ COUNT ];
+	int          parents[ COUNT ];
+	float        palette[ 16 * COUNT ];
+	mat4_t       world[ COUNT ];
+	dual_quat_t  dq[ COUNT ];
+	uint16_t     joints[ COUNT ][ 4 ];
+	scaler_t     weights[ COUNT ][ 4 ];
+	quat_packed32_t     packed32[ COUNT ];
+	quat_packed48_t     packed48[ COUNT ];
+	quat_octahedral32_t octahedral[ COUNT ];
+	vec3_packed48_t     packed_v3[ COUNT ];
+} data;
+
+/* Runs statement for ops operations, cycling over the inputs. */
+#define BENCH( function, statement ) \
+	static void function( size_t ops ) \
+	{ \
+		for( size_t i = 0; i < ops; i++ ) \
+		{ \
+			const size_t j = i & (COUNT - 1); \
+			statement; \
+		} \
+		bench_escape( &data ); \
+	}
+
+/* vec2, vec3 and vec4 */
+BENCH( bench_vec2_add,            data.v2r[ j ] = vec2_add( &data.v2a[ j ], &data.v2b[ j ] ) )
+BENCH( bench_vec2_dot_product,    data.s[ j ] = vec2_dot_product( &data.v2a[ j ], &data.v2b[ j ] ) )
+BENCH( bench_vec2_normalize,      data.v2r[ j ] = data.v2a[ j ]; vec2_normalize( &data.v2r[ j ] ) )
+BENCH( bench_vec3_add,            data.v3r[ j ] = vec3_add( &data.v3a[ j ], &data.v3b[ j ] ) )
+BENCH( bench_vec3_dot_product,    data.s[ j ] = vec3_dot_product( &data.v3a[ j ], &data.v3b[ j ] ) )
+BENCH( bench_vec3_cross_product,  data.v3r[ j ] = vec3_cross_product( &data.v3a[ j ], &data.v3b[ j ] ) )
+BENCH( bench_vec3_normalize,      data.v3r[ j ] = data.v3a[ j ]; vec3_normalize( &data.v3r[ j ] ) )
+BENCH( bench_vec3_angle,          data.s[ j ] = vec3_angle( &data.v3a[ j ], &data.v3b[ j ] ) )
+BENCH( bench_vec4_add,            data.v4r[ j ] = vec4_add( &data.v4a[ j ], &data.v4b[ j ] ) )
+BENCH( bench_vec4_dot_product,    data.s[ j ] = vec4_dot_product( &data.v4a[ j ], &data.v4b[ j ] ) )
+BENCH( bench_vec4_normalize,      data.v4r[ j ] = data.v4a[ j ]; vec4_normalize( &data.v4r[ j ] ) )
+
+/* Batch functions do exactly ops elements, in batches of at most COUNT. */
+#define BATCH( i, ops )   ((ops) - (i) < COUNT ? (ops) - (i) : COUNT)
+
+/* vec3-array; one operation is one element */
+static void bench_vec3_array_add( size_t ops )
+{
+	vec3_array_t a = data.array_a, b = data.array_b, r = data.array_r;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		a.count = b.count = r.count = BATCH( i, ops );
+		vec3_array_add( &r, &a, &b );
+	}
+	bench_escape( data.array_r.x );
+}
+
+static void bench_vec3_array_normalize( size_t ops )
+{
+	vec3_array_t a = data.array_a;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		a.count = BATCH( i, ops );
+		vec3_array_normalize( &a );
+	}
+	bench_escape( data.array_a.x );
+}
+
+/* Formatting; one operation is one vector or matrix */
+static char text[ COUNT * 128 ];
+
+BENCH( bench_vec3_to_string_r,    vec3_to_string_r( &data.v3a[ j ], text, 128 ) )
+BENCH( bench_mat4_to_string_r,    mat4_to_string_r( &data.m4a[ j ], text, 128 ) )
+
+static void bench_vec3_format( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		vec3_format( text, sizeof(text), data.v3a, BATCH( i, ops ), 3, NULL );
+	}
+	bench_escape( text );
+}
+
+static void bench_mat4_format( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		mat4_format( text, sizeof(text), data.m4a, BATCH( i, ops ), 3, NULL );
+	}
+	bench_escape( text );
+}
+
+/* mat2, mat3 and mat4 */
+BENCH( bench_mat2_mult_matrix,    data.m2r[ j ] = mat2_mult_matrix( &data.m2a[ j ], &data.m2b[ j ] ) )
+BENCH( bench_mat2_invert,         data.m2r[ j ] = data.m2a[ j ]; mat2_invert( &data.m2r[ j ] ) )
+BENCH( bench_mat3_mult_matrix,    data.m3r[ j ] = mat3_mult_matrix( &data.m3a[ j ], &data.m3b[ j ] ) )
+BENCH( bench_mat3_mult_vector,    data.v3r[ j ] = mat3_mult_vector( &data.m3a[ j ], &data.v3a[ j ] ) )
+BENCH( bench_mat3_invert,         data.m3r[ j ] = data.m3a[ j ]; mat3_invert( &data.m3r[ j ] ) )
+BENCH( bench_mat4_mult_matrix,    data.m4r[ j ] = mat4_mult_matrix( &data.m4a[ j ], &data.m4b[ j ] ) )
+BENCH( bench_mat4_mult_vector,    data.v4r[ j ] = mat4_mult_vector( &data.m4a[ j ], &data.v4a[ j ] ) )
+BENCH( bench_mat4_determinant,    data.s[ j ] = mat4_determinant( &data.m4a[ j ] ) )
+BENCH( bench_mat4_invert_general, data.m4r[ j ] = data.m4a[ j ]; mat4_invert( &data.m4r[ j ] ) )
+BENCH( bench_mat4_invert_affine,  data.m4r[ j ] = data.affine[ j ]; mat4_invert( &data.m4r[ j ] ) )
+BENCH( bench_mat4_invert_rigid,   data.m4r[ j ] = data.rigid[ j ]; mat4_invert( &data.m4r[ j ] ) )
+
+static void bench_mat4_transform_points3( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		mat4_transform_points3( &data.affine[ (i / COUNT) & (COUNT - 1) ], data.v3r, 0, data.v3a, 0, BATCH( i, ops ) );
+	}
+	bench_escape( data.v3r );
+}
+
+/* Quaternions */
+BENCH( bench_quat_multiply,       data.qr[ j ] = quat_multiply( &data.qa[ j ], &data.qb[ j ] ) )
+BENCH( bench_quat_rotate3,        data.v3r[ j ] = quat_rotate3( &data.qa[ j ], &data.v3a[ j ] ) )
+BENCH( bench_quat_slerp,          data.qr[ j ] = quat_slerp( &data.qa[ j ], &data.qb[ j ], 0.3 ) )
+BENCH( bench_quat_to_mat4,        data.m4r[ j ] = quat_to_mat4( &data.qa[ j ] ) )
+BENCH( bench_quat_from_mat4,      data.qr[ j ] = quat_from_mat4( &data.rigid[ j ] ) )
+
+/* quat-array; one operation is one rotation */
+static void bench_quat_array_nlerp( size_t ops )
+{
+	quat_array_t a = data.quats_a, b = data.quats_b, r = data.quats_r;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		a.count = b.count = r.count = BATCH( i, ops );
+		quat_array_nlerp( &r, &a, &b, 0.3 );
+	}
+	bench_escape( data.quats_r.x );
+}
+
+static void bench_quat_array_slerp( size_t ops )
+{
+	quat_array_t a = data.quats_a, b = data.quats_b, r = data.quats_r;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		a.count = b.count = r.count = BATCH( i, ops );
+		quat_array_slerp( &r, &a, &b, 0.3 );
+	}
+	bench_escape( data.quats_r.x );
+}
+
+static void bench_quat_array_blend_3( size_t ops )
+{
+	quat_array_t a = data.quats_a, b = data.quats_b, c = data.quats_c, r = data.quats_r;
+	quat_array_layer_t layers[] = {
+		{ &a, 0.5, NULL },
+		{ &b, 0.3, data.mask },
+		{ &c, 0.2, NULL },
+	};
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		a.count = b.count = c.count = r.count = BATCH( i, ops );
+		quat_array_blend( &r, layers, 3, true );
+	}
+	bench_escape( data.quats_r.x );
+}
+
+/* Skinning palettes for a skeleton of COUNT joints; one operation is one
+ * joint. The loop is what a caller would write with the scalar functions. */
+static void bench_skinning_palette_loop( size_t ops )
+{
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		mat4_t T = m3d_translate( &data.v3a[ j ] );
+		mat4_t R = quat_to_mat4( &data.qa[ j ] );
+		mat4_t S = m3d_scale( &data.v3b[ j ] );
+		mat4_t TR = mat4_mult_matrix( &T, &R );
+		mat4_t local = mat4_mult_matrix( &TR, &S );
+
+		data.world[ j ] = data.parents[ j ] >= 0 ? mat4_mult_matrix( &data.world[ data.parents[ j ] ], &local ) : local;
+
+		mat4_t skin = mat4_mult_matrix( &data.world[ j ], &data.rigid[ j ] );
+		for( size_t k = 0; k < 16; k++ )
+		{
+			data.palette[ 16 * j + k ] = (float) skin.m[ k ];
+		}
+	}
+	bench_escape( data.palette );
+}
+
+static void bench_skinning_palette_build( size_t ops )
+{
+	quat_array_t rotations = data.quats_a;
+	vec3_array_t translations = data.array_a, scales = data.array_b;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		rotations.count = translations.count = scales.count = BATCH( i, ops );
+		skinning_palette_build( data.parents, &rotations, &translations, &scales, data.rigid, data.world, data.palette, SKINNING_LAYOUT_MAT4 );
+	}
+	bench_escape( data.palette );
+}
+
+static void bench_skinning_palette_build_3x4( size_t ops )
+{
+	quat_array_t rotations = data.quats_a;
+	vec3_array_t translations = data.array_a;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		rotations.count = translations.count = BATCH( i, ops );
+		skinning_palette_build( data.parents, &rotations, &translations, NULL, data.rigid, data.world, data.palette, SKINNING_LAYOUT_MAT3X4 );
+	}
+	bench_escape( data.palette );
+}
+
+/* Skinning of COUNT vertices with four influences each, by a skeleton of
+ * 64 joints; one operation is one vertex, its position and its normal.
+ * The linear blend loop is the mat4 palette approach. */
+static void bench_skinning_linear_blend_loop( size_t ops )
+{
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		mat4_t m;
+		for( size_t k = 0; k < 16; k++ )
+		{
+			m.m[ k ] = data.weights[ j ][ 0 ] * data.rigid[ data.joints[ j ][ 0 ] ].m[ k ] +
+			           data.weights[ j ][ 1 ] * data.rigid[ data.joints[ j ][ 1 ] ].m[ k ] +
+			           data.weights[ j ][ 2 ] * data.rigid[ data.joints[ j ][ 2 ] ].m[ k ] +
+			           data.weights[ j ][ 3 ] * data.rigid[ data.joints[ j ][ 3 ] ].m[ k ];
+		}
+		const vec4_t p = VEC4( data.v3a[ j ].x, data.v3a[ j ].y, data.v3a[ j ].z, 1 );
+		const vec4_t n = VEC4( data.v3b[ j ].x, data.v3b[ j ].y, data.v3b[ j ].z, 0 );
+		data.v4r[ j ] = mat4_mult_vector( &m, &p );
+		data.v4a[ j ] = mat4_mult_vector( &m, &n );
+	}
+	bench_escape( &data );
+}
+
+static void bench_dual_quat_skin_loop( size_t ops )
+{
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		const dual_quat_t* pivot = &data.dq[ data.joints[ j ][ 0 ] ];
+		dual_quat_t blend = DUAL_QUAT( QUAT( 0, 0, 0, 0 ), QUAT( 0, 0, 0, 0 ) );
+		for( size_t k = 0; k < 4; k++ )
+		{
+			const dual_quat_t* dq = &data.dq[ data.joints[ j ][ k ] ];
+			const scaler_t w = quat_dot_product( &dq->real, &pivot->real ) < 0 ? -data.weights[ j ][ k ] : data.weights[ j ][ k ];
+			quat_t real = dq->real, dual = dq->dual;
+			quat_scale( &real, w );
+			quat_scale( &dual, w );
+			blend.real = quat_add( &blend.real, &real );
+			blend.dual = quat_add( &blend.dual, &dual );
+		}
+		dual_quat_normalize( &blend );
+		data.v3r[ j ] = dual_quat_transform_point( &blend, &data.v3a[ j ] );
+		data.v3a[ j ] = dual_quat_transform_vec3( &blend, &data.v3b[ j ] );
+	}
+	bench_escape( &data );
+}
+
+static void bench_dual_quat_skin( size_t ops )
+{
+	vec3_array_t positions = data.array_r, normals = data.array_n, bind_positions = data.array_a, bind_normals = data.array_b;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		positions.count = normals.count = bind_positions.count = bind_normals.count = BATCH( i, ops );
+		dual_quat_skin( &positions, &normals, &bind_positions, &bind_normals, data.dq, data.joints, data.weights );
+	}
+	bench_escape( data.array_r.x );
+}
+
+/* Packed transforms; one operation is one quaternion or translation. The
+ * copies are the uncompressed loads that the decoders stand in for. */
+static const vec3_t packed_min = { .x = -1, .y = -1, .z = -1 };
+static const vec3_t packed_max = { .x =  1, .y =  1, .z =  1 };
+
+BENCH( bench_quat_copy,           data.qr[ j ] = data.qa[ j ] )
+BENCH( bench_quat_unpack32,       data.qr[ j ] = quat_unpack32( data.packed32[ j ] ) )
+BENCH( bench_quat_unpack48,       data.qr[ j ] = quat_unpack48( data.packed48[ j ] ) )
+BENCH( bench_quat_unpack_octahedral, data.qr[ j ] = quat_unpack_octahedral( data.octahedral[ j ] ) )
+BENCH( bench_vec3_copy,           data.v3r[ j ] = data.v3a[ j ] )
+BENCH( bench_vec3_unpack48,       data.v3r[ j ] = vec3_unpack48( data.packed_v3[ j ], &packed_min, &packed_max ) )
+
+static void bench_quat_unpack32_batch( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		quat_unpack32_batch( data.qr, data.packed32, BATCH( i, ops ) );
+	}
+	bench_escape( data.qr );
+}
+
+static void bench_quat_unpack32_array( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		quat_unpack32_array( &data.quats_r, data.packed32, BATCH( i, ops ) );
+	}
+	bench_escape( data.quats_r.x );
+}
+
+static void bench_quat_unpack48_batch( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		quat_unpack48_batch( data.qr, data.packed48, BATCH( i, ops ) );
+	}
+	bench_escape( data.qr );
+}
+
+static void bench_quat_unpack_octahedral_batch( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		quat_unpack_octahedral_batch( data.qr, data.octahedral, BATCH( i, ops ) );
+	}
+	bench_escape( data.qr );
+}
+
+static void bench_vec3_unpack48_batch( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		vec3_unpack48_batch( data.v3r, data.packed_v3, BATCH( i, ops ), &packed_min, &packed_max );
+	}
+	bench_escape( data.v3r );
+}
+
+/*
+ * A scene graph of SCENE_SIZE rigid nodes, every parent before its
+ * children. One operation is one frame: every world matrix recomputed
+ * with mat4_mult_matrix(), as a caller without the hierarchy would, or an
+ * update after moving the roots (everything) or one node in a hundred.
+ */
+#define SCENE_SIZE     (1 << 16)
+
+static struct {
+	int    parents[ SCENE_SIZE ];
+	mat4_t locals[ SCENE_SIZE ];
+	mat4_t worlds[ SCENE_SIZE ];
+	transform_hierarchy_t hierarchy;
+	bool   built;
+} scene;
+
+static void scene_create( void )
+{
+	if( scene.built )
+	{
+		return;
+	}
+
+	m3d_random_t random;
+	m3d_random_seed( &random, SEED );
+
+	for( size_t i = 0; i < SCENE_SIZE; i++ )
+	{
+		scene.parents[ i ] = i < 16 ? -1 : m3d_random_rangei( &random, (int) i / 8, (int) i - 1 );
+		scene.locals[ i ]  = data.rigid[ i & (COUNT - 1) ];
+	}
+
+	scene.built = transform_hierarchy_create( &scene.hierarchy, scene.parents, SCENE_SIZE );
+	for( size_t i = 0; i < SCENE_SIZE; i++ )
+	{
+		transform_hierarchy_set_local( &scene.hierarchy, i, &scene.locals[ i ] );
+	}
+	transform_hierarchy_update( &scene.hierarchy );
+}
+
+static void bench_scene_loop( size_t ops )
+{
+	scene_create( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		for( size_t j = 0; j < SCENE_SIZE; j++ )
+		{
+			scene.worlds[ j ] = scene.parents[ j ] >= 0 ? mat4_mult_matrix( &scene.worlds[ scene.parents[ j ] ], &scene.locals[ j ] ) : scene.locals[ j ];
+		}
+		bench_escape( scene.worlds );
+	}
+}
+
+static void bench_transform_hierarchy_update_all( size_t ops )
+{
+	scene_create( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		for( size_t j = 0; j < 16; j++ )
+		{
+			transform_hierarchy_set_local( &scene.hierarchy, j, &scene.locals[ j ] );
+		}
+		transform_hierarchy_update( &scene.hierarchy );
+		bench_escape( &scene.hierarchy );
+	}
+}
+
+static void bench_transform_hierarchy_update_1_percent( size_t ops )
+{
+	scene_create( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		for( size_t j = i % 100; j < SCENE_SIZE; j += 100 )
+		{
+			transform_hierarchy_set_local( &scene.hierarchy, j, &scene.locals[ j ] );
+		}
+		transform_hierarchy_update( &scene.hierarchy );
+		bench_escape( &scene.hierarchy );
+	}
+}
+
+/* Transforms and projections */
+BENCH( bench_m3d_look_at,         data.m4r[ j ] = m3d_look_at( &data.v3a[ j ], &data.v3b[ j ], &VEC3_YUNIT ) )
+BENCH( bench_m3d_rotate_vec3_to_vec3, data.m3r[ j ] = m3d_rotate_from_vec3_to_vec3( &data.v3a[ j ], &data.v3b[ j ] ) )
+BENCH( bench_m3d_euler_transform, data.m4r[ j ] = m3d_euler_transform( data.v3a[ j ].x, data.v3a[ j ].y, data.v3a[ j ].z ) )
+BENCH( bench_m3d_perspective,     data.m4r[ j ] = m3d_perspective( 1 + data.s[ j ] * 0.1, 1.5, 0.1, 1000 ) )
+BENCH( bench_m3d_perspective_divide, data.v4r[ j ] = m3d_perspective_divide( &data.v4b[ j ] ) )
+
+/* Geographic (always double precision) */
+BENCH( bench_wgs84_geographic_to_cartesian, wgs84_geographic_to_cartesian( data.lon[ j ], data.lat[ j ], data.alt[ j ], &data.x[ j ], &data.y[ j ], &data.z[ j ] ) )
+BENCH( bench_wgs84_cartesian_to_geographic, wgs84_cartesian_to_geographic( data.x[ j ], data.y[ j ], data.z[ j ], &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ], &data.d[ (j + 2) & (COUNT - 1) ] ) )
+BENCH( bench_wgs84_cartesian_to_geographic_bowring, wgs84_cartesian_to_geographic_bowring( data.x[ j ], data.y[ j ], data.z[ j ], &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ], &data.d[ (j + 2) & (COUNT - 1) ] ) )
+BENCH( bench_wgs84_cartesian_to_geographic_vermeille, wgs84_cartesian_to_geographic_vermeille( data.x[ j ], data.y[ j ], data.z[ j ], &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ], &data.d[ (j + 2) & (COUNT - 1) ] ) )
+BENCH( bench_wgs84_geographic_to_mercator,  wgs84_geographic_to_mercator_standard( data.lon[ j ], data.lat[ j ] * 0.9, &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ] ) )
+BENCH( bench_wgs84_mercator_to_geographic,  wgs84_mercator_to_geographic_standard( data.x[ j ] * 1e-1, data.y[ j ] * 1e-1, &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ] ) )
+
+/* One operation is one converted point */
+static void bench_wgs84_geographic_to_cartesian_array( size_t ops )
+{
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		wgs84_geographic_to_cartesian_array( data.lon, data.lat, data.alt, data.x, data.y, data.z, BATCH( i, ops ) );
+	}
+	bench_escape( &data );
+}
+
+static void bench_wgs84_cartesian_to_geographic_array( size_t ops )
+{
+	static double lon[ COUNT ], lat[ COUNT ], alt[ COUNT ];
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		wgs84_cartesian_to_geographic_array( data.x, data.y, data.z, lon, lat, alt, BATCH( i, ops ) );
+	}
+	bench_escape( lon );
+	bench_escape( lat );
+	bench_escape( alt );
+}
+
+/* One operation is one distance */
+static void bench_wgs84_distance_vincenty_pairs( size_t ops )
+{
+	/* Pairs each point with the next one, like the scalar benchmark. */
+	static double lon[ COUNT ], lat[ COUNT ];
+	for( size_t j = 0; j < COUNT; j++ )
+	{
+		lon[ j ] = data.lon[ (j + 1) & (COUNT - 1) ];
+		lat[ j ] = data.lat[ (j + 1) & (COUNT - 1) ];
+	}
+
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		wgs84_geographic_geodesic_distance_vincenty_pairs( data.lon, data.lat, lon, lat, data.d, BATCH( i, ops ) );
+	}
+	bench_escape( data.d );
+}
+
+static void bench_wgs84_distance_vincenty_matrix( size_t ops )
+{
+	static double distances[ 16 * COUNT ];
+	for( size_t i = 0; i < ops; i += 16 * COUNT )
+	{
+		const size_t n = ops - i < 16 * COUNT ? ops - i : 16 * COUNT;
+		wgs84_geographic_geodesic_distance_vincenty_matrix( data.lon, data.lat, (n + COUNT - 1) / COUNT, data.lon, data.lat, COUNT, distances );
+	}
+	bench_escape( distances );
+}
+
+/* ENU frames at Miami; one operation is one converted point */
+static geo_frame_t frame;
+
+static void frame_init( void )
+{
+	geo_frame_init( &frame, -80.2, 25.8, 0.0, GEO_FRAME_ENU );
+}
+
+static void bench_geo_frame_from_geographic( size_t ops )
+{
+	frame_init( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		geo_frame_from_geographic( &frame, data.lon[ j ], data.lat[ j ], data.alt[ j ], &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ], &data.d[ (j + 2) & (COUNT - 1) ] );
+	}
+	bench_escape( &data );
+}
+
+/* Builds the frame for every point, as without a frame object. */
+static void bench_geo_frame_init_each( size_t ops )
+{
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		geo_frame_t each;
+		geo_frame_init( &each, -80.2, 25.8, 0.0, GEO_FRAME_ENU );
+		geo_frame_from_geographic( &each, data.lon[ j ], data.lat[ j ], data.alt[ j ], &data.d[ j ], &data.d[ (j + 1) & (COUNT - 1) ], &data.d[ (j + 2) & (COUNT - 1) ] );
+	}
+	bench_escape( &data );
+}
+
+static void bench_geo_frame_from_geographic_array( size_t ops )
+{
+	static double e[ COUNT ], n[ COUNT ], u[ COUNT ];
+	frame_init( );
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		geo_frame_from_geographic_array( &frame, data.lon, data.lat, data.alt, e, n, u, BATCH( i, ops ) );
+	}
+	bench_escape( e );
+	bench_escape( n );
+	bench_escape( u );
+}
+
+static void bench_geo_frame_from_cartesian_array( size_t ops )
+{
+	static double e[ COUNT ], n[ COUNT ], u[ COUNT ];
+	frame_init( );
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		geo_frame_from_cartesian_array( &frame, data.x, data.y, data.z, e, n, u, BATCH( i, ops ) );
+	}
+	bench_escape( e );
+	bench_escape( n );
+	bench_escape( u );
+}
+
+BENCH( bench_wgs84_distance_vincenty,  data.d[ j ] = wgs84_geographic_geodesic_distance_vincenty( data.lon[ j ], data.lat[ j ], data.lon[ (j + 1) & (COUNT - 1) ], data.lat[ (j + 1) & (COUNT - 1) ] ) )
+BENCH( bench_wgs84_distance_lamberts,  data.d[ j ] = wgs84_geographic_geodesic_distance_lamberts( data.lon[ j ], data.lat[ j ], data.lon[ (j + 1) & (COUNT - 1) ], data.lat[ (j + 1) & (COUNT - 1) ] ) )
+BENCH( bench_wgs84_distance_haversine, data.d[ j ] = wgs84_geographic_geodesic_distance_haversine( data.lon[ j ], data.lat[ j ], data.lon[ (j + 1) & (COUNT - 1) ], data.lat[ (j + 1) & (COUNT - 1) ] ) )
+
+/*
+ * Geographic index over points spread over the globe with half of them
+ * in clusters. One operation is one build or one query.
+ */
+#define INDEX_SIZE     (100000)
+
+static struct {
+	geo_coord_t coords[ INDEX_SIZE ];
+	geo_index_t index;
+	bool        built;
+	size_t      ids[ 64 ];
+	double      distances[ 64 ];
+} geo;
+
+static void geo_points( void )
+{
+	if( geo.built )
+	{
+		return;
+	}
+
+	m3d_random_t random;
+	m3d_random_seed( &random, SEED );
+
+	for( size_t i = 0; i < INDEX_SIZE; i++ )
+	{
+		if( i % 2 == 0 )
+		{
+			geo.coords[ i ].lon = m3d_random_ranged( &random, -180.0, 180.0 );
+			geo.coords[ i ].lat = m3d_random_ranged( &random, -90.0, 90.0 );
+		}
+		else
+		{
+			geo.coords[ i ].lon = -80.0 + m3d_random_ranged( &random, -2.0, 2.0 );
+			geo.coords[ i ].lat = 26.0 + m3d_random_ranged( &random, -2.0, 2.0 );
+		}
+		geo.coords[ i ].alt = 0.0;
+	}
+
+	geo.built = geo_index_create( &geo.index, geo.coords, INDEX_SIZE, WGS84_DISTANCE_HAVERSINE );
+}
+
+static void bench_geo_index_create( size_t ops )
+{
+	geo_points( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		geo_index_t index;
+		geo_index_create( &index, geo.coords, INDEX_SIZE, WGS84_DISTANCE_HAVERSINE );
+		bench_escape( &index );
+		geo_index_destroy( &index );
+	}
+}
+
+static void bench_geo_index_radius( size_t ops )
+{
+	geo_points( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		geo.ids[ 0 ] = geo_index_radius( &geo.index, data.lon[ j ] * 0.02 - 80.0, data.lat[ j ] * 0.02 + 26.0, 20000.0, geo.ids, geo.distances, 64 );
+		bench_escape( geo.ids );
+	}
+}
+
+static void bench_geo_index_nearest( size_t ops )
+{
+	geo_points( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		geo_index_nearest( &geo.index, data.lon[ j ], data.lat[ j ], 8, geo.ids, geo.distances );
+		bench_escape( geo.ids );
+	}
+}
+
+/* What the index replaces: the nearest point by checking every point. */
+static void bench_geo_brute_force_nearest( size_t ops )
+{
+	geo_points( );
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i & (COUNT - 1);
+		double best = INFINITY;
+		for( size_t k = 0; k < INDEX_SIZE; k++ )
+		{
+			const double d = wgs84_geographic_geodesic_distance_haversine( data.lon[ j ], data.lat[ j ], geo.coords[ k ].lon, geo.coords[ k ].lat );
+			best = d < best ? d : best;
+		}
+		geo.distances[ 0 ] = best;
+		bench_escape( geo.distances );
+	}
+}
+
+/* Web Mercator; one operation is one projected point */
+BENCH( bench_web_mercator_tile, web_mercator_tile( data.lon[ j ], data.lat[ j ], 14, 256, (uint32_t*) &data.n[ j ], (uint32_t*) &data.n[ (j + 1) & (COUNT - 1) ], &data.d[ j ], &data.x[ j ] ) )
+
+static void bench_web_mercator_tile_array( size_t ops )
+{
+	static uint32_t tile_x[ COUNT ], tile_y[ COUNT ];
+	static double pixel_x[ COUNT ], pixel_y[ COUNT ];
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		web_mercator_tile_array( data.lon, data.lat, BATCH( i, ops ), 14, 256, tile_x, tile_y, pixel_x, pixel_y );
+	}
+	bench_escape( tile_x );
+	bench_escape( tile_y );
+	bench_escape( pixel_x );
+	bench_escape( pixel_y );
+}
+
+/*
+ * Tile buckets for a million points at zoom 14, half of them spread over
+ * the globe and half in a city sized area. One operation buckets all of
+ * them.
+ */
+#define BUCKET_SIZE    (1 << 20)
+
+static struct {
+	double*   lon;
+	double*   lat;
+	uint64_t* tiles;
+	size_t*   offsets;
+	size_t*   order;
+	void*     workspace;
+} tiles;
+
+static bool tile_points( void )
+{
+	if( tiles.lon )
+	{
+		return true;
+	}
+
+	tiles.lon       = malloc( BUCKET_SIZE * sizeof(double) );
+	tiles.lat       = malloc( BUCKET_SIZE * sizeof(double) );
+	tiles.tiles     = malloc( BUCKET_SIZE * sizeof(uint64_t) );
+	tiles.offsets   = malloc( (BUCKET_SIZE + 1) * sizeof(size_t) );
+	tiles.order     = malloc( BUCKET_SIZE * sizeof(size_t) );
+	tiles.workspace = malloc( web_mercator_bucket_workspace_size( BUCKET_SIZE ) );
+	if( !tiles.lon || !tiles.lat || !tiles.tiles || !tiles.offsets || !tiles.order || !tiles.workspace )
+	{
+		return false;
+	}
+
+	m3d_random_t random;
+	m3d_random_seed( &random, SEED );
+	for( size_t i = 0; i < BUCKET_SIZE; i++ )
+	{
+		if( i % 2 == 0 )
+		{
+			tiles.lon[ i ] = m3d_random_ranged( &random, -180.0, 180.0 );
+			tiles.lat[ i ] = m3d_random_ranged( &random, -85.0, 85.0 );
+		}
+		else
+		{
+			tiles.lon[ i ] = -80.2 + m3d_random_ranged( &random, -0.2, 0.2 );
+			tiles.lat[ i ] = 25.8 + m3d_random_ranged( &random, -0.2, 0.2 );
+		}
+	}
+	return true;
+}
+
+static void bench_web_mercator_bucket( size_t ops )
+{
+	size_t tile_count = 0;
+	if( !tile_points( ) )
+	{
+		return;
+	}
+
+	for( size_t i = 0; i < ops; i++ )
+	{
+		web_mercator_bucket( tiles.lon, tiles.lat, BUCKET_SIZE, 14, tiles.tiles, tiles.offsets, tiles.order, &tile_count, tiles.workspace );
+	}
+	bench_escape( tiles.order );
+}
+
+/* Numerical methods */
+static double cubic( double x )
+{
+	return x * x * x + 4 * x * x - 10;
+}
+
+static double fixed_point( double x )
+{
+	return sin( 0.5 * x + M_PI / 8.0 ) + x;
+}
+
+static double cubic_derivative( double x )
+{
+	return 3 * x * x + 8 * x;
+}
+
+static void cubic_fdf( double x, double* f, double* df )
+{
+	*f  = x * x * x + 4 * x * x - 10;
+	*df = 3 * x * x + 8 * x;
+}
+
+BENCH( bench_bissection_method,   m3d_bissection_method( 1.0, 2.0 + data.d[ j ] * 1e-9, 1e-12, 100, cubic, &data.d[ j ] ) )
+BENCH( bench_secant_method,       m3d_secant_method( 1.0, 2.0 + data.d[ j ] * 1e-9, 1e-12, 100, cubic, &data.d[ j ] ) )
+BENCH( bench_fixed_point_iteration, m3d_fixed_point_iteration( 3.0 + data.d[ j ] * 1e-9, 1e-12, 1000, fixed_point, &data.d[ j ] ) )
+BENCH( bench_brent_method,        m3d_brent_method( 1.0, 2.0 + data.d[ j ] * 1e-9, 1e-12, 100, cubic, &data.d[ j ], NULL ) )
+BENCH( bench_newton_raphson_method, m3d_newton_raphson_method( 1.0, 2.0 + data.d[ j ] * 1e-9, 1e-12, 100, cubic, cubic_derivative, &data.d[ j ], NULL ) )
+BENCH( bench_newton_raphson_method_fdf, m3d_newton_raphson_method_fdf( 1.0, 2.0 + data.d[ j ] * 1e-9, 1e-12, 100, cubic_fdf, &data.d[ j ], NULL ) )
+
+/* Batches of COUNT equations like the ones above; one operation is one
+ * equation. */
+static void cubic_batch( const double x[], double y[], size_t count, const size_t equations[], void* context )
+{
+	(void) equations;
+	(void) context;
+	for( size_t k = 0; k < count; k++ )
+	{
+		y[ k ] = x[ k ] * x[ k ] * x[ k ] + 4 * x[ k ] * x[ k ] - 10;
+	}
+}
+
+static void fixed_point_batch( const double x[], double y[], size_t count, const size_t equations[], void* context )
+{
+	(void) equations;
+	(void) context;
+	for( size_t k = 0; k < count; k++ )
+	{
+		y[ k ] = sin( 0.5 * x[ k ] + M_PI / 8.0 ) + x[ k ];
+	}
+}
+
+static struct {
+	double a[ COUNT ], b[ COUNT ], roots[ COUNT ];
+	m3d_root_status_t status[ COUNT ];
+	double workspace[ 8 * COUNT ];
+} roots;
+
+static void root_brackets( double a, double b )
+{
+	assert( m3d_root_batch_workspace_size( COUNT ) <= sizeof(roots.workspace) );
+	for( size_t j = 0; j < COUNT; j++ )
+	{
+		roots.a[ j ] = a;
+		roots.b[ j ] = b + j * 1e-9;
+	}
+}
+
+static void bench_bissection_method_batch( size_t ops )
+{
+	root_brackets( 1.0, 2.0 );
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_bissection_method_batch( roots.a, roots.b, BATCH( i, ops ), 1e-12, 100, cubic_batch, NULL, roots.roots, roots.status, roots.workspace );
+	}
+	bench_escape( &roots );
+}
+
+static void bench_secant_method_batch( size_t ops )
+{
+	root_brackets( 1.0, 2.0 );
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_secant_method_batch( roots.a, roots.b, BATCH( i, ops ), 1e-12, 100, cubic_batch, NULL, roots.roots, roots.status, roots.workspace );
+	}
+	bench_escape( &roots );
+}
+
+static void bench_fixed_point_iteration_batch( size_t ops )
+{
+	root_brackets( 3.0, 3.0 );
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_fixed_point_iteration_batch( roots.b, BATCH( i, ops ), 1e-12, 1000, fixed_point_batch, NULL, roots.roots, roots.status, roots.workspace );
+	}
+	bench_escape( &roots );
+}
+
+/* One operation is one fitted point */
+static void bench_least_squares_linear( size_t ops )
+{
+	double m, b;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_least_squares_linear( data.lon, data.lat, BATCH( i, ops ), &m, &b );
+		bench_escape( &m );
+		bench_escape( &b );
+	}
+}
+
+static void bench_least_squares_quadratic( size_t ops )
+{
+	double a, b, c;
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_least_squares_quadratic( data.lon, data.lat, BATCH( i, ops ), &a, &b, &c );
+		bench_escape( &a );
+		bench_escape( &b );
+		bench_escape( &c );
+	}
+}
+
+/* One operation is one fitted point */
+static void bench_least_squares_polynomial( size_t ops )
+{
+	static double workspace[ COUNT * 5 ];
+	double c[ 4 ];
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_least_squares_polynomial( data.lon, data.lat, BATCH( i, ops ), 3, c, NULL, workspace );
+		bench_escape( c );
+	}
+}
+
+/* One operation is one fitted series of COUNT points, in batches of up to
+ * POLYNOMIAL_SERIES series. */
+#define POLYNOMIAL_SERIES   (64)
+
+static struct {
+	double x[ POLYNOMIAL_SERIES * COUNT ];
+	double y[ POLYNOMIAL_SERIES * COUNT ];
+	double coefficients[ POLYNOMIAL_SERIES * 4 ];
+	double errors[ POLYNOMIAL_SERIES ];
+} polynomials;
+
+static void bench_least_squares_polynomial_batch( size_t ops, bool shared_x )
+{
+	if( polynomials.x[ 1 ] == 0.0 )
+	{
+		for( size_t s = 0; s < POLYNOMIAL_SERIES; s++ )
+		{
+			for( size_t i = 0; i < COUNT; i++ )
+			{
+				polynomials.x[ s * COUNT + i ] = data.lon[ i ] + s;
+				polynomials.y[ s * COUNT + i ] = data.lat[ (i + s) & (COUNT - 1) ];
+			}
+		}
+	}
+
+	for( size_t i = 0; i < ops; i += POLYNOMIAL_SERIES )
+	{
+		const size_t series = ops - i < POLYNOMIAL_SERIES ? ops - i : POLYNOMIAL_SERIES;
+		m3d_least_squares_polynomial_batch( polynomials.x, polynomials.y, COUNT, series, 3, shared_x, polynomials.coefficients, polynomials.errors );
+		bench_escape( polynomials.coefficients );
+	}
+}
+
+static void bench_least_squares_polynomial_batch_separate( size_t ops )
+{
+	bench_least_squares_polynomial_batch( ops, false );
+}
+
+static void bench_least_squares_polynomial_batch_shared( size_t ops )
+{
+	bench_least_squares_polynomial_batch( ops, true );
+}
+
+/* One operation is one added point */
+static void bench_least_squares_accumulator_add( size_t ops )
+{
+	m3d_least_squares_accumulator_t accumulator;
+	m3d_least_squares_accumulator_init( &accumulator );
+	for( size_t i = 0; i < ops; i += COUNT )
+	{
+		m3d_least_squares_accumulator_add_array( &accumulator, data.lon, data.lat, BATCH( i, ops ) );
+	}
+	bench_escape( &accumulator );
+}
+
+/* One operation moves a window of 64 points by one point and fits a line,
+ * by updating an accumulator or by fitting the whole window again. */
+#define LEAST_SQUARES_WINDOW   (64)
+
+static void bench_least_squares_accumulator_window( size_t ops )
+{
+	/* The window carries over from call to call, so that filling it is
+	 * not timed. */
+	static m3d_least_squares_accumulator_t accumulator;
+	static size_t oldest = 0;
+	double m, b;
+
+	if( accumulator.count == 0 )
+	{
+		m3d_least_squares_accumulator_add_array( &accumulator, data.lon, data.lat, LEAST_SQUARES_WINDOW );
+	}
+	for( size_t i = 0; i < ops; i++, oldest++ )
+	{
+		const size_t j = (oldest + LEAST_SQUARES_WINDOW) & (COUNT - 1);
+		const size_t k = oldest & (COUNT - 1);
+		m3d_least_squares_accumulator_add( &accumulator, data.lon[ j ], data.lat[ j ] );
+		m3d_least_squares_accumulator_remove( &accumulator, data.lon[ k ], data.lat[ k ] );
+		m3d_least_squares_accumulator_linear( &accumulator, &m, &b );
+		bench_escape( &m );
+		bench_escape( &b );
+	}
+}
+
+static void bench_least_squares_linear_window( size_t ops )
+{
+	double m, b;
+	for( size_t i = 0; i < ops; i++ )
+	{
+		const size_t j = i % (COUNT - LEAST_SQUARES_WINDOW);
+		m3d_least_squares_linear( data.lon + j, data.lat + j, LEAST_SQUARES_WINDOW, &m, &b );
+		bench_escape( &m );
+		bench_escape( &b );
+	}
+}
+
+/* Assignment of a 4x4 cost matrix */
+static void bench_hungarian_assignment( size_t ops )
+{
+	static int cost[] = {
+		 4,  7,  3,  5,
+		 6,  2, 13,  2,
+		14,  8,  1,  0,
+		11,  9,  4, 13
+	};
+	int output[ 4 ];
+
+	for( size_t i = 0; i < ops; i++ )
+	{
+		hungarian_assignment( false, cost, 4, 4, output );
+		bench_escape( output );
+	}
+}
+
+/* Assignment of a random cost matrix, with a reused workspace */
+static void bench_hungarian_assignmentd( size_t ops, size_t workers, size_t tasks )
+{
+	double* cost    = malloc( workers * tasks * sizeof(double) );
+	int* output     = malloc( workers * sizeof(int) );
+	void* workspace = malloc( hungarian_workspace_size( workers, tasks ) );
+
+	if( cost && output && workspace )
+	{
+		m3d_random_t random;
+		m3d_random_seed( &random, SEED );
+		m3d_fill_uniformd( &random, cost, workers * tasks );
+
+		for( size_t i = 0; i < ops; i++ )
+		{
+			hungarian_assignmentd( false, cost, workers, tasks, output, workspace );
+			bench_escape( output );
+		}
+	}
+
+	free( cost );
+	free( output );
+	free( workspace );
+}
+
+static void bench_hungarian_assignmentd_64( size_t ops )       { bench_hungarian_assignmentd( ops, 64, 64 ); }
+static void bench_hungarian_assignmentd_512( size_t ops )      { bench_hungarian_assignmentd( ops, 512, 512 ); }
+static void bench_hungarian_assignmentd_256x1024( size_t ops ) { bench_hungarian_assignmentd( ops, 256, 1024 ); }
+
+/*
+ * Sparse assignment of 10000 workers to 10000 tasks with 8 allowed pairs
+ * each, either within clusters of 16 (many small components) or anywhere
+ * (one large component).
+ */
+#define SPARSE_SIZE    (10000)
+#define SPARSE_PAIRS   (8)
+
+static struct {
+	size_t offsets[ SPARSE_SIZE + 1 ];
+	int    columns[ SPARSE_SIZE * SPARSE_PAIRS ];
+	double costs[ SPARSE_SIZE * SPARSE_PAIRS ];
+	int    output[ SPARSE_SIZE ];
+} sparse;
+
+static void sparse_problem( bool clustered )
+{
+	m3d_random_t random;
+	m3d_random_seed( &random, SEED );
+
+	for( size_t w = 0; w < SPARSE_SIZE; w++ )
+	{
+		sparse.offsets[ w ] = w * SPARSE_PAIRS;
+		for( size_t e = 0; e < SPARSE_PAIRS; e++ )
+		{
+			sparse.columns[ w * SPARSE_PAIRS + e ] = clustered ?
+				(int) ((w & ~(size_t) 15) + ((w + 3 * e) & 15)) :
+				(int) ((w + e * 1237 + (size_t) m3d_random_rangei( &random, 0, 1236 )) % SPARSE_SIZE);
+			sparse.costs[ w * SPARSE_PAIRS + e ] = m3d_random_uniformd( &random );
+		}
+	}
+	sparse.offsets[ SPARSE_SIZE ] = SPARSE_SIZE * SPARSE_PAIRS;
+}
+
+static void bench_sparse_assignment( size_t ops, bool clustered, bool components )
+{
+	sparse_problem( clustered );
+
+	for( size_t i = 0; i < ops; i++ )
+	{
+		sparse_assignmentd( false, SPARSE_SIZE, SPARSE_SIZE, sparse.offsets, sparse.columns, sparse.costs, 2.0, components, sparse.output );
+		bench_escape( sparse.output );
+	}
+}
+
+static void bench_sparse_assignment_clustered( size_t ops )            { bench_sparse_assignment( ops, true, false ); }
+static void bench_sparse_assignment_clustered_components( size_t ops ) { bench_sparse_assignment( ops, true, true ); }
+static void bench_sparse_assignment_random( size_t ops )               { bench_sparse_assignment( ops, false, true ); }
+
+/* Random numbers */
+BENCH( bench_m3d_uniformf,        data.s[ j ] = m3d_uniformf( ) )
+BENCH( bench_m3d_uniformd,        data.d[ j ] = m3d_uniformd( ) )
+BENCH( bench_m3d_uniform_rangei,  data.d[ j ] = m3d_uniform_rangei( -100, 100 ) )
+BENCH( bench_m3d_guassianf,       data.f[ j ] = m3d_guassianf( 0.0f, 1.0f ) )
+BENCH( bench_m3d_guassiand,       data.d[ j ] = m3d_guassiand( 0.0, 1.0 ) )
+
+static m3d_random_t generator;
+
+BENCH( bench_m3d_random_next,     data.d[ j ] = (double) m3d_random_next( &generator ) )
+BENCH( bench_m3d_random_uniformd, data.d[ j ] = m3d_random_uniformd( &generator ) )
+BENCH( bench_m3d_random_rangei,   data.d[ j ] = m3d_random_rangei( &generator, -100, 100 ) )
+BENCH( bench_m3d_random_guassiand, data.d[ j ] = m3d_random_guassiand( &generator, 0.0, 1.0 ) )
+
+/* One operation is one filled value */
+#define FILL( function, statement ) \
+	static void function( size_t ops ) \
+	{ \
+		for( size_t i = 0; i < ops; i += COUNT ) \
+		{ \
+			const size_t n = BATCH( i, ops ); \
+			statement; \
+		} \
+		bench_escape( &data ); \
+	}
+
+FILL( bench_m3d_fill_uniformf,    m3d_fill_uniformf( &generator, data.f, n ) )
+FILL( bench_m3d_fill_uniformd,    m3d_fill_uniformd( &generator, data.d, n ) )
+FILL( bench_m3d_fill_rangei,      m3d_fill_rangei( &generator, data.n, n, -100, 100 ) )
+FILL( bench_m3d_fill_guassianf,   m3d_fill_guassianf( &generator, data.f, n, 0.0f, 1.0f ) )
+FILL( bench_m3d_fill_guassiand,   m3d_fill_guassiand( &generator, data.d, n, 0.0, 1.0 ) )
+FILL( bench_m3d_fill_unit_vec3,   m3d_fill_unit_vec3( &generator, data.v3r, n ) )
+FILL( bench_m3d_fill_in_disk,     m3d_fill_in_disk( &generator, data.v2r, n, 1 ) )
+FILL( bench_m3d_fill_in_sphere,   m3d_fill_in_sphere( &generator, data.v3r, n, 1 ) )
+
+/* Fixed point decimals */
+BENCH( bench_fpdec_add,           bool ok; data.fr[ j ] = m3d_fixed_point_decimal_add( data.fa[ j ], data.fb[ j ], &ok ) )
+BENCH( bench_fpdec_multiply,      bool ok; data.fr[ j ] = m3d_fixed_point_decimal_multiply( data.fa[ j ], data.fb[ j ], &ok ) )
+BENCH( bench_fpdec_divide,        bool ok; data.fr[ j ] = m3d_fixed_point_decimal_divide( data.fa[ j ], data.fb[ j ], &ok ) )
+BENCH( bench_fpdec_from_double,   data.fr[ j ] = m3d_fixed_point_decimal_from_double( data.d[ j ] ) )
+
+typedef struct bench_entry {
+	const char* group;
+	const char* name;
+	bench_body_t body;
+} bench_entry_t;
+
+static const bench_entry_t benchmarks[] = {
+	{ "vec2", "vec2_add", bench_vec2_add },
+	{ "vec2", "vec2_dot_product", bench_vec2_dot_product },
+	{ "vec2", "vec2_normalize", bench_vec2_normalize },
+	{ "vec3", "vec3_add", bench_vec3_add },
+	{ "vec3", "vec3_dot_product", bench_vec3_dot_product },
+	{ "vec3", "vec3_cross_product", bench_vec3_cross_product },
+	{ "vec3", "vec3_normalize", bench_vec3_normalize },
+	{ "vec3", "vec3_angle", bench_vec3_angle },
+	{ "vec4", "vec4_add", bench_vec4_add },
+	{ "vec4", "vec4_dot_product", bench_vec4_dot_product },
+	{ "vec4", "vec4_normalize", bench_vec4_normalize },
+	{ "vec3-array", "vec3_array_add", bench_vec3_array_add },
+	{ "vec3-array", "vec3_array_normalize", bench_vec3_array_normalize },
+	{ "format", "vec3_to_string_r", bench_vec3_to_string_r },
+	{ "format", "vec3_format", bench_vec3_format },
+	{ "format", "mat4_to_string_r", bench_mat4_to_string_r },
+	{ "format", "mat4_format", bench_mat4_format },
+	{ "mat2", "mat2_mult_matrix", bench_mat2_mult_matrix },
+	{ "mat2", "mat2_invert", bench_mat2_invert },
+	{ "mat3", "mat3_mult_matrix", bench_mat3_mult_matrix },
+	{ "mat3", "mat3_mult_vector", bench_mat3_mult_vector },
+	{ "mat3", "mat3_invert", bench_mat3_invert },
+	{ "mat4", "mat4_mult_matrix", bench_mat4_mult_matrix },
+	{ "mat4", "mat4_mult_vector", bench_mat4_mult_vector },
+	{ "mat4", "mat4_determinant", bench_mat4_determinant },
+	{ "mat4", "mat4_invert_general", bench_mat4_invert_general },
+	{ "mat4", "mat4_invert_affine", bench_mat4_invert_affine },
+	{ "mat4", "mat4_invert_rigid", bench_mat4_invert_rigid },
+	{ "mat4", "mat4_transform_points3", bench_mat4_transform_points3 },
+	{ "quat", "quat_multiply", bench_quat_multiply },
+	{ "quat", "quat_rotate3", bench_quat_rotate3 },
+	{ "quat", "quat_slerp", bench_quat_slerp },
+	{ "quat", "quat_to_mat4", bench_quat_to_mat4 },
+	{ "quat", "quat_from_mat4", bench_quat_from_mat4 },
+	{ "quat-array", "quat_array_nlerp", bench_quat_array_nlerp },
+	{ "quat-array", "quat_array_slerp", bench_quat_array_slerp },
+	{ "quat-array", "quat_array_blend_3", bench_quat_array_blend_3 },
+	{ "skinning", "skinning_palette_loop", bench_skinning_palette_loop },
+	{ "skinning", "skinning_palette_build", bench_skinning_palette_build },
+	{ "skinning", "skinning_palette_build_3x4_unscaled", bench_skinning_palette_build_3x4 },
+	{ "skinning", "skinning_linear_blend_loop", bench_skinning_linear_blend_loop },
+	{ "skinning", "dual_quat_skin_loop", bench_dual_quat_skin_loop },
+	{ "skinning", "dual_quat_skin", bench_dual_quat_skin },
+	{ "packed-transforms", "quat_copy", bench_quat_copy },
+	{ "packed-transforms", "quat_unpack32", bench_quat_unpack32 },
+	{ "packed-transforms", "quat_unpack32_batch", bench_quat_unpack32_batch },
+	{ "packed-transforms", "quat_unpack32_array", bench_quat_unpack32_array },
+	{ "packed-transforms", "quat_unpack48", bench_quat_unpack48 },
+	{ "packed-transforms", "quat_unpack48_batch", bench_quat_unpack48_batch },
+	{ "packed-transforms", "quat_unpack_octahedral", bench_quat_unpack_octahedral },
+	{ "packed-transforms", "quat_unpack_octahedral_batch", bench_quat_unpack_octahedral_batch },
+	{ "packed-transforms", "vec3_copy", bench_vec3_copy },
+	{ "packed-transforms", "vec3_unpack48", bench_vec3_unpack48 },
+	{ "packed-transforms", "vec3_unpack48_batch", bench_vec3_unpack48_batch },
+	{ "transform-hierarchy", "scene_loop_65536", bench_scene_loop },
+	{ "transform-hierarchy", "transform_hierarchy_update_all_65536", bench_transform_hierarchy_update_all },
+	{ "transform-hierarchy", "transform_hierarchy_update_1_percent_65536", bench_transform_hierarchy_update_1_percent },
+	{ "transforms", "m3d_look_at", bench_m3d_look_at },
+	{ "transforms", "m3d_rotate_from_vec3_to_vec3", bench_m3d_rotate_vec3_to_vec3 },
+	{ "transforms", "m3d_euler_transform", bench_m3d_euler_transform },
+	{ "projections", "m3d_perspective", bench_m3d_perspective },
+	{ "projections", "m3d_perspective_divide", bench_m3d_perspective_divide },
+	{ "geographic", "wgs84_geographic_to_cartesian", bench_wgs84_geographic_to_cartesian },
+	{ "geographic", "wgs84_cartesian_to_geographic", bench_wgs84_cartesian_to_geographic },
+	{ "geographic", "wgs84_cartesian_to_geographic_bowring", bench_wgs84_cartesian_to_geographic_bowring },
+	{ "geographic", "wgs84_cartesian_to_geographic_vermeille", bench_wgs84_cartesian_to_geographic_vermeille },
+	{ "geographic", "wgs84_geographic_to_cartesian_array", bench_wgs84_geographic_to_cartesian_array },
+	{ "geographic", "wgs84_cartesian_to_geographic_array", bench_wgs84_cartesian_to_geographic_array },
+	{ "geographic", "wgs84_geographic_to_mercator", bench_wgs84_geographic_to_mercator },
+	{ "geographic", "wgs84_mercator_to_geographic", bench_wgs84_mercator_to_geographic },
+	{ "geographic", "geo_frame_from_geographic", bench_geo_frame_from_geographic },
+	{ "geographic", "geo_frame_init_each_point", bench_geo_frame_init_each },
+	{ "geographic", "geo_frame_from_geographic_array", bench_geo_frame_from_geographic_array },
+	{ "geographic", "geo_frame_from_cartesian_array", bench_geo_frame_from_cartesian_array },
+	{ "geographic", "wgs84_distance_vincenty", bench_wgs84_distance_vincenty },
+	{ "geographic", "wgs84_distance_vincenty_pairs", bench_wgs84_distance_vincenty_pairs },
+	{ "geographic", "wgs84_distance_vincenty_matrix", bench_wgs84_distance_vincenty_matrix },
+	{ "geographic", "wgs84_distance_lamberts", bench_wgs84_distance_lamberts },
+	{ "geographic", "wgs84_distance_haversine", bench_wgs84_distance_haversine },
+	{ "geographic", "geo_index_create_100000", bench_geo_index_create },
+	{ "geographic", "geo_index_radius_20km", bench_geo_index_radius },
+	{ "geographic", "geo_index_nearest_8", bench_geo_index_nearest },
+	{ "geographic", "brute_force_nearest_1", bench_geo_brute_force_nearest },
+	{ "web-mercator", "web_mercator_tile", bench_web_mercator_tile },
+	{ "web-mercator", "web_mercator_tile_array", bench_web_mercator_tile_array },
+	{ "web-mercator", "web_mercator_bucket_1m_zoom_14", bench_web_mercator_bucket },
+	{ "numerical-methods", "m3d_bissection_method", bench_bissection_method },
+	{ "numerical-methods", "m3d_secant_method", bench_secant_method },
+	{ "numerical-methods", "m3d_fixed_point_iteration", bench_fixed_point_iteration },
+	{ "numerical-methods", "m3d_brent_method", bench_brent_method },
+	{ "numerical-methods", "m3d_newton_raphson_method", bench_newton_raphson_method },
+	{ "numerical-methods", "m3d_newton_raphson_method_fdf", bench_newton_raphson_method_fdf },
+	{ "numerical-methods", "m3d_bissection_method_batch", bench_bissection_method_batch },
+	{ "numerical-methods", "m3d_secant_method_batch", bench_secant_method_batch },
+	{ "numerical-methods", "m3d_fixed_point_iteration_batch", bench_fixed_point_iteration_batch },
+	{ "numerical-methods", "m3d_least_squares_linear", bench_least_squares_linear },
+	{ "numerical-methods", "m3d_least_squares_quadratic", bench_least_squares_quadratic },
+	{ "numerical-methods", "m3d_least_squares_polynomial_3", bench_least_squares_polynomial },
+	{ "numerical-methods", "m3d_least_squares_polynomial_batch_3", bench_least_squares_polynomial_batch_separate },
+	{ "numerical-methods", "m3d_least_squares_polynomial_batch_3_shared_x", bench_least_squares_polynomial_batch_shared },
+	{ "numerical-methods", "m3d_least_squares_accumulator_add", bench_least_squares_accumulator_add },
+	{ "numerical-methods", "m3d_least_squares_accumulator_window_64", bench_least_squares_accumulator_window },
+	{ "numerical-methods", "m3d_least_squares_linear_window_64", bench_least_squares_linear_window },
+	{ "algorithms", "hungarian_assignment_4x4", bench_hungarian_assignment },
+	{ "algorithms", "hungarian_assignmentd_64x64", bench_hungarian_assignmentd_64 },
+	{ "algorithms", "hungarian_assignmentd_512x512", bench_hungarian_assignmentd_512 },
+	{ "algorithms", "hungarian_assignmentd_256x1024", bench_hungarian_assignmentd_256x1024 },
+	{ "algorithms", "sparse_assignmentd_10000_clustered", bench_sparse_assignment_clustered },
+	{ "algorithms", "sparse_assignmentd_10000_clustered_components", bench_sparse_assignment_clustered_components },
+	{ "algorithms", "sparse_assignmentd_10000_random", bench_sparse_assignment_random },
+	{ "random", "m3d_uniformf", bench_m3d_uniformf },
+	{ "random", "m3d_uniformd", bench_m3d_uniformd },
+	{ "random", "m3d_uniform_rangei", bench_m3d_uniform_rangei },
+	{ "random", "m3d_guassianf", bench_m3d_guassianf },
+	{ "random", "m3d_guassiand", bench_m3d_guassiand },
+	{ "random", "m3d_random_next", bench_m3d_random_next },
+	{ "random", "m3d_random_uniformd", bench_m3d_random_uniformd },
+	{ "random", "m3d_random_rangei", bench_m3d_random_rangei },
+	{ "random", "m3d_random_guassiand", bench_m3d_random_guassiand },
+	{ "random", "m3d_fill_uniformf", bench_m3d_fill_uniformf },
+	{ "random", "m3d_fill_uniformd", bench_m3d_fill_uniformd },
+	{ "random", "m3d_fill_rangei", bench_m3d_fill_rangei },
+	{ "random", "m3d_fill_guassianf", bench_m3d_fill_guassianf },
+	{ "random", "m3d_fill_guassiand", bench_m3d_fill_guassiand },
+	{ "random", "m3d_fill_unit_vec3", bench_m3d_fill_unit_vec3 },
+	{ "random", "m3d_fill_in_disk", bench_m3d_fill_in_disk },
+	{ "random", "m3d_fill_in_sphere", bench_m3d_fill_in_sphere },
+	{ "fixed-point-decimal", "fpdec_add", bench_fpdec_add },
+	{ "fixed-point-decimal", "fpdec_multiply", bench_fpdec_multiply },
+	{ "fixed-point-decimal", "fpdec_divide", bench_fpdec_divide },
+	{ "fixed-point-decimal", "fpdec_from_double", bench_fpdec_from_double },
+};
+
+#define BENCHMARK_COUNT   (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static const char* simd_string( void )
+{
+	#if defined(M3D_SIMD_SCALAR)
+	return "scalar";
+	#elif defined(M3D_SIMD_AVX512F)
+	return "avx512f";
+	#elif defined(M3D_SIMD_AVX2) && defined(M3D_SIMD_FMA)
+	return "avx2+fma";
+	#elif defined(M3D_SIMD_AVX)
+	return "avx";
+	#elif defined(M3D_SIMD_SSE2)
+	return "sse2";
+	#elif defined(M3D_SIMD_NEON)
+	return "neon";
+	#else
+	return "unknown";
+	#endif
+}
+
+static void initialize( void )
+{
+	m3d_seed( SEED );
+	m3d_random_seed( &generator, SEED );
+
+	for( size_t i = 0; i < COUNT; i++ )
+	{
+		data.v2a[ i ] = VEC2( m3d_uniform_unitf(), m3d_uniform_unitf() );
+		data.v2b[ i ] = VEC2( m3d_uniform_unitf(), m3d_uniform_unitf() );
+		data.v3a[ i ] = VEC3( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf() );
+		data.v3b[ i ] = VEC3( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf() );
+		data.v4a[ i ] = VEC4( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf(), 1 );
+		data.v4b[ i ] = VEC4( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_rangef( 0.5, 2 ) );
+		data.s[ i ]   = m3d_uniform_unitf();
+
+		for( size_t k = 0; k < 4; k++ )
+		{
+			data.m2a[ i ].m[ k ] = m3d_uniform_unitf();
+			data.m2b[ i ].m[ k ] = m3d_uniform_unitf();
+		}
+		for( size_t k = 0; k < 9; k++ )
+		{
+			data.m3a[ i ].m[ k ] = m3d_uniform_unitf();
+			data.m3b[ i ].m[ k ] = m3d_uniform_unitf();
+		}
+		for( size_t k = 0; k < 16; k++ )
+		{
+			data.m4a[ i ].m[ k ] = m3d_uniform_unitf();
+			data.m4b[ i ].m[ k ] = m3d_uniform_unitf();
+		}
+		/* Keep the general matrices well away from singular */
+		data.m4a[ i ].m[ 0] += 4; data.m4a[ i ].m[ 5] += 4; data.m4a[ i ].m[10] += 4; data.m4a[ i ].m[15] += 4;
+
+		vec3_t axis = VEC3( data.v3a[ i ].x, data.v3a[ i ].y, data.v3a[ i ].z + 2 );
+		data.rigid[ i ] = mat4_from_axis3_angle( &axis, m3d_uniform_rangef( -3, 3 ) );
+		data.rigid[ i ].m[12] = data.v3b[ i ].x;
+		data.rigid[ i ].m[13] = data.v3b[ i ].y;
+		data.rigid[ i ].m[14] = data.v3b[ i ].z;
+		data.affine[ i ] = data.rigid[ i ];
+		for( size_t k = 0; k < 3; k++ )
+		{
+			data.affine[ i ].m[ k ] *= 2;
+		}
+
+		vec3_t q_axis = data.v3a[ i ];
+		data.qa[ i ] = quat_from_axis3_angle( &q_axis, m3d_uniform_rangef( -3, 3 ) );
+		data.qb[ i ] = quat_from_axis3_angle( &q_axis, m3d_uniform_rangef( -3, 3 ) );
+		quat_normalize( &data.qa[ i ] );
+		quat_normalize( &data.qb[ i ] );
+
+		data.lon[ i ] = m3d_uniform_ranged( -180, 180 );
+		data.lat[ i ] = m3d_uniform_ranged( -89, 89 );
+		data.alt[ i ] = m3d_uniform_ranged( -100, 10000 );
+		wgs84_geographic_to_cartesian( data.lon[ i ], data.lat[ i ], data.alt[ i ], &data.x[ i ], &data.y[ i ], &data.z[ i ] );
+		data.d[ i ] = m3d_uniformd( );
+
+		data.fa[ i ] = m3d_fixed_point_decimal_create( m3d_uniform_rangei( -1000, 1000 ), m3d_uniform_rangei( 0, 99 ) );
+		data.fb[ i ] = m3d_fixed_point_decimal_create( m3d_uniform_rangei( 1, 1000 ), m3d_uniform_rangei( 0, 99 ) );
+	}
+
+	vec3_array_create( &data.array_a, COUNT );
+	vec3_array_create( &data.array_b, COUNT );
+	vec3_array_create( &data.array_r, COUNT );
+	vec3_array_create( &data.array_n, COUNT );
+	vec3_array_from_vec3( &data.array_a, data.v3a, COUNT );
+	vec3_array_from_vec3( &data.array_b, data.v3b, COUNT );
+	quat_array_create( &data.quats_a, COUNT );
+	quat_array_create( &data.quats_b, COUNT );
+	quat_array_create( &data.quats_c, COUNT );
+	quat_array_create( &data.quats_r, COUNT );
+	quat_array_from_quat( &data.quats_a, data.qa, COUNT );
+	quat_array_from_quat( &data.quats_b, data.qb, COUNT );
+	for( size_t i = 0; i < COUNT; i++ )
+	{
+		data.qr[ i ]   = quat_multiply( &data.qa[ i ], &data.qb[ i ] );
+		data.mask[ i ] = m3d_uniformf( );
+		data.parents[ i ] = i % 64 == 0 ? -1 : (i % 4 == 0 ? m3d_uniform_rangei( (int) (i & ~(size_t) 63), i - 1 ) : (int) i - 1);
+
+		data.dq[ i ] = dual_quat_from_mat4( &data.rigid[ i ] );
+		scaler_t total = 0;
+		for( size_t k = 0; k < 4; k++ )
+		{
+			data.joints[ i ][ k ]  = (uint16_t) m3d_uniform_rangei( 0, 63 );
+			data.weights[ i ][ k ] = m3d_uniform_rangef( 0.1, 1 );
+			total += data.weights[ i ][ k ];
+		}
+		for( size_t k = 0; k < 4; k++ )
+		{
+			data.weights[ i ][ k ] /= total;
+		}
+
+		data.packed32[ i ]   = quat_pack32( &data.qa[ i ] );
+		data.packed48[ i ]   = quat_pack48( &data.qa[ i ] );
+		data.octahedral[ i ] = quat_pack_octahedral( &data.qa[ i ] );
+		data.packed_v3[ i ]  = vec3_pack48( &data.v3a[ i ], &packed_min, &packed_max );
+	}
+	quat_array_from_quat( &data.quats_c, data.qr, COUNT );
+}
+
+int main( int argc, char* argv[] )
+{
+	size_t samples     = 31;
+	const char* filter = NULL;
+	const char* json   = NULL;
+
+	for( int a = 1; a < argc; a++ )
+	{
+		if( strcmp( argv[ a ], "--samples" ) == 0 && a + 1 < argc )
+		{
+			samples = strtoul( argv[ ++a ], NULL, 10 );
+			if( samples < 1 ) samples = 1;
+		}
+		else if( strcmp( argv[ a ], "--filter" ) == 0 && a + 1 < argc )
+		{
+			filter = argv[ ++a ];
+		}
+		else if( strcmp( argv[ a ], "--json" ) == 0 && a + 1 < argc )
+		{
+			json = argv[ ++a ];
+		}
+		else if( strcmp( argv[ a ], "--list" ) == 0 )
+		{
+			for( size_t b = 0; b < BENCHMARK_COUNT; b++ )
+			{
+				printf( "%s/%s\n", benchmarks[ b ].group, benchmarks[ b ].name );
+			}
+			return 0;
+		}
+		else
+		{
+			fprintf( stderr, "Usage: %s [--samples N] [--filter TEXT] [--json FILE|-] [--list]\n", argv[ 0 ] );
+			return 1;
+		}
+	}
+
+	/* With JSON on stdout the table goes to stderr. */
+	bool json_stdout = json && strcmp( json, "-" ) == 0;
+	FILE* table = json_stdout ? stderr : stdout;
+	FILE* out   = NULL;
+
+	if( json )
+	{
+		out = json_stdout ? stdout : fopen( json, "w" );
+		if( !out )
+		{
+			fprintf( stderr, "Unable to open %s.\n", json );
+			return 1;
+		}
+	}
+
+	initialize( );
+
+	bench_result_t* results = calloc( BENCHMARK_COUNT, sizeof(bench_result_t) );
+	size_t count = 0;
+	if( !results )
+	{
+		fprintf( stderr, "Out of memory.\n" );
+		return 1;
+	}
+
+	fprintf( table, "libm3d benchmarks (scaler_t is %s, %s, %zu samples)\n", scaler_type_string(), simd_string(), samples );
+	bench_print_header( table );
+
+	for( size_t b = 0; b < BENCHMARK_COUNT; b++ )
+	{
+		const bench_entry_t* e = &benchmarks[ b ];
+		char label[ 128 ];
+		snprintf( label, sizeof(label), "%s/%s", e->group, e->name );
+
+		if( filter && !strstr( label, filter ) )
+		{
+			continue;
+		}
+
+		if( bench_measure( &results[ count ], e->group, e->name, e->body, samples ) )
+		{
+			bench_print( table, &results[ count ] );
+			count += 1;
+		}
+	}
+
+	if( out )
+	{
+		fprintf( out, "{\n" );
+		fprintf( out, "  \"library\": \"libm3d\",\n" );
+		fprintf( out, "  \"scaler\": \"%s\",\n", scaler_type_string() );
+		fprintf( out, "  \"simd\": \"%s\",\n", simd_string() );
+		#if defined(__VERSION__)
+		fprintf( out, "  \"compiler\": \"%s\",\n", __VERSION__ );
+		#endif
+		fprintf( out, "  \"samples\": %zu,\n", samples );
+		fprintf( out, "  \"results\": [\n" );
+		for( size_t r = 0; r < count; r++ )
+		{
+			bench_print_json( out, &results[ r ], r + 1 == count );
+		}
+		fprintf( out, "  ]\n}\n" );
+
+		if( !json_stdout ) fclose( out );
+	}
+
+	vec3_array_destroy( &data.array_a );
+	vec3_array_destroy( &data.array_b );
+	vec3_array_destroy( &data.array_r );
+	quat_array_destroy( &data.quats_a );
+	quat_array_destroy( &data.quats_b );
+	quat_array_destroy( &data.quats_c );
+	quat_array_destroy( &data.quats_r );
+	free( results );
+	return 0;
+}
@@ -0,0 +1,182 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/vec3.h"
+#include "../src/vec4.h"
+#include "../src/mat4.h"
+#include "bench.h"
+
+/*
+ * Measures mat4_mult_matrix and mat4_mult_vector over a set of
+ * model-view-projection style products, and the bulk transforms against
+ * looping over mat4_mult_vector. The inversion paths are timed on the
+ * kinds of matrices that they are meant for. The working set is kept small
+ * enough to stay in cache so that arithmetic, not memory, is measured.
+ */
+#define COUNT        (1 << 10)
+#define REPETITIONS  (4000)
+
+static bool invert_rigid( mat4_t* m )
+{
+	mat4_invert_rigid( m );
+	return true;
+}
+
+static void bench_inversion( const char* name, bool (*invert)( mat4_t* ), const mat4_t* matrices, size_t ops )
+{
+	mat4_t* scratch = malloc( COUNT * sizeof(mat4_t) );
+	uint64_t elapsed = 0;
+
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		memcpy( scratch, matrices, COUNT * sizeof(mat4_t) );
+		uint64_t start = bench_now();
+		for( size_t i = 0; i < COUNT; i++ ) invert( &scratch[ i ] );
+		elapsed += bench_now() - start;
+		bench_escape( scratch );
+	}
+	bench_report( name, ops, elapsed );
+	free( scratch );
+}
+
+int main( int argc, char* argv[] )
+{
+	mat4_t* a = malloc( COUNT * sizeof(mat4_t) );
+	mat4_t* b = malloc( COUNT * sizeof(mat4_t) );
+	mat4_t* r = malloc( COUNT * sizeof(mat4_t) );
+	vec4_t* v = malloc( COUNT * sizeof(vec4_t) );
+	vec4_t* u = malloc( COUNT * sizeof(vec4_t) );
+	vec3_t* p = malloc( COUNT * sizeof(vec3_t) );
+	vec3_t* q = malloc( COUNT * sizeof(vec3_t) );
+	const size_t ops = ((size_t) COUNT) * REPETITIONS;
+	uint64_t start;
+
+	if( !a || !b || !r || !v || !u || !p || !q )
+	{
+		fprintf( stderr, "Out of memory.\n" );
+		return 1;
+	}
+
+	for( size_t i = 0; i < COUNT; i++ )
+	{
+		for( size_t j = 0; j < 16; j++ )
+		{
+			a[ i ].m[ j ] = m3d_uniform_unitf();
+			b[ i ].m[ j ] = m3d_uniform_unitf();
+		}
+		v[ i ] = VEC4( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf(), 1 );
+		p[ i ] = VEC3( v[ i ].x, v[ i ].y, v[ i ].z );
+	}
+
+	printf( "mat4 operations (scaler_t is %s, %d matrices)\n", scaler_type_string(), COUNT );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) r[ i ] = mat4_mult_matrix( &a[ i ], &b[ i ] );
+		bench_escape( r );
+	}
+	bench_report( "mat4_mult_matrix", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) u[ i ] = mat4_mult_vector( &a[ i ], &v[ i ] );
+		bench_escape( u );
+	}
+	bench_report( "mat4_mult_vector", ops, bench_now() - start );
+
+	/* Bulk transforms of points with one matrix */
+	mat4_t affine = a[ 0 ];
+	affine.m[ 3] = 0; affine.m[ 7] = 0; affine.m[11] = 0; affine.m[15] = 1;
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ )
+		{
+			vec4_t h = VEC4( p[ i ].x, p[ i ].y, p[ i ].z, 1 );
+			h = mat4_mult_vector( &affine, &h );
+			q[ i ] = VEC3( h.x, h.y, h.z );
+		}
+		bench_escape( q );
+	}
+	bench_report( "mat4_mult_vector point loop", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		mat4_transform_points3( &affine, q, 0, p, 0, COUNT );
+		bench_escape( q );
+	}
+	bench_report( "mat4_transform_points3 (affine)", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		mat4_transform_points3( &a[ 0 ], q, 0, p, 0, COUNT );
+		bench_escape( q );
+	}
+	bench_report( "mat4_transform_points3 (projective)", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		mat4_transform_normals3( &affine, q, 0, p, 0, COUNT );
+		bench_escape( q );
+	}
+	bench_report( "mat4_transform_normals3", ops, bench_now() - start );
+
+	/* Inversion of rigid, affine and general matrices */
+	for( size_t i = 0; i < COUNT; i++ )
+	{
+		vec3_t axis = VEC3( v[ i ].x, v[ i ].y, v[ i ].z + 0.1 );
+		r[ i ] = mat4_from_axis3_angle( &axis, m3d_uniform_unitf() * 6 );
+		r[ i ].m[12] = v[ i ].x;
+		r[ i ].m[13] = v[ i ].y;
+		r[ i ].m[14] = v[ i ].z;
+		b[ i ] = r[ i ];
+		b[ i ].m[ 0] *= 2;
+		b[ i ].m[ 1] *= 2;
+		b[ i ].m[ 2] *= 2;
+		a[ i ].m[ 0] += 4; a[ i ].m[ 5] += 4; a[ i ].m[10] += 4; a[ i ].m[15] += 4;
+	}
+
+	bench_inversion( "mat4_invert_general (rigid)", mat4_invert_general, r, ops );
+	bench_inversion( "mat4_invert_rigid", invert_rigid, r, ops );
+	bench_inversion( "mat4_invert (rigid)", mat4_invert, r, ops );
+	bench_inversion( "mat4_invert_general (affine)", mat4_invert_general, b, ops );
+	bench_inversion( "mat4_invert_affine", mat4_invert_affine, b, ops );
+	bench_inversion( "mat4_invert (affine)", mat4_invert, b, ops );
+	bench_inversion( "mat4_invert_general (general)", mat4_invert_general, a, ops );
+	bench_inversion( "mat4_invert (general)", mat4_invert, a, ops );
+
+	free( a );
+	free( b );
+	free( r );
+	free( v );
+	free( u );
+	free( p );
+	free( q );
+	return 0;
+}
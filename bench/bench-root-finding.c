@@ -0,0 +1,151 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../src/numerical-methods.h"
+#include "bench.h"
+
+/*
+ * Compares the evaluations that each root finder needs on some standard
+ * test functions, with the time for one solve. Every method gets the same
+ * bracket and epsilon. Note that the bissection_method() stops when
+ * |f(x)| < epsilon, while the others stop when x is within epsilon of
+ * the root.
+ */
+#define EPSILON      (1e-10)
+#define ITERATIONS   (200)
+#define REPETITIONS  (20000)
+
+typedef struct test_function {
+	const char* name;
+	double a;
+	double b;
+	double (*f)( double x );
+	double (*df)( double x );
+} test_function_t;
+
+static double cubic( double x )            { return x * x * x + 4 * x * x - 10; }
+static double cubic_derivative( double x ) { return 3 * x * x + 8 * x; }
+static double kepler( double x )           { return x - 0.9 * sin( x ) - 1.0; }
+static double kepler_derivative( double x ){ return 1.0 - 0.9 * cos( x ); }
+static double cosine( double x )           { return cos( x ) - x; }
+static double cosine_derivative( double x ){ return -sin( x ) - 1.0; }
+static double cycle( double x )            { return x * x * x - 2 * x + 2; }
+static double cycle_derivative( double x ) { return 3 * x * x - 2; }
+static double arctangent( double x )       { return atan( x ); }
+static double arctangent_derivative( double x ) { return 1.0 / (1.0 + x * x); }
+static double triple( double x )           { return (x - 1.1) * (x - 1.1) * (x - 1.1); }
+static double triple_derivative( double x ){ return 3 * (x - 1.1) * (x - 1.1); }
+
+static const test_function_t functions[] = {
+	{ "x^3 + 4x^2 - 10 on [1, 2]",     1.0,  2.0, cubic,      cubic_derivative },
+	{ "x - 0.9 sin(x) - 1 on [0, 3]",  0.0,  3.0, kepler,     kepler_derivative },
+	{ "cos(x) - x on [0, 1]",          0.0,  1.0, cosine,     cosine_derivative },
+	{ "x^3 - 2x + 2 on [-3, 1]",      -3.0,  1.0, cycle,      cycle_derivative },
+	{ "atan(x) on [-2, 20]",          -2.0, 20.0, arctangent, arctangent_derivative },
+	{ "(x - 1.1)^3 on [0, 3]",         0.0,  3.0, triple,     triple_derivative },
+};
+
+/* The methods call these, so that every method is counted the same way. */
+static const test_function_t* current;
+static size_t evaluations;
+static size_t derivatives;
+
+static double counted_f( double x )
+{
+	evaluations++;
+	return current->f( x );
+}
+
+static double counted_df( double x )
+{
+	derivatives++;
+	return current->df( x );
+}
+
+typedef enum method {
+	METHOD_BISSECTION = 0,
+	METHOD_SECANT,
+	METHOD_BRENT,
+	METHOD_NEWTON_RAPHSON,
+	METHOD_COUNT
+} method_t;
+
+static const char* method_names[ METHOD_COUNT ] = {
+	"m3d_bissection_method",
+	"m3d_secant_method",
+	"m3d_brent_method",
+	"m3d_newton_raphson_method",
+};
+
+static bool solve( method_t method, double* root )
+{
+	switch( method )
+	{
+		case METHOD_BISSECTION:
+			return m3d_bissection_method( current->a, current->b, EPSILON, ITERATIONS, counted_f, root );
+		case METHOD_SECANT:
+			return m3d_secant_method( current->a, current->b, EPSILON, ITERATIONS, counted_f, root );
+		case METHOD_BRENT:
+			return m3d_brent_method( current->a, current->b, EPSILON, ITERATIONS, counted_f, root, NULL );
+		case METHOD_NEWTON_RAPHSON:
+			return m3d_newton_raphson_method( current->a, current->b, EPSILON, ITERATIONS, counted_f, counted_df, root, NULL );
+		default:
+			return false;
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	printf( "root finding (epsilon = %g, bracket evaluations included)\n", EPSILON );
+
+	for( size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++ )
+	{
+		current = &functions[ i ];
+		printf( "\n%s\n", current->name );
+		printf( "%-28s %6s %22s %6s %6s %12s\n", "method", "found", "root", "f(x)", "f'(x)", "ns/solve" );
+
+		for( method_t method = 0; method < METHOD_COUNT; method++ )
+		{
+			double root = NAN;
+			evaluations = 0;
+			derivatives = 0;
+			bool found = solve( method, &root );
+			size_t f_count  = evaluations;
+			size_t df_count = derivatives;
+
+			uint64_t start = bench_now();
+			for( size_t k = 0; k < REPETITIONS; k++ )
+			{
+				double r;
+				solve( method, &r );
+				bench_escape( &r );
+			}
+			uint64_t elapsed = bench_now() - start;
+
+			printf( "%-28s %6s %22.15g %6zu %6zu %12.1f\n", method_names[ method ], found ? "yes" : "no",
+			        root, f_count, df_count, ((double) elapsed) / REPETITIONS );
+		}
+	}
+
+	return 0;
+}
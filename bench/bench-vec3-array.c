@@ -0,0 +1,154 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/vec3.h"
+#include "../src/vec3-array.h"
+#include "bench.h"
+
+/*
+ * Compares the structure-of-arrays kernels in vec3-array.h against looping
+ * over the inline functions in vec3.h.
+ */
+#define COUNT        (1 << 16)
+#define REPETITIONS  (200)
+
+int main( int argc, char* argv[] )
+{
+	vec3_t* a = malloc( COUNT * sizeof(vec3_t) );
+	vec3_t* b = malloc( COUNT * sizeof(vec3_t) );
+	vec3_t* r = malloc( COUNT * sizeof(vec3_t) );
+	scaler_t* d = malloc( COUNT * sizeof(scaler_t) );
+	vec3_array_t array_a;
+	vec3_array_t array_b;
+	vec3_array_t array_r;
+	const size_t ops = ((size_t) COUNT) * REPETITIONS;
+	uint64_t start;
+
+	if( !a || !b || !r || !d ||
+	    !vec3_array_create( &array_a, COUNT ) ||
+	    !vec3_array_create( &array_b, COUNT ) ||
+	    !vec3_array_create( &array_r, COUNT ) )
+	{
+		fprintf( stderr, "Out of memory.\n" );
+		return 1;
+	}
+
+	for( size_t i = 0; i < COUNT; i++ )
+	{
+		a[ i ] = VEC3( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf() );
+		b[ i ] = VEC3( m3d_uniform_unitf(), m3d_uniform_unitf(), m3d_uniform_unitf() );
+	}
+	vec3_array_from_vec3( &array_a, a, COUNT );
+	vec3_array_from_vec3( &array_b, b, COUNT );
+
+	printf( "vec3 batch operations (scaler_t is %s, %d vectors)\n", scaler_type_string(), COUNT );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) r[ i ] = vec3_add( &a[ i ], &b[ i ] );
+		bench_escape( r );
+	}
+	bench_report( "vec3_add loop", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		vec3_array_add( &array_r, &array_a, &array_b );
+		bench_escape( array_r.x );
+	}
+	bench_report( "vec3_array_add", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) d[ i ] = vec3_dot_product( &a[ i ], &b[ i ] );
+		bench_escape( d );
+	}
+	bench_report( "vec3_dot_product loop", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		vec3_array_dot_product( &array_a, &array_b, d );
+		bench_escape( d );
+	}
+	bench_report( "vec3_array_dot_product", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) r[ i ] = vec3_cross_product( &a[ i ], &b[ i ] );
+		bench_escape( r );
+	}
+	bench_report( "vec3_cross_product loop", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		vec3_array_cross_product( &array_r, &array_a, &array_b );
+		bench_escape( array_r.x );
+	}
+	bench_report( "vec3_array_cross_product", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) { r[ i ] = a[ i ]; vec3_normalize( &r[ i ] ); }
+		bench_escape( r );
+	}
+	bench_report( "vec3_normalize loop", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		vec3_array_multiply( &array_r, &array_a, 1 );
+		vec3_array_normalize( &array_r );
+		bench_escape( array_r.x );
+	}
+	bench_report( "vec3_array_normalize", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		for( size_t i = 0; i < COUNT; i++ ) r[ i ] = vec3_lerp( &a[ i ], &b[ i ], 0.5 );
+		bench_escape( r );
+	}
+	bench_report( "vec3_lerp loop", ops, bench_now() - start );
+
+	start = bench_now();
+	for( size_t k = 0; k < REPETITIONS; k++ )
+	{
+		vec3_array_lerp( &array_r, &array_a, &array_b, 0.5 );
+		bench_escape( array_r.x );
+	}
+	bench_report( "vec3_array_lerp", ops, bench_now() - start );
+
+	vec3_array_destroy( &array_a );
+	vec3_array_destroy( &array_b );
+	vec3_array_destroy( &array_r );
+	free( a );
+	free( b );
+	free( r );
+	free( d );
+	return 0;
+}
@@ -0,0 +1,166 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+/* Monotonic time in nanoseconds. */
+static inline uint64_t bench_now( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ((uint64_t) ts.tv_sec) * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+/* Keep the optimizer from discarding results that are never read. */
+static inline void bench_escape( const void* p )
+{
+	#if defined(__GNUC__)
+	__asm__ volatile( "" : : "g"(p) : "memory" );
+	#else
+	static const void* volatile sink;
+	sink = p;
+	#endif
+}
+
+static inline void bench_report( const char* name, size_t ops, uint64_t elapsed )
+{
+	double ns_per_op = ((double) elapsed) / ops;
+	printf( "%-40s %10.3f ns/op %14.0f ops/sec\n", name, ns_per_op, 1e9 / ns_per_op );
+}
+
+/*
+ * Sampled Measurements
+ *
+ * A benchmark body performs a given number of operations. It is run once
+ * to warm up and to size the batches so that each sample takes about
+ * BENCH_SAMPLE_NS, then timed over several samples. The percentiles are
+ * taken over the per-sample ns/op, which makes them robust against the
+ * occasional preempted sample.
+ */
+#ifndef BENCH_SAMPLE_NS
+#define BENCH_SAMPLE_NS    (2000000ull) /* 2 ms */
+#endif
+
+typedef void (*bench_body_t)( size_t ops );
+
+typedef struct bench_result {
+	const char* group;
+	const char* name;
+	size_t ops;     /* operations per sample */
+	size_t samples;
+	double mean;    /* ns/op */
+	double min;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+} bench_result_t;
+
+static inline int bench_compare_doubles( const void* l, const void* r )
+{
+	double a = *(const double*) l;
+	double b = *(const double*) r;
+	return (a > b) - (a < b);
+}
+
+/* Nearest rank percentile of sorted values */
+static inline double bench_percentile( const double* sorted, size_t count, double p )
+{
+	size_t rank = (size_t) (p / 100.0 * count + 0.5);
+	if( rank < 1 ) rank = 1;
+	if( rank > count ) rank = count;
+	return sorted[ rank - 1 ];
+}
+
+static inline bool bench_measure( bench_result_t* result, const char* group, const char* name, bench_body_t body, size_t samples )
+{
+	double* times = malloc( samples * sizeof(double) );
+	if( !times ) return false;
+
+	/* Warm up and calibrate */
+	size_t ops = 16;
+	uint64_t elapsed = 0;
+	while( ops < (1ull << 40) )
+	{
+		uint64_t start = bench_now();
+		body( ops );
+		elapsed = bench_now() - start;
+		if( elapsed >= BENCH_SAMPLE_NS / 8 ) break;
+		ops *= 2;
+	}
+	ops = (size_t) (ops * ((double) BENCH_SAMPLE_NS / (elapsed ? elapsed : 1)));
+	if( ops < 1 ) ops = 1;
+
+	double sum = 0;
+	for( size_t s = 0; s < samples; s++ )
+	{
+		uint64_t start = bench_now();
+		body( ops );
+		times[ s ] = ((double) (bench_now() - start)) / ops;
+		sum += times[ s ];
+	}
+	qsort( times, samples, sizeof(double), bench_compare_doubles );
+
+	result->group   = group;
+	result->name    = name;
+	result->ops     = ops;
+	result->samples = samples;
+	result->mean    = sum / samples;
+	result->min     = times[ 0 ];
+	result->p50     = bench_percentile( times, samples, 50 );
+	result->p90     = bench_percentile( times, samples, 90 );
+	result->p99     = bench_percentile( times, samples, 99 );
+	result->max     = times[ samples - 1 ];
+
+	free( times );
+	return true;
+}
+
+static inline void bench_print_header( FILE* stream )
+{
+	fprintf( stream, "%-44s %10s %10s %10s %10s %14s\n", "benchmark", "p50 ns/op", "p90", "p99", "mean", "ops/sec" );
+}
+
+static inline void bench_print( FILE* stream, const bench_result_t* r )
+{
+	char label[ 128 ];
+	snprintf( label, sizeof(label), "%s/%s", r->group, r->name );
+	fprintf( stream, "%-44s %10.3f %10.3f %10.3f %10.3f %14.0f\n", label, r->p50, r->p90, r->p99, r->mean, 1e9 / r->p50 );
+}
+
+/* Names are plain identifiers, so they need no escaping. */
+static inline void bench_print_json( FILE* stream, const bench_result_t* r, bool last )
+{
+	fprintf( stream, "    { \"group\": \"%s\", \"name\": \"%s\", \"ops_per_sample\": %zu, \"samples\": %zu, "
+	                 "\"ns_per_op\": { \"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }, "
+	                 "\"ops_per_sec\": %.1f }%s\n",
+	         r->group, r->name, r->ops, r->samples, r->mean, r->min, r->p50, r->p90, r->p99, r->max, 1e9 / r->p50, last ? "" : "," );
+}
+
+#endif /* _BENCH_H_ */
@@ -18,302 +18,920 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-#include <stdio.h>
-#include <string.h>
-#include <limits.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
 #include "algorithms.h"
 
-#if 0
-#define hidx(w,t) (workers * (t) + (w))
-#else
-#define hidx(w,t) (tasks * (w) + (t))
-#endif
-static inline void dump_matrix( int cost[], size_t workers, size_t tasks )
+/*
+ * The solvers below use shortest augmenting paths (Jonker & Volgenant,
+ * 1987), in the form with row and column potentials u and v. Each row is
+ * added with one Dijkstra search over the reduced costs
+ * c(i, j) - u[i] - v[j], which stay non-negative, so the whole
+ * assignment takes O(n^2 m) time for n rows and m >= n columns.
+ *
+ * The matrix is always solved with the shorter side as rows. When there
+ * are more workers than tasks, the tasks are the rows and the cost matrix
+ * is read transposed.
+ */
+typedef enum hungarian_type {
+	HUNGARIAN_INT,
+	HUNGARIAN_FLOAT,
+	HUNGARIAN_DOUBLE
+} hungarian_type_t;
+
+typedef struct hungarian_costs {
+	const void* cost;
+	hungarian_type_t type;
+	size_t rows;
+	size_t columns;
+	bool transposed;
+	bool maximal;
+	double* buffer; /* one row, converted to double */
+} hungarian_costs_t;
+
+/* Returns row i as doubles, negated for maximal assignments. */
+static const double* hungarian_row( const hungarian_costs_t* c, size_t i )
 {
-	for( size_t t = 0; t < tasks; t++ )
+	if( c->type == HUNGARIAN_DOUBLE && !c->transposed && !c->maximal )
+	{
+		return (const double*) c->cost + i * c->columns;
+	}
+
+	const size_t start  = c->transposed ? i : i * c->columns;
+	const size_t stride = c->transposed ? c->rows : 1;
+	const double sign   = c->maximal ? -1.0 : 1.0;
+
+	switch( c->type )
 	{
-		for( size_t w = 0; w < workers; w++ )
+		case HUNGARIAN_INT:
 		{
-			printf( "%3d ", cost[ hidx(w, t) ] );
+			const int* cost = (const int*) c->cost + start;
+			for( size_t j = 0; j < c->columns; j++ )
+			{
+				c->buffer[ j ] = sign * cost[ j * stride ];
+			}
+			break;
+		}
+		case HUNGARIAN_FLOAT:
+		{
+			const float* cost = (const float*) c->cost + start;
+			for( size_t j = 0; j < c->columns; j++ )
+			{
+				c->buffer[ j ] = sign * cost[ j * stride ];
+			}
+			break;
+		}
+		case HUNGARIAN_DOUBLE:
+		{
+			const double* cost = (const double*) c->cost + start;
+			for( size_t j = 0; j < c->columns; j++ )
+			{
+				c->buffer[ j ] = sign * cost[ j * stride ];
+			}
+			break;
 		}
-		printf( "\n" );
 	}
-	printf( "\n" );
+
+	return c->buffer;
 }
-static inline void dump_array( const char* label, int array[], size_t count )
+
+size_t hungarian_workspace_size( size_t workers, size_t tasks )
 {
-	printf( "%s = {", label );
-	for( size_t i = 0; i < count - 1; i++ )
+	const size_t n = workers < tasks ? workers : tasks;
+	const size_t m = workers < tasks ? tasks : workers;
+
+	/* The doubles come first so that every array is aligned. */
+	return (n + 1 + 3 * (m + 1)) * sizeof(double) +
+	       (n + 2 * (m + 1)) * sizeof(int) +
+	       (m + 1) * sizeof(bool);
+}
+
+static bool hungarian_solve( hungarian_costs_t* c, int output[], size_t workers, void* workspace )
+{
+	const size_t n = c->rows;
+	const size_t m = c->columns;
+	void* allocated = NULL;
+
+	for( size_t w = 0; w < workers; w++ )
 	{
-		printf( "%d, ", array[ i ] );
+		output[ w ] = -1;
 	}
 
-	printf( "%d}\n", array[ count - 1 ] );
-}
+	if( n == 0 )
+	{
+		return true;
+	}
 
-static void minimal_hungarian_assignment( int cost[], size_t workers, size_t tasks, int output[] );
-static bool is_optimal_hungarian_assignment( int cost[], size_t workers, size_t tasks, int cols[], int rows[], size_t* lines );
+	if( !workspace )
+	{
+		allocated = malloc( hungarian_workspace_size( n, m ) );
+		if( !allocated )
+		{
+			return false;
+		}
+		workspace = allocated;
+	}
 
+	/* Rows and columns are numbered from 1. Column 0 is the root of each
+	 * search and row 0 means unassigned. */
+	double* u     = workspace;
+	double* v     = u + n + 1;
+	double* minv  = v + m + 1;
+	c->buffer     = minv + m + 1;
+	int*    match = (int*) (c->buffer + m + 1); /* row assigned to each column */
+	int*    way   = match + m + 1;              /* previous column on the path */
+	int*    owner = way + m + 1;                /* column assigned to each row */
+	bool*   used  = (bool*) (owner + n);
+	bool    result = true;
+
+	for( size_t j = 0; j <= m; j++ )
+	{
+		v[ j ]     = 0.0;
+		match[ j ] = 0;
+	}
+	u[ 0 ] = 0.0;
 
-void hungarian_assignment( bool maximal, int cost[], size_t workers, size_t tasks, int output[] )
-{
-	dump_matrix( cost, workers, tasks );
-	if( maximal )
+	/* Row reduction, and a greedy start where a row's cheapest column is
+	 * still free. This keeps every reduced cost non-negative and usually
+	 * leaves few rows for the searches. */
+	for( size_t i = 1; result && i <= n; i++ )
 	{
-		size_t count = workers * tasks;
-		int max = cost[ 0 ];
+		const double* row = hungarian_row( c, i - 1 );
+		size_t best = 0;
 
-		/* Find max value */
-		for( size_t i = 1; i < count; i++ )
+		for( size_t j = 1; j < m; j++ )
 		{
-			if( max < cost[ i ] )
+			if( row[ j ] < row[ best ] )
 			{
-				max = cost[ i ];
+				best = j;
 			}
 		}
 
-		/* Convert maximal values to minimal values */
-		for( size_t i = 0; i < count; i++ )
+		if( !(row[ best ] < INFINITY) )
 		{
-			cost[ i ] = max - cost[ i ];
+			result = false; /* no finite cost in this row */
 		}
-	}
-
-	minimal_hungarian_assignment( cost, workers, tasks, output );
-}
 
-void minimal_hungarian_assignment( int cost[], size_t workers, size_t tasks, int output[] )
-{
-	int cols[ workers ];
-	int rows[ tasks ];
-	size_t lines = 0;
+		u[ i ]         = row[ best ];
+		owner[ i - 1 ] = 0;
 
-	memset( cols, 0, sizeof(cols) );
-	memset( rows, 0, sizeof(rows) );
+		if( match[ best + 1 ] == 0 )
+		{
+			match[ best + 1 ] = (int) i;
+			owner[ i - 1 ]    = (int) (best + 1);
+		}
+	}
 
-	/* Minimize rows */
-	for( size_t t = 0; t < tasks; t++ )
+	for( size_t i = 1; result && i <= n; i++ )
 	{
-		if( !rows[ t ] )
+		if( owner[ i - 1 ] )
 		{
-			int optimal = cost[ hidx(0, t) ];
+			continue;
+		}
+
+		size_t j0 = 0;
+		match[ 0 ] = (int) i;
+
+		for( size_t j = 0; j <= m; j++ )
+		{
+			minv[ j ] = INFINITY;
+			used[ j ] = false;
+		}
 
-			for( size_t w = 1; w < workers; w++ )
+		/* Grow a shortest path tree from row i until it reaches a free
+		 * column. */
+		do {
+			const size_t i0 = (size_t) match[ j0 ];
+			const double* row = hungarian_row( c, i0 - 1 );
+			const double u0 = u[ i0 ];
+			double delta = INFINITY;
+			size_t j1 = 0;
+
+			used[ j0 ] = true;
+
+			for( size_t j = 1; j <= m; j++ )
 			{
-				if( optimal > cost[ hidx(w, t) ] )
+				if( !used[ j ] )
 				{
-					optimal = cost[ hidx(w,  t) ];
+					const double reduced = row[ j - 1 ] - u0 - v[ j ];
+
+					if( reduced < minv[ j ] )
+					{
+						minv[ j ] = reduced;
+						way[ j ]  = (int) j0;
+					}
+
+					if( minv[ j ] < delta )
+					{
+						delta = minv[ j ];
+						j1    = j;
+					}
 				}
 			}
 
-			if( optimal > 0 )
+			if( j1 == 0 )
 			{
-				for( size_t w = 0; w < workers; w++ )
+				result = false; /* only forbidden pairs are left */
+				break;
+			}
+
+			for( size_t j = 0; j <= m; j++ )
+			{
+				if( used[ j ] )
+				{
+					u[ match[ j ] ] += delta;
+					v[ j ] -= delta;
+				}
+				else
 				{
-					cost[ hidx(w, t) ] -= optimal;
+					minv[ j ] -= delta;
 				}
 			}
+
+			j0 = j1;
+		} while( match[ j0 ] != 0 );
+
+		/* Flip the assignments along the path. */
+		while( result && j0 != 0 )
+		{
+			const size_t j1 = (size_t) way[ j0 ];
+			match[ j0 ] = match[ j1 ];
+			j0 = j1;
 		}
 	}
 
-	/* Minimize columns */
-	for( size_t w = 0; w < workers; w++ )
+	if( result )
 	{
-		if( !cols[ w ] )
+		for( size_t j = 1; j <= m; j++ )
 		{
-			int optimal = cost[ hidx(w, 0) ];
-
-			for( size_t t = 1; t < tasks; t++ )
+			if( match[ j ] )
 			{
-				if( optimal > cost[ hidx(w, t) ] )
+				const int row    = match[ j ] - 1;
+				const int column = (int) j - 1;
+
+				if( c->transposed )
 				{
-					optimal = cost[ hidx(w, t) ];
+					output[ column ] = row;
 				}
-			}
-
-			if( optimal > 0 )
-			{
-				for( size_t t = 0; t < tasks; t++ )
+				else
 				{
-					cost[ hidx(w, t) ] -= optimal;
+					output[ row ] = column;
 				}
 			}
 		}
 	}
 
-	while( !is_optimal_hungarian_assignment( cost, workers, tasks, cols, rows, &lines ) )
+	free( allocated );
+	return result;
+}
+
+static bool hungarian_assign( hungarian_type_t type, bool maximal, const void* cost, size_t workers, size_t tasks, int output[], void* workspace )
+{
+	assert( cost || workers == 0 || tasks == 0 );
+	assert( output || workers == 0 );
+
+	hungarian_costs_t c = {
+		.cost       = cost,
+		.type       = type,
+		.rows       = workers <= tasks ? workers : tasks,
+		.columns    = workers <= tasks ? tasks : workers,
+		.transposed = workers > tasks,
+		.maximal    = maximal,
+		.buffer     = NULL
+	};
+
+	return hungarian_solve( &c, output, workers, workspace );
+}
+
+void hungarian_assignment( bool maximal, int cost[], size_t workers, size_t tasks, int output[] )
+{
+	hungarian_assign( HUNGARIAN_INT, maximal, cost, workers, tasks, output, NULL );
+}
+
+bool hungarian_assignmentf( bool maximal, const float cost[], size_t workers, size_t tasks, int output[], void* workspace )
+{
+	return hungarian_assign( HUNGARIAN_FLOAT, maximal, cost, workers, tasks, output, workspace );
+}
+
+bool hungarian_assignmentd( bool maximal, const double cost[], size_t workers, size_t tasks, int output[], void* workspace )
+{
+	return hungarian_assign( HUNGARIAN_DOUBLE, maximal, cost, workers, tasks, output, workspace );
+}
+
+/*
+ * Sparse Assignment
+ *
+ * The sparse solvers also find shortest augmenting paths, but search the
+ * allowed pairs with a binary heap, so one search costs O(k log k) for the
+ * k pairs it reaches instead of O(m) for every step. When workers may go
+ * unassigned, each worker gets a private dummy column, numbered after the
+ * tasks, at the unassigned cost.
+ *
+ * The potentials, the matching and the search arrays that are indexed by
+ * row or column are shared, since the connected components never share
+ * rows or columns. Each thread has its own heap and lists.
+ */
+typedef struct sparse_costs {
+	const size_t* offsets;
+	const int*    columns;
+	const void*   costs;
+	bool          is_float;
+	double        sign;
+	double        unassigned; /* signed, or INFINITY for no dummy columns */
+	size_t        workers;
+	size_t        tasks;
+} sparse_costs_t;
+
+typedef struct sparse_state {
+	double* u;
+	double* v;
+	double* shortest;
+	int*    row4col;
+	int*    col4row;
+	int*    path;
+	bool*   visited;
+} sparse_state_t;
+
+typedef struct sparse_scratch {
+	double* keys; /* heap of columns by path cost */
+	int*    heap;
+	size_t  count;
+	int*    touched;
+	int*    rows;    /* rows reached by a search */
+	int*    columns; /* columns finished by a search */
+	int*    free;    /* rows left to assign */
+} sparse_scratch_t;
+
+static inline double sparse_cost( const sparse_costs_t* c, size_t e )
+{
+	return c->sign * (c->is_float ? (double) ((const float*) c->costs)[ e ] : ((const double*) c->costs)[ e ]);
+}
+
+static inline void sparse_heap_push( sparse_scratch_t* s, double key, int column )
+{
+	size_t i = s->count++;
+
+	while( i > 0 )
 	{
-		int min = INT_MAX;
+		const size_t parent = (i - 1) / 2;
+		if( s->keys[ parent ] <= key ) break;
+		s->keys[ i ] = s->keys[ parent ];
+		s->heap[ i ] = s->heap[ parent ];
+		i = parent;
+	}
+
+	s->keys[ i ] = key;
+	s->heap[ i ] = column;
+}
+
+static inline int sparse_heap_pop( sparse_scratch_t* s, double* key )
+{
+	const int top = s->heap[ 0 ];
+	const double last_key = s->keys[ --s->count ];
+	const int last = s->heap[ s->count ];
+	size_t i = 0;
+
+	*key = s->keys[ 0 ];
+
+	for( ;; )
+	{
+		size_t child = 2 * i + 1;
+		if( child >= s->count ) break;
+		if( child + 1 < s->count && s->keys[ child + 1 ] < s->keys[ child ] ) child += 1;
+		if( last_key <= s->keys[ child ] ) break;
+		s->keys[ i ] = s->keys[ child ];
+		s->heap[ i ] = s->heap[ child ];
+		i = child;
+	}
 
-		for( size_t t = 0; t < tasks; t++ )
+	s->keys[ i ] = last_key;
+	s->heap[ i ] = last;
+	return top;
+}
+
+/* Relaxes the pairs of row i, found at path cost base. */
+static inline void sparse_relax( const sparse_costs_t* c, sparse_state_t* st, sparse_scratch_t* s, size_t* touched, size_t i, double base )
+{
+	const double ui = st->u[ i ];
+
+	for( size_t e = c->offsets[ i ]; e <= c->offsets[ i + 1 ]; e++ )
+	{
+		size_t j;
+		double cost;
+
+		if( e < c->offsets[ i + 1 ] )
+		{
+			j    = (size_t) c->columns[ e ];
+			cost = sparse_cost( c, e );
+		}
+		else if( c->unassigned < INFINITY )
 		{
-			for( size_t w = 0; w < workers; w++ )
+			j    = c->tasks + i;
+			cost = c->unassigned;
+		}
+		else
+		{
+			break;
+		}
+
+		if( st->visited[ j ] || !(cost < INFINITY) ) continue;
+
+		const double r = base + cost - ui - st->v[ j ];
+
+		if( r < st->shortest[ j ] )
+		{
+			if( st->shortest[ j ] == INFINITY )
 			{
-				if( !rows[ t ] && !cols[ w ] )
-				{
-					if( cost[ hidx(w, t) ] < min )
-					{
-						min = cost[ hidx(w, t) ];
-					}
-				}
+				s->touched[ (*touched)++ ] = (int) j;
 			}
+			st->shortest[ j ] = r;
+			st->path[ j ]     = (int) i;
+			sparse_heap_push( s, r, (int) j );
 		}
+	}
+}
+
+/* Assigns the free row start, or returns false when it cannot be. */
+static bool sparse_augment( const sparse_costs_t* c, sparse_state_t* st, sparse_scratch_t* s, size_t start )
+{
+	size_t touched  = 0;
+	size_t rows     = 0;
+	size_t columns  = 0;
+	double min_val  = 0.0;
+	size_t i        = start;
+	int    sink     = -1;
 
-		for( size_t t = 0; t < tasks; t++ )
+	s->count = 0;
+
+	for( ;; )
+	{
+		s->rows[ rows++ ] = (int) i;
+		sparse_relax( c, st, s, &touched, i, min_val );
+
+		int j = -1;
+		while( s->count > 0 )
 		{
-			for( size_t w = 0; w < workers; w++ )
+			double key;
+			j = sparse_heap_pop( s, &key );
+			if( !st->visited[ j ] && key <= st->shortest[ j ] )
 			{
-				if( !rows[ t ] && !cols[ w ] )
-				{
-					cost[ hidx(w, t) ] -= min;
-				}
-				else if( rows[ t ] && cols[ w ] )
-				{
-					cost[ hidx(w, t) ] += min;
-				}
+				min_val = key;
+				break;
 			}
+			j = -1;
+		}
+
+		if( j < 0 )
+		{
+			break;
+		}
+
+		st->visited[ j ] = true;
+		s->columns[ columns++ ] = j;
+
+		if( st->row4col[ j ] < 0 )
+		{
+			sink = j;
+			break;
 		}
+		i = (size_t) st->row4col[ j ];
 	}
 
-	dump_matrix( cost, workers, tasks );
+	if( sink >= 0 )
+	{
+		st->u[ start ] += min_val;
+		for( size_t k = 1; k < rows; k++ )
+		{
+			const int r = s->rows[ k ];
+			st->u[ r ] += min_val - st->shortest[ st->col4row[ r ] ];
+		}
+		for( size_t k = 0; k < columns; k++ )
+		{
+			const int j = s->columns[ k ];
+			st->v[ j ] -= min_val - st->shortest[ j ];
+		}
 
-#if 1
-	for( size_t w = 0; w < workers; w++ )
+		int j = sink;
+		for( ;; )
+		{
+			const int r = st->path[ j ];
+			const int previous = st->col4row[ r ];
+			st->row4col[ j ] = r;
+			st->col4row[ r ] = j;
+			if( (size_t) r == start ) break;
+			j = previous;
+		}
+	}
+
+	for( size_t k = 0; k < touched; k++ )
+	{
+		st->shortest[ s->touched[ k ] ] = INFINITY;
+	}
+	for( size_t k = 0; k < columns; k++ )
 	{
-		output[ w ] = w;
+		st->visited[ s->columns[ k ] ] = false;
 	}
 
-	for( size_t w = 0; w < workers; w++ )
+	return sink >= 0;
+}
+
+/* Finds the two lowest of c(i, j) - v[j] in row i, or INFINITY. */
+static void sparse_row_minima( const sparse_costs_t* c, const sparse_state_t* st, size_t i, size_t* j1, double* u1, size_t* j2, double* u2 )
+{
+	*u1 = INFINITY;
+	*u2 = INFINITY;
+	*j1 = c->tasks + i;
+	*j2 = c->tasks + i;
+
+	for( size_t e = c->offsets[ i ]; e <= c->offsets[ i + 1 ]; e++ )
 	{
-		if( cost[ hidx(w,w) ] != 0 )
+		size_t j;
+		double h;
+
+		if( e < c->offsets[ i + 1 ] )
+		{
+			j = (size_t) c->columns[ e ];
+			h = sparse_cost( c, e ) - st->v[ j ];
+		}
+		else if( c->unassigned < INFINITY )
+		{
+			j = c->tasks + i;
+			h = c->unassigned - st->v[ j ];
+		}
+		else
 		{
-			bool done = false;
+			break;
+		}
+
+		if( h < *u1 )
+		{
+			*u2 = *u1;
+			*j2 = *j1;
+			*u1 = h;
+			*j1 = j;
+		}
+		else if( h < *u2 )
+		{
+			*u2 = h;
+			*j2 = j;
+		}
+	}
+}
+
+/* Solves the rows listed in rows[0..count), which share no columns with
+ * other calls. */
+static bool sparse_solve_rows( const sparse_costs_t* c, sparse_state_t* st, sparse_scratch_t* s, const int rows[], size_t count )
+{
+	size_t free_count = 0;
+
+	/* A greedy start, as in the dense solver. */
+	for( size_t k = 0; k < count; k++ )
+	{
+		const size_t i = (size_t) rows[ k ];
+		size_t j1, j2;
+		double u1, u2;
+
+		sparse_row_minima( c, st, i, &j1, &u1, &j2, &u2 );
+
+		if( !(u1 < INFINITY) )
+		{
+			return false; /* the worker has no allowed task */
+		}
+
+		if( st->row4col[ j1 ] < 0 )
+		{
+			st->row4col[ j1 ] = (int) i;
+			st->col4row[ i ]  = (int) j1;
+		}
+		else
+		{
+			s->free[ free_count++ ] = (int) i;
+		}
+	}
 
-			//for( size_t t = 0; !done && t < tasks; t++ )
-			for( size_t t = 0; !done && t < tasks; t++ )
+	/* Augmenting row reduction (Jonker & Volgenant): a free row takes its
+	 * cheapest column and lowers the column's v to the margin over its
+	 * second cheapest. That keeps the row's reduced costs feasible and only
+	 * raises those of other rows. A displaced owner bids again right away
+	 * while it can lower a price, up to a limit that stops price wars. */
+	for( int pass = 0; pass < 2 && free_count > 0; pass++ )
+	{
+		size_t k     = 0;
+		size_t next  = 0;
+		size_t steps = 0;
+
+		while( k < free_count )
+		{
+			const size_t i = (size_t) s->free[ k++ ];
+			size_t j1, j2;
+			double u1, u2;
+
+			sparse_row_minima( c, st, i, &j1, &u1, &j2, &u2 );
+
+			const bool lowered = u1 < u2 && u2 < INFINITY;
+
+			if( lowered )
 			{
-				if( cost[ hidx(w,t) ] == 0 )
-				{
-					if( t != w )
-					{
-						/* Swap task rows */
-						for( size_t i = 0; i < workers; i++ )
-						{
-							int tmp = cost[ hidx(i, t) ];
-							cost[ hidx(i, t) ] = cost[ hidx(i, w) ];
-							cost[ hidx(i, w) ] = tmp;
-						}
-						int tmp = output[ w ];
-						output[ w ] = output[ t ];
-						output[ t ] = tmp;
-					}
+				st->v[ j1 ] -= u2 - u1;
+			}
+			else if( st->row4col[ j1 ] >= 0 && u2 < INFINITY )
+			{
+				j1 = j2;
+			}
 
-					//done = true;
+			const int owner = st->row4col[ j1 ];
+			st->row4col[ j1 ] = (int) i;
+			st->col4row[ i ]  = (int) j1;
+
+			if( owner >= 0 )
+			{
+				st->col4row[ owner ] = -1;
+
+				if( lowered && steps++ < 4 * count )
+				{
+					s->free[ --k ] = owner;
+				}
+				else
+				{
+					s->free[ next++ ] = owner;
 				}
 			}
 		}
 
+		free_count = next;
 	}
-#else
-	size_t optimal_zeros = (workers > tasks) ? tasks : workers;
 
-	for( size_t z = 0; z < optimal_zeros; z++ )
+	/* Row potentials that make every pair feasible and the assigned ones
+	 * tight. */
+	for( size_t k = 0; k < count; k++ )
 	{
-		for( size_t t = 0; t < tasks; t++ )
+		const size_t i = (size_t) rows[ k ];
+		size_t j1, j2;
+		double u1, u2;
+
+		sparse_row_minima( c, st, i, &j1, &u1, &j2, &u2 );
+		st->u[ i ] = u1;
+	}
+
+	for( size_t k = 0; k < free_count; k++ )
+	{
+		if( !sparse_augment( c, st, s, (size_t) s->free[ k ] ) )
 		{
-			for( size_t w = 0; w < workers; w++ )
-			{
-			}
+			return false;
 		}
 	}
-#endif
 
-	dump_matrix( cost, workers, tasks );
+	return true;
+}
+
+static size_t sparse_find( int parent[], size_t x )
+{
+	while( (size_t) parent[ x ] != x )
+	{
+		parent[ x ] = parent[ parent[ x ] ]; /* path halving */
+		x = (size_t) parent[ x ];
+	}
+	return x;
 }
 
-bool is_optimal_hungarian_assignment( int cost[], size_t workers, size_t tasks, int cols[], int rows[], size_t* lines )
+/* Groups the workers by the connected components of the pairs. Returns the
+ * number of components, with the workers of component k in
+ * rows[ offsets[ k ] .. offsets[ k + 1 ] ). */
+static size_t sparse_components( const sparse_costs_t* c, int parent[], int rows[], size_t offsets[] )
 {
-	size_t optimal_lines = (workers > tasks) ? tasks : workers;
-	if( *lines < optimal_lines )
+	const size_t workers = c->workers;
+
+	for( size_t x = 0; x < workers + c->tasks; x++ )
 	{
-		int max_zeros_in_col = workers;
-		int max_zeros_in_row = tasks;
+		parent[ x ] = (int) x;
+	}
 
-		while( max_zeros_in_col > 0 && max_zeros_in_row > 0 && *lines < optimal_lines )
+	for( size_t i = 0; i < workers; i++ )
+	{
+		for( size_t e = c->offsets[ i ]; e < c->offsets[ i + 1 ]; e++ )
 		{
-			for( size_t t = 0; *lines < optimal_lines && t < tasks; t++ )
-			{
-				if( !rows[ t ] )
-				{
-					int zeros_found = 0;
-					for( size_t w = 0; w < workers; w++ )
-					{
-						if( cost[ hidx(w, t) ] == 0 && !cols[ w ] && !rows[ t ] )
-						{
-							zeros_found += 1;
-						}
-					}
+			const size_t a = sparse_find( parent, i );
+			const size_t b = sparse_find( parent, workers + (size_t) c->columns[ e ] );
+			if( a != b ) parent[ a ] = (int) b;
+		}
+	}
 
-					if( zeros_found == max_zeros_in_row )
-					{
-						rows[ t ] = 1;
-						*lines += 1;
-					}
+	/* Number the components in order of their first worker. After the
+	 * paths are flattened, a root's entry can hold its number instead. */
+	for( size_t x = 0; x < workers + c->tasks; x++ )
+	{
+		parent[ x ] = (int) sparse_find( parent, x );
+	}
 
-					#ifdef DEBUG_HUNGARIAN_ASSIGNMENT
-					dump_array( "rows", rows, tasks );
-					#endif
-				}
-			}
+	size_t count = 0;
+	for( size_t i = 0; i < workers; i++ )
+	{
+		const size_t root = parent[ i ] < 0 ? i : (size_t) parent[ i ];
+		if( parent[ root ] >= 0 )
+		{
+			parent[ root ] = -1 - (int) count++;
+		}
+		rows[ i ] = -1 - parent[ root ]; /* the component, for now */
+	}
 
-			for( size_t w = 0; *lines < optimal_lines && w < workers; w++ )
-			{
-				if( !cols[ w ] )
-				{
-					int zeros_found = 0;
-					for( size_t t = 0; t < tasks; t++ )
-					{
-						if( cost[ hidx(w, t) ] == 0 && !cols[ w ] && !rows[ t ] )
-						{
-							zeros_found += 1;
-						}
-					}
+	for( size_t k = 0; k <= count; k++ )
+	{
+		offsets[ k ] = 0;
+	}
+	for( size_t i = 0; i < workers; i++ )
+	{
+		offsets[ rows[ i ] + 1 ] += 1;
+	}
+	for( size_t k = 0; k < count; k++ )
+	{
+		offsets[ k + 1 ] += offsets[ k ];
+	}
 
-					if( zeros_found == max_zeros_in_col )
-					{
-						cols[ w ] = 1;
-						*lines += 1;
-					}
+	/* parent is reused as the insertion cursor of each component. */
+	for( size_t k = 0; k < count; k++ )
+	{
+		parent[ k ] = (int) offsets[ k ];
+	}
+	for( size_t i = 0; i < workers; i++ )
+	{
+		const int k = rows[ i ];
+		rows[ i ] = parent[ k ];      /* where worker i goes */
+		parent[ k ] += 1;
+	}
+	for( size_t i = 0; i < workers; i++ )
+	{
+		parent[ rows[ i ] ] = (int) i;
+	}
+	for( size_t i = 0; i < workers; i++ )
+	{
+		rows[ i ] = parent[ i ];
+	}
 
-					#ifdef DEBUG_HUNGARIAN_ASSIGNMENT
-					dump_array( "cols", cols, workers );
-					#endif
-				}
-			}
+	return count;
+}
+
+/* Solves the components, each on one thread. */
+static bool sparse_solve_components( const sparse_costs_t* c, sparse_state_t* st, const int rows[], const size_t offsets[], size_t count, size_t columns )
+{
+	const size_t workers = c->workers;
+	const size_t edges   = c->offsets[ workers ] - c->offsets[ 0 ];
+	bool result = true;
 
-			/*
-			if( *lines >= optimal_lines )
+	#ifdef _OPENMP
+	#pragma omp parallel if( count > 1 ) reduction(&&:result)
+	#endif
+	{
+		/* A search relaxes each pair at most once, plus one dummy column
+		 * per row. */
+		sparse_scratch_t s = {
+			.keys    = malloc( (edges + workers) * sizeof(double) ),
+			.heap    = malloc( (edges + workers) * sizeof(int) ),
+			.count   = 0,
+			.touched = malloc( columns * sizeof(int) ),
+			.rows    = malloc( workers * sizeof(int) ),
+			.columns = malloc( columns * sizeof(int) ),
+			.free    = malloc( workers * sizeof(int) )
+		};
+
+		result = s.keys && s.heap && s.touched && s.rows && s.columns && s.free;
+
+		#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+		#endif
+		for( size_t k = 0; k < count; k++ )
+		{
+			if( result )
 			{
-				#ifdef DEBUG_HUNGARIAN_ASSIGNMENT
-				printf( "lines = %zu\n", *lines );
-				dump_array( "rows", rows, tasks );
-				dump_array( "cols", cols, workers );
-				#endif
-				break;
+				result = sparse_solve_rows( c, st, &s, rows + offsets[ k ], offsets[ k + 1 ] - offsets[ k ] );
 			}
-			*/
+		}
+
+		free( s.keys );
+		free( s.heap );
+		free( s.touched );
+		free( s.rows );
+		free( s.columns );
+		free( s.free );
+	}
+
+	return result;
+}
+
+static bool sparse_assign( const sparse_costs_t* c, bool components, int output[] )
+{
+	const size_t workers = c->workers;
+	const size_t columns = c->tasks + (c->unassigned < INFINITY ? workers : 0);
+	bool result = false;
+
+	/* With no workers there is nothing to do, and workers with no tasks
+	 * and no way to stay unassigned cannot all be assigned. */
+	if( workers == 0 || columns == 0 )
+	{
+		return workers == 0;
+	}
+
+	sparse_state_t st = {
+		.u        = malloc( workers * sizeof(double) ),
+		.v        = malloc( columns * sizeof(double) ),
+		.shortest = malloc( columns * sizeof(double) ),
+		.row4col  = malloc( columns * sizeof(int) ),
+		.col4row  = malloc( workers * sizeof(int) ),
+		.path     = malloc( columns * sizeof(int) ),
+		.visited  = malloc( columns * sizeof(bool) )
+	};
+	int* parent     = malloc( (workers + c->tasks) * sizeof(int) );
+	int* rows       = malloc( workers * sizeof(int) );
+	size_t* offsets = malloc( (workers + 1) * sizeof(size_t) );
+
+	if( st.u && st.v && st.shortest && st.row4col && st.col4row && st.path && st.visited && parent && rows && offsets )
+	{
+		for( size_t j = 0; j < columns; j++ )
+		{
+			st.v[ j ]        = 0.0;
+			st.shortest[ j ] = INFINITY;
+			st.row4col[ j ]  = -1;
+			st.visited[ j ]  = false;
+		}
+		for( size_t i = 0; i < workers; i++ )
+		{
+			st.col4row[ i ] = -1;
+		}
 
-			max_zeros_in_col -= 1;
-			max_zeros_in_row -= 1;
+		size_t count = 1;
+		if( components )
+		{
+			count = sparse_components( c, parent, rows, offsets );
+		}
+		else
+		{
+			for( size_t i = 0; i < workers; i++ )
+			{
+				rows[ i ] = (int) i;
+			}
+			offsets[ 0 ] = 0;
+			offsets[ 1 ] = workers;
 		}
 
-		#ifdef DEBUG_HUNGARIAN_ASSIGNMENT
-		printf( "lines = %zu\n", *lines );
-		dump_array( "rows", rows, tasks );
-		dump_array( "cols", cols, workers );
-		#endif
+		result = sparse_solve_components( c, &st, rows, offsets, count, columns );
+	}
+
+	if( result )
+	{
+		for( size_t i = 0; i < workers; i++ )
+		{
+			/* Dummy columns mean unassigned. */
+			output[ i ] = (size_t) st.col4row[ i ] < c->tasks ? st.col4row[ i ] : -1;
+		}
 	}
 
-	return *lines >= 4;
+	free( st.u );
+	free( st.v );
+	free( st.shortest );
+	free( st.row4col );
+	free( st.col4row );
+	free( st.path );
+	free( st.visited );
+	free( parent );
+	free( rows );
+	free( offsets );
+	return result;
 }
 
+bool sparse_assignmentf( bool maximal, size_t workers, size_t tasks, const size_t offsets[], const int columns[], const float costs[], float unassigned, bool components, int output[] )
+{
+	assert( offsets );
+	assert( output || workers == 0 );
+
+	sparse_costs_t c = {
+		.offsets    = offsets,
+		.columns    = columns,
+		.costs      = costs,
+		.is_float   = true,
+		.sign       = maximal ? -1.0 : 1.0,
+		.unassigned = maximal ? -(double) unassigned : (double) unassigned,
+		.workers    = workers,
+		.tasks      = tasks
+	};
+
+	return sparse_assign( &c, components, output );
+}
+
+bool sparse_assignmentd( bool maximal, size_t workers, size_t tasks, const size_t offsets[], const int columns[], const double costs[], double unassigned, bool components, int output[] )
+{
+	assert( offsets );
+	assert( output || workers == 0 );
+
+	sparse_costs_t c = {
+		.offsets    = offsets,
+		.columns    = columns,
+		.costs      = costs,
+		.is_float   = false,
+		.sign       = maximal ? -1.0 : 1.0,
+		.unassigned = maximal ? -unassigned : unassigned,
+		.workers    = workers,
+		.tasks      = tasks
+	};
+
+	return sparse_assign( &c, components, output );
+}
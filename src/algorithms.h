@@ -33,7 +33,54 @@
  *   t1  01  05  09  13
  *   t2  02  06  10  14
  *   t3  03  07  11  15
+ *
+ * The cost of giving worker w task t is cost[ tasks * w + t ], and worker
+ * w is given task output[ w ]. The matrix may be rectangular; when there
+ * are more workers than tasks, the workers left over get -1. The total cost
+ * is minimized, or maximized when maximal is true.
+ *
+ * The solver finds shortest augmenting paths (Jonker-Volgenant) in
+ * O(n^2 m) time, where n is the smaller side. The cost matrix is not
+ * modified.
+ *
+ * hungarian_assignment() allocates its workspace, and if that fails every
+ * output is -1. Callers that need to tell that apart from a solution can
+ * use hungarian_assignmentd() (int costs convert exactly), which returns
+ * false, with a workspace of their own.
  */
 void hungarian_assignment( bool maximal, int cost[], size_t workers, size_t tasks, int output[] );
 
+/*
+ * Float and double costs may use INFINITY (-INFINITY when maximal) for
+ * pairs that are not allowed. These return false when no assignment avoids
+ * them or when the workspace cannot be allocated.
+ *
+ * workspace may be NULL to allocate one for each call. Otherwise it should
+ * point to hungarian_workspace_size( workers, tasks ) bytes, aligned for
+ * doubles, which lets repeated calls avoid the heap.
+ */
+size_t hungarian_workspace_size ( size_t workers, size_t tasks );
+bool   hungarian_assignmentf    ( bool maximal, const float cost[], size_t workers, size_t tasks, int output[], void* workspace );
+bool   hungarian_assignmentd    ( bool maximal, const double cost[], size_t workers, size_t tasks, int output[], void* workspace );
+
+/*
+ * Sparse Assignment
+ *
+ * For problems where most pairs are not allowed, such as gated tracking,
+ * the allowed pairs are given in compressed sparse rows: worker w may take
+ * task columns[ e ] at costs[ e ] for offsets[ w ] <= e < offsets[ w + 1 ].
+ * Memory use is O(workers + tasks + pairs) instead of O(workers * tasks).
+ *
+ * A worker may be left unassigned, with output -1, at a cost of
+ * unassigned; it works like a gate threshold. With unassigned = INFINITY
+ * (-INFINITY when maximal) every worker must get a task, and false is
+ * returned when that is impossible or when memory runs out.
+ *
+ * When components is true, the workers and tasks are split into the
+ * connected components of the pairs, which are solved independently and,
+ * when built with OpenMP, in parallel.
+ */
+bool   sparse_assignmentf       ( bool maximal, size_t workers, size_t tasks, const size_t offsets[], const int columns[], const float costs[], float unassigned, bool components, int output[] );
+bool   sparse_assignmentd       ( bool maximal, size_t workers, size_t tasks, const size_t offsets[], const int columns[], const double costs[], double unassigned, bool components, int output[] );
+
 #endif /* _ALGORITHMS_H_ */
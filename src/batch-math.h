@@ -0,0 +1,169 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _BATCH_MATH_H_
+#define _BATCH_MATH_H_
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Internal double precision math for batch kernels.
+ *
+ * This header is not installed. The functions have no branches or calls,
+ * so loops over them vectorize. Kernels run them over blocks of
+ * BATCH_BLOCK elements, because the compiler only vectorizes cheaply when
+ * the trip count is a known multiple of the vector width. The library is
+ * built with -fno-math-errno and -fno-trapping-math so that sqrt and
+ * selects need no branches. The results are within a few ulps of the C
+ * library.
+ */
+#define BATCH_BLOCK    (64)
+
+#define BATCH_PI       (3.14159265358979323846)
+
+/* For helpers shared by a kernel and a scalar function. A kernel only
+ * vectorizes if its helpers are inlined, which the compiler may decline
+ * once a helper has more than one caller. */
+#if defined(__GNUC__)
+#define BATCH_INLINE   static inline __attribute__((always_inline))
+#else
+#define BATCH_INLINE   static inline
+#endif
+
+/* 1 / sqrt(x), or 0 for x = 0 */
+static inline double batch_inverse_length( double x )
+{
+	return (x != 0.0) / sqrt( x + (x == 0.0) );
+}
+
+/* Rounds x to the nearest integer, for |x| < 2^51. */
+static inline double batch_round( double x )
+{
+	return (x + 0x1.8p52) - 0x1.8p52;
+}
+
+/* Largest integer not above x, for |x| < 2^51. */
+static inline double batch_floor( double x )
+{
+	const double r = batch_round( x );
+	return r > x ? r - 1.0 : r;
+}
+
+/*
+ * Natural logarithm of a positive, normal x. The exponent and mantissa are
+ * split with integer operations, so that the mantissa m is in
+ * [sqrt(2) / 2, sqrt(2)), and log(m) is the fdlibm polynomial in
+ * s = (m - 1) / (m + 1).
+ */
+static inline double batch_log( double x )
+{
+	uint64_t bits;
+	memcpy( &bits, &x, sizeof(bits) );
+	bits += (uint64_t) (0x3ff00000 - 0x3fe6a09e) << 32;
+
+	/* The biased exponent becomes a double by placing it in the mantissa
+	 * of 2^52. */
+	const uint64_t k_bits = 0x4330000000000000ULL | (bits >> 52);
+	double k;
+	memcpy( &k, &k_bits, sizeof(k) );
+	k -= 0x1p52 + 1023.0;
+
+	bits = (bits & 0x000fffffffffffffULL) + ((uint64_t) 0x3fe6a09e << 32);
+	double m;
+	memcpy( &m, &bits, sizeof(m) );
+
+	const double f = m - 1.0;
+	const double s = f / (2.0 + f);
+	const double z = s * s;
+	const double w = z * z;
+	const double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+	const double t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01 +
+	                  w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+	const double hfsq = 0.5 * f * f;
+	return k * 6.93147180369123816490e-01 - ((hfsq - (s * (hfsq + t1 + t2) + k * 1.90821492927058770002e-10)) - f);
+}
+
+/*
+ * Sine and cosine of an angle in degrees, for |degrees| < 2^50. Reducing
+ * by quadrants in degrees is exact, so large angles lose no accuracy. The
+ * polynomials are the fdlibm kernels on [-pi/4, pi/4].
+ */
+static inline void batch_sincos_degrees( double degrees, double* s, double* c )
+{
+	/* Adding 1.5 * 2^52 rounds to an integer and leaves it in the low
+	 * bits of the mantissa, without a conversion. */
+	const double shifted = degrees * (1.0 / 90.0) + 0x1.8p52;
+	const double q = shifted - 0x1.8p52;
+	const double r = (degrees - q * 90.0) * (BATCH_PI / 180.0);
+	uint64_t quadrant;
+	memcpy( &quadrant, &shifted, sizeof(quadrant) );
+	const double z = r * r;
+
+	const double sr = r + r * z * (-1.66666666666666324348e-01 + z * (8.33333333332248946124e-03 +
+	                  z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06 +
+	                  z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)))));
+	const double cr = 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 +
+	                  z * (2.48015872894767294178e-05 + z * (-2.75573143513906633035e-07 +
+	                  z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+
+	/* Quadrants 1 and 3 swap sine and cosine; 2 and 3 negate the sine,
+	 * and 1 and 2 the cosine. */
+	const double sq = (quadrant & 1) ? cr : sr;
+	const double cq = (quadrant & 1) ? sr : cr;
+	*s = (quadrant & 2) ? -sq : sq;
+	*c = ((quadrant + 1) & 2) ? -cq : cq;
+}
+
+/* Arctangent of t in [0, 1], from the Cephes rational approximation. */
+static inline double batch_atan_unit( double t )
+{
+	/* Above tan(3 pi / 16), use atan(t) = pi / 4 + atan((t - 1) / (t + 1)). */
+	const double reduced = (t - 1.0) / (t + 1.0);
+	const double x = t > 0.66 ? reduced : t;
+	const double z = x * x;
+
+	const double p = (((-8.750608600031904122785e-01 * z - 1.615753718733365076637e+01) * z -
+	                 7.500855792314704667340e+01) * z - 1.228866684490136173410e+02) * z -
+	                 6.485021904942025371773e+01;
+	const double q = ((((z + 2.485846490142306297962e+01) * z + 1.650270098316988542046e+02) * z +
+	                 4.328810604912902668951e+02) * z + 4.853903996359136964868e+02) * z +
+	                 1.945506571482613964425e+02;
+
+	const double a = x + x * z * p / q;
+	return t > 0.66 ? (0.25 * BATCH_PI + a) : a;
+}
+
+/* atan2( y, x ) in radians, with atan2( 0, 0 ) = 0. */
+static inline double batch_atan2( double y, double x )
+{
+	const double ax = fabs( x );
+	const double ay = fabs( y );
+	const double large = ay > ax ? ay : ax;
+	const double small = ay > ax ? ax : ay;
+	const double t = small / (large + (large == 0.0)); /* no division by zero */
+
+	double a = batch_atan_unit( t );
+	a = ay > ax ? 0.5 * BATCH_PI - a : a;
+	a = x < 0.0 ? BATCH_PI - a : a;
+	return copysign( a, y );
+}
+
+#endif /* _BATCH_MATH_H_ */
@@ -0,0 +1,188 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <assert.h>
+#include "batch-math.h"
+#include "dual-quat.h"
+
+void dual_quat_normalize( dual_quat_t* dq )
+{
+	const scaler_t magnitude = quat_magnitude( &dq->real );
+
+	if( magnitude > 0.0f )
+	{
+		quat_scale( &dq->real, 1 / magnitude );
+		quat_scale( &dq->dual, 1 / magnitude );
+
+		const scaler_t d = quat_dot_product( &dq->real, &dq->dual );
+		dq->dual.x -= d * dq->real.x;
+		dq->dual.y -= d * dq->real.y;
+		dq->dual.z -= d * dq->real.z;
+		dq->dual.w -= d * dq->real.w;
+	}
+}
+
+dual_quat_t dual_quat_from_mat4( const mat4_t* m )
+{
+	/* Shepperd's method, on the largest of w, x, y and z. The matrix is
+	 * by columns, so row r of column c is m[ 4 * c + r ]. */
+	const scaler_t trace = m->m[ 0 ] + m->m[ 5 ] + m->m[ 10 ];
+	quat_t q;
+
+	if( trace > 0.0f )
+	{
+		const scaler_t s = scaler_sqrt( trace + 1 ) * 2;
+		q = QUAT( (m->m[ 6 ] - m->m[ 9 ]) / s, (m->m[ 8 ] - m->m[ 2 ]) / s, (m->m[ 1 ] - m->m[ 4 ]) / s, s / 4 );
+	}
+	else if( m->m[ 0 ] >= m->m[ 5 ] && m->m[ 0 ] >= m->m[ 10 ] )
+	{
+		const scaler_t s = scaler_sqrt( 1 + m->m[ 0 ] - m->m[ 5 ] - m->m[ 10 ] ) * 2;
+		q = QUAT( s / 4, (m->m[ 4 ] + m->m[ 1 ]) / s, (m->m[ 8 ] + m->m[ 2 ]) / s, (m->m[ 6 ] - m->m[ 9 ]) / s );
+	}
+	else if( m->m[ 5 ] >= m->m[ 10 ] )
+	{
+		const scaler_t s = scaler_sqrt( 1 + m->m[ 5 ] - m->m[ 0 ] - m->m[ 10 ] ) * 2;
+		q = QUAT( (m->m[ 4 ] + m->m[ 1 ]) / s, s / 4, (m->m[ 9 ] + m->m[ 6 ]) / s, (m->m[ 8 ] - m->m[ 2 ]) / s );
+	}
+	else
+	{
+		const scaler_t s = scaler_sqrt( 1 + m->m[ 10 ] - m->m[ 0 ] - m->m[ 5 ] ) * 2;
+		q = QUAT( (m->m[ 8 ] + m->m[ 2 ]) / s, (m->m[ 9 ] + m->m[ 6 ]) / s, s / 4, (m->m[ 1 ] - m->m[ 4 ]) / s );
+	}
+
+	quat_normalize( &q );
+	const vec3_t translation = VEC3( m->m[ 12 ], m->m[ 13 ], m->m[ 14 ] );
+	return dual_quat_from_quat_vec3( &q, &translation );
+}
+
+mat4_t dual_quat_to_mat4( const dual_quat_t* dq )
+{
+	mat4_t m = quat_to_mat4( &dq->real );
+	const vec3_t translation = dual_quat_translation( dq );
+	m.m[ 12 ] = translation.x;
+	m.m[ 13 ] = translation.y;
+	m.m[ 14 ] = translation.z;
+	return m;
+}
+
+/*
+ * The weighted sums of the dual quaternions of n vertices from first, as
+ * the real x, y, z, w and dual x, y, z, w streams of a block.
+ */
+BATCH_INLINE void blend_block( scaler_t blend[ 8 ][ BATCH_BLOCK ], const dual_quat_t* restrict palette, const uint16_t joints[][ 4 ], const scaler_t weights[][ 4 ], size_t first, size_t n )
+{
+	const uint16_t (* restrict joint)[ 4 ] = joints + first;
+	const scaler_t (* restrict weight)[ 4 ] = weights + first;
+
+	for( size_t j = 0; j < n; j++ )
+	{
+		const dual_quat_t* a = &palette[ joint[ j ][ 0 ] ];
+		const dual_quat_t* b = &palette[ joint[ j ][ 1 ] ];
+		const dual_quat_t* c = &palette[ joint[ j ][ 2 ] ];
+		const dual_quat_t* d = &palette[ joint[ j ][ 3 ] ];
+		/* b, c and d on the same side as a */
+		const scaler_t wa = weight[ j ][ 0 ];
+		const scaler_t wb = quat_dot_product( &a->real, &b->real ) < 0 ? -weight[ j ][ 1 ] : weight[ j ][ 1 ];
+		const scaler_t wc = quat_dot_product( &a->real, &c->real ) < 0 ? -weight[ j ][ 2 ] : weight[ j ][ 2 ];
+		const scaler_t wd = quat_dot_product( &a->real, &d->real ) < 0 ? -weight[ j ][ 3 ] : weight[ j ][ 3 ];
+
+		blend[ 0 ][ j ] = wa * a->real.x + wb * b->real.x + wc * c->real.x + wd * d->real.x;
+		blend[ 1 ][ j ] = wa * a->real.y + wb * b->real.y + wc * c->real.y + wd * d->real.y;
+		blend[ 2 ][ j ] = wa * a->real.z + wb * b->real.z + wc * c->real.z + wd * d->real.z;
+		blend[ 3 ][ j ] = wa * a->real.w + wb * b->real.w + wc * c->real.w + wd * d->real.w;
+		blend[ 4 ][ j ] = wa * a->dual.x + wb * b->dual.x + wc * c->dual.x + wd * d->dual.x;
+		blend[ 5 ][ j ] = wa * a->dual.y + wb * b->dual.y + wc * c->dual.y + wd * d->dual.y;
+		blend[ 6 ][ j ] = wa * a->dual.z + wb * b->dual.z + wc * c->dual.z + wd * d->dual.z;
+		blend[ 7 ][ j ] = wa * a->dual.w + wb * b->dual.w + wc * c->dual.w + wd * d->dual.w;
+	}
+}
+
+/*
+ * Normalizes the blended dual quaternions and moves n points by them, or
+ * only rotates them when translate is 0. A zero blend has a zero real
+ * part, which leaves the point where it is.
+ */
+BATCH_INLINE void transform_block( const scaler_t blend[ 8 ][ BATCH_BLOCK ], scaler_t* restrict ox, scaler_t* restrict oy, scaler_t* restrict oz,
+                                   const scaler_t* restrict px, const scaler_t* restrict py, const scaler_t* restrict pz, size_t n, scaler_t translate )
+{
+	for( size_t j = 0; j < n; j++ )
+	{
+		const scaler_t length2 = blend[ 0 ][ j ] * blend[ 0 ][ j ] + blend[ 1 ][ j ] * blend[ 1 ][ j ] +
+		                         blend[ 2 ][ j ] * blend[ 2 ][ j ] + blend[ 3 ][ j ] * blend[ 3 ][ j ];
+		const scaler_t inverse = (length2 != 0) / scaler_sqrt( length2 + (length2 == 0) );
+		const scaler_t x  = blend[ 0 ][ j ] * inverse, y  = blend[ 1 ][ j ] * inverse;
+		const scaler_t z  = blend[ 2 ][ j ] * inverse, w  = blend[ 3 ][ j ] * inverse;
+		const scaler_t dx = blend[ 4 ][ j ] * inverse, dy = blend[ 5 ][ j ] * inverse;
+		const scaler_t dz = blend[ 6 ][ j ] * inverse, dw = blend[ 7 ][ j ] * inverse;
+
+		/* The translation, 2 * dual * conjugate(real), of which only the
+		 * part of the dual orthogonal to the real contributes. */
+		const scaler_t tx = 2 * translate * (w * dx - dw * x + y * dz - z * dy);
+		const scaler_t ty = 2 * translate * (w * dy - dw * y + z * dx - x * dz);
+		const scaler_t tz = 2 * translate * (w * dz - dw * z + x * dy - y * dx);
+
+		/* p + w * c + r x c with c = 2 * r x p */
+		const scaler_t cx = 2 * (y * pz[ j ] - z * py[ j ]);
+		const scaler_t cy = 2 * (z * px[ j ] - x * pz[ j ]);
+		const scaler_t cz = 2 * (x * py[ j ] - y * px[ j ]);
+		ox[ j ] = px[ j ] + w * cx + (y * cz - z * cy) + tx;
+		oy[ j ] = py[ j ] + w * cy + (z * cx - x * cz) + ty;
+		oz[ j ] = pz[ j ] + w * cz + (x * cy - y * cx) + tz;
+	}
+}
+
+BATCH_INLINE void skin_block( const scaler_t blend[ 8 ][ BATCH_BLOCK ], vec3_array_t* positions, vec3_array_t* normals,
+                              const vec3_array_t* bind_positions, const vec3_array_t* bind_normals, size_t first, size_t n )
+{
+	transform_block( blend, positions->x + first, positions->y + first, positions->z + first,
+	                 bind_positions->x + first, bind_positions->y + first, bind_positions->z + first, n, 1 );
+	if( normals )
+	{
+		transform_block( blend, normals->x + first, normals->y + first, normals->z + first,
+		                 bind_normals->x + first, bind_normals->y + first, bind_normals->z + first, n, 0 );
+	}
+}
+
+void dual_quat_skin( vec3_array_t* positions, vec3_array_t* normals,
+                     const vec3_array_t* bind_positions, const vec3_array_t* bind_normals,
+                     const dual_quat_t palette[], const uint16_t joints[][ 4 ], const scaler_t weights[][ 4 ] )
+{
+	assert( positions && bind_positions && palette && joints && weights );
+	assert( positions->count == bind_positions->count );
+	assert( !normals || (bind_normals && normals->count == positions->count && bind_normals->count == positions->count) );
+	const size_t count = positions->count;
+	scaler_t blend[ 8 ][ BATCH_BLOCK ];
+
+	for( size_t first = 0; first < count; first += BATCH_BLOCK )
+	{
+		const size_t n = count - first < BATCH_BLOCK ? count - first : BATCH_BLOCK;
+
+		if( n == BATCH_BLOCK )
+		{
+			blend_block( blend, palette, joints, weights, first, BATCH_BLOCK );
+			skin_block( blend, positions, normals, bind_positions, bind_normals, first, BATCH_BLOCK );
+		}
+		else
+		{
+			blend_block( blend, palette, joints, weights, first, n );
+			skin_block( blend, positions, normals, bind_positions, bind_normals, first, n );
+		}
+	}
+}
@@ -0,0 +1,153 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _DUAL_QUAT_H_
+#define _DUAL_QUAT_H_
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "vec3.h"
+#include "mat4.h"
+#include "quat.h"
+#include "vec3-array.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Dual Quaternions
+ *
+ * A unit dual quaternion real + e dual is a rigid transform: real is the
+ * rotation and dual = (t, 0) * real / 2 holds the translation t. That is 8
+ * scalers instead of the 16 of a mat4_t, and, unlike matrices, a weighted
+ * sum of them renormalizes to a rigid transform, which is what makes dual
+ * quaternion skinning free of the collapsing joints of linear blending.
+ *
+ * Multiplication composes like matrices: a * b applies b first. The
+ * functions below expect unit dual quaternions unless noted otherwise.
+ *
+ * The products here are Hamilton products, the convention of
+ * quat_to_mat4(). quat_multiply( a, b ) gives the Hamilton product b a,
+ * hence the swapped arguments below.
+ */
+typedef struct dual_quat {
+	quat_t real;
+	quat_t dual;
+} dual_quat_t;
+
+#define DUAL_QUAT(r,d)          (dual_quat_t){ .real = (r), .dual = (d) }
+#define DUAL_QUAT_IDENTITY      DUAL_QUAT( QUAT_WUNIT, QUAT( 0, 0, 0, 0 ) )
+
+static inline dual_quat_t dual_quat_from_quat_vec3( const quat_t* rotation, const vec3_t* translation )
+{
+	const quat_t t = QUAT( translation->x, translation->y, translation->z, 0 );
+	quat_t dual = quat_multiply( rotation, &t ); /* t rotation */
+	quat_scale( &dual, 0.5f );
+	return DUAL_QUAT( *rotation, dual );
+}
+
+static inline quat_t dual_quat_rotation( const dual_quat_t* dq )
+{
+	return dq->real;
+}
+
+static inline vec3_t dual_quat_translation( const dual_quat_t* dq )
+{
+	/* 2 * dual * conjugate(real) */
+	const quat_t conjugate = quat_conjugate( &dq->real );
+	const quat_t t = quat_multiply( &conjugate, &dq->dual );
+	return VEC3( 2 * t.x, 2 * t.y, 2 * t.z );
+}
+
+static inline dual_quat_t dual_quat_multiply( const dual_quat_t* a, const dual_quat_t* b )
+{
+	const quat_t real = quat_multiply( &b->real, &a->real );
+	const quat_t ab   = quat_multiply( &b->dual, &a->real );
+	const quat_t ba   = quat_multiply( &b->real, &a->dual );
+	return DUAL_QUAT( real, quat_add( &ab, &ba ) );
+}
+
+/* The inverse of a unit dual quaternion. */
+static inline dual_quat_t dual_quat_conjugate( const dual_quat_t* dq )
+{
+	return DUAL_QUAT( quat_conjugate( &dq->real ), quat_conjugate( &dq->dual ) );
+}
+
+static inline vec3_t dual_quat_transform_vec3( const dual_quat_t* dq, const vec3_t* v ) /* rotation only, e.g. normals */
+{
+	const vec3_t r  = VEC3( dq->real.x, dq->real.y, dq->real.z );
+	const vec3_t rv = vec3_cross_product( &r, v );
+	const vec3_t t  = VEC3( 2 * rv.x, 2 * rv.y, 2 * rv.z );
+	const vec3_t rt = vec3_cross_product( &r, &t );
+	return VEC3(
+		v->x + dq->real.w * t.x + rt.x,
+		v->y + dq->real.w * t.y + rt.y,
+		v->z + dq->real.w * t.z + rt.z
+	);
+}
+
+static inline vec3_t dual_quat_transform_point( const dual_quat_t* dq, const vec3_t* p )
+{
+	const vec3_t rotated     = dual_quat_transform_vec3( dq, p );
+	const vec3_t translation = dual_quat_translation( dq );
+	return vec3_add( &rotated, &translation );
+}
+
+/*
+ * Makes a dual quaternion, e.g. a sum of weighted ones, a unit dual
+ * quaternion: both parts are divided by the length of the real part and
+ * the dual part is then made orthogonal to the real part.
+ */
+void        dual_quat_normalize  ( dual_quat_t* dq );
+dual_quat_t dual_quat_from_mat4  ( const mat4_t* m ); /* m must be rigid */
+mat4_t      dual_quat_to_mat4    ( const dual_quat_t* dq );
+
+/*
+ * Dual Quaternion Skinning
+ *
+ * Each vertex is moved by the normalized, weighted sum of the dual
+ * quaternions of up to four joints (dual quaternion linear blending). A
+ * joint whose rotation is on the other side of the first joint's is
+ * negated before it is added, so the blend takes the short way around.
+ *
+ * The vertices are structures of arrays. The influences are four joints
+ * and weights per vertex, like the JOINTS_0 and WEIGHTS_0 attributes of
+ * glTF; unused influences have a weight of 0. The weights need not add up
+ * to one, and vertices with no weight at all are copied. The palette holds
+ * one skinning transform (world * inverse bind) per joint, e.g. from
+ * dual_quat_from_mat4() of each skinning matrix, which is half the size of
+ * a mat4_t palette.
+ *
+ * Normals may be NULL, in which case only the positions are skinned. The
+ * results must not be the same arrays as the inputs.
+ */
+void dual_quat_skin ( vec3_array_t* positions, vec3_array_t* normals,
+                      const vec3_array_t* bind_positions, const vec3_array_t* bind_normals,
+                      const dual_quat_t palette[], const uint16_t joints[][ 4 ], const scaler_t weights[][ 4 ] );
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _DUAL_QUAT_H_ */
@@ -0,0 +1,242 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include "format.h"
+
+/* Values are scaled in at least double precision so that float builds
+ * keep all of their digits. */
+#if defined(LIBM3D_USE_LONG_DOUBLE)
+typedef long double format_real_t;
+#else
+typedef double format_real_t;
+#endif
+
+static const uint64_t powers_of_ten[ M3D_FORMAT_PRECISION_MAX + 1 ] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+	1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+};
+
+static const char digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* Writes the digits of n backwards, ending just before end. */
+static inline char* format_digits( char* end, uint64_t n )
+{
+	while( n >= 100 )
+	{
+		const uint64_t pair = n % 100;
+		n /= 100;
+		end -= 2;
+		memcpy( end, &digit_pairs[ 2 * pair ], 2 );
+	}
+
+	if( n >= 10 )
+	{
+		end -= 2;
+		memcpy( end, &digit_pairs[ 2 * n ], 2 );
+	}
+	else
+	{
+		*--end = (char) ('0' + n);
+	}
+
+	return end;
+}
+
+/*
+ * Writes value with precision digits after the decimal point and returns
+ * the number of characters written. No terminator is written and string
+ * must have room for M3D_FORMAT_SCALER_MAX characters. The result is
+ * rounded to nearest, so a tie may round differently than printf().
+ */
+size_t m3d_format_scaler( char* string, scaler_t value, int precision )
+{
+	if( precision < 0 ) precision = 0;
+	if( precision > M3D_FORMAT_PRECISION_MAX ) precision = M3D_FORMAT_PRECISION_MAX;
+
+	const format_real_t v      = value;
+	const bool negative        = v < 0;
+	const format_real_t scaled = (negative ? -v : v) * (format_real_t) powers_of_ten[ precision ] + 0.5;
+
+	/* Also catches NaN and infinity. */
+	if( !(scaled < (format_real_t) 1.8e19) )
+	{
+		#if defined(LIBM3D_USE_LONG_DOUBLE)
+		int length = snprintf( string, M3D_FORMAT_SCALER_MAX, "%.*Le", precision, v );
+		#else
+		int length = snprintf( string, M3D_FORMAT_SCALER_MAX, "%.*e", precision, v );
+		#endif
+		return length < 0 ? 0 : (size_t) m3d_mini( length, M3D_FORMAT_SCALER_MAX - 1 );
+	}
+
+	const uint64_t n = (uint64_t) scaled;
+	char digits[ M3D_FORMAT_SCALER_MAX ];
+	char* const end = digits + sizeof(digits);
+	char* p = end;
+
+	uint64_t integer, fraction;
+
+	/* 32-bit division is much cheaper and covers the common magnitudes. */
+	if( n <= UINT32_MAX )
+	{
+		const uint32_t divisor = (uint32_t) powers_of_ten[ precision ];
+		integer  = (uint32_t) n / divisor;
+		fraction = (uint32_t) n % divisor;
+	}
+	else
+	{
+		integer  = n / powers_of_ten[ precision ];
+		fraction = n % powers_of_ten[ precision ];
+	}
+
+	if( precision > 0 )
+	{
+		p = format_digits( p, fraction );
+		while( end - p < precision )
+		{
+			*--p = '0';
+		}
+		*--p = '.';
+	}
+
+	p = format_digits( p, integer );
+
+	/* Values that round to zero are written without a sign. */
+	if( negative && n != 0 )
+	{
+		*--p = '-';
+	}
+
+	const size_t length = (size_t) (end - p);
+	memcpy( string, p, length );
+	return length;
+}
+
+/* Vectors are written as "(x, y, z)" and matrices as "[a, b; c, d]" in
+ * row order, where values holds the matrix in column-major order. */
+static size_t format_element( char* string, const scaler_t* values, size_t rows, size_t columns, int precision )
+{
+	char* p = string;
+
+	if( rows == 1 )
+	{
+		*p++ = '(';
+		for( size_t c = 0; c < columns; c++ )
+		{
+			if( c > 0 )
+			{
+				*p++ = ',';
+				*p++ = ' ';
+			}
+			p += m3d_format_scaler( p, values[ c ], precision );
+		}
+		*p++ = ')';
+	}
+	else
+	{
+		*p++ = '[';
+		for( size_t r = 0; r < rows; r++ )
+		{
+			if( r > 0 )
+			{
+				*p++ = ';';
+				*p++ = ' ';
+			}
+			for( size_t c = 0; c < columns; c++ )
+			{
+				if( c > 0 )
+				{
+					*p++ = ',';
+					*p++ = ' ';
+				}
+				p += m3d_format_scaler( p, values[ c * rows + r ], precision );
+			}
+		}
+		*p++ = ']';
+	}
+
+	*p++ = '\n';
+	return (size_t) (p - string);
+}
+
+/*
+ * Formats count elements of rows x columns scalers, one per line, where
+ * consecutive elements are stride scalers apart. Only whole elements are
+ * written and the buffer is always terminated. Returns the number of
+ * elements written and sets length to the number of characters.
+ */
+size_t m3d_format_elements( char* restrict buffer, size_t size, const scaler_t* restrict values, size_t stride,
+                            size_t count, size_t rows, size_t columns, int precision, size_t* restrict length )
+{
+	assert( buffer || size == 0 );
+	assert( values || count == 0 );
+	assert( rows >= 1 && columns >= 1 && rows * columns <= 16 );
+
+	/* Every scaler followed by a separator, plus the brackets and newline. */
+	const size_t worst_case = rows * columns * (M3D_FORMAT_SCALER_MAX + 2) + 3;
+	char scratch[ 16 * (M3D_FORMAT_SCALER_MAX + 2) + 3 ];
+	size_t used = 0;
+	size_t i    = 0;
+
+	if( size == 0 )
+	{
+		if( length ) *length = 0;
+		return 0;
+	}
+
+	for( ; i < count; i++ )
+	{
+		const size_t available = size - 1 - used;
+
+		if( available >= worst_case )
+		{
+			used += format_element( buffer + used, values + i * stride, rows, columns, precision );
+		}
+		else
+		{
+			/* Near the end of the buffer the element might not fit. */
+			const size_t n = format_element( scratch, values + i * stride, rows, columns, precision );
+			if( n > available )
+			{
+				break;
+			}
+			memcpy( buffer + used, scratch, n );
+			used += n;
+		}
+	}
+
+	buffer[ used ] = '\0';
+	if( length ) *length = used;
+	return i;
+}
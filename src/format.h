@@ -0,0 +1,41 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _FORMAT_H_
+#define _FORMAT_H_
+#include <stddef.h>
+#include "mathematics.h"
+
+/*
+ * Internal number formatting for the *_format() bulk functions.
+ *
+ * This header is not installed. Values are written in fixed notation
+ * without going through stdio, which is much faster than calling
+ * snprintf() for every component. Values too large for 64-bit fixed
+ * point, and NaN and infinity, are handed to snprintf() instead.
+ */
+#define M3D_FORMAT_PRECISION_MAX  (9)
+#define M3D_FORMAT_SCALER_MAX     (32) /* characters needed by one scaler */
+
+size_t m3d_format_scaler   ( char* string, scaler_t value, int precision );
+size_t m3d_format_elements ( char* restrict buffer, size_t size, const scaler_t* restrict values, size_t stride,
+                             size_t count, size_t rows, size_t columns, int precision, size_t* restrict length );
+
+#endif /* _FORMAT_H_ */
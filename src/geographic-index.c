@@ -0,0 +1,488 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "geographic-index.h"
+
+#define DEGREES_TO_RADIANS(degs)     ((degs) * M_PI / 180.0)
+
+/* Ranges of at most this many points are scanned instead of split. */
+#define GEO_INDEX_LEAF               (8)
+/* The tree is rebuilt once more than this many points, or an eighth of
+ * the tree, are waiting to be added to it. */
+#define GEO_INDEX_PENDING            (64)
+
+/*
+ * Every distance method is at least the angle between the normals times
+ * the smallest radius of curvature of the ellipsoid, a (1 - e^2) at the
+ * equator, and the angle is at least the chord between the unit normals.
+ * So chord * GEO_INDEX_SCALE is a lower bound on the distance that is
+ * safe for pruning. The factor leaves room for rounding.
+ */
+#define GEO_INDEX_SCALE              (WGS84_SEMI_MAJOR_AXIS * (1.0 - WGS84_ECCENTRICITY_SQUARED) * (1.0 - 1e-9))
+
+static inline void geo_index_normal( const geo_coord_t* coord, double n[ 3 ] )
+{
+	const double lat = DEGREES_TO_RADIANS( coord->lat );
+	const double lon = DEGREES_TO_RADIANS( coord->lon );
+	n[ 0 ] = cos( lat ) * cos( lon );
+	n[ 1 ] = cos( lat ) * sin( lon );
+	n[ 2 ] = sin( lat );
+}
+
+static inline double geo_index_chord( const double a[ 3 ], const double b[ 3 ] )
+{
+	const double dx = a[ 0 ] - b[ 0 ];
+	const double dy = a[ 1 ] - b[ 1 ];
+	const double dz = a[ 2 ] - b[ 2 ];
+	return sqrt( dx * dx + dy * dy + dz * dz );
+}
+
+static bool geo_index_reserve( geo_index_t* index, size_t capacity )
+{
+	if( capacity <= index->capacity )
+	{
+		return true;
+	}
+
+	geo_coord_t* coords = realloc( index->coords, capacity * sizeof(geo_coord_t) );
+	if( coords ) index->coords = coords;
+	double* normals = realloc( index->normals, 3 * capacity * sizeof(double) );
+	if( normals ) index->normals = normals;
+	bool* alive = realloc( index->alive, capacity * sizeof(bool) );
+	if( alive ) index->alive = alive;
+	size_t* tree = realloc( index->tree, capacity * sizeof(size_t) );
+	if( tree ) index->tree = tree;
+	double* tree_normals = realloc( index->tree_normals, 3 * capacity * sizeof(double) );
+	if( tree_normals ) index->tree_normals = tree_normals;
+	uint8_t* tree_axes = realloc( index->tree_axes, capacity * sizeof(uint8_t) );
+	if( tree_axes ) index->tree_axes = tree_axes;
+
+	if( !coords || !normals || !alive || !tree || !tree_normals || !tree_axes )
+	{
+		return false;
+	}
+
+	index->capacity = capacity;
+	return true;
+}
+
+/* Partitions tree[ lo, hi ) so that the nth point on axis is in place,
+ * with no point before it greater and no point after it smaller. */
+static void geo_index_select( const double* normals, size_t* tree, size_t lo, size_t hi, size_t nth, int axis )
+{
+	ptrdiff_t left  = (ptrdiff_t) lo;
+	ptrdiff_t right = (ptrdiff_t) hi - 1;
+	const ptrdiff_t n = (ptrdiff_t) nth;
+
+	while( left < right )
+	{
+		const double pivot = normals[ 3 * tree[ left + (right - left) / 2 ] + axis ];
+		ptrdiff_t i = left;
+		ptrdiff_t j = right;
+
+		while( i <= j )
+		{
+			while( normals[ 3 * tree[ i ] + axis ] < pivot ) i++;
+			while( normals[ 3 * tree[ j ] + axis ] > pivot ) j--;
+			if( i <= j )
+			{
+				const size_t t = tree[ i ];
+				tree[ i ] = tree[ j ];
+				tree[ j ] = t;
+				i++;
+				j--;
+			}
+		}
+
+		if( n <= j )
+		{
+			right = j;
+		}
+		else if( n >= i )
+		{
+			left = i;
+		}
+		else
+		{
+			return;
+		}
+	}
+}
+
+/* Splits tree[ lo, hi ) on the axis with the widest spread. */
+static void geo_index_build( geo_index_t* index, size_t lo, size_t hi )
+{
+	if( hi - lo <= GEO_INDEX_LEAF )
+	{
+		return;
+	}
+
+	double min[ 3 ] = { INFINITY, INFINITY, INFINITY };
+	double max[ 3 ] = { -INFINITY, -INFINITY, -INFINITY };
+	for( size_t i = lo; i < hi; i++ )
+	{
+		const double* n = &index->normals[ 3 * index->tree[ i ] ];
+		for( int k = 0; k < 3; k++ )
+		{
+			min[ k ] = n[ k ] < min[ k ] ? n[ k ] : min[ k ];
+			max[ k ] = n[ k ] > max[ k ] ? n[ k ] : max[ k ];
+		}
+	}
+
+	int axis = 0;
+	for( int k = 1; k < 3; k++ )
+	{
+		if( max[ k ] - min[ k ] > max[ axis ] - min[ axis ] ) axis = k;
+	}
+
+	const size_t mid = lo + (hi - lo) / 2;
+	geo_index_select( index->normals, index->tree, lo, hi, mid, axis );
+	index->tree_axes[ mid ] = (uint8_t) axis;
+
+	geo_index_build( index, lo, mid );
+	geo_index_build( index, mid + 1, hi );
+}
+
+/* Rebuilds the tree from every live point. */
+static void geo_index_rebuild( geo_index_t* index )
+{
+	size_t n = 0;
+	for( size_t id = 0; id < index->count; id++ )
+	{
+		if( index->alive[ id ] )
+		{
+			index->tree[ n++ ] = id;
+		}
+	}
+
+	index->tree_count = n;
+	index->tree_dead  = 0;
+	index->built      = index->count;
+	geo_index_build( index, 0, n );
+
+	/* Copy the normals into tree order so that scans are sequential. */
+	for( size_t i = 0; i < n; i++ )
+	{
+		memcpy( &index->tree_normals[ 3 * i ], &index->normals[ 3 * index->tree[ i ] ], 3 * sizeof(double) );
+	}
+}
+
+bool geo_index_create( geo_index_t* index, const geo_coord_t coords[], size_t count, wgs84_distance_method_t method )
+{
+	assert( index );
+	assert( coords || count == 0 );
+	memset( index, 0, sizeof(*index) );
+	index->method = method;
+
+	if( !geo_index_reserve( index, count > 16 ? count : 16 ) )
+	{
+		geo_index_destroy( index );
+		return false;
+	}
+
+	for( size_t id = 0; id < count; id++ )
+	{
+		index->coords[ id ] = coords[ id ];
+		index->alive[ id ]  = true;
+		geo_index_normal( &coords[ id ], &index->normals[ 3 * id ] );
+	}
+	index->count = count;
+	index->live  = count;
+
+	geo_index_rebuild( index );
+	return true;
+}
+
+void geo_index_destroy( geo_index_t* index )
+{
+	assert( index );
+	free( index->coords );
+	free( index->normals );
+	free( index->alive );
+	free( index->tree );
+	free( index->tree_normals );
+	free( index->tree_axes );
+	memset( index, 0, sizeof(*index) );
+}
+
+size_t geo_index_count( const geo_index_t* index )
+{
+	assert( index );
+	return index->live;
+}
+
+wgs84_distance_method_t geo_index_method( const geo_index_t* index )
+{
+	assert( index );
+	return index->method;
+}
+
+const geo_coord_t* geo_index_get( const geo_index_t* index, size_t id )
+{
+	assert( index );
+	return id < index->count && index->alive[ id ] ? &index->coords[ id ] : NULL;
+}
+
+bool geo_index_insert( geo_index_t* index, const geo_coord_t* coord, size_t* id )
+{
+	assert( index );
+	assert( coord );
+
+	if( index->count == index->capacity && !geo_index_reserve( index, 2 * index->capacity ) )
+	{
+		return false;
+	}
+
+	const size_t i = index->count++;
+	index->coords[ i ] = *coord;
+	index->alive[ i ]  = true;
+	geo_index_normal( coord, &index->normals[ 3 * i ] );
+	index->live++;
+
+	const size_t pending = index->count - index->built;
+	if( pending > GEO_INDEX_PENDING && pending > index->tree_count / 8 )
+	{
+		geo_index_rebuild( index );
+	}
+
+	if( id ) *id = i;
+	return true;
+}
+
+bool geo_index_delete( geo_index_t* index, size_t id )
+{
+	assert( index );
+	if( id >= index->count || !index->alive[ id ] )
+	{
+		return false;
+	}
+
+	index->alive[ id ] = false;
+	index->live--;
+
+	if( id < index->built && ++index->tree_dead > index->tree_count / 2 )
+	{
+		geo_index_rebuild( index );
+	}
+	return true;
+}
+
+/*
+ * Queries
+ *
+ * Both queries keep the best results found so far in a max-heap on the
+ * caller's arrays, and skip any part of the tree whose lower bound is
+ * past the radius or, once the heap is full, past the worst result in it.
+ */
+typedef struct geo_index_query {
+	const geo_index_t* index;
+	double  lon, lat;
+	double  normal[ 3 ];
+	double  radius;
+	size_t* ids;
+	double* distances;
+	size_t  capacity; /* heap size */
+	size_t  size;
+	size_t  found;    /* within the radius */
+	bool    count_all;
+} geo_index_query_t;
+
+static inline double geo_index_query_bound( const geo_index_query_t* q )
+{
+	return q->size == q->capacity && !q->count_all ? (q->size > 0 ? q->distances[ 0 ] : -1.0) : q->radius;
+}
+
+static void geo_index_heap_push( geo_index_query_t* q, size_t id, double distance )
+{
+	size_t* ids = q->ids;
+	double* d   = q->distances;
+	size_t i;
+
+	if( q->size < q->capacity )
+	{
+		i = q->size++;
+		while( i > 0 && d[ (i - 1) / 2 ] < distance )
+		{
+			d[ i ]   = d[ (i - 1) / 2 ];
+			ids[ i ] = ids[ (i - 1) / 2 ];
+			i = (i - 1) / 2;
+		}
+	}
+	else if( q->size > 0 && distance < d[ 0 ] )
+	{
+		/* Replace the worst result and sift it down. */
+		i = 0;
+		for( ;; )
+		{
+			size_t c = 2 * i + 1;
+			if( c >= q->size ) break;
+			if( c + 1 < q->size && d[ c + 1 ] > d[ c ] ) c++;
+			if( d[ c ] <= distance ) break;
+			d[ i ]   = d[ c ];
+			ids[ i ] = ids[ c ];
+			i = c;
+		}
+	}
+	else
+	{
+		return;
+	}
+
+	d[ i ]   = distance;
+	ids[ i ] = id;
+}
+
+/* Sorts the heap into increasing distance. */
+static void geo_index_heap_sort( geo_index_query_t* q )
+{
+	size_t* ids = q->ids;
+	double* d   = q->distances;
+
+	for( size_t n = q->size; n > 1; n-- )
+	{
+		const size_t last_id = ids[ n - 1 ];
+		const double last_d  = d[ n - 1 ];
+		ids[ n - 1 ] = ids[ 0 ];
+		d[ n - 1 ]   = d[ 0 ];
+
+		size_t i = 0;
+		for( ;; )
+		{
+			size_t c = 2 * i + 1;
+			if( c >= n - 1 ) break;
+			if( c + 1 < n - 1 && d[ c + 1 ] > d[ c ] ) c++;
+			if( d[ c ] <= last_d ) break;
+			d[ i ]   = d[ c ];
+			ids[ i ] = ids[ c ];
+			i = c;
+		}
+		d[ i ]   = last_d;
+		ids[ i ] = last_id;
+	}
+}
+
+static inline void geo_index_query_point( geo_index_query_t* q, size_t id, const double normal[ 3 ] )
+{
+	const geo_index_t* index = q->index;
+
+	if( !index->alive[ id ] || geo_index_chord( q->normal, normal ) * GEO_INDEX_SCALE > geo_index_query_bound( q ) )
+	{
+		return;
+	}
+
+	const geo_coord_t* c = &index->coords[ id ];
+	const double distance = wgs84_geographic_geodesic_distance_with_method( q->lon, q->lat, c->lon, c->lat, index->method );
+
+	if( distance <= q->radius )
+	{
+		q->found++;
+		geo_index_heap_push( q, id, distance );
+	}
+}
+
+static void geo_index_query_tree( geo_index_query_t* q, size_t lo, size_t hi )
+{
+	const geo_index_t* index = q->index;
+
+	if( hi - lo <= GEO_INDEX_LEAF )
+	{
+		for( size_t i = lo; i < hi; i++ )
+		{
+			geo_index_query_point( q, index->tree[ i ], &index->tree_normals[ 3 * i ] );
+		}
+		return;
+	}
+
+	const size_t mid  = lo + (hi - lo) / 2;
+	const int    axis = index->tree_axes[ mid ];
+	const double diff = q->normal[ axis ] - index->tree_normals[ 3 * mid + axis ];
+
+	if( diff < 0.0 )
+	{
+		geo_index_query_tree( q, lo, mid );
+	}
+	else
+	{
+		geo_index_query_tree( q, mid + 1, hi );
+	}
+
+	geo_index_query_point( q, index->tree[ mid ], &index->tree_normals[ 3 * mid ] );
+
+	if( fabs( diff ) * GEO_INDEX_SCALE <= geo_index_query_bound( q ) )
+	{
+		if( diff < 0.0 )
+		{
+			geo_index_query_tree( q, mid + 1, hi );
+		}
+		else
+		{
+			geo_index_query_tree( q, lo, mid );
+		}
+	}
+}
+
+static size_t geo_index_query( geo_index_query_t* q )
+{
+	const geo_index_t* index = q->index;
+	const geo_coord_t center = { .lat = q->lat, .lon = q->lon, .alt = 0.0 };
+	geo_index_normal( &center, q->normal );
+
+	geo_index_query_tree( q, 0, index->tree_count );
+
+	/* Points inserted since the last rebuild */
+	for( size_t id = index->built; id < index->count; id++ )
+	{
+		geo_index_query_point( q, id, &index->normals[ 3 * id ] );
+	}
+
+	geo_index_heap_sort( q );
+	return q->size;
+}
+
+size_t geo_index_radius( const geo_index_t* index, double lon, double lat, double radius, size_t ids[], double distances[], size_t max_results )
+{
+	assert( index );
+	assert( (ids && distances) || max_results == 0 );
+	geo_index_query_t q = {
+		.index = index, .lon = lon, .lat = lat, .radius = radius,
+		.ids = ids, .distances = distances, .capacity = max_results,
+		.count_all = true,
+	};
+
+	geo_index_query( &q );
+	return q.found;
+}
+
+size_t geo_index_nearest( const geo_index_t* index, double lon, double lat, size_t k, size_t ids[], double distances[] )
+{
+	assert( index );
+	assert( (ids && distances) || k == 0 );
+	geo_index_query_t q = {
+		.index = index, .lon = lon, .lat = lat, .radius = INFINITY,
+		.ids = ids, .distances = distances, .capacity = k,
+		.count_all = false,
+	};
+
+	return geo_index_query( &q );
+}
@@ -0,0 +1,100 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _GEOGRAPHIC_INDEX_H_
+#define _GEOGRAPHIC_INDEX_H_
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "geographic.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Geographic Index
+ *
+ * A spatial index over WGS84 coordinates for radius and nearest neighbor
+ * queries. Points are kept in a k-d tree over the unit normals of the
+ * ellipsoid, and candidates are refined with the index's distance method,
+ * so the results are exactly what a brute force search with that method
+ * would return. Altitudes are stored but distances are along the surface.
+ *
+ * Points are identified by the order they were added in: the points given
+ * to geo_index_create get ids 0 to count - 1, and each insert gets the
+ * next id. Ids are never reused. Inserted points go to a small list that
+ * queries scan directly, and deleted points are skipped, until either grows
+ * enough for the tree to be rebuilt.
+ *
+ * The fields are private.
+ */
+typedef struct geo_index {
+	wgs84_distance_method_t method;
+
+	/* By id */
+	geo_coord_t* coords;
+	double*      normals; /* 3 per point */
+	bool*        alive;
+	size_t       count;
+	size_t       capacity;
+	size_t       live;
+
+	/* The tree holds the ids below built, in tree order. */
+	size_t*      tree;
+	double*      tree_normals; /* 3 per node */
+	uint8_t*     tree_axes;
+	size_t       tree_count;
+	size_t       tree_dead;
+	size_t       built;
+} geo_index_t;
+
+bool               geo_index_create  ( geo_index_t* index, const geo_coord_t coords[], size_t count, wgs84_distance_method_t method );
+void               geo_index_destroy ( geo_index_t* index );
+size_t             geo_index_count   ( const geo_index_t* index ); /* points not deleted */
+wgs84_distance_method_t geo_index_method( const geo_index_t* index );
+const geo_coord_t* geo_index_get     ( const geo_index_t* index, size_t id ); /* NULL if deleted */
+bool               geo_index_insert  ( geo_index_t* index, const geo_coord_t* coord, size_t* id );
+bool               geo_index_delete  ( geo_index_t* index, size_t id );
+
+/*
+ * Queries
+ *
+ * geo_index_radius finds the points within radius meters of (lon, lat) and
+ * returns how many there are. The nearest max_results of them are written
+ * to ids and distances in order of distance, so a caller can retry with a
+ * larger buffer when the count is larger than max_results.
+ *
+ * geo_index_nearest writes the k nearest points in order of distance and
+ * returns how many it wrote, which is less than k only when the index has
+ * fewer than k points.
+ *
+ * The ids and distances arrays must have room for max_results or k entries.
+ */
+size_t geo_index_radius  ( const geo_index_t* index, double lon, double lat, double radius, size_t ids[], double distances[], size_t max_results );
+size_t geo_index_nearest ( const geo_index_t* index, double lon, double lat, size_t k, size_t ids[], double distances[] );
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _GEOGRAPHIC_INDEX_H_ */
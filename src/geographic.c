@@ -19,12 +19,15 @@
  * THE SOFTWARE.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <float.h>
 #include <math.h>
 #include <assert.h>
 #include "mathematics.h"
 #include "geographic.h"
+#include "batch-math.h"
 
 #define DEGREES_TO_RADIANS(degs)     ((degs) * M_PI / 180.0)
 #define RADIANS_TO_DEGREES(rads)     ((rads) * 180.0 / M_PI)
@@ -41,31 +44,405 @@ void wgs84_geographic_to_cartesian( double lon, double lat, double alt, double*
 	*z = ((1.0 - WGS84_ECCENTRICITY_SQUARED) * N + alt) * sin( lat_rads );
 }
 
+/*
+ * Iterates on the latitude from the reduced spherical guess. The altitude
+ * is taken as p cos(lat) + z sin(lat) - a^2 / N, which unlike p / cos(lat) - N
+ * stays exact at the poles. Convergence is linear with a factor of about e^2,
+ * so GEOGRAPHIC_MAX_ITERATIONS bounds the loop when epsilon is too tight to
+ * be met in double precision.
+ */
+#define GEOGRAPHIC_MAX_ITERATIONS    (16)
+
 void wgs84_cartesian_to_geographic_with_epsilon( double x, double y, double z, double* lon, double* lat, double* alt, double epsilon )
 {
 	double p = sqrt( x * x + y * y );
-	*lon = RADIANS_TO_DEGREES( atan( y / x ) );
+	*lon = RADIANS_TO_DEGREES( atan2( y, x ) );
 
 	// initial value
-	double lat_i = atan( z / ((1.0 - WGS84_ECCENTRICITY_SQUARED) * p ) );
+	double lat_i = atan2( z, (1.0 - WGS84_ECCENTRICITY_SQUARED) * p );
 	double alt_i = 0.0;
+	int iterations = 0;
 
 	do {
 		*lat = lat_i;
 		*alt = alt_i;
 
-		double N_i = WGS84_SEMI_MAJOR_AXIS / sqrt( 1.0 - WGS84_ECCENTRICITY_SQUARED * sin( lat_i ) * sin( lat_i ) );
-		double alt_i = (p / cos(lat_i)) - N_i;
+		double sin_lat = sin( lat_i );
+		double N_i = WGS84_SEMI_MAJOR_AXIS / sqrt( 1.0 - WGS84_ECCENTRICITY_SQUARED * sin_lat * sin_lat );
+		alt_i = p * cos( lat_i ) + z * sin_lat - WGS84_SEMI_MAJOR_AXIS * WGS84_SEMI_MAJOR_AXIS / N_i;
 
-		lat_i = atan( z / ((1.0 - WGS84_ECCENTRICITY_SQUARED * (N_i / (N_i + alt_i))) * p));
+		lat_i = atan2( z, (1.0 - WGS84_ECCENTRICITY_SQUARED * (N_i / (N_i + alt_i))) * p );
 
-	} while( fabs(*lat - lat_i) > epsilon &&
-	         fabs(*alt - alt_i) > epsilon );
+	} while( (fabs(*lat - lat_i) > epsilon || fabs(*alt - alt_i) > epsilon * WGS84_SEMI_MAJOR_AXIS) &&
+	         ++iterations < GEOGRAPHIC_MAX_ITERATIONS );
 
 	*lat = RADIANS_TO_DEGREES( lat_i );
 	*alt = alt_i;
 }
 
+/*
+ * Bowring's method (1976) with two fixed iterations on the parametric
+ * latitude. Each iteration only needs a square root and a division, and
+ * the altitude formula holds at the poles.
+ */
+/* From tan(beta) = n / d, finds tan(lat) = num / den and the next beta,
+ * where tan(beta) = (b / a) tan(lat). */
+BATCH_INLINE void bowring_iteration( double z, double p, double* n, double* d, double* num, double* den )
+{
+	const double a   = WGS84_SEMI_MAJOR_AXIS;
+	const double b   = WGS84_SEMI_MINOR_AXIS;
+	const double e2  = WGS84_ECCENTRICITY_SQUARED;
+	const double ep2 = WGS84_ECCENTRICITY_SQUARED / (1.0 - WGS84_ECCENTRICITY_SQUARED);
+
+	const double s = batch_inverse_length( *n * *n + *d * *d );
+	const double sin_beta = *n * s;
+	const double cos_beta = s != 0.0 ? *d * s : 1.0;
+
+	*num = z + ep2 * b * sin_beta * sin_beta * sin_beta;
+	*den = p - e2 * a * cos_beta * cos_beta * cos_beta;
+	*n   = b * *num;
+	*d   = a * *den;
+}
+
+/* Finds tan(lat) = num / den and the altitude for a point at distance p
+ * from the polar axis. */
+BATCH_INLINE double bowring_geodetic( double z, double p, double* num, double* den )
+{
+	const double a   = WGS84_SEMI_MAJOR_AXIS;
+	const double b   = WGS84_SEMI_MINOR_AXIS;
+	const double e2  = WGS84_ECCENTRICITY_SQUARED;
+
+	/* Initial parametric latitude, tan(beta) = a z / (b p) */
+	double n = a * z;
+	double d = b * p;
+
+	/* Two iterations, written out so that the loop stays flat. */
+	bowring_iteration( z, p, &n, &d, num, den );
+	bowring_iteration( z, p, &n, &d, num, den );
+
+	const double s = batch_inverse_length( *num * *num + *den * *den );
+	const double sin_lat = *num * s;
+	const double cos_lat = s != 0.0 ? *den * s : 1.0;
+
+	return p * cos_lat + z * sin_lat - a * sqrt( 1.0 - e2 * sin_lat * sin_lat );
+}
+
+void wgs84_cartesian_to_geographic_bowring( double x, double y, double z, double* lon, double* lat, double* alt )
+{
+	double num, den;
+	*alt = bowring_geodetic( z, sqrt( x * x + y * y ), &num, &den );
+	*lon = RADIANS_TO_DEGREES( atan2( y, x ) );
+	*lat = RADIANS_TO_DEGREES( atan2( num, den ) );
+}
+
+/*
+ * Vermeille's closed form (2002). It solves the quartic for the distance
+ * along the normal directly, so it has no iterations at all, but needs a
+ * cube root. The formulas break down inside the evolute of the ellipse,
+ * within about 43 km of the center of the earth.
+ */
+void wgs84_cartesian_to_geographic_vermeille( double x, double y, double z, double* lon, double* lat, double* alt )
+{
+	const double a2 = WGS84_SEMI_MAJOR_AXIS * WGS84_SEMI_MAJOR_AXIS;
+	const double e2 = WGS84_ECCENTRICITY_SQUARED;
+	const double e4 = e2 * e2;
+
+	const double w2 = x * x + y * y;
+	const double p  = w2 / a2;
+	const double q  = (1.0 - e2) * z * z / a2;
+	const double r  = (p + q - e4) / 6.0;
+	const double s  = e4 * p * q / (4.0 * r * r * r);
+	const double t  = cbrt( 1.0 + s + sqrt( s * (2.0 + s) ) );
+	const double u  = r * (1.0 + t + 1.0 / t);
+	const double v  = sqrt( u * u + e4 * q );
+	const double w  = e2 * (u + v - q) / (2.0 * v);
+	const double k  = sqrt( u + v + w * w ) - w;
+	const double D  = k * sqrt( w2 ) / (k + e2);
+	const double Dz = sqrt( D * D + z * z );
+
+	*lon = RADIANS_TO_DEGREES( atan2( y, x ) );
+	*lat = RADIANS_TO_DEGREES( 2.0 * atan2( z, D + Dz ) );
+	*alt = (k + e2 - 1.0) / k * Dz;
+}
+
+void wgs84_cartesian_to_geographic_with_method( double x, double y, double z, double* lon, double* lat, double* alt, wgs84_geodetic_method_t method )
+{
+	switch( method )
+	{
+		case WGS84_GEODETIC_BOWRING:
+			wgs84_cartesian_to_geographic_bowring( x, y, z, lon, lat, alt );
+			break;
+		case WGS84_GEODETIC_VERMEILLE:
+			wgs84_cartesian_to_geographic_vermeille( x, y, z, lon, lat, alt );
+			break;
+		case WGS84_GEODETIC_ITERATIVE:
+		default:
+			wgs84_cartesian_to_geographic_with_epsilon( x, y, z, lon, lat, alt, DBL_EPSILON );
+			break;
+	}
+}
+
+/*
+ * Batch Conversions
+ *
+ * The kernels work on blocks of BATCH_BLOCK points so that they vectorize,
+ * with a padded block for the remainder. Arrays with at least
+ * GEOGRAPHIC_PARALLEL_COUNT points are split across threads with OpenMP.
+ */
+#define GEOGRAPHIC_PARALLEL_COUNT    (1 << 16)
+
+BATCH_INLINE void geographic_to_cartesian_point( double lon, double lat, double alt, double* x, double* y, double* z )
+{
+	double sin_lat, cos_lat, sin_lon, cos_lon;
+	batch_sincos_degrees( lat, &sin_lat, &cos_lat );
+	batch_sincos_degrees( lon, &sin_lon, &cos_lon );
+
+	const double N = WGS84_SEMI_MAJOR_AXIS / sqrt( 1.0 - WGS84_ECCENTRICITY_SQUARED * sin_lat * sin_lat );
+
+	*x = (N + alt) * cos_lat * cos_lon;
+	*y = (N + alt) * cos_lat * sin_lon;
+	*z = ((1.0 - WGS84_ECCENTRICITY_SQUARED) * N + alt) * sin_lat;
+}
+
+BATCH_INLINE void cartesian_to_geographic_point( double x, double y, double z, double* lon, double* lat, double* alt )
+{
+	double num, den;
+	*alt = bowring_geodetic( z, sqrt( x * x + y * y ), &num, &den );
+	*lon = batch_atan2( y, x ) * (180.0 / BATCH_PI);
+	*lat = batch_atan2( num, den ) * (180.0 / BATCH_PI);
+}
+
+static inline void geographic_to_cartesian_block( const void* restrict context, const double* restrict lon, const double* restrict lat, const double* restrict alt, double* restrict x, double* restrict y, double* restrict z )
+{
+	(void) context;
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		geographic_to_cartesian_point( lon[ i ], lat[ i ], alt[ i ], &x[ i ], &y[ i ], &z[ i ] );
+	}
+}
+
+static inline void cartesian_to_geographic_block( const void* restrict context, const double* restrict x, const double* restrict y, const double* restrict z, double* restrict lon, double* restrict lat, double* restrict alt )
+{
+	(void) context;
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		cartesian_to_geographic_point( x[ i ], y[ i ], z[ i ], &lon[ i ], &lat[ i ], &alt[ i ] );
+	}
+}
+
+/* Runs a block kernel over count points, padding the remainder. The
+ * context is passed to the kernel as is. */
+typedef void (*geographic_block_t)( const void* restrict, const double* restrict, const double* restrict, const double* restrict, double* restrict, double* restrict, double* restrict );
+
+static void geographic_batch( geographic_block_t kernel, const void* context, const double* a, const double* b, const double* c, double* r0, double* r1, double* r2, size_t count )
+{
+	const size_t blocks = count / BATCH_BLOCK;
+	const size_t rest   = count % BATCH_BLOCK;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( count >= GEOGRAPHIC_PARALLEL_COUNT )
+	#endif
+	for( size_t k = 0; k < blocks; k++ )
+	{
+		const size_t i = k * BATCH_BLOCK;
+		kernel( context, a + i, b + i, c + i, r0 + i, r1 + i, r2 + i );
+	}
+
+	if( rest > 0 )
+	{
+		const size_t i = blocks * BATCH_BLOCK;
+		double in[ 3 ][ BATCH_BLOCK ] = { { 0 } };
+		double out[ 3 ][ BATCH_BLOCK ];
+
+		memcpy( in[ 0 ], a + i, rest * sizeof(double) );
+		memcpy( in[ 1 ], b + i, rest * sizeof(double) );
+		memcpy( in[ 2 ], c + i, rest * sizeof(double) );
+		kernel( context, in[ 0 ], in[ 1 ], in[ 2 ], out[ 0 ], out[ 1 ], out[ 2 ] );
+		memcpy( r0 + i, out[ 0 ], rest * sizeof(double) );
+		memcpy( r1 + i, out[ 1 ], rest * sizeof(double) );
+		memcpy( r2 + i, out[ 2 ], rest * sizeof(double) );
+	}
+}
+
+void wgs84_geographic_to_cartesian_array( const double lon[], const double lat[], const double alt[], double x[], double y[], double z[], size_t count )
+{
+	geographic_batch( geographic_to_cartesian_block, NULL, lon, lat, alt, x, y, z, count );
+}
+
+void wgs84_cartesian_to_geographic_array( const double x[], const double y[], const double z[], double lon[], double lat[], double alt[], size_t count )
+{
+	geographic_batch( cartesian_to_geographic_block, NULL, x, y, z, lon, lat, alt, count );
+}
+
+/*
+ * Local Tangent Frames
+ *
+ * local = R (ecef - origin) and ecef = origin + R^T local, where the rows
+ * of R are the local axes.
+ */
+void geo_frame_init( geo_frame_t* frame, double lon, double lat, double alt, geo_frame_axes_t axes )
+{
+	assert( frame );
+	const double sin_lat = sin( DEGREES_TO_RADIANS(lat) );
+	const double cos_lat = cos( DEGREES_TO_RADIANS(lat) );
+	const double sin_lon = sin( DEGREES_TO_RADIANS(lon) );
+	const double cos_lon = cos( DEGREES_TO_RADIANS(lon) );
+
+	const double east[ 3 ]  = { -sin_lon, cos_lon, 0.0 };
+	const double north[ 3 ] = { -sin_lat * cos_lon, -sin_lat * sin_lon, cos_lat };
+	const double up[ 3 ]    = { cos_lat * cos_lon, cos_lat * sin_lon, sin_lat };
+
+	frame->axes = axes;
+	wgs84_geographic_to_cartesian( lon, lat, alt, &frame->origin[ 0 ], &frame->origin[ 1 ], &frame->origin[ 2 ] );
+
+	for( int j = 0; j < 3; j++ )
+	{
+		switch( axes )
+		{
+			case GEO_FRAME_NED:
+				frame->rotation[ 0 + j ] = north[ j ];
+				frame->rotation[ 3 + j ] = east[ j ];
+				frame->rotation[ 6 + j ] = -up[ j ];
+				break;
+			case GEO_FRAME_ENU:
+			default:
+				frame->rotation[ 0 + j ] = east[ j ];
+				frame->rotation[ 3 + j ] = north[ j ];
+				frame->rotation[ 6 + j ] = up[ j ];
+				break;
+		}
+	}
+}
+
+mat3_t geo_frame_rotation( const geo_frame_t* frame )
+{
+	const double* R = frame->rotation;
+
+	/* mat3_t is stored by columns. */
+	return MAT3( R[ 0 ], R[ 3 ], R[ 6 ],
+	             R[ 1 ], R[ 4 ], R[ 7 ],
+	             R[ 2 ], R[ 5 ], R[ 8 ] );
+}
+
+BATCH_INLINE void frame_from_cartesian_point( const double* restrict R, const double* restrict o, double x, double y, double z, double* lx, double* ly, double* lz )
+{
+	const double dx = x - o[ 0 ];
+	const double dy = y - o[ 1 ];
+	const double dz = z - o[ 2 ];
+	*lx = R[ 0 ] * dx + R[ 1 ] * dy + R[ 2 ] * dz;
+	*ly = R[ 3 ] * dx + R[ 4 ] * dy + R[ 5 ] * dz;
+	*lz = R[ 6 ] * dx + R[ 7 ] * dy + R[ 8 ] * dz;
+}
+
+BATCH_INLINE void frame_to_cartesian_point( const double* restrict R, const double* restrict o, double lx, double ly, double lz, double* x, double* y, double* z )
+{
+	*x = o[ 0 ] + R[ 0 ] * lx + R[ 3 ] * ly + R[ 6 ] * lz;
+	*y = o[ 1 ] + R[ 1 ] * lx + R[ 4 ] * ly + R[ 7 ] * lz;
+	*z = o[ 2 ] + R[ 2 ] * lx + R[ 5 ] * ly + R[ 8 ] * lz;
+}
+
+void geo_frame_from_cartesian( const geo_frame_t* frame, double x, double y, double z, double* local_x, double* local_y, double* local_z )
+{
+	frame_from_cartesian_point( frame->rotation, frame->origin, x, y, z, local_x, local_y, local_z );
+}
+
+void geo_frame_to_cartesian( const geo_frame_t* frame, double local_x, double local_y, double local_z, double* x, double* y, double* z )
+{
+	frame_to_cartesian_point( frame->rotation, frame->origin, local_x, local_y, local_z, x, y, z );
+}
+
+void geo_frame_from_geographic( const geo_frame_t* frame, double lon, double lat, double alt, double* local_x, double* local_y, double* local_z )
+{
+	double x, y, z;
+	wgs84_geographic_to_cartesian( lon, lat, alt, &x, &y, &z );
+	frame_from_cartesian_point( frame->rotation, frame->origin, x, y, z, local_x, local_y, local_z );
+}
+
+void geo_frame_to_geographic( const geo_frame_t* frame, double local_x, double local_y, double local_z, double* lon, double* lat, double* alt )
+{
+	double x, y, z;
+	frame_to_cartesian_point( frame->rotation, frame->origin, local_x, local_y, local_z, &x, &y, &z );
+	wgs84_cartesian_to_geographic_bowring( x, y, z, lon, lat, alt );
+}
+
+/* The frame kernels copy the rotation and origin to locals, so the
+ * compiler knows the outputs do not change them. */
+static inline void frame_from_cartesian_block( const void* restrict context, const double* restrict x, const double* restrict y, const double* restrict z, double* restrict lx, double* restrict ly, double* restrict lz )
+{
+	const geo_frame_t* frame = context;
+	double R[ 9 ], o[ 3 ];
+	memcpy( R, frame->rotation, sizeof(R) );
+	memcpy( o, frame->origin, sizeof(o) );
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		frame_from_cartesian_point( R, o, x[ i ], y[ i ], z[ i ], &lx[ i ], &ly[ i ], &lz[ i ] );
+	}
+}
+
+static inline void frame_to_cartesian_block( const void* restrict context, const double* restrict lx, const double* restrict ly, const double* restrict lz, double* restrict x, double* restrict y, double* restrict z )
+{
+	const geo_frame_t* frame = context;
+	double R[ 9 ], o[ 3 ];
+	memcpy( R, frame->rotation, sizeof(R) );
+	memcpy( o, frame->origin, sizeof(o) );
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		frame_to_cartesian_point( R, o, lx[ i ], ly[ i ], lz[ i ], &x[ i ], &y[ i ], &z[ i ] );
+	}
+}
+
+static inline void frame_from_geographic_block( const void* restrict context, const double* restrict lon, const double* restrict lat, const double* restrict alt, double* restrict lx, double* restrict ly, double* restrict lz )
+{
+	const geo_frame_t* frame = context;
+	double R[ 9 ], o[ 3 ];
+	memcpy( R, frame->rotation, sizeof(R) );
+	memcpy( o, frame->origin, sizeof(o) );
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		double x, y, z;
+		geographic_to_cartesian_point( lon[ i ], lat[ i ], alt[ i ], &x, &y, &z );
+		frame_from_cartesian_point( R, o, x, y, z, &lx[ i ], &ly[ i ], &lz[ i ] );
+	}
+}
+
+static inline void frame_to_geographic_block( const void* restrict context, const double* restrict lx, const double* restrict ly, const double* restrict lz, double* restrict lon, double* restrict lat, double* restrict alt )
+{
+	const geo_frame_t* frame = context;
+	double R[ 9 ], o[ 3 ];
+	memcpy( R, frame->rotation, sizeof(R) );
+	memcpy( o, frame->origin, sizeof(o) );
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		double x, y, z;
+		frame_to_cartesian_point( R, o, lx[ i ], ly[ i ], lz[ i ], &x, &y, &z );
+		cartesian_to_geographic_point( x, y, z, &lon[ i ], &lat[ i ], &alt[ i ] );
+	}
+}
+
+void geo_frame_from_cartesian_array( const geo_frame_t* frame, const double x[], const double y[], const double z[], double local_x[], double local_y[], double local_z[], size_t count )
+{
+	geographic_batch( frame_from_cartesian_block, frame, x, y, z, local_x, local_y, local_z, count );
+}
+
+void geo_frame_to_cartesian_array( const geo_frame_t* frame, const double local_x[], const double local_y[], const double local_z[], double x[], double y[], double z[], size_t count )
+{
+	geographic_batch( frame_to_cartesian_block, frame, local_x, local_y, local_z, x, y, z, count );
+}
+
+void geo_frame_from_geographic_array( const geo_frame_t* frame, const double lon[], const double lat[], const double alt[], double local_x[], double local_y[], double local_z[], size_t count )
+{
+	geographic_batch( frame_from_geographic_block, frame, lon, lat, alt, local_x, local_y, local_z, count );
+}
+
+void geo_frame_to_geographic_array( const geo_frame_t* frame, const double local_x[], const double local_y[], const double local_z[], double lon[], double lat[], double alt[], size_t count )
+{
+	geographic_batch( frame_to_geographic_block, frame, local_x, local_y, local_z, lon, lat, alt, count );
+}
+
 void wgs84_geographic_to_mercator( double lon, double lat, double central_meridian, double* x, double* y )
 {
 	lat = m3d_clampd( lat, -89.5, 89.5 );
@@ -80,58 +457,354 @@ void wgs84_mercator_to_geographic( double x, double y, double central_meridian,
 	*lat = RADIANS_TO_DEGREES(2.0 * atan( exp(y / WGS84_SEMI_MAJOR_AXIS) ) - M_PI_2);
 }
 
-double wgs84_geographic_geodesic_distance_vincenty( double lon1, double lat1, double lon2, double lat2 )
+/*
+ * Vincenty's inverse method (1975) on the auxiliary sphere. The helpers
+ * take the sine and cosine of lambda from the caller, so the scalar
+ * function can use the C library while the batch kernel uses batch-math.h.
+ */
+#define VINCENTY_MAX_ITERATIONS      (32)
+#define VINCENTY_EPSILON             (1e-12)
+/* Below this sin(sigma), the bisection has reached the degenerate root
+ * at lambda = pi. */
+#define VINCENTY_DEGENERATE          (1e-9)
+
+/* Returns sin(sigma) and the cosine of the arc between the points. */
+BATCH_INLINE double vincenty_sigma( double sin_lambda, double cos_lambda, double sin_u1, double cos_u1, double sin_u2, double cos_u2, double* cos_sigma )
 {
-	double lon1_rads = DEGREES_TO_RADIANS(lon1);
-	double lat1_rads = DEGREES_TO_RADIANS(lat1);
-	double lon2_rads = DEGREES_TO_RADIANS(lon2);
-	double lat2_rads = DEGREES_TO_RADIANS(lat2);
+	const double t = cos_u1 * sin_u2 - sin_u1 * cos_u2 * cos_lambda;
+	*cos_sigma = sin_u1 * sin_u2 + cos_u1 * cos_u2 * cos_lambda;
+	return sqrt( (cos_u2 * sin_lambda) * (cos_u2 * sin_lambda) + t * t );
+}
+
+/* Returns lambda - L for the current lambda. Along the equator cos^2(alpha)
+ * is zero and cos(2 sigma_m) is taken as zero, as Vincenty does. */
+BATCH_INLINE double vincenty_correction( double sin_lambda, double sin_sigma, double cos_sigma, double sigma, double sin_u1, double cos_u1, double sin_u2, double cos_u2, double* cos_sqrd_alpha, double* cos_2_sigma_m )
+{
+	const double f = WGS84_FLATTENING_FACTOR;
+	const double sin_alpha = sin_sigma != 0.0 ? cos_u1 * cos_u2 * sin_lambda / sin_sigma : 0.0;
+	const double ca2 = 1.0 - sin_alpha * sin_alpha;
+	const double c2m = ca2 != 0.0 ? cos_sigma - 2.0 * sin_u1 * sin_u2 / ca2 : 0.0;
+	const double C = f / 16.0 * ca2 * (4.0 + f * (4.0 - 3.0 * ca2));
+
+	*cos_sqrd_alpha = ca2;
+	*cos_2_sigma_m  = c2m;
+	return (1.0 - C) * f * sin_alpha * (sigma + C * sin_sigma * (c2m + C * cos_sigma * (-1.0 + 2.0 * c2m * c2m)));
+}
+
+BATCH_INLINE double vincenty_distance( double sin_sigma, double cos_sigma, double sigma, double cos_sqrd_alpha, double cos_2_sigma_m )
+{
+	const double a = WGS84_SEMI_MAJOR_AXIS;
+	const double b = WGS84_SEMI_MINOR_AXIS;
+	const double c2m = cos_2_sigma_m;
+
+	const double u_sqrd = cos_sqrd_alpha * (a * a - b * b) / (b * b);
+	const double A = 1 + u_sqrd / 16384 * (4096 + u_sqrd * (-768 + u_sqrd * (320 - 175 * u_sqrd)));
+	const double B = u_sqrd / 1024 * (256 + u_sqrd * (-128 + u_sqrd * (74 - 47 * u_sqrd)));
+	const double delta_sigma = B * sin_sigma * (c2m + B / 4 * (cos_sigma * (-1 + 2 * c2m * c2m) -
+	                           B / 6 * c2m * (-3 + 4 * sin_sigma * sin_sigma) * (-3 + 4 * c2m * c2m)));
+
+	return b * A * (sigma - delta_sigma);
+}
 
-	double L = lon2_rads - lon1_rads;
-	double tan_u1 = (1 - WGS84_FLATTENING_FACTOR) * tan(lat1_rads);
-	double cos_u1 = 1 / sqrt(1 + tan_u1 * tan_u1);
-   	double sin_u1 = tan_u1 * cos_u1;
-	double tan_u2 = (1 - WGS84_FLATTENING_FACTOR) * tan(lat2_rads);
-	double cos_u2 = 1 / sqrt(1 + tan_u2 * tan_u2);
-   	double sin_u2 = tan_u2 * cos_u2;
+/* sin(u) and cos(u) of the reduced latitude, tan(u) = (1 - f) tan(lat). */
+BATCH_INLINE void vincenty_reduced_latitude( double sin_lat, double cos_lat, double* sin_u, double* cos_u )
+{
+	const double n = (1.0 - WGS84_FLATTENING_FACTOR) * sin_lat;
+	const double s = batch_inverse_length( n * n + cos_lat * cos_lat );
+	*sin_u = n * s;
+	*cos_u = cos_lat * s;
+}
 
-	double sin_phi, cos_phi, phi, cos_alpha_sqrd, cos_2_phi_sub_m;
+/* Longitude difference in radians, in [-pi, pi]. */
+BATCH_INLINE double vincenty_longitude_difference( double lon1, double lon2 )
+{
+	const double d = lon2 - lon1;
+	return (d - 360.0 * batch_round( d * (1.0 / 360.0) )) * (BATCH_PI / 180.0);
+}
 
+/*
+ * Fallback for pairs where the iteration on lambda does not converge,
+ * which happens for nearly antipodal points. The next lambda minus lambda
+ * goes from positive at |L| to negative at pi, so bisection, which keeps
+ * lo where it is positive and hi where it is not, always finds a root. When that root is lambda = pi with sin(sigma) = 0, the points
+ * are symmetric about the equator and sin(alpha) is found from
+ * pi - |L| = (1 - C) f sin(alpha) pi instead.
+ */
+static double vincenty_antipodal( double L, double sin_u1, double cos_u1, double sin_u2, double cos_u2 )
+{
+	const double sign = L < 0.0 ? -1.0 : 1.0;
+	double lo = fabs( L );
+	double hi = M_PI;
+	double sin_sigma = 0.0, cos_sigma = 0.0, sigma = 0.0, ca2 = 0.0, c2m = 0.0;
+
+	for( int i = 0; i < 64; i++ )
+	{
+		const double lambda = 0.5 * (lo + hi);
+		const double sin_lambda = sign * sin( lambda );
+		sin_sigma = vincenty_sigma( sin_lambda, cos( lambda ), sin_u1, cos_u1, sin_u2, cos_u2, &cos_sigma );
+		sigma = atan2( sin_sigma, cos_sigma );
+		const double next = fabs( L + vincenty_correction( sin_lambda, sin_sigma, cos_sigma, sigma, sin_u1, cos_u1, sin_u2, cos_u2, &ca2, &c2m ) );
+
+		if( next > lambda )
+		{
+			lo = lambda;
+		}
+		else
+		{
+			hi = lambda;
+		}
+	}
+
+	if( sin_sigma > VINCENTY_DEGENERATE )
+	{
+		return vincenty_distance( sin_sigma, cos_sigma, sigma, ca2, c2m );
+	}
+
+	const double f = WGS84_FLATTENING_FACTOR;
+	double sin_alpha = 0.0;
+	for( int i = 0; i < 8; i++ )
+	{
+		ca2 = 1.0 - sin_alpha * sin_alpha;
+		const double C = f / 16.0 * ca2 * (4.0 + f * (4.0 - 3.0 * ca2));
+		sin_alpha = m3d_clampd( (M_PI - fabs( L )) / ((1.0 - C) * f * M_PI), 0.0, 1.0 );
+	}
+	ca2 = 1.0 - sin_alpha * sin_alpha;
+
+	return vincenty_distance( 0.0, -1.0, M_PI, ca2, -1.0 );
+}
+
+double wgs84_geographic_geodesic_distance_vincenty( double lon1, double lat1, double lon2, double lat2 )
+{
+	double sin_u1, cos_u1, sin_u2, cos_u2;
+	vincenty_reduced_latitude( sin( DEGREES_TO_RADIANS(lat1) ), cos( DEGREES_TO_RADIANS(lat1) ), &sin_u1, &cos_u1 );
+	vincenty_reduced_latitude( sin( DEGREES_TO_RADIANS(lat2) ), cos( DEGREES_TO_RADIANS(lat2) ), &sin_u2, &cos_u2 );
+
+	double L = vincenty_longitude_difference( lon1, lon2 );
 	double lambda = L;
-	double lambda_prime;
-	int iterations = 0;
+	double sin_sigma, cos_sigma, sigma, cos_sqrd_alpha, cos_2_sigma_m;
+	bool converged = false;
 
-	do {
+	for( int iterations = 0; !converged && iterations < VINCENTY_MAX_ITERATIONS; iterations++ )
+	{
 		double sin_lambda = sin(lambda);
-		double cos_lambda = cos(lambda);
-		double sin_phi = sqrt( (cos_u2 * sin_lambda) * (cos_u2 * sin_lambda) + (cos_u1 * sin_u2 - sin_u1 * cos_u2 * cos_lambda) * (cos_u1 * sin_u2 - sin_u1 * cos_u2 * cos_lambda) );
-		if (sin_phi == 0) return 0;  // co-incident points
-		cos_phi = sin_u1 * sin_u2 + cos_u1 * cos_u2 * cos_lambda;
-		phi = atan2(sin_phi, cos_phi);
-		double sin_alpha = cos_u1 * cos_u2 * sin_lambda / sin_phi;
-		cos_alpha_sqrd = 1 - sin_alpha * sin_alpha;
-		cos_2_phi_sub_m = cos_phi - 2 * sin_u1 * sin_u2 / cos_alpha_sqrd;
-
-		assert( isnan(cos_2_phi_sub_m) != 0 ); // TODO: Can this happen equatorial line: cos_alpha_sqrd=0 (§6)
-
-		double C = WGS84_FLATTENING_FACTOR / 16 * cos_alpha_sqrd * (4 + WGS84_FLATTENING_FACTOR * (4 - 3 * cos_alpha_sqrd));
-		lambda_prime = lambda;
-		lambda = L + (1 - C) * WGS84_FLATTENING_FACTOR * sin_alpha * (phi + C * sin_phi * (cos_2_phi_sub_m + C * cos_phi * (-1 + 2 * cos_2_phi_sub_m * cos_2_phi_sub_m)));
-
-		if( fabs(lambda) > M_PI )
+		sin_sigma = vincenty_sigma( sin_lambda, cos(lambda), sin_u1, cos_u1, sin_u2, cos_u2, &cos_sigma );
+		sigma = atan2( sin_sigma, cos_sigma );
+
+		double lambda_prime = lambda;
+		lambda = L + vincenty_correction( sin_lambda, sin_sigma, cos_sigma, sigma, sin_u1, cos_u1, sin_u2, cos_u2, &cos_sqrd_alpha, &cos_2_sigma_m );
+		converged = fabs(lambda - lambda_prime) <= VINCENTY_EPSILON;
+	}
+
+	if( !converged || fabs(lambda) > M_PI + VINCENTY_EPSILON )
+	{
+		return vincenty_antipodal( L, sin_u1, cos_u1, sin_u2, cos_u2 );
+	}
+
+	return vincenty_distance( sin_sigma, cos_sigma, sigma, cos_sqrd_alpha, cos_2_sigma_m );
+}
+
+/*
+ * Batch Distances
+ *
+ * The kernel iterates all lanes of a block together, freezing each lane
+ * once it converges, and stops when every lane has. The lanes that are
+ * still moving after VINCENTY_MAX_ITERATIONS are finished one at a time
+ * by vincenty_antipodal. Matrices with at least GEOGRAPHIC_PARALLEL_COUNT
+ * entries have their rows split across threads with OpenMP.
+ */
+static inline void vincenty_reduced_latitude_block( const double* restrict lat, double* restrict sin_u, double* restrict cos_u )
+{
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		double sin_lat, cos_lat;
+		batch_sincos_degrees( lat[ i ], &sin_lat, &cos_lat );
+		vincenty_reduced_latitude( sin_lat, cos_lat, &sin_u[ i ], &cos_u[ i ] );
+	}
+}
+
+static void vincenty_block( const double* restrict L, const double* restrict sin_u1, const double* restrict cos_u1, const double* restrict sin_u2, const double* restrict cos_u2, double* restrict distances )
+{
+	double lambda[ BATCH_BLOCK ];
+	double sin_sigma[ BATCH_BLOCK ], cos_sigma[ BATCH_BLOCK ], sigma[ BATCH_BLOCK ];
+	double cos_sqrd_alpha[ BATCH_BLOCK ], cos_2_sigma_m[ BATCH_BLOCK ];
+	double converged[ BATCH_BLOCK ];
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		lambda[ i ]    = L[ i ];
+		converged[ i ] = 0.0;
+	}
+
+	for( int iterations = 0; iterations < VINCENTY_MAX_ITERATIONS; iterations++ )
+	{
+		double pending = 0.0;
+
+		for( size_t i = 0; i < BATCH_BLOCK; i++ )
+		{
+			double sin_lambda, cos_lambda, ss, cs, ca2, c2m;
+			batch_sincos_degrees( lambda[ i ] * (180.0 / BATCH_PI), &sin_lambda, &cos_lambda );
+			ss = vincenty_sigma( sin_lambda, cos_lambda, sin_u1[ i ], cos_u1[ i ], sin_u2[ i ], cos_u2[ i ], &cs );
+			const double s = batch_atan2( ss, cs );
+			const double next = L[ i ] + vincenty_correction( sin_lambda, ss, cs, s, sin_u1[ i ], cos_u1[ i ], sin_u2[ i ], cos_u2[ i ], &ca2, &c2m );
+
+			/* Converged lanes keep the terms they converged with. */
+			const bool active = converged[ i ] == 0.0;
+			sin_sigma[ i ]      = active ? ss : sin_sigma[ i ];
+			cos_sigma[ i ]      = active ? cs : cos_sigma[ i ];
+			sigma[ i ]          = active ? s : sigma[ i ];
+			cos_sqrd_alpha[ i ] = active ? ca2 : cos_sqrd_alpha[ i ];
+			cos_2_sigma_m[ i ]  = active ? c2m : cos_2_sigma_m[ i ];
+			converged[ i ]      = active && fabs( next - lambda[ i ] ) <= VINCENTY_EPSILON ? 1.0 : converged[ i ];
+			lambda[ i ]         = active ? next : lambda[ i ];
+			pending            += 1.0 - converged[ i ];
+		}
+
+		if( pending == 0.0 )
+		{
+			break;
+		}
+	}
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		distances[ i ] = vincenty_distance( sin_sigma[ i ], cos_sigma[ i ], sigma[ i ], cos_sqrd_alpha[ i ], cos_2_sigma_m[ i ] );
+	}
+
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		if( converged[ i ] == 0.0 || fabs( lambda[ i ] ) > M_PI + VINCENTY_EPSILON )
+		{
+			distances[ i ] = vincenty_antipodal( L[ i ], sin_u1[ i ], cos_u1[ i ], sin_u2[ i ], cos_u2[ i ] );
+		}
+	}
+}
+
+/* Copies n values into a zero padded block. */
+static inline const double* vincenty_pad( double block[ BATCH_BLOCK ], const double* values, size_t n )
+{
+	if( n == BATCH_BLOCK )
+	{
+		return values;
+	}
+	memset( block, 0, sizeof(double) * BATCH_BLOCK );
+	memcpy( block, values, n * sizeof(double) );
+	return block;
+}
+
+void wgs84_geographic_geodesic_distance_vincenty_pairs( const double lon1[], const double lat1[], const double lon2[], const double lat2[], double distances[], size_t count )
+{
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic, 16) if( count >= GEOGRAPHIC_PARALLEL_COUNT )
+	#endif
+	for( size_t i = 0; i < count; i += BATCH_BLOCK )
+	{
+		const size_t n = count - i < BATCH_BLOCK ? count - i : BATCH_BLOCK;
+		double pad[ 4 ][ BATCH_BLOCK ];
+		double L[ BATCH_BLOCK ], sin_u1[ BATCH_BLOCK ], cos_u1[ BATCH_BLOCK ], sin_u2[ BATCH_BLOCK ], cos_u2[ BATCH_BLOCK ];
+		double result[ BATCH_BLOCK ];
+
+		const double* lo1 = vincenty_pad( pad[ 0 ], lon1 + i, n );
+		const double* la1 = vincenty_pad( pad[ 1 ], lat1 + i, n );
+		const double* lo2 = vincenty_pad( pad[ 2 ], lon2 + i, n );
+		const double* la2 = vincenty_pad( pad[ 3 ], lat2 + i, n );
+
+		for( size_t k = 0; k < BATCH_BLOCK; k++ )
 		{
-			// TODO: antipodal points
+			L[ k ] = vincenty_longitude_difference( lo1[ k ], lo2[ k ] );
 		}
+		vincenty_reduced_latitude_block( la1, sin_u1, cos_u1 );
+		vincenty_reduced_latitude_block( la2, sin_u2, cos_u2 );
+
+		vincenty_block( L, sin_u1, cos_u1, sin_u2, cos_u2, result );
+		memcpy( distances + i, result, n * sizeof(double) );
+	}
+}
 
-	} while( fabs(lambda - lambda_prime) > SCALAR_EPSILON && ++iterations<200 );
+/* Distances from one point to count points. The reduced latitudes of the
+ * points are taken from sin_u and cos_u when they are given, and found
+ * from lats otherwise. */
+static void vincenty_one_to_many( double lon, double lat, const double lons[], const double lats[], const double sin_u[], const double cos_u[], double distances[], size_t count )
+{
+	double sin_u1[ BATCH_BLOCK ], cos_u1[ BATCH_BLOCK ];
+	double su, cu;
+	vincenty_reduced_latitude( sin( DEGREES_TO_RADIANS(lat) ), cos( DEGREES_TO_RADIANS(lat) ), &su, &cu );
+
+	for( size_t k = 0; k < BATCH_BLOCK; k++ )
+	{
+		sin_u1[ k ] = su;
+		cos_u1[ k ] = cu;
+	}
+
+	for( size_t i = 0; i < count; i += BATCH_BLOCK )
+	{
+		const size_t n = count - i < BATCH_BLOCK ? count - i : BATCH_BLOCK;
+		double pad[ 3 ][ BATCH_BLOCK ];
+		double L[ BATCH_BLOCK ], sin_u2[ BATCH_BLOCK ], cos_u2[ BATCH_BLOCK ], result[ BATCH_BLOCK ];
+		const double* su2 = sin_u2;
+		const double* cu2 = cos_u2;
+
+		const double* lo2 = vincenty_pad( pad[ 0 ], lons + i, n );
+		if( sin_u )
+		{
+			su2 = vincenty_pad( pad[ 1 ], sin_u + i, n );
+			cu2 = vincenty_pad( pad[ 2 ], cos_u + i, n );
+		}
+		else
+		{
+			vincenty_reduced_latitude_block( vincenty_pad( pad[ 1 ], lats + i, n ), sin_u2, cos_u2 );
+		}
 
-	double u_sqrd = cos_alpha_sqrd * (WGS84_SEMI_MAJOR_AXIS*WGS84_SEMI_MAJOR_AXIS - WGS84_SEMI_MINOR_AXIS*WGS84_SEMI_MINOR_AXIS) / (WGS84_SEMI_MINOR_AXIS*WGS84_SEMI_MINOR_AXIS);
-	double A = 1 + u_sqrd/16384*(4096+u_sqrd*(-768+u_sqrd*(320-175*u_sqrd)));
-	double B = u_sqrd/1024 * (256+u_sqrd*(-128+u_sqrd*(74-47*u_sqrd)));
-	double delta_phi = B*sin_phi*(cos_2_phi_sub_m+B/4*(cos_phi*(-1+2*cos_2_phi_sub_m*cos_2_phi_sub_m)-
-				B/6*cos_2_phi_sub_m*(-3+4*sin_phi*sin_phi)*(-3+4*cos_2_phi_sub_m*cos_2_phi_sub_m)));
+		for( size_t k = 0; k < BATCH_BLOCK; k++ )
+		{
+			L[ k ] = vincenty_longitude_difference( lon, lo2[ k ] );
+		}
 
-	return WGS84_SEMI_MINOR_AXIS * A * (phi - delta_phi);
+		vincenty_block( L, sin_u1, cos_u1, su2, cu2, result );
+		memcpy( distances + i, result, n * sizeof(double) );
+	}
+}
+
+void wgs84_geographic_geodesic_distance_vincenty_one_to_many( double lon, double lat, const double lons[], const double lats[], double distances[], size_t count )
+{
+	vincenty_one_to_many( lon, lat, lons, lats, NULL, NULL, distances, count );
+}
+
+bool wgs84_geographic_geodesic_distance_vincenty_matrix( const double lons1[], const double lats1[], size_t rows, const double lons2[], const double lats2[], size_t columns, double distances[] )
+{
+	if( columns == 0 )
+	{
+		return true;
+	}
+
+	/* The reduced latitudes of the columns are shared by every row. */
+	double* sin_u = malloc( 2 * columns * sizeof(double) );
+	if( !sin_u )
+	{
+		return false;
+	}
+	double* cos_u = sin_u + columns;
+
+	for( size_t i = 0; i < columns; i += BATCH_BLOCK )
+	{
+		const size_t n = columns - i < BATCH_BLOCK ? columns - i : BATCH_BLOCK;
+		double pad[ BATCH_BLOCK ];
+		double su[ BATCH_BLOCK ], cu[ BATCH_BLOCK ];
+
+		vincenty_reduced_latitude_block( vincenty_pad( pad, lats2 + i, n ), su, cu );
+		memcpy( sin_u + i, su, n * sizeof(double) );
+		memcpy( cos_u + i, cu, n * sizeof(double) );
+	}
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic) if( rows * columns >= GEOGRAPHIC_PARALLEL_COUNT )
+	#endif
+	for( size_t r = 0; r < rows; r++ )
+	{
+		vincenty_one_to_many( lons1[ r ], lats1[ r ], lons2, lats2, sin_u, cos_u, distances + r * columns, columns );
+	}
+
+	free( sin_u );
+	return true;
 }
 
 // for long lines
@@ -150,18 +823,21 @@ double wgs84_geographic_geodesic_distance_lamberts( double lon1, double lat1, do
 	double q = (beta2 - beta1) / 2.0;
 
 	// central angle between (beta1, lon1) and (beta2, lon2) using haversine formula
-	double central_angle = 2 * asin(sqrt( sin(q) * sin(q) +
-		cos(beta1) * cos(beta2) * sin( (lon2_rads - lon1_rads) / 2.0 ) * sin( (lon2_rads - lon1_rads) / 2.0 )
-	));
-
-	double sin_p = sin(p);
 	double sin_q = sin(q);
 	double cos_q = cos(q);
+	double sin_p = sin(p);
 	double cos_p = cos(p);
-	double cos_ca2 = cos( central_angle / 2.0 );
+	double h = sin_q * sin_q + cos(beta1) * cos(beta2) * sin( (lon2_rads - lon1_rads) / 2.0 ) * sin( (lon2_rads - lon1_rads) / 2.0 );
+	h = m3d_clampd( h, 0.0, 1.0 );
+	double central_angle = 2 * asin(sqrt( h ));
+
+	// sin^2(central_angle / 2) is h. Both ratios are at most 1, but near
+	// coincident or antipodal points they are 0 / 0 up to rounding.
+	double p_ratio = h < 1.0 ? m3d_clampd( sin_p * sin_p / (1.0 - h), 0.0, 1.0 ) : 1.0;
+	double q_ratio = h > 0.0 ? m3d_clampd( sin_q * sin_q / h, 0.0, 1.0 ) : 1.0;
 
-	double x = ((central_angle - sin(central_angle)) * sin_p * sin_p * cos_q * cos_q) / cos_ca2;
-	double y = ((central_angle + sin(central_angle)) * cos_p * cos_p * sin_q * sin_q) / cos_ca2;
+	double x = (central_angle - sin(central_angle)) * cos_q * cos_q * p_ratio;
+	double y = (central_angle + sin(central_angle)) * cos_p * cos_p * q_ratio;
 
 	return WGS84_SEMI_MAJOR_AXIS * (central_angle - (WGS84_FLATTENING_FACTOR / 2.0) * (x + y));
 }
@@ -176,3 +852,17 @@ double wgs84_geographic_geodesic_distance_haversine( double lon1, double lat1, d
 	double c = 2.0 * atan2(sqrt(a), sqrt(1.0 - a));
 	return WGS84_SEMI_MAJOR_AXIS * c;
 }
+
+double wgs84_geographic_geodesic_distance_with_method( double lon1, double lat1, double lon2, double lat2, wgs84_distance_method_t method )
+{
+	switch( method )
+	{
+		case WGS84_DISTANCE_LAMBERTS:
+			return wgs84_geographic_geodesic_distance_lamberts( lon1, lat1, lon2, lat2 );
+		case WGS84_DISTANCE_VINCENTY:
+			return wgs84_geographic_geodesic_distance_vincenty( lon1, lat1, lon2, lat2 );
+		case WGS84_DISTANCE_HAVERSINE:
+		default:
+			return wgs84_geographic_geodesic_distance_haversine( lon1, lat1, lon2, lat2 );
+	}
+}
@@ -22,6 +22,8 @@
 #define _GEOGRAPHIC_H_
 #include <stddef.h>
 #include <stdbool.h>
+#include <float.h>
+#include "mat3.h"
 
 #define WGS84_SEMI_MAJOR_AXIS         (6378137.0) /* center to equator */
 #define WGS84_SEMI_MINOR_AXIS         (6356752.314245) /* center to pole */
@@ -34,13 +36,131 @@ typedef struct geo_coord {
 	double alt;
 } geo_coord_t;
 
+/*
+ * ECEF to Geodetic Methods
+ *
+ * WGS84_GEODETIC_ITERATIVE repeats a fixed point iteration on the latitude
+ * until it converges, which takes a variable number of iterations (at most
+ * 16). WGS84_GEODETIC_BOWRING runs exactly two iterations of Bowring's
+ * method and WGS84_GEODETIC_VERMEILLE uses Vermeille's closed form, so both
+ * have a fixed cost and no data dependent branches.
+ *
+ * All three are within 1e-12 degrees and 1e-7 meters of the exact geodetic
+ * coordinates from -10 km to beyond geostationary altitude, including the
+ * poles. Vermeille's method is not defined within about 43 km of the center
+ * of the earth.
+ */
+typedef enum wgs84_geodetic_method {
+	WGS84_GEODETIC_ITERATIVE = 0,
+	WGS84_GEODETIC_BOWRING,
+	WGS84_GEODETIC_VERMEILLE,
+} wgs84_geodetic_method_t;
+
+/*
+ * Geodesic Distance Methods
+ *
+ * WGS84_DISTANCE_VINCENTY is within 0.1 mm of the exact geodesic distance.
+ * WGS84_DISTANCE_LAMBERTS is within about 10 m up to 9000 km and 200 m up
+ * to 18000 km, but can be off by tens of kilometers for nearly antipodal
+ * points.
+ * WGS84_DISTANCE_HAVERSINE treats the earth as a sphere with the
+ * semi-major axis as its radius.
+ */
+typedef enum wgs84_distance_method {
+	WGS84_DISTANCE_HAVERSINE = 0,
+	WGS84_DISTANCE_LAMBERTS,
+	WGS84_DISTANCE_VINCENTY,
+} wgs84_distance_method_t;
+
 void   wgs84_geographic_to_cartesian( double lon, double lat, double alt, double* x, double* y, double* z );
 void   wgs84_cartesian_to_geographic_with_epsilon( double x, double y, double z, double* lon, double* lat, double* alt, double epsilon );
+void   wgs84_cartesian_to_geographic_with_method( double x, double y, double z, double* lon, double* lat, double* alt, wgs84_geodetic_method_t method );
+void   wgs84_cartesian_to_geographic_bowring( double x, double y, double z, double* lon, double* lat, double* alt );
+void   wgs84_cartesian_to_geographic_vermeille( double x, double y, double z, double* lon, double* lat, double* alt );
 void   wgs84_geographic_to_mercator( double lon, double lat, double central_meridian, double* x, double* y );
 void   wgs84_mercator_to_geographic( double x, double y, double central_meridian, double* lon, double* lat );
 double wgs84_geographic_geodesic_distance_vincenty( double lon1, double lat1, double lon2, double lat2 );
 double wgs84_geographic_geodesic_distance_lamberts( double lon1, double lat1, double lon2, double lat2 );
 double wgs84_geographic_geodesic_distance_haversine( double lon1, double lat1, double lon2, double lat2 );
+double wgs84_geographic_geodesic_distance_with_method( double lon1, double lat1, double lon2, double lat2, wgs84_distance_method_t method );
+
+/*
+ * Batch Conversions
+ *
+ * These convert count points between structure of arrays buffers, which
+ * must not overlap. The kernels use vectorized sine, cosine and arctangent,
+ * and arrays of 65536 or more points are split across threads when built
+ * with OpenMP.
+ *
+ * wgs84_geographic_to_cartesian_array matches wgs84_geographic_to_cartesian
+ * within 1e-7 meters. wgs84_cartesian_to_geographic_array uses the same
+ * two fixed iterations as WGS84_GEODETIC_BOWRING, so it has the same
+ * accuracy. Longitudes are in [-180, 180], and points on the polar axis get
+ * a longitude of 0.
+ */
+void   wgs84_geographic_to_cartesian_array( const double lon[], const double lat[], const double alt[], double x[], double y[], double z[], size_t count );
+void   wgs84_cartesian_to_geographic_array( const double x[], const double y[], const double z[], double lon[], double lat[], double alt[], size_t count );
+
+/*
+ * Batch Geodesic Distances
+ *
+ * These find Vincenty distances in meters for many pairs at once: pairs
+ * from two lists, one point to many, and a rows by columns matrix stored
+ * row by row. The iterations run on blocks of pairs in vector lanes, and
+ * large inputs are split across threads when built with OpenMP.
+ *
+ * Like wgs84_geographic_geodesic_distance_vincenty, they are within 0.1 mm
+ * of the exact geodesic distance. Nearly antipodal pairs, where Vincenty's
+ * iteration does not converge, fall back to a bisection that is within
+ * 1 cm. The matrix function returns false if it cannot
+ * allocate its workspace.
+ */
+void   wgs84_geographic_geodesic_distance_vincenty_pairs( const double lon1[], const double lat1[], const double lon2[], const double lat2[], double distances[], size_t count );
+void   wgs84_geographic_geodesic_distance_vincenty_one_to_many( double lon, double lat, const double lons[], const double lats[], double distances[], size_t count );
+bool   wgs84_geographic_geodesic_distance_vincenty_matrix( const double lons1[], const double lats1[], size_t rows, const double lons2[], const double lats2[], size_t columns, double distances[] );
+
+/*
+ * Local Tangent Frames
+ *
+ * A frame holds the ECEF origin and rotation of the east, north, up (ENU)
+ * or north, east, down (NED) axes at a reference point, so converting a
+ * point does not recompute the sines and cosines of the reference. Local
+ * coordinates are in meters along the frame's axes, in the order of its
+ * name, so local_x is east in an ENU frame and north in an NED frame.
+ *
+ * The array functions convert count points between structure of arrays
+ * buffers, which must not overlap. They do the geographic conversion and
+ * the rotation together in vectorized blocks, and arrays of 65536 or more
+ * points are split across threads when built with OpenMP. Conversions to
+ * geographic coordinates use WGS84_GEODETIC_BOWRING.
+ *
+ * geo_frame_rotation returns the rotation from ECEF to local axes, such as
+ * for rendering. The origin is not included, since a scaler_t may be too
+ * small for ECEF coordinates.
+ *
+ * The fields are private.
+ */
+typedef enum geo_frame_axes {
+	GEO_FRAME_ENU = 0,
+	GEO_FRAME_NED,
+} geo_frame_axes_t;
+
+typedef struct geo_frame {
+	geo_frame_axes_t axes;
+	double origin[ 3 ];   /* ECEF */
+	double rotation[ 9 ]; /* the local axes in ECEF, one per row */
+} geo_frame_t;
+
+void   geo_frame_init                 ( geo_frame_t* frame, double lon, double lat, double alt, geo_frame_axes_t axes );
+mat3_t geo_frame_rotation             ( const geo_frame_t* frame );
+void   geo_frame_from_cartesian       ( const geo_frame_t* frame, double x, double y, double z, double* local_x, double* local_y, double* local_z );
+void   geo_frame_to_cartesian         ( const geo_frame_t* frame, double local_x, double local_y, double local_z, double* x, double* y, double* z );
+void   geo_frame_from_geographic      ( const geo_frame_t* frame, double lon, double lat, double alt, double* local_x, double* local_y, double* local_z );
+void   geo_frame_to_geographic        ( const geo_frame_t* frame, double local_x, double local_y, double local_z, double* lon, double* lat, double* alt );
+void   geo_frame_from_cartesian_array ( const geo_frame_t* frame, const double x[], const double y[], const double z[], double local_x[], double local_y[], double local_z[], size_t count );
+void   geo_frame_to_cartesian_array   ( const geo_frame_t* frame, const double local_x[], const double local_y[], const double local_z[], double x[], double y[], double z[], size_t count );
+void   geo_frame_from_geographic_array( const geo_frame_t* frame, const double lon[], const double lat[], const double alt[], double local_x[], double local_y[], double local_z[], size_t count );
+void   geo_frame_to_geographic_array  ( const geo_frame_t* frame, const double local_x[], const double local_y[], const double local_z[], double lon[], double lat[], double alt[], size_t count );
 
 static inline void wgs84_cartesian_to_geographic( double x, double y, double z, double* lon, double* lat, double* alt )
 {
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <assert.h>
 #include "mathematics.h"
+#include "format.h"
 #include "mat2.h"
 
 const mat2_t MAT2_IDENTITY = { .m = {
@@ -117,35 +118,46 @@ void mat2_transpose( mat2_t* m )
 	m->m[ 2 ] = tmp;
 }
 
-const char* mat2_to_string( const mat2_t* m )
+size_t mat2_to_string_r( const mat2_t* m, char* buffer, size_t size )
 {
-	static char string_buffer[ 128 ];
+	int length;
 	#if defined(LIBM3D_USE_LONG_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-6.2Lf %6.2Lf|\n"
 		"|%-6.2Lf %6.2Lf|\n",
 		m->m[0], m->m[2],
 		m->m[1], m->m[3]
  	);
 	#elif defined(LIBM3D_USE_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-6.2lf %6.2lf|\n"
 		"|%-6.2lf %6.2lf|\n",
 		m->m[0], m->m[2],
 		m->m[1], m->m[3]
  	);
 	#else
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-6.2f %6.2f|\n"
 		"|%-6.2f %6.2f|\n",
 		m->m[0], m->m[2],
 		m->m[1], m->m[3]
  	);
 	#endif
-	string_buffer[ sizeof(string_buffer) - 1 ] = '\0';
+	return length < 0 ? 0 : (size_t) length;
+}
+
+const char* mat2_to_string( const mat2_t* m )
+{
+	static _Thread_local char string_buffer[ 128 ];
+	mat2_to_string_r( m, string_buffer, sizeof(string_buffer) );
 	return string_buffer;
 }
 
+size_t mat2_format( char* restrict buffer, size_t size, const mat2_t* restrict m, size_t count, int precision, size_t* restrict length )
+{
+	return m3d_format_elements( buffer, size, (const scaler_t*) m, sizeof(mat2_t) / sizeof(scaler_t), count, 2, 2, precision, length );
+}
+
 #if 0
 const vec2_t* mat2_x_vector( const mat2_t* m )
 {
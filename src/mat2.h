@@ -27,6 +27,7 @@
 #else
 #error "Need a C99 compiler."
 #endif
+#include <stddef.h>
 #include "mathematics.h"
 #include "vec2.h"
 #ifdef __cplusplus
@@ -57,7 +58,17 @@ mat2_t      mat2_mult_matrix ( const mat2_t* restrict a, const mat2_t* restrict
 vec2_t      mat2_mult_vector ( const mat2_t* restrict m, const vec2_t* restrict v );
 bool        mat2_invert      ( mat2_t* m );
 void        mat2_transpose   ( mat2_t* m );
-const char* mat2_to_string   ( const mat2_t* m );
+const char* mat2_to_string   ( const mat2_t* m ); /* uses a thread-local buffer */
+size_t      mat2_to_string_r ( const mat2_t* m, char* buffer, size_t size ); /* returns the length like snprintf() */
+
+/*
+ * Writes count matrices as "[a, b; c, d]" in row order, one per line,
+ * with precision decimals (at most 9). This does not use snprintf() and
+ * is meant for dumping large arrays. Only whole matrices are written and
+ * the buffer is always terminated. Returns the number of matrices written
+ * and stores the number of characters in length (if not NULL).
+ */
+size_t mat2_format( char* restrict buffer, size_t size, const mat2_t* restrict m, size_t count, int precision, size_t* restrict length );
 
 #define mat2_x_vector( p_m )   ((vec2_t*) &(p_m)->m[0])
 #define mat2_y_vector( p_m )   ((vec2_t*) &(p_m)->m[2])
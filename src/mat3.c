@@ -23,6 +23,7 @@
 #include <string.h>
 #include <assert.h>
 #include "mathematics.h"
+#include "format.h"
 #include "mat3.h"
 
 const mat3_t MAT3_IDENTITY = { .m = {
@@ -204,11 +205,11 @@ mat3_t mat3_from_axis3_angle( const vec3_t* axis, scaler_t angle )
 	);
 }
 
-const char* mat3_to_string( const mat3_t* m )
+size_t mat3_to_string_r( const mat3_t* m, char* buffer, size_t size )
 {
-	static char string_buffer[ 128 ];
+	int length;
 	#if defined(LIBM3D_USE_LONG_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-5.2Lf %-5.2Lf %-5.2Lf|\n"
 		"|%-5.2Lf %-5.2Lf %-5.2Lf|\n"
 		"|%-5.2Lf %-5.2Lf %-5.2Lf|\n",
@@ -217,7 +218,7 @@ const char* mat3_to_string( const mat3_t* m )
 		m->m[2], m->m[5], m->m[8]
  	);
 	#elif defined(LIBM3D_USE_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-5.2lf %-5.2lf %-5.2lf|\n"
 		"|%-5.2lf %-5.2lf %-5.2lf|\n"
 		"|%-5.2lf %-5.2lf %-5.2lf|\n",
@@ -226,7 +227,7 @@ const char* mat3_to_string( const mat3_t* m )
 		m->m[2], m->m[5], m->m[8]
  	);
 	#else
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-5.2f %-5.2f %-5.2f|\n"
 		"|%-5.2f %-5.2f %-5.2f|\n"
 		"|%-5.2f %-5.2f %-5.2f|\n",
@@ -235,10 +236,21 @@ const char* mat3_to_string( const mat3_t* m )
 		m->m[2], m->m[5], m->m[8]
  	);
 	#endif
-	string_buffer[ sizeof(string_buffer) - 1 ] = '\0';
+	return length < 0 ? 0 : (size_t) length;
+}
+
+const char* mat3_to_string( const mat3_t* m )
+{
+	static _Thread_local char string_buffer[ 128 ];
+	mat3_to_string_r( m, string_buffer, sizeof(string_buffer) );
 	return string_buffer;
 }
 
+size_t mat3_format( char* restrict buffer, size_t size, const mat3_t* restrict m, size_t count, int precision, size_t* restrict length )
+{
+	return m3d_format_elements( buffer, size, (const scaler_t*) m, sizeof(mat3_t) / sizeof(scaler_t), count, 3, 3, precision, length );
+}
+
 #if 0
 const vec3_t* mat3_x_vector( const mat3_t* m )
 {
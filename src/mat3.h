@@ -27,6 +27,7 @@
 #else
 #error "Need a C99 compiler."
 #endif
+#include <stddef.h>
 #include "mathematics.h"
 #include "vec3.h"
 #ifdef __cplusplus
@@ -61,7 +62,18 @@ void        mat3_transpose        ( mat3_t* m );
 mat3_t      mat3_cofactor         ( const mat3_t* m );
 void        mat3_adjoint          ( mat3_t* m );
 mat3_t      mat3_from_axis3_angle ( const vec3_t* axis, scaler_t angle );
-const char* mat3_to_string        ( const mat3_t* m );
+const char* mat3_to_string        ( const mat3_t* m ); /* uses a thread-local buffer */
+size_t      mat3_to_string_r      ( const mat3_t* m, char* buffer, size_t size ); /* returns the length like snprintf() */
+
+/*
+ * Writes count matrices as "[a, b, c; d, e, f; g, h, i]" in row order,
+ * one per line, with precision decimals (at most 9). This does not use
+ * snprintf() and is meant for dumping large arrays. Only whole matrices
+ * are written and the buffer is always terminated. Returns the number of
+ * matrices written and stores the number of characters in length (if not
+ * NULL).
+ */
+size_t mat3_format( char* restrict buffer, size_t size, const mat3_t* restrict m, size_t count, int precision, size_t* restrict length );
 
 #define mat3_x_vector( p_m )   ((vec3_t*) &(p_m)->m[0])
 #define mat3_y_vector( p_m )   ((vec3_t*) &(p_m)->m[3])
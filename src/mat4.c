@@ -23,6 +23,8 @@
 #include <string.h>
 #include <assert.h>
 #include "mathematics.h"
+#include "simd.h"
+#include "format.h"
 #include "mat4.h"
 
 const mat4_t MAT4_IDENTITY = { .m = {
@@ -60,6 +62,59 @@ scaler_t mat4_determinant( const mat4_t* m )
 	return m->m[0]*d1 - m->m[1]*d2 + m->m[2]*d3 - m->m[3]*d4;
 }
 
+/*
+ * SIMD helpers for mat4_mult_matrix() and mat4_mult_vector(). Each returns
+ * one column of the product as a linear combination of the columns of a,
+ * weighted by the four scalars in b. The sum is evaluated as a tree to
+ * shorten the dependency chain.
+ */
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+static inline __m128 mat4_column_ps( __m128 a0, __m128 a1, __m128 a2, __m128 a3, const float* b )
+{
+	__m128 B  = _mm_loadu_ps( b );
+	__m128 b0 = _mm_shuffle_ps( B, B, 0x00 );
+	__m128 b1 = _mm_shuffle_ps( B, B, 0x55 );
+	__m128 b2 = _mm_shuffle_ps( B, B, 0xAA );
+	__m128 b3 = _mm_shuffle_ps( B, B, 0xFF );
+	#if defined(M3D_SIMD_FMA)
+	__m128 r01 = _mm_fmadd_ps( a1, b1, _mm_mul_ps( a0, b0 ) );
+	__m128 r23 = _mm_fmadd_ps( a3, b3, _mm_mul_ps( a2, b2 ) );
+	#else
+	__m128 r01 = _mm_add_ps( _mm_mul_ps( a0, b0 ), _mm_mul_ps( a1, b1 ) );
+	__m128 r23 = _mm_add_ps( _mm_mul_ps( a2, b2 ), _mm_mul_ps( a3, b3 ) );
+	#endif
+	return _mm_add_ps( r01, r23 );
+}
+#elif defined(M3D_SIMD_FLOAT_NEON)
+static inline float32x4_t mat4_column_f32( float32x4_t a0, float32x4_t a1, float32x4_t a2, float32x4_t a3, const float* b )
+{
+	float32x4_t B   = vld1q_f32( b );
+	float32x4_t r01 = vfmaq_laneq_f32( vmulq_laneq_f32( a0, B, 0 ), a1, B, 1 );
+	float32x4_t r23 = vfmaq_laneq_f32( vmulq_laneq_f32( a2, B, 2 ), a3, B, 3 );
+	return vaddq_f32( r01, r23 );
+}
+#elif defined(M3D_SIMD_DOUBLE_AVX)
+static inline __m256d mat4_column_pd( __m256d a0, __m256d a1, __m256d a2, __m256d a3, const double* b )
+{
+	#if defined(M3D_SIMD_FMA)
+	__m256d r01 = _mm256_fmadd_pd( a1, _mm256_broadcast_sd( &b[ 1 ] ), _mm256_mul_pd( a0, _mm256_broadcast_sd( &b[ 0 ] ) ) );
+	__m256d r23 = _mm256_fmadd_pd( a3, _mm256_broadcast_sd( &b[ 3 ] ), _mm256_mul_pd( a2, _mm256_broadcast_sd( &b[ 2 ] ) ) );
+	#else
+	__m256d r01 = _mm256_add_pd( _mm256_mul_pd( a0, _mm256_broadcast_sd( &b[ 0 ] ) ), _mm256_mul_pd( a1, _mm256_broadcast_sd( &b[ 1 ] ) ) );
+	__m256d r23 = _mm256_add_pd( _mm256_mul_pd( a2, _mm256_broadcast_sd( &b[ 2 ] ) ), _mm256_mul_pd( a3, _mm256_broadcast_sd( &b[ 3 ] ) ) );
+	#endif
+	return _mm256_add_pd( r01, r23 );
+}
+#elif defined(M3D_SIMD_DOUBLE_SSE2)
+/* Half a column (two rows starting at h) */
+static inline __m128d mat4_column_half_pd( const double* a, int h, const double* b )
+{
+	__m128d r01 = _mm_add_pd( _mm_mul_pd( _mm_loadu_pd( &a[ 0 + h] ), _mm_set1_pd( b[ 0 ] ) ), _mm_mul_pd( _mm_loadu_pd( &a[ 4 + h] ), _mm_set1_pd( b[ 1 ] ) ) );
+	__m128d r23 = _mm_add_pd( _mm_mul_pd( _mm_loadu_pd( &a[ 8 + h] ), _mm_set1_pd( b[ 2 ] ) ), _mm_mul_pd( _mm_loadu_pd( &a[12 + h] ), _mm_set1_pd( b[ 3 ] ) ) );
+	return _mm_add_pd( r01, r23 );
+}
+#endif
+
 mat4_t mat4_mult_matrix( const mat4_t* restrict a, const mat4_t* restrict b )
 {
     assert( a && b );
@@ -68,6 +123,59 @@ mat4_t mat4_mult_matrix( const mat4_t* restrict a, const mat4_t* restrict b )
 	// |a01 a05 a09 a13| * |b01 b05 b09 b13|
 	// |a02 a06 a10 a14|   |b02 b06 b10 b14|
 	// |a03 a07 a11 a15|   |b03 b07 b11 b15|
+#if defined(M3D_SIMD_FLOAT_AVX) && defined(M3D_SIMD_AVX512F)
+	mat4_t result;
+	/* The whole matrix fits in one register. */
+	__m512 A   = _mm512_loadu_ps( &a->m[ 0] );
+	__m512 B   = _mm512_loadu_ps( &b->m[ 0] );
+	__m512 r01 = _mm512_fmadd_ps( _mm512_shuffle_f32x4( A, A, 0x55 ), _mm512_permute_ps( B, 0x55 ),
+	                              _mm512_mul_ps( _mm512_shuffle_f32x4( A, A, 0x00 ), _mm512_permute_ps( B, 0x00 ) ) );
+	__m512 r23 = _mm512_fmadd_ps( _mm512_shuffle_f32x4( A, A, 0xFF ), _mm512_permute_ps( B, 0xFF ),
+	                              _mm512_mul_ps( _mm512_shuffle_f32x4( A, A, 0xAA ), _mm512_permute_ps( B, 0xAA ) ) );
+	_mm512_storeu_ps( &result.m[ 0], _mm512_add_ps( r01, r23 ) );
+	return result;
+#elif defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	mat4_t result;
+	__m128 a0 = _mm_loadu_ps( &a->m[ 0] );
+	__m128 a1 = _mm_loadu_ps( &a->m[ 4] );
+	__m128 a2 = _mm_loadu_ps( &a->m[ 8] );
+	__m128 a3 = _mm_loadu_ps( &a->m[12] );
+	_mm_storeu_ps( &result.m[ 0], mat4_column_ps( a0, a1, a2, a3, &b->m[ 0] ) );
+	_mm_storeu_ps( &result.m[ 4], mat4_column_ps( a0, a1, a2, a3, &b->m[ 4] ) );
+	_mm_storeu_ps( &result.m[ 8], mat4_column_ps( a0, a1, a2, a3, &b->m[ 8] ) );
+	_mm_storeu_ps( &result.m[12], mat4_column_ps( a0, a1, a2, a3, &b->m[12] ) );
+	return result;
+#elif defined(M3D_SIMD_FLOAT_NEON)
+	mat4_t result;
+	float32x4_t a0 = vld1q_f32( &a->m[ 0] );
+	float32x4_t a1 = vld1q_f32( &a->m[ 4] );
+	float32x4_t a2 = vld1q_f32( &a->m[ 8] );
+	float32x4_t a3 = vld1q_f32( &a->m[12] );
+	vst1q_f32( &result.m[ 0], mat4_column_f32( a0, a1, a2, a3, &b->m[ 0] ) );
+	vst1q_f32( &result.m[ 4], mat4_column_f32( a0, a1, a2, a3, &b->m[ 4] ) );
+	vst1q_f32( &result.m[ 8], mat4_column_f32( a0, a1, a2, a3, &b->m[ 8] ) );
+	vst1q_f32( &result.m[12], mat4_column_f32( a0, a1, a2, a3, &b->m[12] ) );
+	return result;
+#elif defined(M3D_SIMD_DOUBLE_AVX)
+	mat4_t result;
+	__m256d a0 = _mm256_loadu_pd( &a->m[ 0] );
+	__m256d a1 = _mm256_loadu_pd( &a->m[ 4] );
+	__m256d a2 = _mm256_loadu_pd( &a->m[ 8] );
+	__m256d a3 = _mm256_loadu_pd( &a->m[12] );
+	_mm256_storeu_pd( &result.m[ 0], mat4_column_pd( a0, a1, a2, a3, &b->m[ 0] ) );
+	_mm256_storeu_pd( &result.m[ 4], mat4_column_pd( a0, a1, a2, a3, &b->m[ 4] ) );
+	_mm256_storeu_pd( &result.m[ 8], mat4_column_pd( a0, a1, a2, a3, &b->m[ 8] ) );
+	_mm256_storeu_pd( &result.m[12], mat4_column_pd( a0, a1, a2, a3, &b->m[12] ) );
+	return result;
+#elif defined(M3D_SIMD_DOUBLE_SSE2)
+	mat4_t result;
+	for( int j = 0; j < 16; j += 4 )
+	{
+		_mm_storeu_pd( &result.m[ j + 0 ], mat4_column_half_pd( a->m, 0, &b->m[ j ] ) );
+		_mm_storeu_pd( &result.m[ j + 2 ], mat4_column_half_pd( a->m, 2, &b->m[ j ] ) );
+	}
+	return result;
+#else
 	return MAT4(
 		a->m[ 0] * b->m[ 0]  +  a->m[ 4] * b->m[ 1]  +  a->m[ 8] * b->m[ 2]  +  a->m[12] * b->m[ 3],
 		a->m[ 1] * b->m[ 0]  +  a->m[ 5] * b->m[ 1]  +  a->m[ 9] * b->m[ 2]  +  a->m[13] * b->m[ 3],
@@ -89,6 +197,7 @@ mat4_t mat4_mult_matrix( const mat4_t* restrict a, const mat4_t* restrict b )
 		a->m[ 2] * b->m[12]  +  a->m[ 6] * b->m[13]  +  a->m[10] * b->m[14]  +  a->m[14] * b->m[15],
 		a->m[ 3] * b->m[12]  +  a->m[ 7] * b->m[13]  +  a->m[11] * b->m[14]  +  a->m[15] * b->m[15]
 	);
+#endif
 }
 
 vec4_t mat4_mult_vector( const mat4_t* restrict m, const vec4_t* restrict v )
@@ -98,16 +207,237 @@ vec4_t mat4_mult_vector( const mat4_t* restrict m, const vec4_t* restrict v )
 	// |m03x + m04y + m05z + m03w| = | m01 m05 m09 m13| *  |y|
 	// |m06x + m07y + m08z + m03w|   | m02 m06 m10 m14|    |z|
 	// |m06x + m07y + m08z + m03w|   | m03 m07 m11 m15|    |w|
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	vec4_t result;
+	_mm_storeu_ps( &result.x, mat4_column_ps( _mm_loadu_ps( &m->m[ 0] ), _mm_loadu_ps( &m->m[ 4] ), _mm_loadu_ps( &m->m[ 8] ), _mm_loadu_ps( &m->m[12] ), &v->x ) );
+	return result;
+#elif defined(M3D_SIMD_FLOAT_NEON)
+	vec4_t result;
+	vst1q_f32( &result.x, mat4_column_f32( vld1q_f32( &m->m[ 0] ), vld1q_f32( &m->m[ 4] ), vld1q_f32( &m->m[ 8] ), vld1q_f32( &m->m[12] ), &v->x ) );
+	return result;
+#elif defined(M3D_SIMD_DOUBLE_AVX)
+	vec4_t result;
+	_mm256_storeu_pd( &result.x, mat4_column_pd( _mm256_loadu_pd( &m->m[ 0] ), _mm256_loadu_pd( &m->m[ 4] ), _mm256_loadu_pd( &m->m[ 8] ), _mm256_loadu_pd( &m->m[12] ), &v->x ) );
+	return result;
+#elif defined(M3D_SIMD_DOUBLE_SSE2)
+	vec4_t result;
+	_mm_storeu_pd( &result.x, mat4_column_half_pd( m->m, 0, &v->x ) );
+	_mm_storeu_pd( &result.z, mat4_column_half_pd( m->m, 2, &v->x ) );
+	return result;
+#else
 	return VEC4(
 		m->m[ 0] * v->x  +  m->m[ 4] * v->y  +  m->m[ 8] * v->z  +  m->m[12] * v->w,
 		m->m[ 1] * v->x  +  m->m[ 5] * v->y  +  m->m[ 9] * v->z  +  m->m[13] * v->w,
 		m->m[ 2] * v->x  +  m->m[ 6] * v->y  +  m->m[10] * v->z  +  m->m[14] * v->w,
 		m->m[ 3] * v->x  +  m->m[ 7] * v->y  +  m->m[11] * v->z  +  m->m[15] * v->w
 	);
+#endif
 }
 
-bool mat4_invert( mat4_t* m )
+bool mat4_is_affine( const mat4_t* m )
+{
+	assert( m );
+	return m->m[ 3] == 0 && m->m[ 7] == 0 && m->m[11] == 0 && m->m[15] == 1;
+}
+
+/*
+ * Four lane helpers for the bulk transforms. One vector is transformed at
+ * a time as a combination of the columns of the matrix so that the input
+ * and output buffers can have any stride and can be the same buffer.
+ */
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+typedef __m128 mat4_lanes_t;
+
+static inline mat4_lanes_t mat4_lanes_load( const scaler_t* p ) { return _mm_loadu_ps( p ); }
+static inline mat4_lanes_t mat4_lanes_zero( void )              { return _mm_setzero_ps( ); }
+static inline mat4_lanes_t mat4_lanes_scale( mat4_lanes_t a, scaler_t s ) { return _mm_mul_ps( a, _mm_set1_ps( s ) ); }
+static inline scaler_t     mat4_lanes_w( mat4_lanes_t a )       { return _mm_cvtss_f32( _mm_shuffle_ps( a, a, 0xFF ) ); }
+static inline void         mat4_lanes_store4( scaler_t* p, mat4_lanes_t a ) { _mm_storeu_ps( p, a ); }
+static inline void         mat4_lanes_store3( scaler_t* p, mat4_lanes_t a )
+{
+	_mm_storel_pi( (__m64*) p, a );
+	_mm_store_ss( p + 2, _mm_movehl_ps( a, a ) );
+}
+# if defined(M3D_SIMD_FMA)
+static inline mat4_lanes_t mat4_lanes_madd( mat4_lanes_t a, scaler_t s, mat4_lanes_t c ) { return _mm_fmadd_ps( a, _mm_set1_ps( s ), c ); }
+# else
+static inline mat4_lanes_t mat4_lanes_madd( mat4_lanes_t a, scaler_t s, mat4_lanes_t c ) { return _mm_add_ps( _mm_mul_ps( a, _mm_set1_ps( s ) ), c ); }
+# endif
+#elif defined(M3D_SIMD_FLOAT_NEON)
+typedef float32x4_t mat4_lanes_t;
+
+static inline mat4_lanes_t mat4_lanes_load( const scaler_t* p ) { return vld1q_f32( p ); }
+static inline mat4_lanes_t mat4_lanes_zero( void )              { return vdupq_n_f32( 0 ); }
+static inline mat4_lanes_t mat4_lanes_scale( mat4_lanes_t a, scaler_t s ) { return vmulq_n_f32( a, s ); }
+static inline mat4_lanes_t mat4_lanes_madd( mat4_lanes_t a, scaler_t s, mat4_lanes_t c ) { return vfmaq_n_f32( c, a, s ); }
+static inline scaler_t     mat4_lanes_w( mat4_lanes_t a )       { return vgetq_lane_f32( a, 3 ); }
+static inline void         mat4_lanes_store4( scaler_t* p, mat4_lanes_t a ) { vst1q_f32( p, a ); }
+static inline void         mat4_lanes_store3( scaler_t* p, mat4_lanes_t a )
+{
+	vst1_f32( p, vget_low_f32( a ) );
+	vst1q_lane_f32( p + 2, a, 2 );
+}
+#elif defined(M3D_SIMD_DOUBLE_AVX)
+typedef __m256d mat4_lanes_t;
+
+static inline mat4_lanes_t mat4_lanes_load( const scaler_t* p ) { return _mm256_loadu_pd( p ); }
+static inline mat4_lanes_t mat4_lanes_zero( void )              { return _mm256_setzero_pd( ); }
+static inline mat4_lanes_t mat4_lanes_scale( mat4_lanes_t a, scaler_t s ) { return _mm256_mul_pd( a, _mm256_set1_pd( s ) ); }
+static inline scaler_t     mat4_lanes_w( mat4_lanes_t a )
+{
+	__m128d hi = _mm256_extractf128_pd( a, 1 );
+	return _mm_cvtsd_f64( _mm_unpackhi_pd( hi, hi ) );
+}
+static inline void         mat4_lanes_store4( scaler_t* p, mat4_lanes_t a ) { _mm256_storeu_pd( p, a ); }
+static inline void         mat4_lanes_store3( scaler_t* p, mat4_lanes_t a )
+{
+	_mm_storeu_pd( p, _mm256_castpd256_pd128( a ) );
+	_mm_store_sd( p + 2, _mm256_extractf128_pd( a, 1 ) );
+}
+# if defined(M3D_SIMD_FMA)
+static inline mat4_lanes_t mat4_lanes_madd( mat4_lanes_t a, scaler_t s, mat4_lanes_t c ) { return _mm256_fmadd_pd( a, _mm256_set1_pd( s ), c ); }
+# else
+static inline mat4_lanes_t mat4_lanes_madd( mat4_lanes_t a, scaler_t s, mat4_lanes_t c ) { return _mm256_add_pd( _mm256_mul_pd( a, _mm256_set1_pd( s ) ), c ); }
+# endif
+#else
+typedef struct { scaler_t v[ 4 ]; } mat4_lanes_t;
+
+static inline mat4_lanes_t mat4_lanes_load( const scaler_t* p ) { return (mat4_lanes_t){ { p[ 0 ], p[ 1 ], p[ 2 ], p[ 3 ] } }; }
+static inline mat4_lanes_t mat4_lanes_zero( void )              { return (mat4_lanes_t){ { 0, 0, 0, 0 } }; }
+static inline mat4_lanes_t mat4_lanes_scale( mat4_lanes_t a, scaler_t s ) { return (mat4_lanes_t){ { a.v[ 0 ] * s, a.v[ 1 ] * s, a.v[ 2 ] * s, a.v[ 3 ] * s } }; }
+static inline mat4_lanes_t mat4_lanes_madd( mat4_lanes_t a, scaler_t s, mat4_lanes_t c )
+{
+	return (mat4_lanes_t){ { a.v[ 0 ] * s + c.v[ 0 ], a.v[ 1 ] * s + c.v[ 1 ], a.v[ 2 ] * s + c.v[ 2 ], a.v[ 3 ] * s + c.v[ 3 ] } };
+}
+static inline scaler_t     mat4_lanes_w( mat4_lanes_t a )       { return a.v[ 3 ]; }
+static inline void         mat4_lanes_store4( scaler_t* p, mat4_lanes_t a ) { p[ 0 ] = a.v[ 0 ]; p[ 1 ] = a.v[ 1 ]; p[ 2 ] = a.v[ 2 ]; p[ 3 ] = a.v[ 3 ]; }
+static inline void         mat4_lanes_store3( scaler_t* p, mat4_lanes_t a ) { p[ 0 ] = a.v[ 0 ]; p[ 1 ] = a.v[ 1 ]; p[ 2 ] = a.v[ 2 ]; }
+#endif
+
+/* Element i of a buffer with a stride in bytes */
+#define mat4_element( buffer, stride, i )  ((scaler_t*) ((char*) (buffer) + (i) * (stride)))
+
+void mat4_transform_points3( const mat4_t* m, vec3_t* out, size_t out_stride, const vec3_t* in, size_t in_stride, size_t count )
 {
+	assert( m && (out || count == 0) && (in || count == 0) );
+	if( out_stride == 0 ) out_stride = sizeof(vec3_t);
+	if( in_stride == 0 ) in_stride = sizeof(vec3_t);
+
+	const mat4_lanes_t c0 = mat4_lanes_load( &m->m[ 0] );
+	const mat4_lanes_t c1 = mat4_lanes_load( &m->m[ 4] );
+	const mat4_lanes_t c2 = mat4_lanes_load( &m->m[ 8] );
+	const mat4_lanes_t c3 = mat4_lanes_load( &m->m[12] );
+
+	if( mat4_is_affine( m ) )
+	{
+		/* The bottom row is (0, 0, 0, 1), so w stays 1 and there is
+		 * nothing to divide by. */
+		for( size_t i = 0; i < count; i++ )
+		{
+			const scaler_t* p = mat4_element( in, in_stride, i );
+			mat4_lanes_t r = mat4_lanes_madd( c2, p[ 2 ], mat4_lanes_madd( c1, p[ 1 ], mat4_lanes_madd( c0, p[ 0 ], c3 ) ) );
+			mat4_lanes_store3( mat4_element( out, out_stride, i ), r );
+		}
+	}
+	else
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			const scaler_t* p = mat4_element( in, in_stride, i );
+			mat4_lanes_t r = mat4_lanes_madd( c2, p[ 2 ], mat4_lanes_madd( c1, p[ 1 ], mat4_lanes_madd( c0, p[ 0 ], c3 ) ) );
+			r = mat4_lanes_scale( r, 1 / mat4_lanes_w( r ) );
+			mat4_lanes_store3( mat4_element( out, out_stride, i ), r );
+		}
+	}
+}
+
+void mat4_transform_vectors3( const mat4_t* m, vec3_t* out, size_t out_stride, const vec3_t* in, size_t in_stride, size_t count )
+{
+	assert( m && (out || count == 0) && (in || count == 0) );
+	if( out_stride == 0 ) out_stride = sizeof(vec3_t);
+	if( in_stride == 0 ) in_stride = sizeof(vec3_t);
+
+	/* Directions have w = 0 so the translation and the bottom row
+	 * do not contribute. */
+	const mat4_lanes_t c0 = mat4_lanes_load( &m->m[ 0] );
+	const mat4_lanes_t c1 = mat4_lanes_load( &m->m[ 4] );
+	const mat4_lanes_t c2 = mat4_lanes_load( &m->m[ 8] );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		const scaler_t* p = mat4_element( in, in_stride, i );
+		mat4_lanes_t r = mat4_lanes_madd( c2, p[ 2 ], mat4_lanes_madd( c1, p[ 1 ], mat4_lanes_madd( c0, p[ 0 ], mat4_lanes_zero( ) ) ) );
+		mat4_lanes_store3( mat4_element( out, out_stride, i ), r );
+	}
+}
+
+void mat4_transform_normals3( const mat4_t* m, vec3_t* out, size_t out_stride, const vec3_t* in, size_t in_stride, size_t count )
+{
+	assert( m && (out || count == 0) && (in || count == 0) );
+	if( out_stride == 0 ) out_stride = sizeof(vec3_t);
+	if( in_stride == 0 ) in_stride = sizeof(vec3_t);
+
+	/* The columns of the inverse transpose of the upper 3x3 block are
+	 * the cross products of its columns divided by the determinant. */
+	const vec3_t a = VEC3( m->m[ 0], m->m[ 1], m->m[ 2] );
+	const vec3_t b = VEC3( m->m[ 4], m->m[ 5], m->m[ 6] );
+	const vec3_t c = VEC3( m->m[ 8], m->m[ 9], m->m[10] );
+	vec3_t bc = vec3_cross_product( &b, &c );
+	vec3_t ca = vec3_cross_product( &c, &a );
+	vec3_t ab = vec3_cross_product( &a, &b );
+	scaler_t det = vec3_dot_product( &a, &bc );
+	scaler_t s = det != 0 ? 1 / det : 1;
+
+	const scaler_t n[ 12 ] = {
+		bc.x * s, bc.y * s, bc.z * s, 0,
+		ca.x * s, ca.y * s, ca.z * s, 0,
+		ab.x * s, ab.y * s, ab.z * s, 0
+	};
+	const mat4_lanes_t c0 = mat4_lanes_load( &n[ 0] );
+	const mat4_lanes_t c1 = mat4_lanes_load( &n[ 4] );
+	const mat4_lanes_t c2 = mat4_lanes_load( &n[ 8] );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		const scaler_t* p = mat4_element( in, in_stride, i );
+		mat4_lanes_t r = mat4_lanes_madd( c2, p[ 2 ], mat4_lanes_madd( c1, p[ 1 ], mat4_lanes_madd( c0, p[ 0 ], mat4_lanes_zero( ) ) ) );
+		scaler_t* q = mat4_element( out, out_stride, i );
+		mat4_lanes_store3( q, r );
+
+		/* Zero length normals are left untouched, like vec3_normalize(). */
+		scaler_t length = scaler_sqrt( q[ 0 ] * q[ 0 ] + q[ 1 ] * q[ 1 ] + q[ 2 ] * q[ 2 ] );
+		if( length > 0 )
+		{
+			scaler_t inverse = 1 / length;
+			q[ 0 ] *= inverse;
+			q[ 1 ] *= inverse;
+			q[ 2 ] *= inverse;
+		}
+	}
+}
+
+void mat4_transform_vectors4( const mat4_t* m, vec4_t* out, size_t out_stride, const vec4_t* in, size_t in_stride, size_t count )
+{
+	assert( m && (out || count == 0) && (in || count == 0) );
+	if( out_stride == 0 ) out_stride = sizeof(vec4_t);
+	if( in_stride == 0 ) in_stride = sizeof(vec4_t);
+
+	const mat4_lanes_t c0 = mat4_lanes_load( &m->m[ 0] );
+	const mat4_lanes_t c1 = mat4_lanes_load( &m->m[ 4] );
+	const mat4_lanes_t c2 = mat4_lanes_load( &m->m[ 8] );
+	const mat4_lanes_t c3 = mat4_lanes_load( &m->m[12] );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		const scaler_t* p = mat4_element( in, in_stride, i );
+		mat4_lanes_t r = mat4_lanes_madd( c3, p[ 3 ], mat4_lanes_madd( c2, p[ 2 ], mat4_lanes_madd( c1, p[ 1 ], mat4_lanes_madd( c0, p[ 0 ], mat4_lanes_zero( ) ) ) ) );
+		mat4_lanes_store4( mat4_element( out, out_stride, i ), r );
+	}
+}
+
+bool mat4_invert_general( mat4_t* m )
+{
+	assert( m );
 	#if 0
 	scaler_t det = mat4_determinant( m );
 
@@ -135,6 +465,75 @@ bool mat4_invert( mat4_t* m )
 		return true;
 	}
 
+	return false;
+	#elif defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	// Reading the column-major array as row-major gives the transpose,
+	// and the inverse of the transpose is the transpose of the inverse.
+	// So the rows below (r0..r3) are the columns of m and the rows of the
+	// result are written straight back as columns.
+	//
+	// s0..s5 and c0..c5 are the 2x2 minors of rows {0,1} and {2,3}.
+	const __m128 r0 = _mm_loadu_ps( &m->m[ 0] );
+	const __m128 r1 = _mm_loadu_ps( &m->m[ 4] );
+	const __m128 r2 = _mm_loadu_ps( &m->m[ 8] );
+	const __m128 r3 = _mm_loadu_ps( &m->m[12] );
+
+	/* (s0, s1, s2, s3) and (c0, c1, c2, c3) */
+	const __m128 s03 = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( r0, r0, _MM_SHUFFLE(1,0,0,0) ), _mm_shuffle_ps( r1, r1, _MM_SHUFFLE(2,3,2,1) ) ),
+	                               _mm_mul_ps( _mm_shuffle_ps( r1, r1, _MM_SHUFFLE(1,0,0,0) ), _mm_shuffle_ps( r0, r0, _MM_SHUFFLE(2,3,2,1) ) ) );
+	const __m128 c03 = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( r2, r2, _MM_SHUFFLE(1,0,0,0) ), _mm_shuffle_ps( r3, r3, _MM_SHUFFLE(2,3,2,1) ) ),
+	                               _mm_mul_ps( _mm_shuffle_ps( r3, r3, _MM_SHUFFLE(1,0,0,0) ), _mm_shuffle_ps( r2, r2, _MM_SHUFFLE(2,3,2,1) ) ) );
+	/* (s4, s5, c4, c5) */
+	const __m128 p45 = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE(2,1,2,1) ), _mm_shuffle_ps( r1, r3, _MM_SHUFFLE(3,3,3,3) ) ),
+	                               _mm_mul_ps( _mm_shuffle_ps( r1, r3, _MM_SHUFFLE(2,1,2,1) ), _mm_shuffle_ps( r0, r2, _MM_SHUFFLE(3,3,3,3) ) ) );
+
+	/* yN = (cN, cN, sN, sN) */
+	const __m128 y0 = _mm_shuffle_ps( c03, s03, _MM_SHUFFLE(0,0,0,0) );
+	const __m128 y1 = _mm_shuffle_ps( c03, s03, _MM_SHUFFLE(1,1,1,1) );
+	const __m128 y2 = _mm_shuffle_ps( c03, s03, _MM_SHUFFLE(2,2,2,2) );
+	const __m128 y3 = _mm_shuffle_ps( c03, s03, _MM_SHUFFLE(3,3,3,3) );
+	const __m128 y4 = _mm_shuffle_ps( p45, p45, _MM_SHUFFLE(0,0,2,2) );
+	const __m128 y5 = _mm_shuffle_ps( p45, p45, _MM_SHUFFLE(1,1,3,3) );
+
+	/* xK = (a1K, a0K, a3K, a2K) */
+	const __m128 lo10 = _mm_unpacklo_ps( r1, r0 );
+	const __m128 lo32 = _mm_unpacklo_ps( r3, r2 );
+	const __m128 hi10 = _mm_unpackhi_ps( r1, r0 );
+	const __m128 hi32 = _mm_unpackhi_ps( r3, r2 );
+	const __m128 x0 = _mm_movelh_ps( lo10, lo32 );
+	const __m128 x1 = _mm_movehl_ps( lo32, lo10 );
+	const __m128 x2 = _mm_movelh_ps( hi10, hi32 );
+	const __m128 x3 = _mm_movehl_ps( hi32, hi10 );
+
+	const __m128 sign0 = _mm_setr_ps(  1, -1,  1, -1 );
+	const __m128 sign1 = _mm_setr_ps( -1,  1, -1,  1 );
+
+	/* Rows of the adjugate */
+	__m128 b0 = _mm_mul_ps( sign0, _mm_add_ps( _mm_sub_ps( _mm_mul_ps( x1, y5 ), _mm_mul_ps( x2, y4 ) ), _mm_mul_ps( x3, y3 ) ) );
+	__m128 b1 = _mm_mul_ps( sign1, _mm_add_ps( _mm_sub_ps( _mm_mul_ps( x0, y5 ), _mm_mul_ps( x2, y2 ) ), _mm_mul_ps( x3, y1 ) ) );
+	__m128 b2 = _mm_mul_ps( sign0, _mm_add_ps( _mm_sub_ps( _mm_mul_ps( x0, y4 ), _mm_mul_ps( x1, y2 ) ), _mm_mul_ps( x3, y0 ) ) );
+	__m128 b3 = _mm_mul_ps( sign1, _mm_add_ps( _mm_sub_ps( _mm_mul_ps( x0, y3 ), _mm_mul_ps( x1, y1 ) ), _mm_mul_ps( x2, y0 ) ) );
+
+	/* The determinant is the first row of the input dotted with the
+	 * first column of the adjugate. */
+	__m128 column = _mm_movelh_ps( _mm_unpacklo_ps( b0, b1 ), _mm_unpacklo_ps( b2, b3 ) );
+	__m128 dot    = _mm_mul_ps( r0, column );
+	dot = _mm_add_ps( dot, _mm_movehl_ps( dot, dot ) );
+	dot = _mm_add_ss( dot, _mm_shuffle_ps( dot, dot, _MM_SHUFFLE(1,1,1,1) ) );
+	scaler_t det = _mm_cvtss_f32( dot );
+
+	if( scaler_abs(det) > SCALAR_EPSILON ) // testing if not zero
+	{
+		/* Divide rather than multiply by the reciprocal so that the
+		 * results round the same way as the scalar code. */
+		const __m128 d = _mm_set1_ps( det );
+		_mm_storeu_ps( &m->m[ 0], _mm_div_ps( b0, d ) );
+		_mm_storeu_ps( &m->m[ 4], _mm_div_ps( b1, d ) );
+		_mm_storeu_ps( &m->m[ 8], _mm_div_ps( b2, d ) );
+		_mm_storeu_ps( &m->m[12], _mm_div_ps( b3, d ) );
+		return true;
+	}
+
 	return false;
 	#else
 	scaler_t d1 = m->m[5] * (m->m[10] * m->m[15] - m->m[14] * m->m[11]) - m->m[6] * (m->m[9] * m->m[15] - m->m[13] * m->m[11]) + m->m[7] * (m->m[9] * m->m[14] - m->m[13] * m->m[10]);
@@ -190,6 +589,226 @@ bool mat4_invert( mat4_t* m )
 	#endif
 }
 
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+/*
+ * SSE helpers for affine matrices. The upper 3x3 block is loaded
+ * transposed, so x, y and z each hold one component of the columns
+ * a, b and c (and of the translation t in the last lane).
+ */
+typedef struct mat4_affine_ps {
+	__m128 x;
+	__m128 y;
+	__m128 z;
+	__m128 t;
+} mat4_affine_ps_t;
+
+static inline mat4_affine_ps_t mat4_affine_load_ps( const mat4_t* m )
+{
+	__m128 a = _mm_loadu_ps( &m->m[ 0] );
+	__m128 b = _mm_loadu_ps( &m->m[ 4] );
+	__m128 c = _mm_loadu_ps( &m->m[ 8] );
+	__m128 t = _mm_loadu_ps( &m->m[12] );
+	__m128 w = t;
+	_MM_TRANSPOSE4_PS( a, b, c, w );
+	return (mat4_affine_ps_t){ a, b, c, t };
+}
+
+/* Stores an affine matrix with the given upper 3x3 columns whose
+ * translation is the negation of those columns applied to t. */
+static inline void mat4_affine_store_ps( mat4_t* m, __m128 c0, __m128 c1, __m128 c2, __m128 t )
+{
+	const __m128 mask = _mm_castsi128_ps( _mm_setr_epi32( -1, -1, -1, 0 ) );
+	c0 = _mm_and_ps( c0, mask );
+	c1 = _mm_and_ps( c1, mask );
+	c2 = _mm_and_ps( c2, mask );
+
+	__m128 r = _mm_mul_ps( c0, _mm_shuffle_ps( t, t, _MM_SHUFFLE(0,0,0,0) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( c1, _mm_shuffle_ps( t, t, _MM_SHUFFLE(1,1,1,1) ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( c2, _mm_shuffle_ps( t, t, _MM_SHUFFLE(2,2,2,2) ) ) );
+
+	_mm_storeu_ps( &m->m[ 0], c0 );
+	_mm_storeu_ps( &m->m[ 4], c1 );
+	_mm_storeu_ps( &m->m[ 8], c2 );
+	_mm_storeu_ps( &m->m[12], _mm_sub_ps( _mm_setr_ps( 0, 0, 0, 1 ), r ) );
+}
+
+static inline mat4_class_t mat4_affine_classify_ps( const mat4_affine_ps_t* a )
+{
+	/* (a.a, b.b, c.c) and (a.b, b.c, c.a) */
+	__m128 g1 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( a->x, a->x ), _mm_mul_ps( a->y, a->y ) ), _mm_mul_ps( a->z, a->z ) );
+	__m128 g2 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( a->x, _mm_shuffle_ps( a->x, a->x, _MM_SHUFFLE(3,0,2,1) ) ),
+	                                    _mm_mul_ps( a->y, _mm_shuffle_ps( a->y, a->y, _MM_SHUFFLE(3,0,2,1) ) ) ),
+	                                    _mm_mul_ps( a->z, _mm_shuffle_ps( a->z, a->z, _MM_SHUFFLE(3,0,2,1) ) ) );
+	const __m128 abs_mask = _mm_castsi128_ps( _mm_setr_epi32( 0x7fffffff, 0x7fffffff, 0x7fffffff, 0 ) );
+	__m128 e = _mm_add_ps( _mm_and_ps( _mm_sub_ps( g1, _mm_set1_ps( 1 ) ), abs_mask ), _mm_and_ps( g2, abs_mask ) );
+	e = _mm_add_ps( e, _mm_movehl_ps( e, e ) );
+	e = _mm_add_ss( e, _mm_shuffle_ps( e, e, _MM_SHUFFLE(1,1,1,1) ) );
+
+	return _mm_cvtss_f32( e ) <= 16 * SCALAR_EPSILON ? MAT4_CLASS_RIGID : MAT4_CLASS_AFFINE;
+}
+
+static inline void mat4_affine_invert_rigid_ps( mat4_t* m, const mat4_affine_ps_t* a )
+{
+	mat4_affine_store_ps( m, a->x, a->y, a->z, a->t );
+}
+
+static inline bool mat4_affine_invert_ps( mat4_t* m, const mat4_affine_ps_t* a )
+{
+	/* With the columns a, b and c spread across lanes, the rotated
+	 * copies give (b x c, c x a, a x b) one component at a time. These
+	 * are the columns of the adjugate. */
+	__m128 x1 = _mm_shuffle_ps( a->x, a->x, _MM_SHUFFLE(3,0,2,1) );
+	__m128 y1 = _mm_shuffle_ps( a->y, a->y, _MM_SHUFFLE(3,0,2,1) );
+	__m128 z1 = _mm_shuffle_ps( a->z, a->z, _MM_SHUFFLE(3,0,2,1) );
+	__m128 x2 = _mm_shuffle_ps( a->x, a->x, _MM_SHUFFLE(3,1,0,2) );
+	__m128 y2 = _mm_shuffle_ps( a->y, a->y, _MM_SHUFFLE(3,1,0,2) );
+	__m128 z2 = _mm_shuffle_ps( a->z, a->z, _MM_SHUFFLE(3,1,0,2) );
+	__m128 cx = _mm_sub_ps( _mm_mul_ps( y1, z2 ), _mm_mul_ps( z1, y2 ) );
+	__m128 cy = _mm_sub_ps( _mm_mul_ps( z1, x2 ), _mm_mul_ps( x1, z2 ) );
+	__m128 cz = _mm_sub_ps( _mm_mul_ps( x1, y2 ), _mm_mul_ps( y1, x2 ) );
+
+	/* a . (b x c) */
+	__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( a->x, cx ), _mm_mul_ps( a->y, cy ) ), _mm_mul_ps( a->z, cz ) );
+	scaler_t det = _mm_cvtss_f32( d );
+
+	if( scaler_abs(det) > SCALAR_EPSILON ) // testing if not zero
+	{
+		d = _mm_set1_ps( det );
+		mat4_affine_store_ps( m, _mm_div_ps( cx, d ), _mm_div_ps( cy, d ), _mm_div_ps( cz, d ), a->t );
+		return true;
+	}
+
+	return false;
+}
+#endif
+
+bool mat4_invert_affine( mat4_t* m )
+{
+	assert( m );
+	assert( mat4_is_affine( m ) );
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	mat4_affine_ps_t a = mat4_affine_load_ps( m );
+	return mat4_affine_invert_ps( m, &a );
+#else
+	const vec3_t a = VEC3( m->m[ 0], m->m[ 1], m->m[ 2] );
+	const vec3_t b = VEC3( m->m[ 4], m->m[ 5], m->m[ 6] );
+	const vec3_t c = VEC3( m->m[ 8], m->m[ 9], m->m[10] );
+	const vec3_t t = VEC3( m->m[12], m->m[13], m->m[14] );
+
+	/* The rows of the inverse of the upper 3x3 block are the cross
+	 * products of its columns divided by the determinant. */
+	vec3_t r0 = vec3_cross_product( &b, &c );
+	vec3_t r1 = vec3_cross_product( &c, &a );
+	vec3_t r2 = vec3_cross_product( &a, &b );
+	scaler_t det = vec3_dot_product( &a, &r0 );
+
+	if( scaler_abs(det) > SCALAR_EPSILON ) // testing if not zero
+	{
+		r0 = VEC3( r0.x / det, r0.y / det, r0.z / det );
+		r1 = VEC3( r1.x / det, r1.y / det, r1.z / det );
+		r2 = VEC3( r2.x / det, r2.y / det, r2.z / det );
+
+		*m = MAT4(
+			r0.x, r1.x, r2.x, 0,
+			r0.y, r1.y, r2.y, 0,
+			r0.z, r1.z, r2.z, 0,
+			-vec3_dot_product( &r0, &t ), -vec3_dot_product( &r1, &t ), -vec3_dot_product( &r2, &t ), 1
+		);
+		return true;
+	}
+
+	return false;
+#endif
+}
+
+void mat4_invert_rigid( mat4_t* m )
+{
+	assert( m );
+	assert( mat4_is_affine( m ) );
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	mat4_affine_ps_t a = mat4_affine_load_ps( m );
+	mat4_affine_invert_rigid_ps( m, &a );
+#else
+	const vec3_t a = VEC3( m->m[ 0], m->m[ 1], m->m[ 2] );
+	const vec3_t b = VEC3( m->m[ 4], m->m[ 5], m->m[ 6] );
+	const vec3_t c = VEC3( m->m[ 8], m->m[ 9], m->m[10] );
+	const vec3_t t = VEC3( m->m[12], m->m[13], m->m[14] );
+
+	/* The inverse of an orthonormal block is its transpose, so the
+	 * translation is the negated transpose applied to t. */
+	*m = MAT4(
+		a.x, b.x, c.x, 0,
+		a.y, b.y, c.y, 0,
+		a.z, b.z, c.z, 0,
+		-vec3_dot_product( &a, &t ), -vec3_dot_product( &b, &t ), -vec3_dot_product( &c, &t ), 1
+	);
+#endif
+}
+
+mat4_class_t mat4_classify( const mat4_t* m )
+{
+	assert( m );
+
+	if( !mat4_is_affine( m ) )
+	{
+		return MAT4_CLASS_GENERAL;
+	}
+
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	mat4_affine_ps_t a = mat4_affine_load_ps( m );
+	return mat4_affine_classify_ps( &a );
+#else
+	const vec3_t a = VEC3( m->m[ 0], m->m[ 1], m->m[ 2] );
+	const vec3_t b = VEC3( m->m[ 4], m->m[ 5], m->m[ 6] );
+	const vec3_t c = VEC3( m->m[ 8], m->m[ 9], m->m[10] );
+
+	/* The deviations from orthonormality are summed so that there is
+	 * only one comparison. */
+	scaler_t error = scaler_abs( vec3_dot_product( &a, &a ) - 1 ) +
+	                 scaler_abs( vec3_dot_product( &b, &b ) - 1 ) +
+	                 scaler_abs( vec3_dot_product( &c, &c ) - 1 ) +
+	                 scaler_abs( vec3_dot_product( &a, &b ) ) +
+	                 scaler_abs( vec3_dot_product( &a, &c ) ) +
+	                 scaler_abs( vec3_dot_product( &b, &c ) );
+
+	return error <= 16 * SCALAR_EPSILON ? MAT4_CLASS_RIGID : MAT4_CLASS_AFFINE;
+#endif
+}
+
+bool mat4_invert( mat4_t* m )
+{
+	assert( m );
+#if defined(M3D_SIMD_FLOAT_SSE2) || defined(M3D_SIMD_FLOAT_AVX)
+	if( mat4_is_affine( m ) )
+	{
+		/* Load the block once for both the classification and the
+		 * inverse. */
+		mat4_affine_ps_t a = mat4_affine_load_ps( m );
+
+		if( mat4_affine_classify_ps( &a ) == MAT4_CLASS_RIGID )
+		{
+			mat4_affine_invert_rigid_ps( m, &a );
+			return true;
+		}
+
+		return mat4_affine_invert_ps( m, &a );
+	}
+
+	return mat4_invert_general( m );
+#else
+	switch( mat4_classify( m ) )
+	{
+		case MAT4_CLASS_RIGID:
+			mat4_invert_rigid( m );
+			return true;
+		case MAT4_CLASS_AFFINE:
+			return mat4_invert_affine( m );
+		default:
+			return mat4_invert_general( m );
+	}
+#endif
+}
+
 void mat4_transpose( mat4_t* m )
 {
     assert( m );
@@ -286,11 +905,11 @@ mat4_t mat4_from_axis3_angle( const vec3_t* axis, scaler_t angle )
 	);
 }
 
-const char* mat4_to_string( const mat4_t* m )
+size_t mat4_to_string_r( const mat4_t* m, char* buffer, size_t size )
 {
-	static char string_buffer[ 128 ];
+	int length;
 	#if defined(LIBM3D_USE_LONG_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-6.2Lf %-6.2Lf %-6.2Lf %6.2Lf|\n"
 		"|%-6.2Lf %-6.2Lf %-6.2Lf %6.2Lf|\n"
 		"|%-6.2Lf %-6.2Lf %-6.2Lf %6.2Lf|\n"
@@ -301,7 +920,7 @@ const char* mat4_to_string( const mat4_t* m )
 		m->m[ 3], m->m[ 7], m->m[11], m->m[15]
  	);
 	#elif defined(LIBM3D_USE_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-6.2lf %-6.2lf %-6.2lf %6.2lf|\n"
 		"|%-6.2lf %-6.2lf %-6.2lf %6.2lf|\n"
 		"|%-6.2lf %-6.2lf %-6.2lf %6.2lf|\n"
@@ -312,7 +931,7 @@ const char* mat4_to_string( const mat4_t* m )
 		m->m[ 3], m->m[ 7], m->m[11], m->m[15]
  	);
 	#else
-	snprintf( string_buffer, sizeof(string_buffer) - 1,
+	length = snprintf( buffer, size,
 		"|%-6.2f %-6.2f %-6.2f %6.2f|\n"
 		"|%-6.2f %-6.2f %-6.2f %6.2f|\n"
 		"|%-6.2f %-6.2f %-6.2f %6.2f|\n"
@@ -323,10 +942,21 @@ const char* mat4_to_string( const mat4_t* m )
 		m->m[ 3], m->m[ 7], m->m[11], m->m[15]
  	);
 	#endif
-	string_buffer[ sizeof(string_buffer) - 1 ] = '\0';
+	return length < 0 ? 0 : (size_t) length;
+}
+
+const char* mat4_to_string( const mat4_t* m )
+{
+	static _Thread_local char string_buffer[ 128 ];
+	mat4_to_string_r( m, string_buffer, sizeof(string_buffer) );
 	return string_buffer;
 }
 
+size_t mat4_format( char* restrict buffer, size_t size, const mat4_t* restrict m, size_t count, int precision, size_t* restrict length )
+{
+	return m3d_format_elements( buffer, size, (const scaler_t*) m, sizeof(mat4_t) / sizeof(scaler_t), count, 4, 4, precision, length );
+}
+
 #if 0
 const vec4_t* mat4_x_vector( const mat4_t* m )
 {
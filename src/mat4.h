@@ -22,6 +22,7 @@
 #define _MAT4_H_
 #include <float.h>
 #include <limits.h>
+#include <stddef.h>
 #if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
 #include <stdbool.h>
 #else
@@ -52,17 +53,62 @@ extern const mat4_t MAT4_ZERO;
  */
 #define MAT4(A,B,C,D,E,F,G,H,I,J,K,L,M,N,O,P)  ((mat4_t){ .m = { (A), (B), (C), (D), (E), (F), (G), (H), (I), (J), (K), (L), (M), (N), (O), (P) } })
 
+/*
+ * The cheapest correct inverse of a matrix depends on its structure.
+ * Rigid matrices (affine with an orthonormal upper 3x3 block, within a
+ * few epsilons) are inverted with a transpose, affine matrices with a 3x3
+ * inverse, and anything else with the general 4x4 inverse.
+ */
+typedef enum mat4_class {
+	MAT4_CLASS_GENERAL = 0,
+	MAT4_CLASS_AFFINE,
+	MAT4_CLASS_RIGID,
+} mat4_class_t;
+
 void        mat4_identity         ( mat4_t* m );
 void        mat4_zero             ( mat4_t* m );
 scaler_t    mat4_determinant      ( const mat4_t* m );
 mat4_t      mat4_mult_matrix      ( const mat4_t* restrict a, const mat4_t* restrict b );
 vec4_t      mat4_mult_vector      ( const mat4_t* restrict m, const vec4_t* restrict v );
-bool        mat4_invert           ( mat4_t* m );
+bool        mat4_invert           ( mat4_t* m ); /* picks a path with mat4_classify() */
+bool        mat4_invert_general   ( mat4_t* m );
+bool        mat4_invert_affine    ( mat4_t* m ); /* m must be affine */
+void        mat4_invert_rigid     ( mat4_t* m ); /* m must be rigid */
+mat4_class_t mat4_classify        ( const mat4_t* m );
 void        mat4_transpose        ( mat4_t* m );
 mat4_t      mat4_cofactor         ( const mat4_t* m );
 void        mat4_adjoint          ( mat4_t* m );
 mat4_t      mat4_from_axis3_angle ( const vec3_t* axis, scaler_t angle );
-const char* mat4_to_string        ( const mat4_t* m );
+const char* mat4_to_string        ( const mat4_t* m ); /* uses a thread-local buffer */
+size_t      mat4_to_string_r      ( const mat4_t* m, char* buffer, size_t size ); /* returns the length like snprintf() */
+bool        mat4_is_affine        ( const mat4_t* m ); /* bottom row is (0, 0, 0, 1) */
+
+/*
+ * Writes count matrices as "[a, b, c, d; ...]" in row order, one per
+ * line, with precision decimals (at most 9). This does not use snprintf()
+ * and is meant for dumping large arrays. Only whole matrices are written
+ * and the buffer is always terminated. Returns the number of matrices
+ * written and stores the number of characters in length (if not NULL).
+ */
+size_t      mat4_format           ( char* restrict buffer, size_t size, const mat4_t* restrict m, size_t count, int precision, size_t* restrict length );
+
+/*
+ * Bulk Transforms
+ *
+ * Strides are in bytes and a stride of zero means the elements are tightly
+ * packed. This allows, for example, transforming the positions inside an
+ * interleaved vertex buffer. The output may be the same buffer as the input
+ * (with the same stride) but must not partially overlap it.
+ *
+ * Points are transformed with w = 1 and divided by the resulting w, unless
+ * the matrix is affine. Vectors are transformed with w = 0. Normals are
+ * transformed by the inverse transpose of the upper 3x3 block and then
+ * normalized.
+ */
+void        mat4_transform_points3  ( const mat4_t* m, vec3_t* out, size_t out_stride, const vec3_t* in, size_t in_stride, size_t count );
+void        mat4_transform_vectors3 ( const mat4_t* m, vec3_t* out, size_t out_stride, const vec3_t* in, size_t in_stride, size_t count );
+void        mat4_transform_normals3 ( const mat4_t* m, vec3_t* out, size_t out_stride, const vec3_t* in, size_t in_stride, size_t count );
+void        mat4_transform_vectors4 ( const mat4_t* m, vec4_t* out, size_t out_stride, const vec4_t* in, size_t in_stride, size_t count );
 
 #define mat4_x_vector( p_m )   ((vec4_t*) &(p_m)->m[0])
 #define mat4_y_vector( p_m )   ((vec4_t*) &(p_m)->m[4])
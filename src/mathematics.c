@@ -21,154 +21,77 @@
 #include <stdlib.h>
 #include <math.h>
 #include "mathematics.h"
+#include "random.h"
 
+/* These use the calling thread's generator from random.h. */
 int m3d_uniformi( void )
 {
-	return rand( );
+	return (int) (m3d_random_next( m3d_random_default() ) >> 33);
 }
 
 float m3d_uniformf( void )
 {
-	return ((float)rand( )) / RAND_MAX;
+	return m3d_random_uniformf( m3d_random_default() );
 }
 
 double m3d_uniformd( void )
 {
-	return ((double)rand( )) / RAND_MAX;
+	return m3d_random_uniformd( m3d_random_default() );
 }
 
 long double m3d_uniformld( void )
 {
-	return ((long double)rand( )) / RAND_MAX;
+	return m3d_random_uniformld( m3d_random_default() );
 }
 
 int m3d_uniform_rangei( int min, int max )
 {
-	int diff = max - min;
-	return min + rand() % (diff + 1);
+	return m3d_random_rangei( m3d_random_default(), min, max );
 }
 
 long m3d_uniform_rangel( long min, long max )
 {
-	long diff = max - min;
-	return min + rand() % (diff + 1);
+	return m3d_random_rangel( m3d_random_default(), min, max );
 }
 
 float m3d_uniform_rangef( float min, float max )
 {
-	float diff = max - min;
-	return min + m3d_uniformf() * diff;
+	return m3d_random_rangef( m3d_random_default(), min, max );
 }
 
 double m3d_uniform_ranged( double min, double max )
 {
-	double diff = max - min;
-	return min + m3d_uniformd() * diff;
+	return m3d_random_ranged( m3d_random_default(), min, max );
 }
 
 float m3d_uniform_unitf( void )
 {
-	return 2 * (((float)rand()) / RAND_MAX) - 1;
+	return m3d_random_unitf( m3d_random_default() );
 }
 
 double m3d_uniform_unitd( void )
 {
-	return 2 * (((double)rand()) / RAND_MAX) - 1;
+	return m3d_random_unitd( m3d_random_default() );
 }
 
 long double m3d_uniform_unitld( void )
 {
-	return 2 * (((long double)rand()) / RAND_MAX) - 1;
+	return m3d_random_unitld( m3d_random_default() );
 }
 
 float m3d_guassianf( float mean, float stddev )
 {
-	float ux;
-	float uy;
-	float s;
-	static float spare;
-	static bool spare_ready = false;
-
-	if( spare_ready )
-	{
-		spare_ready = false;
-		return mean + stddev * spare;
-	}
-	else
-	{
-		do {
-			ux = m3d_uniformf( ) * 2.0f - 1;
-			uy = m3d_uniformf( ) * 2.0f - 1;
-			s = ux * ux + uy * uy;
-		} while( s >= 1.0f || s <= 0.0f );
-
-		float mul = sqrtf( -2.0f * logf(s) / s );
-
-		spare = uy * mul;
-		spare_ready = true;
-
-		return mean + stddev * ux * mul;
-	}
+	return m3d_random_guassianf( m3d_random_default(), mean, stddev );
 }
 
 double m3d_guassiand( double mean, double stddev )
 {
-	double ux;
-	double uy;
-	double s;
-	static double spare;
-	static bool spare_ready = false;
-
-	if( spare_ready )
-	{
-		spare_ready = false;
-		return mean + stddev * spare;
-	}
-	else
-	{
-		do {
-			ux = m3d_uniformd( ) * 2.0 - 1;
-			uy = m3d_uniformd( ) * 2.0 - 1;
-			s = ux * ux + uy * uy;
-		} while( s >= 1.0f || s <= 0.0f );
-
-		double mul = sqrt( -2.0f * log(s) / s );
-
-		spare = uy * mul;
-		spare_ready = true;
-
-		return mean + stddev * ux * mul;
-	}
+	return m3d_random_guassiand( m3d_random_default(), mean, stddev );
 }
 
 long double m3d_guassianld( long double mean, long double stddev )
 {
-	long double ux;
-	long double uy;
-	long double s;
-	static long double spare;
-	static bool spare_ready = false;
-
-	if( spare_ready )
-	{
-		spare_ready = false;
-		return mean + stddev * spare;
-	}
-	else
-	{
-		do {
-			ux = m3d_uniformld( ) * 2.0 - 1;
-			uy = m3d_uniformld( ) * 2.0 - 1;
-			s = ux * ux + uy * uy;
-		} while( s >= 1.0f || s <= 0.0f );
-
-		long double mul = sqrtl( -2.0f * log(s) / s );
-
-		spare = uy * mul;
-		spare_ready = true;
-
-		return mean + stddev * ux * mul;
-	}
+	return m3d_random_guassianld( m3d_random_default(), mean, stddev );
 }
 
 int m3d_maxi( int x, int y )
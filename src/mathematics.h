@@ -43,6 +43,7 @@
 #endif
 #include <math.h>
 #include <float.h>
+#include <stdint.h>
 #if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
 # include <stdbool.h>
 #else
@@ -89,19 +90,20 @@ extern "C" {
 #define m3d_integer_max( x, y )    ((x) ^ (((x) ^ (y)) & -((x) < (y))))
 #define m3d_integer_min( x, y )    ((y) ^ (((x) ^ (y)) & -((x) < (y))))
 
-float         m3d_uniformf           ( void ); /* [0.0f, 1.0f] */
-double        m3d_uniformd           ( void ); /* [0.0, 1.0] */
-long double   m3d_uniformld          ( void ); /* [0.0, 1.0] */
-int           m3d_uniform_rangei     ( int min, int max ); /* [min. max] */
-long          m3d_uniform_rangel     ( long min, long max ); /* [min. max] */
-float         m3d_uniform_rangef     ( float min, float max ); /* [min. max] */
-double        m3d_uniform_ranged     ( double min, double max ); /* [min. max] */
-float         m3d_uniform_unitf      ( void ); /* [-1.0f, 1.0f]; */
-double        m3d_uniform_unitd      ( void ); /* [-1.0, 1.0]; */
-long double   m3d_uniform_unitld     ( void ); /* [-1.0, 1.0]; */
+float         m3d_uniformf           ( void ); /* [0.0f, 1.0f) */
+double        m3d_uniformd           ( void ); /* [0.0, 1.0) */
+long double   m3d_uniformld          ( void ); /* [0.0, 1.0) */
+int           m3d_uniform_rangei     ( int min, int max ); /* [min, max] */
+long          m3d_uniform_rangel     ( long min, long max ); /* [min, max] */
+float         m3d_uniform_rangef     ( float min, float max ); /* [min, max) */
+double        m3d_uniform_ranged     ( double min, double max ); /* [min, max) */
+float         m3d_uniform_unitf      ( void ); /* [-1.0f, 1.0f) */
+double        m3d_uniform_unitd      ( void ); /* [-1.0, 1.0) */
+long double   m3d_uniform_unitld     ( void ); /* [-1.0, 1.0) */
 float         m3d_guassianf          ( float mean, float stddev );
 double        m3d_guassiand          ( double mean, double stddev );
 long double   m3d_guassianld         ( long double mean, long double stddev );
+void          m3d_seed               ( uint64_t seed ); /* see random.h */
 int           m3d_maxi               ( int x, int y );
 long          m3d_maxl               ( long x, long y );
 float         m3d_maxf               ( float x, float y );
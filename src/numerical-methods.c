@@ -19,9 +19,10 @@
  * THE SOFTWARE.
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
 #include "numerical-methods.h"
-#include "mat2.h"
-#include "mat3.h"
 
 bool m3d_bissection_method( double a, double b, double epsilon, size_t iterations, double (*f)(double x), double* root )
 {
@@ -120,46 +121,581 @@ bool m3d_secant_method( double a, double b, double epsilon, size_t iterations, d
 	return found;
 }
 
-void m3d_least_squares_linear( const double x[], const double y[], size_t count, double* m, double* b )
+bool m3d_brent_method( double a, double b, double epsilon, size_t iterations, double (*f)(double x), double* root, m3d_root_stats_t* stats )
+{
+	m3d_root_stats_t counts = { 0, 2, 0 };
+	bool found    = false;
+	double f_of_a = f( a );
+	double f_of_b = f( b );
+
+	if( f_of_a == 0.0 )
+	{
+		*root = a;
+		found = true;
+	}
+	else if( f_of_a * f_of_b <= 0.0 )
+	{
+		/* The root is between b, the best estimate, and c. a is the
+		 * previous value of b. */
+		double c      = a;
+		double f_of_c = f_of_a;
+		double step   = b - a;
+		double last   = step;
+
+		for( size_t i = 0; !found && i < iterations; i++ )
+		{
+			counts.iterations++;
+
+			if( (f_of_b > 0.0) == (f_of_c > 0.0) )
+			{
+				c      = a;
+				f_of_c = f_of_a;
+				step   = b - a;
+				last   = step;
+			}
+
+			if( fabs(f_of_c) < fabs(f_of_b) )
+			{
+				a      = b;
+				b      = c;
+				c      = a;
+				f_of_a = f_of_b;
+				f_of_b = f_of_c;
+				f_of_c = f_of_a;
+			}
+
+			double tolerance = 2.0 * DBL_EPSILON * fabs(b) + 0.5 * epsilon;
+			double middle    = 0.5 * (c - b);
+
+			if( fabs(middle) <= tolerance || f_of_b == 0.0 )
+			{
+				*root = b;
+				found = true;
+			}
+			else
+			{
+				if( fabs(last) >= tolerance && fabs(f_of_a) > fabs(f_of_b) )
+				{
+					double s = f_of_b / f_of_a;
+					double p;
+					double q;
+
+					if( a == c )
+					{
+						/* Secant */
+						p = 2.0 * middle * s;
+						q = 1.0 - s;
+					}
+					else
+					{
+						/* Inverse quadratic interpolation */
+						double r = f_of_b / f_of_c;
+						q = f_of_a / f_of_c;
+						p = s * (2.0 * middle * q * (q - r) - (b - a) * (r - 1.0));
+						q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+					}
+
+					if( p > 0.0 )
+					{
+						q = -q;
+					}
+					else
+					{
+						p = -p;
+					}
+
+					/* Accept the step if it stays well inside the interval
+					 * and is less than half of the step before last. */
+					double limit = fmin( 3.0 * middle * q - fabs(tolerance * q), fabs(last * q) );
+
+					if( 2.0 * p < limit )
+					{
+						last = step;
+						step = p / q;
+					}
+					else
+					{
+						step = middle;
+						last = middle;
+					}
+				}
+				else
+				{
+					step = middle;
+					last = middle;
+				}
+
+				a      = b;
+				f_of_a = f_of_b;
+				b     += fabs(step) > tolerance ? step : copysign( tolerance, middle );
+				f_of_b = f( b );
+				counts.evaluations++;
+			}
+		}
+	}
+
+	if( stats )
+	{
+		*stats = counts;
+	}
+
+	return found;
+}
+
+bool m3d_brent_method_max_precision( double a, double b, double (*f)(double x), double* root, m3d_root_stats_t* stats )
+{
+	return m3d_brent_method( a, b, DBL_EPSILON, 100, f, root, stats );
+}
+
+/*
+ * Both Newton-Raphson variants share this, with either f and df or fdf.
+ */
+static bool newton_raphson_method( double a, double b, double epsilon, size_t iterations,
+                                   double (*f)(double x), double (*df)(double x),
+                                   void (*fdf)(double x, double* f, double* df),
+                                   double* root, m3d_root_stats_t* stats )
+{
+	m3d_root_stats_t counts = { 0, 2, 0 };
+	bool found = false;
+	double f_of_a;
+	double f_of_b;
+	double slope;
+
+	if( fdf )
+	{
+		fdf( a, &f_of_a, &slope );
+		fdf( b, &f_of_b, &slope );
+		counts.derivatives += 2;
+	}
+	else
+	{
+		f_of_a = f( a );
+		f_of_b = f( b );
+	}
+
+	if( f_of_a == 0.0 )
+	{
+		*root = a;
+		found = true;
+	}
+	else if( f_of_b == 0.0 )
+	{
+		*root = b;
+		found = true;
+	}
+	else if( f_of_a * f_of_b < 0.0 )
+	{
+		/* Keep f(low) < 0 < f(high). */
+		double low  = f_of_a < 0.0 ? a : b;
+		double high = f_of_a < 0.0 ? b : a;
+		double x    = 0.5 * (a + b);
+		double step = fabs(b - a);
+		double last = step;
+		double f_of_x;
+
+		if( fdf )
+		{
+			fdf( x, &f_of_x, &slope );
+		}
+		else
+		{
+			f_of_x = f( x );
+			slope  = df( x );
+		}
+		counts.evaluations++;
+		counts.derivatives++;
+
+		if( f_of_x == 0.0 )
+		{
+			*root = x;
+			found = true;
+		}
+		else if( f_of_x < 0.0 )
+		{
+			low = x;
+		}
+		else
+		{
+			high = x;
+		}
+
+		for( size_t i = 0; !found && i < iterations; i++ )
+		{
+			double previous = x;
+			counts.iterations++;
+
+			/* Take the Newton step only if it lands inside the interval
+			 * and is less than half of the step before last. The test is
+			 * written so that a NaN slope bisects. */
+			if( ((x - high) * slope - f_of_x) * ((x - low) * slope - f_of_x) < 0.0 &&
+			    fabs(2.0 * f_of_x) <= fabs(last * slope) )
+			{
+				last = step;
+				step = f_of_x / slope;
+				x   -= step;
+			}
+			else
+			{
+				last = step;
+				step = 0.5 * (high - low);
+				x    = low + step;
+			}
+
+			if( fabs(step) < epsilon || x == previous )
+			{
+				*root = x;
+				found = true;
+			}
+			else
+			{
+				if( fdf )
+				{
+					fdf( x, &f_of_x, &slope );
+				}
+				else
+				{
+					f_of_x = f( x );
+					slope  = df( x );
+				}
+				counts.evaluations++;
+				counts.derivatives++;
+
+				if( f_of_x == 0.0 )
+				{
+					*root = x;
+					found = true;
+				}
+				else if( f_of_x < 0.0 )
+				{
+					low = x;
+				}
+				else
+				{
+					high = x;
+				}
+			}
+		}
+	}
+
+	if( stats )
+	{
+		*stats = counts;
+	}
+
+	return found;
+}
+
+bool m3d_newton_raphson_method( double a, double b, double epsilon, size_t iterations, double (*f)(double x), double (*df)(double x), double* root, m3d_root_stats_t* stats )
+{
+	return newton_raphson_method( a, b, epsilon, iterations, f, df, NULL, root, stats );
+}
+
+bool m3d_newton_raphson_method_fdf( double a, double b, double epsilon, size_t iterations, void (*fdf)(double x, double* f, double* df), double* root, m3d_root_stats_t* stats )
+{
+	return newton_raphson_method( a, b, epsilon, iterations, NULL, NULL, fdf, root, stats );
+}
+
+/*
+ * Batch Root Finding
+ *
+ * The state of the equations that are still being solved is kept in
+ * arrays, packed at the front. After each evaluation one pass updates every
+ * equation, writes its root and status, and moves the equations that are
+ * not done down over the ones that are. The writes do not depend on
+ * whether an equation is done, so the pass has no branches; the root and
+ * status of an equation that is not done are written again later. Moving
+ * an equation from k down to w <= k reads it before anything is written
+ * at k.
+ */
+#define ROOT_BATCH_ARRAYS    (6)
+
+size_t m3d_root_batch_workspace_size( size_t count )
+{
+	/* The doubles come first so that every array is aligned. */
+	return count * (ROOT_BATCH_ARRAYS * sizeof(double) + sizeof(size_t));
+}
+
+static void* root_batch_workspace( size_t count, void* workspace, void** allocated )
+{
+	*allocated = NULL;
+	if( !workspace )
+	{
+		workspace = *allocated = malloc( m3d_root_batch_workspace_size( count ) );
+	}
+	return workspace;
+}
+
+bool m3d_bissection_method_batch( const double a[], const double b[], size_t count, double epsilon, size_t iterations, m3d_batch_function_t f, void* context, double roots[], m3d_root_status_t status[], void* workspace )
+{
+	void* allocated;
+	if( count == 0 )
+	{
+		return true;
+	}
+	if( !(workspace = root_batch_workspace( count, workspace, &allocated )) )
+	{
+		return false;
+	}
+
+	double* lo        = workspace;
+	double* hi        = lo + count;
+	double* f_of_lo   = hi + count;
+	double* x         = f_of_lo + count;
+	double* y         = x + count;
+	size_t* equations = (size_t*) (y + 2 * count);
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		equations[ i ] = i;
+		lo[ i ]        = a[ i ];
+		hi[ i ]        = b[ i ];
+		roots[ i ]     = a[ i ] + (b[ i ] - a[ i ]) / 2.0;
+		status[ i ]    = M3D_ROOT_MAX_ITERATIONS;
+	}
+
+	f( lo, f_of_lo, count, equations, context );
+
+	size_t active = count;
+	for( size_t i = 0; active > 0 && i < iterations; i++ )
+	{
+		for( size_t k = 0; k < active; k++ )
+		{
+			x[ k ] = lo[ k ] + (hi[ k ] - lo[ k ]) / 2.0;
+		}
+
+		f( x, y, active, equations, context );
+
+		size_t w = 0;
+		for( size_t k = 0; k < active; k++ )
+		{
+			const size_t e         = equations[ k ];
+			const bool   converged = fabs( y[ k ] ) < epsilon;
+			const bool   stalled   = !converged && fabs( (hi[ k ] - lo[ k ]) / 2.0 ) < epsilon;
+			const bool   raise     = f_of_lo[ k ] * y[ k ] > 0.0;
+
+			roots[ e ]  = x[ k ];
+			status[ e ] = converged ? M3D_ROOT_CONVERGED : (stalled ? M3D_ROOT_STALLED : M3D_ROOT_MAX_ITERATIONS);
+
+			equations[ w ] = e;
+			f_of_lo[ w ]   = raise ? y[ k ] : f_of_lo[ k ];
+			hi[ w ]        = raise ? hi[ k ] : x[ k ];
+			lo[ w ]        = raise ? x[ k ] : lo[ k ];
+			w += !converged && !stalled;
+		}
+		active = w;
+	}
+
+	free( allocated );
+	return true;
+}
+
+bool m3d_fixed_point_iteration_batch( const double estimates[], size_t count, double epsilon, size_t iterations, m3d_batch_function_t g, void* context, double roots[], m3d_root_status_t status[], void* workspace )
+{
+	void* allocated;
+	if( count == 0 )
+	{
+		return true;
+	}
+	if( !(workspace = root_batch_workspace( count, workspace, &allocated )) )
+	{
+		return false;
+	}
+
+	double* x         = workspace;
+	double* y         = x + count;
+	size_t* equations = (size_t*) (x + ROOT_BATCH_ARRAYS * count);
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		equations[ i ] = i;
+		x[ i ]         = estimates[ i ];
+		roots[ i ]     = estimates[ i ];
+		status[ i ]    = M3D_ROOT_MAX_ITERATIONS;
+	}
+
+	size_t active = count;
+	for( size_t i = 0; active > 0 && i < iterations; i++ )
+	{
+		g( x, y, active, equations, context );
+
+		size_t w = 0;
+		for( size_t k = 0; k < active; k++ )
+		{
+			const size_t e         = equations[ k ];
+			const double p         = y[ k ];
+			const bool   converged = fabs( p - x[ k ] ) < epsilon;
+			const bool   finite    = isfinite( p );
+
+			roots[ e ]  = finite ? p : x[ k ];
+			status[ e ] = converged ? M3D_ROOT_CONVERGED : (finite ? M3D_ROOT_MAX_ITERATIONS : M3D_ROOT_NOT_FINITE);
+
+			equations[ w ] = e;
+			x[ w ]         = p;
+			w += !converged && finite;
+		}
+		active = w;
+	}
+
+	free( allocated );
+	return true;
+}
+
+bool m3d_secant_method_batch( const double a[], const double b[], size_t count, double epsilon, size_t iterations, m3d_batch_function_t f, void* context, double roots[], m3d_root_status_t status[], void* workspace )
 {
-	double alpha = 0.0;
-	double beta  = 0.0;
-	double gamma = 0.0;
-	double delta = 0.0;
+	void* allocated;
+	if( count == 0 )
+	{
+		return true;
+	}
+	if( !(workspace = root_batch_workspace( count, workspace, &allocated )) )
+	{
+		return false;
+	}
+
+	/* x0 and x1 are the last two estimates, a and b in the scalar method,
+	 * and f0 and f1 are alpha and beta. */
+	double* x0        = workspace;
+	double* f0        = x0 + count;
+	double* x1        = f0 + count;
+	double* f1        = x1 + count;
+	size_t* equations = (size_t*) (x0 + ROOT_BATCH_ARRAYS * count);
 
 	for( size_t i = 0; i < count; i++ )
 	{
-		alpha += x[ i ];
-		beta  += x[ i ] * x[ i ];
-		gamma += y[ i ];
-		delta += x[ i ] * y[ i ];
+		equations[ i ] = i;
+		x0[ i ]        = a[ i ];
+		x1[ i ]        = b[ i ];
+		roots[ i ]     = b[ i ];
+		status[ i ]    = M3D_ROOT_MAX_ITERATIONS;
 	}
 
+	f( x0, f0, count, equations, context );
+	f( x1, f1, count, equations, context );
+
+	size_t active = count;
+	for( size_t i = 0; active > 0 && i < iterations; i++ )
+	{
+		/* The scalar method evaluates the new estimate at the end of an
+		 * iteration. Doing it at the start of the next one saves the
+		 * evaluation after the last iteration. */
+		if( i > 0 )
+		{
+			f( x1, f1, active, equations, context );
+		}
+
+		size_t w = 0;
+		for( size_t k = 0; k < active; k++ )
+		{
+			const size_t e         = equations[ k ];
+			const double p         = x1[ k ] - f1[ k ] * (x1[ k ] - x0[ k ]) / (f1[ k ] - f0[ k ]);
+			const bool   converged = fabs( p - x1[ k ] ) < epsilon;
+			const bool   finite    = isfinite( p );
+
+			roots[ e ]  = finite ? p : x1[ k ];
+			status[ e ] = converged ? M3D_ROOT_CONVERGED : (finite ? M3D_ROOT_MAX_ITERATIONS : M3D_ROOT_NOT_FINITE);
+
+			equations[ w ] = e;
+			x0[ w ]        = x1[ k ];
+			f0[ w ]        = f1[ k ];
+			x1[ w ]        = p;
+			w += !converged && finite;
+		}
+		active = w;
+	}
+
+	free( allocated );
+	return true;
+}
+
+/*
+ * The sums of the linear and quadratic fits, with dx = x - x0 and
+ * dy = y - y0 about some point (x0, y0): the sums of dx, dx^2, dx^3, dx^4,
+ * dy, dx dy, dx^2 dy and dy^2.
+ */
+enum least_squares_sum {
+	SUM_X = 0,
+	SUM_XX,
+	SUM_XXX,
+	SUM_XXXX,
+	SUM_Y,
+	SUM_XY,
+	SUM_XXY,
+	SUM_YY,
+};
+
+static bool least_squares_quadratic_fit( const double sums[], double count, double mean_x, double mean_y, double* a, double* b, double* c );
+
+/* The means of x and y, for fits about the mean. */
+static void least_squares_means( const double x[], const double y[], size_t count, double* mean_x, double* mean_y )
+{
+	double sx[ 8 ] = { 0.0 };
+	double sy[ 8 ] = { 0.0 };
+	size_t i = 0;
+
+	for( ; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			sx[ k ] += x[ i + k ];
+			sy[ k ] += y[ i + k ];
+		}
+	}
+	for( size_t k = 1; k < 8; k++ )
+	{
+		sx[ 0 ] += sx[ k ];
+		sy[ 0 ] += sy[ k ];
+	}
+	for( ; i < count; i++ )
+	{
+		sx[ 0 ] += x[ i ];
+		sy[ 0 ] += y[ i ];
+	}
+
+	*mean_x = sx[ 0 ] / count;
+	*mean_y = sy[ 0 ] / count;
+}
+
+void m3d_least_squares_linear( const double x[], const double y[], size_t count, double* m, double* b )
+{
 	/* A * c = y  <==>  transpose(A) * A * c = transpose(A) * y)
 	 * where:
 	 *       * c is the vector of coefficients in y_i = c_0 + c_1 * x_i
 	 *       * y is the vector y values y = (y_0, y_1, ..., y_n)
 	 *       * A is the n * 2 matrix of [ 1, x ] where x = (x_0, x_1, ..., x_n)
-	 */
-#if 0
-	mat2_t Q_inverse = MAT2( // inverse(Q) where Q = transpose(A) * A
-		alpha, (double) count,
-		beta,  alpha
-	);
-	mat2_invert(&Q_inverse);
-
-	double P[] = {
-		delta,
-		gamma
-	};
+	 *
+	 * About the mean of x and y, transpose(A) * A is diagonal. Sums of the
+	 * raw powers would lose the spread of x when x is far from zero. */
+	double mean_x;
+	double mean_y;
+	double xx[ 8 ] = { 0.0 };
+	double xy[ 8 ] = { 0.0 };
+	size_t i = 0;
 
-	*b = Q_inverse.m[0] * P[0] + Q_inverse.m[2] * P[1];
-	*m = Q_inverse.m[1] * P[0] + Q_inverse.m[3] * P[1];
-#else
-	double determinant = alpha * alpha - ((double)count) * beta;
-	*b = (delta * alpha - gamma * beta) / determinant;
-	*m = (-delta * ((double)count) + gamma * alpha) / determinant;
-#endif
+	least_squares_means( x, y, count, &mean_x, &mean_y );
+
+	for( ; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			const double dx = x[ i + k ] - mean_x;
+			xx[ k ] += dx * dx;
+			xy[ k ] += dx * (y[ i + k ] - mean_y);
+		}
+	}
+	for( size_t k = 1; k < 8; k++ )
+	{
+		xx[ 0 ] += xx[ k ];
+		xy[ 0 ] += xy[ k ];
+	}
+	for( ; i < count; i++ )
+	{
+		const double dx = x[ i ] - mean_x;
+		xx[ 0 ] += dx * dx;
+		xy[ 0 ] += dx * (y[ i ] - mean_y);
+	}
+
+	*m = xy[ 0 ] / xx[ 0 ];
+	*b = mean_y - *m * mean_x;
 }
 
 double m3d_least_squares_linear_error( const double x[], const double y[], size_t count, double m, double b )
@@ -177,40 +713,59 @@ double m3d_least_squares_linear_error( const double x[], const double y[], size_
 
 void m3d_least_squares_quadratic( const double x[], const double y[], size_t count, double* a, double* b, double* c )
 {
-	double alpha   = 0.0;
-	double beta    = 0.0;
-	double gamma   = 0.0;
-	double delta   = 0.0;
-	double epsilon = 0.0;
-	double zeta    = 0.0;
-	double eta     = 0.0;
+	/* The sums are about the mean, as in m3d_least_squares_linear(), and
+	 * the fit is that of the streaming accumulators. */
+	double mean_x;
+	double mean_y;
+	double partial[ SUM_YY ][ 8 ] = { { 0.0 } };
+	double sums[ M3D_LEAST_SQUARES_SUMS ] = { 0.0 };
+	size_t i = 0;
 
-	for( size_t i = 0; i < count; i++ )
-	{
-		double x_sqr = x[ i ] * x[ i ];
-		double x_cub = x_sqr * x[ i ];
+	least_squares_means( x, y, count, &mean_x, &mean_y );
 
-		alpha   += x[ i ];
-		beta    += x_sqr;
-		gamma   += x_cub;
-		delta   += x_cub * x[ i ];
-		epsilon += y[ i ];
-		zeta    += y[ i ] * x[ i ];
-		eta     += y[ i ] * x_sqr;
+	for( ; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			const double dx  = x[ i + k ] - mean_x;
+			const double dy  = y[ i + k ] - mean_y;
+			const double dx2 = dx * dx;
+			partial[ SUM_X ][ k ]    += dx;
+			partial[ SUM_XX ][ k ]   += dx2;
+			partial[ SUM_XXX ][ k ]  += dx2 * dx;
+			partial[ SUM_XXXX ][ k ] += dx2 * dx2;
+			partial[ SUM_Y ][ k ]    += dy;
+			partial[ SUM_XY ][ k ]   += dx * dy;
+			partial[ SUM_XXY ][ k ]  += dx2 * dy;
+		}
+	}
+	for( size_t j = 0; j < SUM_YY; j++ )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			sums[ j ] += partial[ j ][ k ];
+		}
+	}
+	for( ; i < count; i++ )
+	{
+		const double dx  = x[ i ] - mean_x;
+		const double dy  = y[ i ] - mean_y;
+		const double dx2 = dx * dx;
+		sums[ SUM_X ]    += dx;
+		sums[ SUM_XX ]   += dx2;
+		sums[ SUM_XXX ]  += dx2 * dx;
+		sums[ SUM_XXXX ] += dx2 * dx2;
+		sums[ SUM_Y ]    += dy;
+		sums[ SUM_XY ]   += dx * dy;
+		sums[ SUM_XXY ]  += dx2 * dy;
 	}
 
-	mat3_t Q_inverse = MAT3( // inverse(Q) where Q = transpose(A) * A
-		beta, alpha, (double)count,
-		gamma, beta, alpha,
-		delta, gamma, beta
-	);
-	mat3_invert(&Q_inverse);
-
-	vec3_t p = VEC3( eta, zeta, epsilon ); // p = transpose(A) * y
-	vec3_t coefficients = mat3_mult_vector( &Q_inverse, &p);
-	*a = coefficients.z;
-	*b = coefficients.y;
-	*c = coefficients.x;
+	if( !least_squares_quadratic_fit( sums, (double) count, mean_x, mean_y, a, b, c ) )
+	{
+		*a = NAN;
+		*b = NAN;
+		*c = NAN;
+	}
 }
 
 double m3d_least_squares_quadratic_error( const double x[], const double y[], size_t count, double a, double b, double c )
@@ -226,6 +781,786 @@ double m3d_least_squares_quadratic_error( const double x[], const double y[], si
 	return error;
 }
 
+/*
+ * Streaming Least Squares
+ *
+ * Each of the sums has a compensation that collects the rounding error of
+ * every addition to it.
+ */
+
+/* Neumaier's variant of Kahan summation, which is also exact when the
+ * value is larger than the sum. */
+static inline void compensated_add( double* sum, double* compensation, double value )
+{
+	double t = *sum + value;
+	*compensation += fabs(*sum) >= fabs(value) ? (*sum - t) + value : (value - t) + *sum;
+	*sum = t;
+}
+
+static void least_squares_accumulate( m3d_least_squares_accumulator_t* accumulator, double x, double y, double sign )
+{
+	double dx  = x - accumulator->x0;
+	double dy  = y - accumulator->y0;
+	double dx2 = dx * dx;
+	double terms[ M3D_LEAST_SQUARES_SUMS ] = {
+		[ SUM_X ]    = dx,
+		[ SUM_XX ]   = dx2,
+		[ SUM_XXX ]  = dx2 * dx,
+		[ SUM_XXXX ] = dx2 * dx2,
+		[ SUM_Y ]    = dy,
+		[ SUM_XY ]   = dx * dy,
+		[ SUM_XXY ]  = dx2 * dy,
+		[ SUM_YY ]   = dy * dy,
+	};
+
+	for( size_t k = 0; k < M3D_LEAST_SQUARES_SUMS; k++ )
+	{
+		compensated_add( &accumulator->sums[ k ], &accumulator->compensations[ k ], sign * terms[ k ] );
+	}
+}
+
+static void least_squares_values( const m3d_least_squares_accumulator_t* accumulator, double sums[] )
+{
+	for( size_t k = 0; k < M3D_LEAST_SQUARES_SUMS; k++ )
+	{
+		sums[ k ] = accumulator->sums[ k ] + accumulator->compensations[ k ];
+	}
+}
+
+/*
+ * Changes the sums of count samples from being about (x0, y0) to being
+ * about (x0 + d, y0 + e), by expanding (dx - d)^k (dy - e)^j.
+ */
+static void least_squares_shift( double sums[], double count, double d, double e )
+{
+	const double sx    = sums[ SUM_X ];
+	const double sxx   = sums[ SUM_XX ];
+	const double sxxx  = sums[ SUM_XXX ];
+	const double sxxxx = sums[ SUM_XXXX ];
+	const double sy    = sums[ SUM_Y ];
+	const double sxy   = sums[ SUM_XY ];
+	const double sxxy  = sums[ SUM_XXY ];
+	const double syy   = sums[ SUM_YY ];
+	const double d2    = d * d;
+
+	/* The squares about the new x0, which the x^2 y sum needs. */
+	const double shifted_xx = sxx - 2.0 * d * sx + count * d2;
+
+	sums[ SUM_X ]    = sx - count * d;
+	sums[ SUM_XX ]   = shifted_xx;
+	sums[ SUM_XXX ]  = sxxx - 3.0 * d * sxx + 3.0 * d2 * sx - count * d2 * d;
+	sums[ SUM_XXXX ] = sxxxx - 4.0 * d * sxxx + 6.0 * d2 * sxx - 4.0 * d2 * d * sx + count * d2 * d2;
+	sums[ SUM_Y ]    = sy - count * e;
+	sums[ SUM_XY ]   = sxy - e * sx - d * sy + count * d * e;
+	sums[ SUM_XXY ]  = sxxy - 2.0 * d * sxy + d2 * sy - e * shifted_xx;
+	sums[ SUM_YY ]   = syy - 2.0 * e * sy + count * e * e;
+}
+
+/*
+ * Moves the sums from being about (x0, y0) to being about (x, y). The
+ * differences are rounded when x0 and x are far apart, which would leave
+ * the sums about a slightly different point than the new samples. So the
+ * rounding errors, which Knuth's two-sum finds exactly, are a second,
+ * small shift.
+ */
+static void least_squares_move( double sums[], double count, double x0, double y0, double x, double y )
+{
+	const double d       = x - x0;
+	const double e       = y - y0;
+	const double d_part  = d - x;
+	const double e_part  = e - y;
+	const double d_error = (x - (d - d_part)) + (-x0 - d_part);
+	const double e_error = (y - (e - e_part)) + (-y0 - e_part);
+
+	least_squares_shift( sums, count, d, e );
+	least_squares_shift( sums, count, d_error, e_error );
+}
+
+/* The sums about the mean of the samples, and that mean. */
+static void least_squares_centered( const m3d_least_squares_accumulator_t* accumulator, double sums[], double* mean_x, double* mean_y )
+{
+	const double count = (double) accumulator->count;
+	least_squares_values( accumulator, sums );
+
+	*mean_x = accumulator->x0 + sums[ SUM_X ] / count;
+	*mean_y = accumulator->y0 + sums[ SUM_Y ] / count;
+	least_squares_move( sums, count, accumulator->x0, accumulator->y0, *mean_x, *mean_y );
+}
+
+void m3d_least_squares_accumulator_init( m3d_least_squares_accumulator_t* accumulator )
+{
+	assert( accumulator );
+	accumulator->count = 0;
+	accumulator->x0    = 0.0;
+	accumulator->y0    = 0.0;
+	for( size_t k = 0; k < M3D_LEAST_SQUARES_SUMS; k++ )
+	{
+		accumulator->sums[ k ]          = 0.0;
+		accumulator->compensations[ k ] = 0.0;
+	}
+}
+
+void m3d_least_squares_accumulator_add( m3d_least_squares_accumulator_t* accumulator, double x, double y )
+{
+	assert( accumulator );
+	if( accumulator->count == 0 )
+	{
+		accumulator->x0 = x;
+		accumulator->y0 = y;
+	}
+
+	least_squares_accumulate( accumulator, x, y, 1.0 );
+	accumulator->count += 1;
+}
+
+void m3d_least_squares_accumulator_add_array( m3d_least_squares_accumulator_t* accumulator, const double x[], const double y[], size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+	{
+		m3d_least_squares_accumulator_add( accumulator, x[ i ], y[ i ] );
+	}
+}
+
+void m3d_least_squares_accumulator_remove( m3d_least_squares_accumulator_t* accumulator, double x, double y )
+{
+	assert( accumulator );
+	assert( accumulator->count > 0 );
+
+	if( accumulator->count == 1 )
+	{
+		/* Start over, without the rounding errors of the old samples. */
+		m3d_least_squares_accumulator_init( accumulator );
+	}
+	else
+	{
+		least_squares_accumulate( accumulator, x, y, -1.0 );
+		accumulator->count -= 1;
+	}
+}
+
+void m3d_least_squares_accumulator_merge( m3d_least_squares_accumulator_t* accumulator, const m3d_least_squares_accumulator_t* other )
+{
+	assert( accumulator );
+	assert( other );
+
+	if( other->count == 0 )
+	{
+		return;
+	}
+	if( accumulator->count == 0 )
+	{
+		*accumulator = *other;
+		return;
+	}
+
+	double sums[ M3D_LEAST_SQUARES_SUMS ];
+	least_squares_values( other, sums );
+	least_squares_move( sums, (double) other->count, other->x0, other->y0, accumulator->x0, accumulator->y0 );
+
+	for( size_t k = 0; k < M3D_LEAST_SQUARES_SUMS; k++ )
+	{
+		compensated_add( &accumulator->sums[ k ], &accumulator->compensations[ k ], sums[ k ] );
+	}
+	accumulator->count += other->count;
+}
+
+void m3d_least_squares_accumulator_recenter( m3d_least_squares_accumulator_t* accumulator )
+{
+	assert( accumulator );
+
+	if( accumulator->count > 0 )
+	{
+		double sums[ M3D_LEAST_SQUARES_SUMS ];
+		double mean_x;
+		double mean_y;
+		least_squares_centered( accumulator, sums, &mean_x, &mean_y );
+		accumulator->x0 = mean_x;
+		accumulator->y0 = mean_y;
+
+		for( size_t k = 0; k < M3D_LEAST_SQUARES_SUMS; k++ )
+		{
+			accumulator->sums[ k ]          = sums[ k ];
+			accumulator->compensations[ k ] = 0.0;
+		}
+	}
+}
+
+bool m3d_least_squares_accumulator_linear( const m3d_least_squares_accumulator_t* accumulator, double* m, double* b )
+{
+	assert( accumulator );
+	if( accumulator->count < 2 )
+	{
+		return false;
+	}
+
+	const double count = (double) accumulator->count;
+	double sums[ M3D_LEAST_SQUARES_SUMS ];
+	least_squares_values( accumulator, sums );
+
+	/* These are the sums about the mean, which is all the linear fit
+	 * needs, so the sums are not moved. */
+	const double mean_x = sums[ SUM_X ] / count;
+	const double mean_y = sums[ SUM_Y ] / count;
+	const double xx     = sums[ SUM_XX ] - sums[ SUM_X ] * mean_x;
+	const double xy     = sums[ SUM_XY ] - sums[ SUM_X ] * mean_y;
+	if( !(xx > 0.0) )
+	{
+		return false;
+	}
+
+	const double slope = xy / xx;
+	*m = slope;
+	*b = (accumulator->y0 + mean_y) - slope * (accumulator->x0 + mean_x);
+	return true;
+}
+
+double m3d_least_squares_accumulator_linear_error( const m3d_least_squares_accumulator_t* accumulator, double m, double b )
+{
+	assert( accumulator );
+	if( accumulator->count == 0 )
+	{
+		return 0.0;
+	}
+
+	const double count = (double) accumulator->count;
+	double sums[ M3D_LEAST_SQUARES_SUMS ];
+	double mean_x;
+	double mean_y;
+	least_squares_centered( accumulator, sums, &mean_x, &mean_y );
+
+	/* About the mean, each residual is dy - m dx - k. */
+	const double k = m * mean_x + b - mean_y;
+	const double error = sums[ SUM_YY ] - 2.0 * m * sums[ SUM_XY ] - 2.0 * k * sums[ SUM_Y ] +
+	                     m * m * sums[ SUM_XX ] + 2.0 * m * k * sums[ SUM_X ] + count * k * k;
+	return error > 0.0 ? error : 0.0;
+}
+
+/* A pivot of the factorization is zero when it is no more than the
+ * rounding in the sums, which grows with the square root of the count,
+ * relative to the diagonal entry it came from. */
+#define LEAST_SQUARES_PIVOT_TOLERANCE  (64 * DBL_EPSILON)
+
+/*
+ * The quadratic fit from sums about (mean_x, mean_y). The normal equations
+ * are in u = dx / sigma, so that the sums of the powers of u are all about
+ * count and the matrix is well conditioned. It is symmetric positive
+ * definite, so it is solved with a Cholesky factorization.
+ */
+static bool least_squares_quadratic_fit( const double sums[], double count, double mean_x, double mean_y, double* a, double* b, double* c )
+{
+	const double variance = (sums[ SUM_XX ] - sums[ SUM_X ] * sums[ SUM_X ] / count) / count;
+	if( !(variance > 0.0) )
+	{
+		return false;
+	}
+
+	const double sigma = sqrt( variance );
+	const double u     = sums[ SUM_X ] / sigma;
+	const double uu    = sums[ SUM_XX ] / (sigma * sigma);
+	const double uuu   = sums[ SUM_XXX ] / (sigma * sigma * sigma);
+	const double uuuu  = sums[ SUM_XXXX ] / (sigma * sigma * sigma * sigma);
+	const double r0    = sums[ SUM_Y ];
+	const double r1    = sums[ SUM_XY ] / sigma;
+	const double r2    = sums[ SUM_XXY ] / (sigma * sigma);
+
+	const double l00 = sqrt( count );
+	const double l10 = u / l00;
+	const double l20 = uu / l00;
+	const double p11 = uu - l10 * l10;
+	const double tolerance = LEAST_SQUARES_PIVOT_TOLERANCE * sqrt( count );
+	if( !(p11 > tolerance * uu) )
+	{
+		return false;
+	}
+	const double l11 = sqrt( p11 );
+	const double l21 = (uuu - l20 * l10) / l11;
+	const double p22 = uuuu - l20 * l20 - l21 * l21;
+	if( !(p22 > tolerance * uuuu) )
+	{
+		/* The samples are at only two values of x. */
+		return false;
+	}
+	const double l22 = sqrt( p22 );
+
+	const double z0 = r0 / l00;
+	const double z1 = (r1 - l10 * z0) / l11;
+	const double z2 = (r2 - l20 * z0 - l21 * z1) / l22;
+	const double c2 = z2 / l22;
+	const double c1 = (z1 - l21 * c2) / l11;
+	const double c0 = (z0 - l10 * c1 - l20 * c2) / l00;
+
+	/* y = mean_y + c0 + c1 u + c2 u^2, where u = (x - mean_x) / sigma. */
+	const double A = c2 / (sigma * sigma);
+	const double B = c1 / sigma;
+	*a = A;
+	*b = B - 2.0 * A * mean_x;
+	*c = mean_y + c0 - B * mean_x + A * mean_x * mean_x;
+	return true;
+}
+
+bool m3d_least_squares_accumulator_quadratic( const m3d_least_squares_accumulator_t* accumulator, double* a, double* b, double* c )
+{
+	assert( accumulator );
+	if( accumulator->count < 3 )
+	{
+		return false;
+	}
+
+	double sums[ M3D_LEAST_SQUARES_SUMS ];
+	double mean_x;
+	double mean_y;
+	least_squares_centered( accumulator, sums, &mean_x, &mean_y );
+	return least_squares_quadratic_fit( sums, (double) accumulator->count, mean_x, mean_y, a, b, c );
+}
+
+double m3d_least_squares_accumulator_quadratic_error( const m3d_least_squares_accumulator_t* accumulator, double a, double b, double c )
+{
+	assert( accumulator );
+	if( accumulator->count == 0 )
+	{
+		return 0.0;
+	}
+
+	const double count = (double) accumulator->count;
+	double sums[ M3D_LEAST_SQUARES_SUMS ];
+	double mean_x;
+	double mean_y;
+	least_squares_centered( accumulator, sums, &mean_x, &mean_y );
+
+	/* About the mean, each residual is dy - A dx^2 - B dx - C. */
+	const double A = a;
+	const double B = 2.0 * a * mean_x + b;
+	const double C = (a * mean_x + b) * mean_x + c - mean_y;
+	const double error = sums[ SUM_YY ] - 2.0 * (A * sums[ SUM_XXY ] + B * sums[ SUM_XY ] + C * sums[ SUM_Y ]) +
+	                     A * A * sums[ SUM_XXXX ] + B * B * sums[ SUM_XX ] + C * C * count +
+	                     2.0 * (A * B * sums[ SUM_XXX ] + A * C * sums[ SUM_XX ] + B * C * sums[ SUM_X ]);
+	return error > 0.0 ? error : 0.0;
+}
+
+/*
+ * Dense Least Squares
+ *
+ * The design matrix and the right-hand sides are copied by columns into the
+ * workspace, so that every loop of the factorization runs down a column,
+ * over contiguous doubles. The loops take a block of elements at a time,
+ * which the compiler turns into vector instructions. The dot products keep
+ * 32 partial sums, so that several vector additions are in flight rather
+ * than each waiting for the one before.
+ */
+#define LEAST_SQUARES_PARALLEL_COUNT   (1 << 16)
+
+/* A column is dependent on the ones before it when the part of it that
+ * they do not span is this small, relative to the whole column. */
+#define LEAST_SQUARES_RANK_TOLERANCE   (64 * DBL_EPSILON)
+
+static double column_dot( const double* restrict a, const double* restrict b, size_t count )
+{
+	double partial[ 32 ] = { 0.0 };
+	size_t i = 0;
+
+	for( ; i + 32 <= count; i += 32 )
+	{
+		for( size_t k = 0; k < 32; k++ )
+		{
+			partial[ k ] += a[ i + k ] * b[ i + k ];
+		}
+	}
+	for( ; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			partial[ k ] += a[ i + k ] * b[ i + k ];
+		}
+	}
+	for( size_t width = 16; width > 0; width /= 2 )
+	{
+		for( size_t k = 0; k < width; k++ )
+		{
+			partial[ k ] += partial[ k + width ];
+		}
+	}
+
+	double sum = partial[ 0 ];
+	for( ; i < count; i++ )
+	{
+		sum += a[ i ] * b[ i ];
+	}
+	return sum;
+}
+
+/* y -= scale * x */
+static void column_subtract( double* restrict y, const double* restrict x, double scale, size_t count )
+{
+	size_t i = 0;
+
+	for( ; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			y[ i + k ] -= scale * x[ i + k ];
+		}
+	}
+	for( ; i < count; i++ )
+	{
+		y[ i ] -= scale * x[ i ];
+	}
+}
+
+/*
+ * Solves the least squares problem of the rows x columns matrix A, stored
+ * by columns, for the count columns of Y, also stored by columns. Both are
+ * overwritten. Coefficient j of right-hand side r goes to
+ * coefficients[ j * column_stride + r * rhs_stride ].
+ *
+ * Each Householder reflection I - beta v transpose(v) zeroes column j of A
+ * below the diagonal, and is applied to the columns after it and to Y.
+ * Then A holds R above the diagonal and Y holds transpose(Q) y, whose rows
+ * past columns are the residuals.
+ */
+static bool householder_least_squares( double* restrict A, double* restrict Y, size_t rows, size_t columns, size_t count,
+                                       double coefficients[], size_t column_stride, size_t rhs_stride, double errors[] )
+{
+	if( columns == 0 || rows < columns )
+	{
+		return false;
+	}
+
+	for( size_t j = 0; j < columns; j++ )
+	{
+		double* column    = A + j * rows;
+		double* v         = column + j;
+		const size_t n    = rows - j;
+		const double above = column_dot( column, column, j );
+		const double below = column_dot( v, v, n );
+		const double norm  = sqrt( below );
+
+		if( !(norm > LEAST_SQUARES_RANK_TOLERANCE * sqrt( above + below )) )
+		{
+			return false;
+		}
+
+		/* The reflection takes the column to alpha e_j. alpha has the
+		 * opposite sign of v[ 0 ], so that v[ 0 ] - alpha does not cancel,
+		 * and transpose(v) v = 2 norm (norm + |v[ 0 ]|). */
+		const double alpha = v[ 0 ] > 0.0 ? -norm : norm;
+		const double beta  = 1.0 / (norm * (norm + fabs(v[ 0 ])));
+		v[ 0 ] -= alpha;
+
+		for( size_t k = j + 1; k < columns; k++ )
+		{
+			double* other = A + k * rows + j;
+			column_subtract( other, v, beta * column_dot( v, other, n ), n );
+		}
+
+		#ifdef _OPENMP
+		#pragma omp parallel for schedule(static) if( count * n >= LEAST_SQUARES_PARALLEL_COUNT )
+		#endif
+		for( size_t r = 0; r < count; r++ )
+		{
+			double* y = Y + r * rows + j;
+			column_subtract( y, v, beta * column_dot( v, y, n ), n );
+		}
+
+		v[ 0 ] = alpha;
+	}
+
+	for( size_t r = 0; r < count; r++ )
+	{
+		const double* y = Y + r * rows;
+
+		if( errors )
+		{
+			errors[ r ] = column_dot( y + columns, y + columns, rows - columns );
+		}
+
+		for( size_t j = columns; j > 0; j-- )
+		{
+			double sum = y[ j - 1 ];
+			for( size_t k = j; k < columns; k++ )
+			{
+				sum -= A[ k * rows + j - 1 ] * coefficients[ k * column_stride + r * rhs_stride ];
+			}
+			coefficients[ (j - 1) * column_stride + r * rhs_stride ] = sum / A[ (j - 1) * rows + j - 1 ];
+		}
+	}
+
+	return true;
+}
+
+size_t m3d_least_squares_workspace_size( size_t rows, size_t columns, size_t count )
+{
+	return rows * (columns + count) * sizeof(double);
+}
+
+bool m3d_least_squares_solve( const double A[], const double Y[], size_t rows, size_t columns, size_t count, double coefficients[], double errors[], void* workspace )
+{
+	void* allocated = NULL;
+	if( !workspace )
+	{
+		workspace = allocated = malloc( m3d_least_squares_workspace_size( rows, columns, count ) );
+		if( !workspace )
+		{
+			return false;
+		}
+	}
+
+	double* a = workspace;
+	double* y = a + rows * columns;
+
+	for( size_t i = 0; i < rows; i++ )
+	{
+		for( size_t j = 0; j < columns; j++ )
+		{
+			a[ j * rows + i ] = A[ i * columns + j ];
+		}
+		for( size_t r = 0; r < count; r++ )
+		{
+			y[ r * rows + i ] = Y[ i * count + r ];
+		}
+	}
+
+	bool result = householder_least_squares( a, y, rows, columns, count, coefficients, count, 1, errors );
+	free( allocated );
+	return result;
+}
+
+/*
+ * Fills the count x (degree + 1) Vandermonde matrix, by columns, of x
+ * mapped to t = (x - middle) / half in [-1, 1]. Returns false when there
+ * are too few distinct x.
+ */
+static bool polynomial_design( const double x[], size_t count, size_t degree, double* restrict V, double* middle, double* half )
+{
+	if( count <= degree )
+	{
+		return false;
+	}
+
+	double low[ 8 ];
+	double high[ 8 ];
+	size_t i = 0;
+	for( size_t k = 0; k < 8; k++ )
+	{
+		low[ k ]  = x[ 0 ];
+		high[ k ] = x[ 0 ];
+	}
+	for( ; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			low[ k ]  = x[ i + k ] < low[ k ] ? x[ i + k ] : low[ k ];
+			high[ k ] = x[ i + k ] > high[ k ] ? x[ i + k ] : high[ k ];
+		}
+	}
+	for( ; i < count; i++ )
+	{
+		low[ 0 ]  = x[ i ] < low[ 0 ] ? x[ i ] : low[ 0 ];
+		high[ 0 ] = x[ i ] > high[ 0 ] ? x[ i ] : high[ 0 ];
+	}
+	for( size_t k = 1; k < 8; k++ )
+	{
+		low[ 0 ]  = low[ k ] < low[ 0 ] ? low[ k ] : low[ 0 ];
+		high[ 0 ] = high[ k ] > high[ 0 ] ? high[ k ] : high[ 0 ];
+	}
+
+	*middle = 0.5 * (low[ 0 ] + high[ 0 ]);
+	*half   = 0.5 * (high[ 0 ] - low[ 0 ]);
+	if( !(*half > 0.0) )
+	{
+		if( degree > 0 )
+		{
+			return false;
+		}
+		*half = 1.0;
+	}
+
+	/* Each column is the one before times t, one block of rows at a time. */
+	const double m     = *middle;
+	const double scale = 1.0 / *half;
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			V[ i + k ] = 1.0;
+		}
+	}
+	for( ; i < count; i++ )
+	{
+		V[ i ] = 1.0;
+	}
+	if( degree == 0 )
+	{
+		return true;
+	}
+
+	double* restrict t = V + count;
+	for( i = 0; i + 8 <= count; i += 8 )
+	{
+		for( size_t k = 0; k < 8; k++ )
+		{
+			t[ i + k ] = (x[ i + k ] - m) * scale;
+		}
+	}
+	for( ; i < count; i++ )
+	{
+		t[ i ] = (x[ i ] - m) * scale;
+	}
+
+	for( size_t j = 2; j <= degree; j++ )
+	{
+		const double* restrict previous = V + (j - 1) * count;
+		double* restrict column         = V + j * count;
+		for( i = 0; i + 8 <= count; i += 8 )
+		{
+			for( size_t k = 0; k < 8; k++ )
+			{
+				column[ i + k ] = previous[ i + k ] * t[ i + k ];
+			}
+		}
+		for( ; i < count; i++ )
+		{
+			column[ i ] = previous[ i ] * t[ i ];
+		}
+	}
+	return true;
+}
+
+/* Turns the coefficients of powers of t = (x - middle) / half into those
+ * of powers of x, first as powers of x - middle, then by Taylor shifts. */
+static void polynomial_expand( double coefficients[], size_t degree, double middle, double half )
+{
+	double power = 1.0;
+	for( size_t j = 1; j <= degree; j++ )
+	{
+		power             /= half;
+		coefficients[ j ] *= power;
+	}
+
+	for( size_t i = 0; i < degree; i++ )
+	{
+		for( size_t k = degree; k > i; k-- )
+		{
+			coefficients[ k - 1 ] -= middle * coefficients[ k ];
+		}
+	}
+}
+
+size_t m3d_least_squares_polynomial_workspace_size( size_t count, size_t degree )
+{
+	return m3d_least_squares_workspace_size( count, degree + 1, 1 );
+}
+
+static bool polynomial_fit( const double x[], const double y[], size_t count, size_t degree, double coefficients[], double* error, double* workspace )
+{
+	double* V = workspace;
+	double* Y = V + count * (degree + 1);
+	double middle;
+	double half;
+
+	if( !polynomial_design( x, count, degree, V, &middle, &half ) )
+	{
+		return false;
+	}
+	for( size_t i = 0; i < count; i++ )
+	{
+		Y[ i ] = y[ i ];
+	}
+	if( !householder_least_squares( V, Y, count, degree + 1, 1, coefficients, 1, 1, error ) )
+	{
+		return false;
+	}
+	polynomial_expand( coefficients, degree, middle, half );
+	return true;
+}
+
+bool m3d_least_squares_polynomial( const double x[], const double y[], size_t count, size_t degree, double coefficients[], double* error, void* workspace )
+{
+	void* allocated = NULL;
+	if( !workspace )
+	{
+		workspace = allocated = malloc( m3d_least_squares_polynomial_workspace_size( count, degree ) );
+		if( !workspace )
+		{
+			return false;
+		}
+	}
+
+	bool result = polynomial_fit( x, y, count, degree, coefficients, error, workspace );
+	free( allocated );
+	return result;
+}
+
+bool m3d_least_squares_polynomial_batch( const double x[], const double y[], size_t count, size_t series, size_t degree, bool shared_x, double coefficients[], double errors[] )
+{
+	const size_t terms = degree + 1;
+	bool result = true;
+
+	if( shared_x )
+	{
+		/* One factorization, with every series as a right-hand side. y is
+		 * already count x series by columns. */
+		double* V = malloc( count * (terms + series) * sizeof(double) );
+		double* Y = V + count * terms;
+		double middle;
+		double half;
+
+		if( !V )
+		{
+			return false;
+		}
+
+		memcpy( Y, y, count * series * sizeof(double) );
+		result = polynomial_design( x, count, degree, V, &middle, &half ) &&
+		         householder_least_squares( V, Y, count, terms, series, coefficients, 1, terms, errors );
+
+		for( size_t s = 0; s < series; s++ )
+		{
+			if( result )
+			{
+				polynomial_expand( coefficients + s * terms, degree, middle, half );
+			}
+			else
+			{
+				for( size_t j = 0; j < terms; j++ )
+				{
+					coefficients[ s * terms + j ] = NAN;
+				}
+			}
+		}
+
+		free( V );
+		return result;
+	}
+
+	#ifdef _OPENMP
+	#pragma omp parallel if( series * count >= LEAST_SQUARES_PARALLEL_COUNT ) reduction(&&:result)
+	#endif
+	{
+		double* workspace = malloc( m3d_least_squares_polynomial_workspace_size( count, degree ) );
+		result = workspace != NULL;
+
+		#ifdef _OPENMP
+		#pragma omp for schedule(static)
+		#endif
+		for( size_t s = 0; s < series; s++ )
+		{
+			double* c = coefficients + s * terms;
+			if( !workspace || !polynomial_fit( x + s * count, y + s * count, count, degree, c, errors ? errors + s : NULL, workspace ) )
+			{
+				for( size_t j = 0; j < terms; j++ )
+				{
+					c[ j ] = NAN;
+				}
+				result = false;
+			}
+		}
+
+		free( workspace );
+	}
+
+	return result;
+}
+
 void m3d_table_dump( FILE* stream, const double x[], const double y[], size_t count, const char* label_x, const char* label_y )
 {
 	fprintf( stream, "+--------------+--------------+\n" );
@@ -61,6 +61,77 @@ bool m3d_fixed_point_iteration_max_precision( double estimate, double (*g)(doubl
  */
 bool m3d_secant_method( double a, double b, double epsilon, size_t iterations, double (*f)(double x), double* root );
 
+/*
+ * The work done by a root finder. The functions that take one accept NULL
+ * when the counts are not needed.
+ */
+typedef struct m3d_root_stats {
+	size_t iterations;  /* iterations used */
+	size_t evaluations; /* evaluations of f(x) */
+	size_t derivatives; /* evaluations of f'(x) */
+} m3d_root_stats_t;
+
+/* Find the root of a function f(x) within an interval of [a, b], where f(a)
+ * and f(b) have opposite signs. Brent's method takes secant and inverse
+ * quadratic interpolation steps, and falls back to bisection whenever they
+ * would not shrink the interval fast enough. On smooth functions it needs
+ * far fewer evaluations than the bissection_method(), but at a multiple
+ * root, like that of (x - 1)^3, the interpolation creeps towards the root
+ * and it can need a few times more. The root is found when the interval is
+ * narrower than epsilon. Returns false when f(a) and f(b) have the same
+ * sign or when a solution is not found within the iterations.
+ */
+bool m3d_brent_method( double a, double b, double epsilon, size_t iterations, double (*f)(double x), double* root, m3d_root_stats_t* stats );
+bool m3d_brent_method_max_precision( double a, double b, double (*f)(double x), double* root, m3d_root_stats_t* stats );
+
+/* Find the root of a function f(x) within an interval of [a, b], where f(a)
+ * and f(b) have opposite signs, with the Newton-Raphson method. The first
+ * estimate is the middle of the interval. A Newton step that would leave
+ * the interval, or that would not halve the step before last, is replaced
+ * with a bisection step, and the interval shrinks around the root after
+ * every evaluation. So it converges even where f'(x) is zero or the
+ * function is far from linear. The root is found when a step is smaller
+ * than epsilon. Returns false when f(a) and f(b) have the same sign or when
+ * a solution is not found within the iterations.
+ *
+ * The _fdf variant takes one function that computes both f(x) and f'(x),
+ * which is cheaper when they share terms. It is also evaluated at a and
+ * b, where the other variant only evaluates f.
+ */
+bool m3d_newton_raphson_method    ( double a, double b, double epsilon, size_t iterations, double (*f)(double x), double (*df)(double x), double* root, m3d_root_stats_t* stats );
+bool m3d_newton_raphson_method_fdf( double a, double b, double epsilon, size_t iterations, void (*fdf)(double x, double* f, double* df), double* root, m3d_root_stats_t* stats );
+
+/*
+ * Batch root finding solves count independent equations at once. The
+ * callback evaluates the equations on an array: y[ k ] is equation
+ * equations[ k ] at x[ k ], for k < count. Each call gets only the
+ * equations that are still being solved, packed together, so it can be a
+ * vectorized loop and the work of each iteration shrinks as equations
+ * converge.
+ *
+ * Each equation follows the same steps, with the same results, as the
+ * single equation function. roots gets the last estimate of every
+ * equation and status tells whether it converged. The functions return
+ * false only if the workspace cannot be allocated.
+ *
+ * workspace may be NULL to allocate one for each call. Otherwise it should
+ * point to m3d_root_batch_workspace_size( count ) bytes, aligned for
+ * doubles, which lets repeated calls avoid the heap.
+ */
+typedef void (*m3d_batch_function_t)( const double x[], double y[], size_t count, const size_t equations[], void* context );
+
+typedef enum m3d_root_status {
+	M3D_ROOT_CONVERGED = 0,
+	M3D_ROOT_MAX_ITERATIONS, /* did not converge within the iterations */
+	M3D_ROOT_STALLED,        /* the bracket shrank below epsilon without converging */
+	M3D_ROOT_NOT_FINITE,     /* an estimate was infinite or NaN */
+} m3d_root_status_t;
+
+size_t m3d_root_batch_workspace_size      ( size_t count );
+bool   m3d_bissection_method_batch        ( const double a[], const double b[], size_t count, double epsilon, size_t iterations, m3d_batch_function_t f, void* context, double roots[], m3d_root_status_t status[], void* workspace );
+bool   m3d_fixed_point_iteration_batch    ( const double estimates[], size_t count, double epsilon, size_t iterations, m3d_batch_function_t g, void* context, double roots[], m3d_root_status_t status[], void* workspace );
+bool   m3d_secant_method_batch            ( const double a[], const double b[], size_t count, double epsilon, size_t iterations, m3d_batch_function_t f, void* context, double roots[], m3d_root_status_t status[], void* workspace );
+
 /*
  * Given a list of (x,y) coordinates, least_squares_linear() will find the least
  * sqaures linear equation y = mx + b that has the minimal error.
@@ -71,10 +142,90 @@ double m3d_least_squares_linear_error ( const double x[], const double y[], size
 /*
  * Given a list of (x,y) coordinates, least_squares_quadratic() will find the least
  * sqaures quadratic equation y = ax^2 + bx + c that has the minimal error.
+ * When the samples are at fewer than three distinct values of x, the
+ * quadratic is not determined and a, b and c are all NaN.
  */
 void   m3d_least_squares_quadratic       ( const double x[], const double y[], size_t count, double* a, double* b, double* c );
 double m3d_least_squares_quadratic_error ( const double x[], const double y[], size_t count, double a, double b, double c );
 
+/*
+ * Streaming least squares keeps the sums that the linear and quadratic fits
+ * need, so that samples can be added and removed one at a time, in O(1),
+ * without keeping them. Removing the oldest sample after adding a new one
+ * fits a sliding window. Accumulators of different shards of the data can
+ * be merged, in any order, and the fits of the merged accumulator are those
+ * of all the samples.
+ *
+ * The sums are of powers of x - x0 and y - y0, where (x0, y0) is the first
+ * sample, and they are compensated (Neumaier summation), so they neither
+ * lose the small spread of samples far from the origin, like timestamps,
+ * nor drift after many additions and removals. The fits solve the normal
+ * equations about the mean of x. When a sliding window moves far from its
+ * first sample, m3d_least_squares_accumulator_recenter() moves (x0, y0) to
+ * the mean.
+ *
+ * The fits return false when there are too few samples or all the x are
+ * the same. The errors are the sum of the squared residuals, like the
+ * functions above, within rounding relative to the spread of y.
+ */
+#define M3D_LEAST_SQUARES_SUMS    (8)
+
+typedef struct m3d_least_squares_accumulator {
+	size_t count;
+	double x0;
+	double y0;
+	double sums[ M3D_LEAST_SQUARES_SUMS ];
+	double compensations[ M3D_LEAST_SQUARES_SUMS ];
+} m3d_least_squares_accumulator_t;
+
+void   m3d_least_squares_accumulator_init            ( m3d_least_squares_accumulator_t* accumulator );
+void   m3d_least_squares_accumulator_add             ( m3d_least_squares_accumulator_t* accumulator, double x, double y );
+void   m3d_least_squares_accumulator_add_array       ( m3d_least_squares_accumulator_t* accumulator, const double x[], const double y[], size_t count );
+void   m3d_least_squares_accumulator_remove          ( m3d_least_squares_accumulator_t* accumulator, double x, double y );
+void   m3d_least_squares_accumulator_merge           ( m3d_least_squares_accumulator_t* accumulator, const m3d_least_squares_accumulator_t* other );
+void   m3d_least_squares_accumulator_recenter        ( m3d_least_squares_accumulator_t* accumulator );
+bool   m3d_least_squares_accumulator_linear          ( const m3d_least_squares_accumulator_t* accumulator, double* m, double* b );
+double m3d_least_squares_accumulator_linear_error    ( const m3d_least_squares_accumulator_t* accumulator, double m, double b );
+bool   m3d_least_squares_accumulator_quadratic       ( const m3d_least_squares_accumulator_t* accumulator, double* a, double* b, double* c );
+double m3d_least_squares_accumulator_quadratic_error ( const m3d_least_squares_accumulator_t* accumulator, double a, double b, double c );
+
+/*
+ * Dense least squares finds the coefficients c that minimize |A c - y| for
+ * a rows x columns design matrix A, stored by rows, with rows >= columns.
+ * It uses Householder QR on A itself, rather than the normal equations
+ * transpose(A) A, which square the condition number of A.
+ *
+ * m3d_least_squares_solve() solves for count right-hand sides at once,
+ * which share the factorization: Y is rows x count and coefficients is
+ * columns x count, both stored by rows, so that with count = 1 they are
+ * plain vectors. errors, if not NULL, gets the sum of the squared
+ * residuals of each right-hand side. Returns false when rows < columns or
+ * the columns of A are linearly dependent, to within rounding.
+ *
+ * m3d_least_squares_polynomial() fits y = c[0] + c[1] x + ... + c[degree]
+ * x^degree. The fit is in x shifted and scaled to [-1, 1], which keeps the
+ * columns of the design matrix far from dependent, and the coefficients
+ * are then expanded in powers of x. It needs count > degree distinct x.
+ *
+ * m3d_least_squares_polynomial_batch() fits series independent series of
+ * count points each: y[ s * count + i ] for series s, with coefficients[
+ * s * (degree + 1) + j ] and errors[ s ]. When shared_x is true, x has the
+ * count values that every series uses, and the design matrix is factored
+ * once for all of them. Otherwise x is laid out like y and the series are
+ * fitted in parallel. The coefficients of a series that cannot be fitted
+ * are NaN, and then the function returns false, as it does when it cannot
+ * allocate memory.
+ *
+ * workspace may be NULL to allocate one for each call. Otherwise it should
+ * point to the number of bytes from the matching _workspace_size()
+ * function, aligned for doubles.
+ */
+size_t m3d_least_squares_workspace_size            ( size_t rows, size_t columns, size_t count );
+bool   m3d_least_squares_solve                     ( const double A[], const double Y[], size_t rows, size_t columns, size_t count, double coefficients[], double errors[], void* workspace );
+size_t m3d_least_squares_polynomial_workspace_size ( size_t count, size_t degree );
+bool   m3d_least_squares_polynomial                ( const double x[], const double y[], size_t count, size_t degree, double coefficients[], double* error, void* workspace );
+bool   m3d_least_squares_polynomial_batch          ( const double x[], const double y[], size_t count, size_t series, size_t degree, bool shared_x, double coefficients[], double errors[] );
+
 
 /*
  * Write out the coordinates in a tabular layout.
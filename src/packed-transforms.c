@@ -0,0 +1,353 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <assert.h>
+#include "batch-math.h"
+#include "packed-transforms.h"
+
+/* The smallest three components of a unit quaternion are within this. */
+#define SMALLEST_THREE_RANGE    ((scaler_t) 0.70710678118654752440)
+
+/* Runs statement over count elements in blocks of n = BATCH_BLOCK, then
+ * the rest, so that the full blocks have a constant count and vectorize. */
+#define FOR_EACH_BLOCK( count, first, n, statement ) \
+	for( size_t first = 0; first < (count); first += BATCH_BLOCK ) \
+	{ \
+		if( (count) - first >= BATCH_BLOCK ) \
+		{ \
+			const size_t n = BATCH_BLOCK; \
+			statement; \
+		} \
+		else \
+		{ \
+			const size_t n = (count) - first; \
+			statement; \
+		} \
+	}
+
+/* round( (value - min) / (max - min) * steps ), clamped to [0, steps].
+ * In double, as a float is too coarse near 65535 to round correctly. */
+static inline uint32_t quantize( scaler_t value, scaler_t min, scaler_t max, uint32_t steps )
+{
+	double t = ((double) value - min) / ((double) max - min) * steps + 0.5;
+	t = t > 0 ? t : 0;
+	t = t < steps ? t : steps;
+	return (uint32_t) t;
+}
+
+static inline quat_t unit( const quat_t* q )
+{
+	quat_t result = *q;
+	quat_normalize( &result );
+	return result;
+}
+
+/* The index of the largest component, at the top, and the other three,
+ * on the side where the largest is positive, bits each. */
+static uint64_t smallest_three_encode( const quat_t* q, unsigned bits )
+{
+	const quat_t u = unit( q );
+	const scaler_t c[ 4 ] = { u.x, u.y, u.z, u.w };
+	const uint32_t steps = (1u << bits) - 1;
+	size_t largest = 0;
+
+	for( size_t k = 1; k < 4; k++ )
+	{
+		if( scaler_abs( c[ k ] ) > scaler_abs( c[ largest ] ) )
+		{
+			largest = k;
+		}
+	}
+
+	const scaler_t sign = c[ largest ] < 0 ? -1 : 1;
+	uint64_t packed = largest;
+	for( size_t k = 0; k < 4; k++ )
+	{
+		if( k != largest )
+		{
+			packed = packed << bits | quantize( sign * c[ k ], -SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE, steps );
+		}
+	}
+	return packed;
+}
+
+/*
+ * The quaternion from the index of its largest component and the other
+ * three, a, b and c, in order. Selects rather than indexing, so that
+ * loops over it vectorize.
+ */
+BATCH_INLINE void smallest_three_decode( scaler_t q[ 4 ], uint32_t largest, scaler_t a, scaler_t b, scaler_t c )
+{
+	const scaler_t s = 1 - a * a - b * b - c * c;
+	const scaler_t d = scaler_sqrt( s > 0 ? s : 0 );
+
+	q[ 0 ] = largest < 1 ? d : a;
+	q[ 1 ] = largest < 1 ? a : (largest < 2 ? d : b);
+	q[ 2 ] = largest < 2 ? b : (largest < 3 ? d : c);
+	q[ 3 ] = largest < 3 ? c : d;
+}
+
+BATCH_INLINE scaler_t smallest_three_component( uint32_t bits, uint32_t steps )
+{
+	return (scaler_t) (int32_t) bits * (2 * SMALLEST_THREE_RANGE / steps) - SMALLEST_THREE_RANGE;
+}
+
+BATCH_INLINE void unpack32( scaler_t q[ 4 ], uint32_t p )
+{
+	smallest_three_decode( q, p >> 30, smallest_three_component( (p >> 20) & 1023, 1023 ),
+	                                   smallest_three_component( (p >> 10) & 1023, 1023 ),
+	                                   smallest_three_component( p & 1023, 1023 ) );
+}
+
+BATCH_INLINE void unpack48( scaler_t q[ 4 ], const quat_packed48_t* packed )
+{
+	/* Each part is loaded once; the components straddle them. */
+	const uint32_t low = packed->bits[ 0 ], middle = packed->bits[ 1 ], high = packed->bits[ 2 ];
+
+	smallest_three_decode( q, high >> 13, smallest_three_component( (middle >> 14) | (high & 8191) << 2, 32767 ),
+	                                      smallest_three_component( (low >> 15) | (middle & 16383) << 1, 32767 ),
+	                                      smallest_three_component( low & 32767, 32767 ) );
+}
+
+BATCH_INLINE void unpack_octahedral( scaler_t q[ 4 ], uint32_t p )
+{
+	const scaler_t x = (scaler_t) (int32_t) (p >> 21) * ((scaler_t) 2 / 2047) - 1;
+	const scaler_t y = (scaler_t) (int32_t) ((p >> 10) & 2047) * ((scaler_t) 2 / 2047) - 1;
+	const scaler_t z = (scaler_t) (int32_t) (p & 1023) * ((scaler_t) 2 / 1023) - 1;
+	const scaler_t r = 1 - scaler_abs( x ) - scaler_abs( y ) - scaler_abs( z );
+	const scaler_t w = r > 0 ? r : 0;
+	const scaler_t inverse = 1 / scaler_sqrt( x * x + y * y + z * z + w * w );
+
+	q[ 0 ] = x * inverse;
+	q[ 1 ] = y * inverse;
+	q[ 2 ] = z * inverse;
+	q[ 3 ] = w * inverse;
+}
+
+/* Decodes n quaternions to the block, by components. Called with
+ * n = BATCH_BLOCK, the loop has a constant count and vectorizes. */
+#define UNPACK_BLOCK( block, n, decode, packed ) \
+	for( size_t j = 0; j < (n); j++ ) \
+	{ \
+		scaler_t q[ 4 ]; \
+		decode( q, packed ); \
+		(block)[ 0 ][ j ] = q[ 0 ]; \
+		(block)[ 1 ][ j ] = q[ 1 ]; \
+		(block)[ 2 ][ j ] = q[ 2 ]; \
+		(block)[ 3 ][ j ] = q[ 3 ]; \
+	}
+
+BATCH_INLINE void unpack32_block( scaler_t block[ 4 ][ BATCH_BLOCK ], const quat_packed32_t* restrict packed, size_t n )
+{
+	UNPACK_BLOCK( block, n, unpack32, packed[ j ] )
+}
+
+BATCH_INLINE void unpack48_block( scaler_t block[ 4 ][ BATCH_BLOCK ], const quat_packed48_t* restrict packed, size_t n )
+{
+	UNPACK_BLOCK( block, n, unpack48, &packed[ j ] )
+}
+
+BATCH_INLINE void octahedral_block( scaler_t block[ 4 ][ BATCH_BLOCK ], const quat_octahedral32_t* restrict packed, size_t n )
+{
+	UNPACK_BLOCK( block, n, unpack_octahedral, packed[ j ] )
+}
+
+BATCH_INLINE void vec3_unpack48_block( scaler_t block[ 3 ][ BATCH_BLOCK ], const vec3_packed48_t* restrict packed, size_t n, const vec3_t* min, const vec3_t* max )
+{
+	const scaler_t sx = (max->x - min->x) / 65535, sy = (max->y - min->y) / 65535, sz = (max->z - min->z) / 65535;
+
+	for( size_t j = 0; j < n; j++ )
+	{
+		block[ 0 ][ j ] = min->x + (scaler_t) (int32_t) packed[ j ].x * sx;
+		block[ 1 ][ j ] = min->y + (scaler_t) (int32_t) packed[ j ].y * sy;
+		block[ 2 ][ j ] = min->z + (scaler_t) (int32_t) packed[ j ].z * sz;
+	}
+}
+
+BATCH_INLINE void quat_block_store( quat_t* restrict q, const scaler_t block[ 4 ][ BATCH_BLOCK ], size_t n )
+{
+	for( size_t j = 0; j < n; j++ )
+	{
+		q[ j ] = QUAT( block[ 0 ][ j ], block[ 1 ][ j ], block[ 2 ][ j ], block[ 3 ][ j ] );
+	}
+}
+
+BATCH_INLINE void quat_array_block_store( scaler_t* restrict x, scaler_t* restrict y, scaler_t* restrict z, scaler_t* restrict w,
+                                          const scaler_t block[ 4 ][ BATCH_BLOCK ], size_t n )
+{
+	for( size_t j = 0; j < n; j++ )
+	{
+		x[ j ] = block[ 0 ][ j ];
+		y[ j ] = block[ 1 ][ j ];
+		z[ j ] = block[ 2 ][ j ];
+		w[ j ] = block[ 3 ][ j ];
+	}
+}
+
+BATCH_INLINE void vec3_block_store( vec3_t* restrict v, const scaler_t block[ 3 ][ BATCH_BLOCK ], size_t n )
+{
+	for( size_t j = 0; j < n; j++ )
+	{
+		v[ j ] = VEC3( block[ 0 ][ j ], block[ 1 ][ j ], block[ 2 ][ j ] );
+	}
+}
+
+BATCH_INLINE void vec3_array_block_store( scaler_t* restrict x, scaler_t* restrict y, scaler_t* restrict z,
+                                          const scaler_t block[ 3 ][ BATCH_BLOCK ], size_t n )
+{
+	for( size_t j = 0; j < n; j++ )
+	{
+		x[ j ] = block[ 0 ][ j ];
+		y[ j ] = block[ 1 ][ j ];
+		z[ j ] = block[ 2 ][ j ];
+	}
+}
+
+quat_packed32_t quat_pack32( const quat_t* q )
+{
+	return (quat_packed32_t) smallest_three_encode( q, 10 );
+}
+
+quat_t quat_unpack32( quat_packed32_t packed )
+{
+	scaler_t q[ 4 ];
+	unpack32( q, packed );
+	return QUAT( q[ 0 ], q[ 1 ], q[ 2 ], q[ 3 ] );
+}
+
+quat_packed48_t quat_pack48( const quat_t* q )
+{
+	const uint64_t bits = smallest_three_encode( q, 15 );
+	const quat_packed48_t packed = { { (uint16_t) bits, (uint16_t) (bits >> 16), (uint16_t) (bits >> 32) } };
+	return packed;
+}
+
+quat_t quat_unpack48( quat_packed48_t packed )
+{
+	scaler_t q[ 4 ];
+	unpack48( q, &packed );
+	return QUAT( q[ 0 ], q[ 1 ], q[ 2 ], q[ 3 ] );
+}
+
+quat_octahedral32_t quat_pack_octahedral( const quat_t* q )
+{
+	quat_t u = unit( q );
+	if( u.w < 0 )
+	{
+		quat_scale( &u, -1 );
+	}
+
+	const scaler_t l1 = scaler_abs( u.x ) + scaler_abs( u.y ) + scaler_abs( u.z ) + u.w;
+	return quantize( u.x / l1, -1, 1, 2047 ) << 21 |
+	       quantize( u.y / l1, -1, 1, 2047 ) << 10 |
+	       quantize( u.z / l1, -1, 1, 1023 );
+}
+
+quat_t quat_unpack_octahedral( quat_octahedral32_t packed )
+{
+	scaler_t q[ 4 ];
+	unpack_octahedral( q, packed );
+	return QUAT( q[ 0 ], q[ 1 ], q[ 2 ], q[ 3 ] );
+}
+
+vec3_packed48_t vec3_pack48( const vec3_t* v, const vec3_t* min, const vec3_t* max )
+{
+	const vec3_packed48_t packed = {
+		(uint16_t) quantize( v->x, min->x, max->x, 65535 ),
+		(uint16_t) quantize( v->y, min->y, max->y, 65535 ),
+		(uint16_t) quantize( v->z, min->z, max->z, 65535 )
+	};
+	return packed;
+}
+
+vec3_t vec3_unpack48( vec3_packed48_t packed, const vec3_t* min, const vec3_t* max )
+{
+	return VEC3( min->x + (scaler_t) (int32_t) packed.x * ((max->x - min->x) / 65535),
+	             min->y + (scaler_t) (int32_t) packed.y * ((max->y - min->y) / 65535),
+	             min->z + (scaler_t) (int32_t) packed.z * ((max->z - min->z) / 65535) );
+}
+
+void quat_unpack32_batch( quat_t q[], const quat_packed32_t packed[], size_t count )
+{
+	scaler_t block[ 4 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		unpack32_block( block, packed + first, n );
+		quat_block_store( q + first, block, n ) )
+}
+
+void quat_unpack32_array( quat_array_t* array, const quat_packed32_t packed[], size_t count )
+{
+	assert( count <= array->count );
+	scaler_t block[ 4 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		unpack32_block( block, packed + first, n );
+		quat_array_block_store( array->x + first, array->y + first, array->z + first, array->w + first, block, n ) )
+}
+
+void quat_unpack48_batch( quat_t q[], const quat_packed48_t packed[], size_t count )
+{
+	scaler_t block[ 4 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		unpack48_block( block, packed + first, n );
+		quat_block_store( q + first, block, n ) )
+}
+
+void quat_unpack48_array( quat_array_t* array, const quat_packed48_t packed[], size_t count )
+{
+	assert( count <= array->count );
+	scaler_t block[ 4 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		unpack48_block( block, packed + first, n );
+		quat_array_block_store( array->x + first, array->y + first, array->z + first, array->w + first, block, n ) )
+}
+
+void quat_unpack_octahedral_batch( quat_t q[], const quat_octahedral32_t packed[], size_t count )
+{
+	scaler_t block[ 4 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		octahedral_block( block, packed + first, n );
+		quat_block_store( q + first, block, n ) )
+}
+
+void quat_unpack_octahedral_array( quat_array_t* array, const quat_octahedral32_t packed[], size_t count )
+{
+	assert( count <= array->count );
+	scaler_t block[ 4 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		octahedral_block( block, packed + first, n );
+		quat_array_block_store( array->x + first, array->y + first, array->z + first, array->w + first, block, n ) )
+}
+
+void vec3_unpack48_batch( vec3_t v[], const vec3_packed48_t packed[], size_t count, const vec3_t* min, const vec3_t* max )
+{
+	scaler_t block[ 3 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		vec3_unpack48_block( block, packed + first, n, min, max );
+		vec3_block_store( v + first, block, n ) )
+}
+
+void vec3_unpack48_array( vec3_array_t* array, const vec3_packed48_t packed[], size_t count, const vec3_t* min, const vec3_t* max )
+{
+	assert( count <= array->count );
+	scaler_t block[ 3 ][ BATCH_BLOCK ];
+	FOR_EACH_BLOCK( count, first, n,
+		vec3_unpack48_block( block, packed + first, n, min, max );
+		vec3_array_block_store( array->x + first, array->y + first, array->z + first, block, n ) )
+}
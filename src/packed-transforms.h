@@ -0,0 +1,109 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _PACKED_TRANSFORMS_H_
+#define _PACKED_TRANSFORMS_H_
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "vec3.h"
+#include "quat.h"
+#include "vec3-array.h"
+#include "quat-array.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Packed Quaternions and Translations
+ *
+ * Compact storage for animation keys, which are decoded far more often
+ * than they are encoded. Every format keeps rotations, not quaternions:
+ * q and -q are the same rotation and may decode to either sign. Decoded
+ * quaternions are unit length to the precision of scaler_t.
+ *
+ * Smallest three: the largest component (by magnitude) is dropped and
+ * recovered from the unit length, and the other three, which lie within
+ * +/- 1/sqrt(2), are quantized. The index of the dropped component takes
+ * two bits. A quantized component is off by at most half a step, h, and
+ * the recovered one by up to (|a| + |b| + |c|) h / d, which is 3h when
+ * all four are 1/2.
+ *
+ *   quat_packed32_t   10 bits each, a component is off by at most 2.1e-3
+ *                     and the rotation by at most 0.28 degrees.
+ *   quat_packed48_t   15 bits each, a component is off by at most 6.5e-5
+ *                     and the rotation by at most 0.009 degrees.
+ *
+ * Octahedral: the quaternion, with w >= 0, is divided by the sum of the
+ * magnitudes of its components, which puts (x, y, z) in the octahedron
+ * |x| + |y| + |z| <= 1 (w is what is left over). x and y are quantized to
+ * 11 bits and z to 10 bits over [-1, 1].
+ *
+ *   quat_octahedral32_t  a component is off by at most 4.2e-3 and the
+ *                        rotation by at most 0.53 degrees. Less
+ *                        accurate than quat_packed32_t, but it needs no
+ *                        index bits and decodes with no selects.
+ *
+ * Translations are quantized to 16 bits per axis within a box given at
+ * both ends, so an axis is off by at most (max - min) / 131070 (plus
+ * the rounding of scaler_t). Values outside the box are clamped to it.
+ *
+ * The batch decoders write count elements, in blocks that vectorize, to
+ * arrays of quat_t or vec3_t or to a quat_array_t or vec3_array_t with
+ * at least count elements.
+ */
+typedef uint32_t quat_packed32_t;
+typedef struct quat_packed48 {
+	uint16_t bits[ 3 ];
+} quat_packed48_t;
+typedef uint32_t quat_octahedral32_t;
+typedef struct vec3_packed48 {
+	uint16_t x;
+	uint16_t y;
+	uint16_t z;
+} vec3_packed48_t;
+
+quat_packed32_t     quat_pack32             ( const quat_t* q );
+quat_t              quat_unpack32           ( quat_packed32_t packed );
+quat_packed48_t     quat_pack48             ( const quat_t* q );
+quat_t              quat_unpack48           ( quat_packed48_t packed );
+quat_octahedral32_t quat_pack_octahedral    ( const quat_t* q );
+quat_t              quat_unpack_octahedral  ( quat_octahedral32_t packed );
+vec3_packed48_t     vec3_pack48             ( const vec3_t* v, const vec3_t* min, const vec3_t* max );
+vec3_t              vec3_unpack48           ( vec3_packed48_t packed, const vec3_t* min, const vec3_t* max );
+
+void quat_unpack32_batch           ( quat_t q[], const quat_packed32_t packed[], size_t count );
+void quat_unpack32_array           ( quat_array_t* array, const quat_packed32_t packed[], size_t count );
+void quat_unpack48_batch           ( quat_t q[], const quat_packed48_t packed[], size_t count );
+void quat_unpack48_array           ( quat_array_t* array, const quat_packed48_t packed[], size_t count );
+void quat_unpack_octahedral_batch  ( quat_t q[], const quat_octahedral32_t packed[], size_t count );
+void quat_unpack_octahedral_array  ( quat_array_t* array, const quat_octahedral32_t packed[], size_t count );
+void vec3_unpack48_batch           ( vec3_t v[], const vec3_packed48_t packed[], size_t count, const vec3_t* min, const vec3_t* max );
+void vec3_unpack48_array           ( vec3_array_t* array, const vec3_packed48_t packed[], size_t count, const vec3_t* min, const vec3_t* max );
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _PACKED_TRANSFORMS_H_ */
@@ -0,0 +1,419 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "batch-math.h"
+#include "simd.h"
+#include "quat-array.h"
+
+/* Arrays with at least this many rotations are split across threads. */
+#define QUAT_ARRAY_PARALLEL_COUNT    (1 << 16)
+
+/* Below this sin(theta), slerp uses sin(t theta) / sin(theta) = t, which
+ * is off by less than theta^2 / 6. */
+#define QUAT_ARRAY_SLERP_EPSILON     (1e-6)
+
+bool quat_array_create( quat_array_t* array, size_t count )
+{
+	assert( array );
+	/* Pad each stream so the next one starts on an aligned boundary. */
+	const size_t lanes  = M3D_SIMD_ALIGNMENT / sizeof(scaler_t);
+	const size_t stride = ((count + lanes - 1) / lanes) * lanes;
+
+	array->count = count;
+
+	if( count == 0 )
+	{
+		array->x = NULL;
+		array->y = NULL;
+		array->z = NULL;
+		array->w = NULL;
+		return true;
+	}
+
+	scaler_t* block = aligned_alloc( M3D_SIMD_ALIGNMENT, 4 * stride * sizeof(scaler_t) );
+
+	if( !block )
+	{
+		array->count = 0;
+		array->x = NULL;
+		array->y = NULL;
+		array->z = NULL;
+		array->w = NULL;
+		return false;
+	}
+
+	memset( block, 0, 3 * stride * sizeof(scaler_t) );
+	array->x = block;
+	array->y = block + stride;
+	array->z = block + 2 * stride;
+	array->w = block + 3 * stride;
+
+	for( size_t i = 0; i < stride; i++ )
+	{
+		array->w[ i ] = 1;
+	}
+	return true;
+}
+
+void quat_array_destroy( quat_array_t* array )
+{
+	assert( array );
+	free( array->x ); /* x is the start of the block */
+	array->x     = NULL;
+	array->y     = NULL;
+	array->z     = NULL;
+	array->w     = NULL;
+	array->count = 0;
+}
+
+void quat_array_from_quat( quat_array_t* restrict array, const quat_t* restrict q, size_t count )
+{
+	assert( array && q );
+	assert( count <= array->count );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		array->x[ i ] = q[ i ].x;
+		array->y[ i ] = q[ i ].y;
+		array->z[ i ] = q[ i ].z;
+		array->w[ i ] = q[ i ].w;
+	}
+}
+
+void quat_array_to_quat( const quat_array_t* restrict array, quat_t* restrict q, size_t count )
+{
+	assert( array && q );
+	assert( count <= array->count );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		q[ i ].x = array->x[ i ];
+		q[ i ].y = array->y[ i ];
+		q[ i ].z = array->z[ i ];
+		q[ i ].w = array->w[ i ];
+	}
+}
+
+void quat_array_normalize( quat_array_t* array )
+{
+	assert( array );
+	const size_t count = array->count;
+	const size_t n     = simd_floor( count );
+	const simd_t zero  = simd_set1( 0 );
+	const simd_t one   = simd_set1( 1 );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_t x = simd_load( array->x + i );
+		simd_t y = simd_load( array->y + i );
+		simd_t z = simd_load( array->z + i );
+		simd_t w = simd_load( array->w + i );
+		simd_t length = simd_sqrt( simd_madd( w, w, simd_madd( z, z, simd_madd( y, y, simd_mul( x, x ) ) ) ) );
+
+		/* Zero length quaternions are left untouched, like quat_normalize(). */
+		simd_t inverse = simd_select( simd_gt( length, zero ), simd_div( one, length ), one );
+
+		simd_store( array->x + i, simd_mul( x, inverse ) );
+		simd_store( array->y + i, simd_mul( y, inverse ) );
+		simd_store( array->z + i, simd_mul( z, inverse ) );
+		simd_store( array->w + i, simd_mul( w, inverse ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		quat_t q = quat_array_get( array, i );
+		quat_normalize( &q );
+		quat_array_set( array, i, &q );
+	}
+}
+
+void quat_array_nlerp( quat_array_t* result, const quat_array_t* a, const quat_array_t* b, scaler_t t )
+{
+	assert( result && a && b );
+	assert( a->count == b->count && result->count == a->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	const simd_t zero  = simd_set1( 0 );
+	const simd_t one   = simd_set1( 1 );
+	const simd_t vs    = simd_set1( t );
+	const simd_t vr    = simd_set1( 1 - t );
+	const simd_t vn    = simd_set1( -t );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_t ax = simd_load( a->x + i );
+		simd_t ay = simd_load( a->y + i );
+		simd_t az = simd_load( a->z + i );
+		simd_t aw = simd_load( a->w + i );
+		simd_t bx = simd_load( b->x + i );
+		simd_t by = simd_load( b->y + i );
+		simd_t bz = simd_load( b->z + i );
+		simd_t bw = simd_load( b->w + i );
+		simd_t d  = simd_madd( aw, bw, simd_madd( az, bz, simd_madd( ay, by, simd_mul( ax, bx ) ) ) );
+
+		/* t for b, negated when b is on the other side of a. */
+		simd_t s = simd_select( simd_gt( zero, d ), vn, vs );
+		simd_t x = simd_madd( s, bx, simd_mul( vr, ax ) );
+		simd_t y = simd_madd( s, by, simd_mul( vr, ay ) );
+		simd_t z = simd_madd( s, bz, simd_mul( vr, az ) );
+		simd_t w = simd_madd( s, bw, simd_mul( vr, aw ) );
+
+		simd_t length  = simd_sqrt( simd_madd( w, w, simd_madd( z, z, simd_madd( y, y, simd_mul( x, x ) ) ) ) );
+		simd_t inverse = simd_select( simd_gt( length, zero ), simd_div( one, length ), one );
+
+		simd_store( result->x + i, simd_mul( x, inverse ) );
+		simd_store( result->y + i, simd_mul( y, inverse ) );
+		simd_store( result->z + i, simd_mul( z, inverse ) );
+		simd_store( result->w + i, simd_mul( w, inverse ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		quat_t qa = quat_array_get( a, i );
+		quat_t qb = quat_array_get( b, i );
+		scaler_t s = quat_dot_product( &qa, &qb ) < 0 ? -t : t;
+		quat_t q = QUAT( (1 - t) * qa.x + s * qb.x,
+		                 (1 - t) * qa.y + s * qb.y,
+		                 (1 - t) * qa.z + s * qb.z,
+		                 (1 - t) * qa.w + s * qb.w );
+		quat_normalize( &q );
+		quat_array_set( result, i, &q );
+	}
+}
+
+/*
+ * Slerp
+ *
+ * With d = |dot(a, b)| = cos(theta), slerp is alpha a + beta b where
+ *
+ *   beta  = sin(t theta) / sin(theta)
+ *   alpha = sin((1 - t) theta) / sin(theta) = cos(t theta) - d beta
+ *
+ * so each rotation needs one arctangent and one sine and cosine, which
+ * come from the branch free polynomials in batch-math.h instead of
+ * acos() and sin(). The kernel works in double precision on blocks of
+ * BATCH_BLOCK rotations so that it vectorizes; the result is within a few
+ * ulps of the exact slerp in double, which is more than float needs.
+ */
+BATCH_INLINE void slerp_coefficients( double d, double t, double* alpha, double* beta )
+{
+	d = d > 1.0 ? 1.0 : d;
+	const double sin_theta = sqrt( (1.0 - d) * (1.0 + d) );
+	const double theta     = batch_atan2( sin_theta, d );
+	double s, c;
+	batch_sincos_degrees( t * theta * (180.0 / BATCH_PI), &s, &c );
+
+	const double ratio = sin_theta > QUAT_ARRAY_SLERP_EPSILON ? s / sin_theta : t;
+	*beta  = ratio;
+	*alpha = c - d * ratio;
+}
+
+/* q[ 0 .. 3 ] is a, and is replaced by the result, and q[ 4 .. 7 ] is b. */
+static inline void quat_slerp_block( double q[ 8 ][ BATCH_BLOCK ], double t )
+{
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		const double d = q[ 0 ][ i ] * q[ 4 ][ i ] + q[ 1 ][ i ] * q[ 5 ][ i ] +
+		                 q[ 2 ][ i ] * q[ 6 ][ i ] + q[ 3 ][ i ] * q[ 7 ][ i ];
+		double alpha, beta;
+		slerp_coefficients( fabs( d ), t, &alpha, &beta );
+		beta = d < 0.0 ? -beta : beta;
+
+		q[ 0 ][ i ] = alpha * q[ 0 ][ i ] + beta * q[ 4 ][ i ];
+		q[ 1 ][ i ] = alpha * q[ 1 ][ i ] + beta * q[ 5 ][ i ];
+		q[ 2 ][ i ] = alpha * q[ 2 ][ i ] + beta * q[ 6 ][ i ];
+		q[ 3 ][ i ] = alpha * q[ 3 ][ i ] + beta * q[ 7 ][ i ];
+	}
+}
+
+/* Copies n <= BATCH_BLOCK values of a stream to or from a block, padding
+ * the block with zeros. Whole blocks take the loop with a constant count,
+ * which vectorizes. */
+static inline void block_load( double* restrict block, const scaler_t* restrict stream, size_t n )
+{
+	if( n == BATCH_BLOCK )
+	{
+		for( size_t j = 0; j < BATCH_BLOCK; j++ )
+		{
+			block[ j ] = stream[ j ];
+		}
+	}
+	else
+	{
+		for( size_t j = 0; j < n; j++ )
+		{
+			block[ j ] = stream[ j ];
+		}
+		for( size_t j = n; j < BATCH_BLOCK; j++ )
+		{
+			block[ j ] = 0.0;
+		}
+	}
+}
+
+static inline void block_store( scaler_t* restrict stream, const double* restrict block, size_t n )
+{
+	if( n == BATCH_BLOCK )
+	{
+		for( size_t j = 0; j < BATCH_BLOCK; j++ )
+		{
+			stream[ j ] = block[ j ];
+		}
+	}
+	else
+	{
+		for( size_t j = 0; j < n; j++ )
+		{
+			stream[ j ] = block[ j ];
+		}
+	}
+}
+
+void quat_array_slerp( quat_array_t* result, const quat_array_t* a, const quat_array_t* b, scaler_t t )
+{
+	assert( result && a && b );
+	assert( a->count == b->count && result->count == a->count );
+	const size_t count  = a->count;
+	const size_t blocks = (count + BATCH_BLOCK - 1) / BATCH_BLOCK;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( count >= QUAT_ARRAY_PARALLEL_COUNT )
+	#endif
+	for( size_t k = 0; k < blocks; k++ )
+	{
+		/* The block is copied in and out, which lets the result alias
+		 * the inputs. */
+		const size_t i = k * BATCH_BLOCK;
+		const size_t n = count - i < BATCH_BLOCK ? count - i : BATCH_BLOCK;
+		double q[ 8 ][ BATCH_BLOCK ];
+
+		block_load( q[ 0 ], a->x + i, n );
+		block_load( q[ 1 ], a->y + i, n );
+		block_load( q[ 2 ], a->z + i, n );
+		block_load( q[ 3 ], a->w + i, n );
+		block_load( q[ 4 ], b->x + i, n );
+		block_load( q[ 5 ], b->y + i, n );
+		block_load( q[ 6 ], b->z + i, n );
+		block_load( q[ 7 ], b->w + i, n );
+
+		quat_slerp_block( q, t );
+
+		block_store( result->x + i, q[ 0 ], n );
+		block_store( result->y + i, q[ 1 ], n );
+		block_store( result->z + i, q[ 2 ], n );
+		block_store( result->w + i, q[ 3 ], n );
+	}
+}
+
+void quat_array_blend( quat_array_t* result, const quat_array_layer_t layers[], size_t count, bool normalize )
+{
+	assert( result && layers && count > 0 );
+	const size_t size = result->count;
+	const size_t n    = simd_floor( size );
+	const simd_t zero = simd_set1( 0 );
+	const simd_t one  = simd_set1( 1 );
+
+	for( size_t l = 0; l < count; l++ )
+	{
+		assert( layers[ l ].pose && layers[ l ].pose->count == size );
+		assert( layers[ l ].weight >= 0 );
+	}
+
+	/* Every layer is read for a lane of rotations before the lane is
+	 * stored, so the result can be one of the poses. */
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( size >= QUAT_ARRAY_PARALLEL_COUNT )
+	#endif
+	for( size_t i = 0; i < n; i += SIMD_WIDTH )
+	{
+		const quat_array_t* first = layers[ 0 ].pose;
+		const simd_t rx = simd_load( first->x + i );
+		const simd_t ry = simd_load( first->y + i );
+		const simd_t rz = simd_load( first->z + i );
+		const simd_t rw = simd_load( first->w + i );
+		simd_t x = zero, y = zero, z = zero, w = zero, total = zero;
+
+		for( size_t l = 0; l < count; l++ )
+		{
+			const quat_array_t* pose = layers[ l ].pose;
+			simd_t weight = simd_set1( layers[ l ].weight );
+			if( layers[ l ].mask )
+			{
+				weight = simd_mul( weight, simd_load( layers[ l ].mask + i ) );
+			}
+
+			simd_t qx = simd_load( pose->x + i );
+			simd_t qy = simd_load( pose->y + i );
+			simd_t qz = simd_load( pose->z + i );
+			simd_t qw = simd_load( pose->w + i );
+			simd_t d  = simd_madd( rw, qw, simd_madd( rz, qz, simd_madd( ry, qy, simd_mul( rx, qx ) ) ) );
+			simd_t s  = simd_select( simd_gt( zero, d ), simd_sub( zero, weight ), weight );
+
+			x     = simd_madd( s, qx, x );
+			y     = simd_madd( s, qy, y );
+			z     = simd_madd( s, qz, z );
+			w     = simd_madd( s, qw, w );
+			total = simd_add( total, weight );
+		}
+
+		/* Either 1 / length or 1 / total, and the identity where that is
+		 * zero. */
+		simd_t norm = normalize ? simd_sqrt( simd_madd( w, w, simd_madd( z, z, simd_madd( y, y, simd_mul( x, x ) ) ) ) ) : total;
+		simd_mask_t some = simd_gt( norm, zero );
+		simd_t inverse   = simd_select( some, simd_div( one, norm ), zero );
+
+		simd_store( result->x + i, simd_mul( x, inverse ) );
+		simd_store( result->y + i, simd_mul( y, inverse ) );
+		simd_store( result->z + i, simd_mul( z, inverse ) );
+		simd_store( result->w + i, simd_select( some, simd_mul( w, inverse ), one ) );
+	}
+
+	for( size_t i = n; i < size; i++ )
+	{
+		const quat_t r = quat_array_get( layers[ 0 ].pose, i );
+		quat_t q = QUAT( 0, 0, 0, 0 );
+		scaler_t total = 0;
+
+		for( size_t l = 0; l < count; l++ )
+		{
+			quat_t p = quat_array_get( layers[ l ].pose, i );
+			scaler_t weight = layers[ l ].weight * (layers[ l ].mask ? layers[ l ].mask[ i ] : 1);
+			quat_scale( &p, quat_dot_product( &r, &p ) < 0 ? -weight : weight );
+			q = quat_add( &q, &p );
+			total += weight;
+		}
+
+		scaler_t norm = normalize ? quat_magnitude( &q ) : total;
+		if( norm > 0 )
+		{
+			quat_scale( &q, 1 / norm );
+		}
+		else
+		{
+			q = QUAT( 0, 0, 0, 1 );
+		}
+		quat_array_set( result, i, &q );
+	}
+}
@@ -0,0 +1,105 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _QUAT_ARRAY_H_
+#define _QUAT_ARRAY_H_
+#include <stddef.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "quat.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Arrays of Quaternions
+ *
+ * Like vec3_array_t, the components are stored as a structure of arrays
+ * (separate x, y, z and w streams, each 64-byte aligned) so that the batch
+ * functions below blend several rotations per instruction, e.g. every
+ * bone of a skeleton at once.
+ *
+ * The interpolations take the shortest path: b is negated wherever
+ * dot(a, b) < 0, so the result never goes the long way around. This
+ * differs from quat_slerp(), which interpolates the quaternions as given.
+ *
+ * Unless noted otherwise, the result array may be the same array as any
+ * of the inputs and every array must have the same count.
+ */
+typedef struct quat_array {
+	scaler_t* x;
+	scaler_t* y;
+	scaler_t* z;
+	scaler_t* w;
+	size_t count;
+} quat_array_t;
+
+/*
+ * One layer of a blend. Each rotation of pose is weighted by weight, times
+ * mask[ i ] when there is a mask (e.g. to blend only the upper body).
+ * Weights must not be negative.
+ */
+typedef struct quat_array_layer {
+	const quat_array_t* pose;
+	scaler_t weight;
+	const scaler_t* mask; /* one weight per rotation, or NULL */
+} quat_array_layer_t;
+
+bool quat_array_create    ( quat_array_t* array, size_t count ); /* every rotation is the identity */
+void quat_array_destroy   ( quat_array_t* array );
+void quat_array_from_quat ( quat_array_t* restrict array, const quat_t* restrict q, size_t count ); /* count <= array->count */
+void quat_array_to_quat   ( const quat_array_t* restrict array, quat_t* restrict q, size_t count ); /* count <= array->count */
+
+void quat_array_normalize ( quat_array_t* array );
+void quat_array_nlerp     ( quat_array_t* result, const quat_array_t* a, const quat_array_t* b, scaler_t t );
+void quat_array_slerp     ( quat_array_t* result, const quat_array_t* a, const quat_array_t* b, scaler_t t );
+
+/*
+ * Weighted blend of several poses: the weighted sum of the layers, each
+ * on the same side as the first layer, divided by the sum of the weights.
+ * With normalize, the result is renormalized, which is the usual way to
+ * blend animation layers (two layers with weights 1 - t and t give
+ * quat_array_nlerp()). Without it, the result is the weighted average,
+ * for callers that normalize later. Rotations with no weight at all are
+ * the identity. The result may be the pose of any layer.
+ */
+void quat_array_blend     ( quat_array_t* result, const quat_array_layer_t layers[], size_t count, bool normalize );
+
+static inline quat_t quat_array_get( const quat_array_t* array, size_t i )
+{
+	return QUAT( array->x[ i ], array->y[ i ], array->z[ i ], array->w[ i ] );
+}
+
+static inline void quat_array_set( quat_array_t* array, size_t i, const quat_t* q )
+{
+	array->x[ i ] = q->x;
+	array->y[ i ] = q->y;
+	array->z[ i ] = q->z;
+	array->w[ i ] = q->w;
+}
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _QUAT_ARRAY_H_ */
@@ -251,7 +251,9 @@ static inline quat_t quat_lerp( const quat_t* restrict a, const quat_t* restrict
 }
 
 
-#define quat_to_string vec4_to_string
+#define quat_to_string   vec4_to_string
+#define quat_to_string_r vec4_to_string_r
+#define quat_format      vec4_format
 
 
 #ifdef __cplusplus
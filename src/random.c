@@ -0,0 +1,713 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "random.h"
+
+/* Threads seed their default state lazily from this seed, each one a jump
+ * further along the sequence than the thread before it. */
+#define M3D_RANDOM_DEFAULT_SEED  (0x6d33a1f0c3c5e8d1ULL)
+
+static _Atomic uint64_t default_seed    = M3D_RANDOM_DEFAULT_SEED;
+static atomic_uint      default_streams = 0;
+
+static _Thread_local m3d_random_t default_random;
+static _Thread_local bool         default_ready = false;
+
+static inline uint64_t splitmix64( uint64_t* x )
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+void m3d_random_seed( m3d_random_t* r, uint64_t seed )
+{
+	assert( r );
+	/* SplitMix64 spreads the seed so that similar seeds give unrelated
+	 * states and the state is never all zeros. */
+	r->s[ 0 ] = splitmix64( &seed );
+	r->s[ 1 ] = splitmix64( &seed );
+	r->s[ 2 ] = splitmix64( &seed );
+	r->s[ 3 ] = splitmix64( &seed );
+	r->spare     = 0;
+	r->has_spare = false;
+}
+
+static void random_jump( m3d_random_t* r, const uint64_t polynomial[ 4 ] )
+{
+	uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+	for( int i = 0; i < 4; i++ )
+	{
+		for( int b = 0; b < 64; b++ )
+		{
+			if( polynomial[ i ] & (UINT64_C(1) << b) )
+			{
+				s0 ^= r->s[ 0 ];
+				s1 ^= r->s[ 1 ];
+				s2 ^= r->s[ 2 ];
+				s3 ^= r->s[ 3 ];
+			}
+			m3d_random_next( r );
+		}
+	}
+
+	r->s[ 0 ] = s0;
+	r->s[ 1 ] = s1;
+	r->s[ 2 ] = s2;
+	r->s[ 3 ] = s3;
+	r->has_spare = false;
+}
+
+void m3d_random_jump( m3d_random_t* r )
+{
+	static const uint64_t jump[ 4 ] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+	};
+	assert( r );
+	random_jump( r, jump );
+}
+
+void m3d_random_long_jump( m3d_random_t* r )
+{
+	static const uint64_t long_jump[ 4 ] = {
+		0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+	};
+	assert( r );
+	random_jump( r, long_jump );
+}
+
+m3d_random_t* m3d_random_default( void )
+{
+	if( !default_ready )
+	{
+		unsigned int stream = atomic_fetch_add( &default_streams, 1 );
+
+		m3d_random_seed( &default_random, atomic_load( &default_seed ) );
+		while( stream-- > 0 )
+		{
+			m3d_random_jump( &default_random );
+		}
+		default_ready = true;
+	}
+
+	return &default_random;
+}
+
+void m3d_seed( uint64_t seed )
+{
+	atomic_store( &default_seed, seed );
+	atomic_store( &default_streams, 1 ); /* the calling thread is stream 0 */
+	m3d_random_seed( &default_random, seed );
+	default_ready = true;
+}
+
+uint64_t m3d_random_bounded( m3d_random_t* r, uint64_t bound )
+{
+	uint64_t mask = bound;
+	uint64_t x;
+
+	mask |= mask >> 1;
+	mask |= mask >> 2;
+	mask |= mask >> 4;
+	mask |= mask >> 8;
+	mask |= mask >> 16;
+	mask |= mask >> 32;
+
+	/* Rejecting values outside the bound keeps every value equally likely;
+	 * at worst half of the draws are rejected. */
+	do {
+		x = m3d_random_next( r ) & mask;
+	} while( x > bound );
+
+	return x;
+}
+
+int m3d_random_rangei( m3d_random_t* r, int min, int max )
+{
+	assert( min <= max );
+	return (int) ((int64_t) min + (int64_t) m3d_random_bounded( r, (uint64_t) ((int64_t) max - (int64_t) min) ));
+}
+
+long m3d_random_rangel( m3d_random_t* r, long min, long max )
+{
+	assert( min <= max );
+	return (long) ((unsigned long) min + (unsigned long) m3d_random_bounded( r, (unsigned long) max - (unsigned long) min ));
+}
+
+/* Marsaglia's polar method makes two values at a time; the second one is
+ * kept in the state for the next call. */
+float m3d_random_guassianf( m3d_random_t* r, float mean, float stddev )
+{
+	if( r->has_spare )
+	{
+		r->has_spare = false;
+		return mean + stddev * (float) r->spare;
+	}
+
+	float ux, uy, s;
+	do {
+		ux = m3d_random_unitf( r );
+		uy = m3d_random_unitf( r );
+		s  = ux * ux + uy * uy;
+	} while( s >= 1.0f || s == 0.0f );
+
+	float mul = sqrtf( -2.0f * logf( s ) / s );
+
+	r->spare     = uy * mul;
+	r->has_spare = true;
+	return mean + stddev * ux * mul;
+}
+
+double m3d_random_guassiand( m3d_random_t* r, double mean, double stddev )
+{
+	if( r->has_spare )
+	{
+		r->has_spare = false;
+		return mean + stddev * (double) r->spare;
+	}
+
+	double ux, uy, s;
+	do {
+		ux = m3d_random_unitd( r );
+		uy = m3d_random_unitd( r );
+		s  = ux * ux + uy * uy;
+	} while( s >= 1.0 || s == 0.0 );
+
+	double mul = sqrt( -2.0 * log( s ) / s );
+
+	r->spare     = uy * mul;
+	r->has_spare = true;
+	return mean + stddev * ux * mul;
+}
+
+long double m3d_random_guassianld( m3d_random_t* r, long double mean, long double stddev )
+{
+	if( r->has_spare )
+	{
+		r->has_spare = false;
+		return mean + stddev * r->spare;
+	}
+
+	long double ux, uy, s;
+	do {
+		ux = m3d_random_unitld( r );
+		uy = m3d_random_unitld( r );
+		s  = ux * ux + uy * uy;
+	} while( s >= 1.0L || s == 0.0L );
+
+	long double mul = sqrtl( -2.0L * logl( s ) / s );
+
+	r->spare     = uy * mul;
+	r->has_spare = true;
+	return mean + stddev * ux * mul;
+}
+
+/*
+ * Bulk Fills
+ *
+ * Large fills run RANDOM_LANES xoshiro256** generators side by side. Their
+ * states are stored as a structure of arrays so that every step compiles to
+ * a few vector instructions. The lanes are seeded from r, so a fill can be
+ * reproduced from r's state, and r itself only advances by RANDOM_LANES
+ * numbers. Small fills just draw from r.
+ */
+#define RANDOM_LANES   (8)
+#define RANDOM_BLOCK   (256) /* numbers generated at a time */
+#define RANDOM_SMALL   (32)  /* fills below this size draw from r directly */
+
+typedef struct random_lanes {
+	uint64_t s0[ RANDOM_LANES ];
+	uint64_t s1[ RANDOM_LANES ];
+	uint64_t s2[ RANDOM_LANES ];
+	uint64_t s3[ RANDOM_LANES ];
+} random_lanes_t;
+
+/* A block of numbers from the lanes, handed out one at a time to the
+ * rejection samplers. */
+typedef struct random_stream {
+	random_lanes_t lanes;
+	size_t         index;
+	uint64_t       block[ RANDOM_BLOCK ];
+} random_stream_t;
+
+static inline m3d_random_t* random_state( m3d_random_t* r )
+{
+	return r ? r : m3d_random_default( );
+}
+
+static void random_lanes_seed( random_lanes_t* lanes, m3d_random_t* r )
+{
+	for( size_t k = 0; k < RANDOM_LANES; k++ )
+	{
+		uint64_t seed = m3d_random_next( r );
+		lanes->s0[ k ] = splitmix64( &seed );
+		lanes->s1[ k ] = splitmix64( &seed );
+		lanes->s2[ k ] = splitmix64( &seed );
+		lanes->s3[ k ] = splitmix64( &seed );
+	}
+}
+
+/* count must be a multiple of RANDOM_LANES. */
+static void random_lanes_generate( random_lanes_t* restrict lanes, uint64_t* restrict out, size_t count )
+{
+	random_lanes_t l = *lanes;
+
+	for( size_t i = 0; i < count; i += RANDOM_LANES )
+	{
+		for( size_t k = 0; k < RANDOM_LANES; k++ )
+		{
+			const uint64_t x = l.s1[ k ] * 5;
+			const uint64_t t = l.s1[ k ] << 17;
+			out[ i + k ] = ((x << 7) | (x >> 57)) * 9;
+
+			l.s2[ k ] ^= l.s0[ k ];
+			l.s3[ k ] ^= l.s1[ k ];
+			l.s1[ k ] ^= l.s2[ k ];
+			l.s0[ k ] ^= l.s3[ k ];
+			l.s2[ k ] ^= t;
+			l.s3[ k ] = (l.s3[ k ] << 45) | (l.s3[ k ] >> 19);
+		}
+	}
+
+	*lanes = l;
+}
+
+static void random_stream_initialize( random_stream_t* s, m3d_random_t* r )
+{
+	random_lanes_seed( &s->lanes, r );
+	s->index = RANDOM_BLOCK;
+}
+
+static inline uint64_t random_stream_next( random_stream_t* s )
+{
+	if( s->index == RANDOM_BLOCK )
+	{
+		random_lanes_generate( &s->lanes, s->block, RANDOM_BLOCK );
+		s->index = 0;
+	}
+	return s->block[ s->index++ ];
+}
+
+/* [-1, 1) from the upper 53 bits */
+static inline double random_stream_unit( random_stream_t* s )
+{
+	return (double) (int64_t) (random_stream_next( s ) >> 11) * 0x1.0p-52 - 1.0;
+}
+
+/* Conversions work on a whole block at a time, which lets the compiler
+ * vectorize them without a remainder loop. Two uniform floats are made
+ * from the upper and lower 24 bits of each number. */
+static inline void random_floats( float* restrict out, const uint64_t* restrict bits, float scale, float offset )
+{
+	for( size_t i = 0; i < RANDOM_BLOCK; i++ )
+	{
+		out[ 2 * i + 0 ] = offset + (float) (int32_t) (bits[ i ] >> 40) * scale;
+		out[ 2 * i + 1 ] = offset + (float) (int32_t) (bits[ i ] & 0xffffff) * scale;
+	}
+}
+
+/* Uniform doubles are made by putting 52 bits under the exponent of 1.0,
+ * which avoids a 64-bit integer conversion. */
+static inline void random_doubles( double* restrict out, const uint64_t* restrict bits, double scale, double offset )
+{
+	for( size_t i = 0; i < RANDOM_BLOCK; i++ )
+	{
+		const uint64_t u = UINT64_C(0x3ff0000000000000) | (bits[ i ] >> 12);
+		double d;
+		memcpy( &d, &u, sizeof(d) );
+		out[ i ] = offset + (d - 1.0) * scale;
+	}
+}
+
+static void random_fill_floats( m3d_random_t* r, float* out, size_t count, float min, float max )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+
+	if( count < RANDOM_SMALL )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			out[ i ] = m3d_random_rangef( r, min, max );
+		}
+		return;
+	}
+
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+	const float scale = (max - min) * 0x1.0p-24f;
+	size_t i = 0;
+
+	for( ; i + 2 * RANDOM_BLOCK <= count; i += 2 * RANDOM_BLOCK )
+	{
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_floats( out + i, s.block, scale, min );
+	}
+
+	if( i < count )
+	{
+		float rest[ 2 * RANDOM_BLOCK ];
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_floats( rest, s.block, scale, min );
+		memcpy( out + i, rest, (count - i) * sizeof(float) );
+	}
+}
+
+static void random_fill_doubles( m3d_random_t* r, double* out, size_t count, double min, double max )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+
+	if( count < RANDOM_SMALL )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			out[ i ] = m3d_random_ranged( r, min, max );
+		}
+		return;
+	}
+
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+	const double scale = max - min;
+	size_t i = 0;
+
+	for( ; i + RANDOM_BLOCK <= count; i += RANDOM_BLOCK )
+	{
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_doubles( out + i, s.block, scale, min );
+	}
+
+	if( i < count )
+	{
+		double rest[ RANDOM_BLOCK ];
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_doubles( rest, s.block, scale, min );
+		memcpy( out + i, rest, (count - i) * sizeof(double) );
+	}
+}
+
+void m3d_fill_uniformf( m3d_random_t* r, float* out, size_t count )
+{
+	random_fill_floats( r, out, count, 0.0f, 1.0f );
+}
+
+void m3d_fill_uniformd( m3d_random_t* r, double* out, size_t count )
+{
+	random_fill_doubles( r, out, count, 0.0, 1.0 );
+}
+
+void m3d_fill_rangef( m3d_random_t* r, float* out, size_t count, float min, float max )
+{
+	random_fill_floats( r, out, count, min, max );
+}
+
+void m3d_fill_ranged( m3d_random_t* r, double* out, size_t count, double min, double max )
+{
+	random_fill_doubles( r, out, count, min, max );
+}
+
+void m3d_fill_rangei( m3d_random_t* r, int* out, size_t count, int min, int max )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+	assert( min <= max );
+
+	if( count < RANDOM_SMALL )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			out[ i ] = m3d_random_rangei( r, min, max );
+		}
+		return;
+	}
+
+	const uint64_t bound = (uint64_t) ((int64_t) max - (int64_t) min);
+	uint64_t mask = bound;
+	mask |= mask >> 1;
+	mask |= mask >> 2;
+	mask |= mask >> 4;
+	mask |= mask >> 8;
+	mask |= mask >> 16;
+
+	/* The bound fits in 32 bits, so each number gives two candidates. Like
+	 * the geometric fills below, rejected ones are skipped without a branch. */
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+
+	for( size_t i = 0; i < count; )
+	{
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+
+		for( size_t k = 0; k < 2 * RANDOM_BLOCK && i < count; k++ )
+		{
+			const uint64_t x = (s.block[ k / 2 ] >> (32 * (k & 1))) & mask;
+			out[ i ] = (int) ((int64_t) min + (int64_t) x);
+			i += x <= bound;
+		}
+	}
+}
+
+/*
+ * Normal deviates use the Ziggurat method, with Doornik's 128 block layout
+ * (ZIGNOR). About 99% of the samples need one random number, a table
+ * lookup and a compare. The tables below are x[i] for the right edges of
+ * the blocks and x[i + 1] / x[i].
+ */
+#define ZIGGURAT_R   (3.442619855899)
+
+static const double ziggurat_x[ 129 ] = {
+	3.7130862467425505, 3.4426198558990002, 3.2230849845811416, 3.0832288582168683,
+	2.9786962526477803, 2.8943440070215289, 2.8231253505489105, 2.7611693723871769,
+	2.7061135731218195, 2.6564064112613597, 2.6109722484318474, 2.5690336259249378,
+	2.5300096723888275, 2.4934545220953721, 2.4590181774118305, 2.4264206455337498,
+	2.3954342780110625, 2.3658713701176386, 2.3375752413392368, 2.310413683698763,
+	2.2842740596774718, 2.2590595738691985, 2.2346863955909795, 2.2110814088787034,
+	2.1881804320760492, 2.1659267937489219, 2.1442701823603953, 2.1231657086739766,
+	2.1025731351892385, 2.0824562379920168, 2.0627822745083084, 2.0435215366550676,
+	2.0246469733773855, 2.0061338699634721, 1.9879595741276199, 1.9701032608543265,
+	1.9525457295535567, 1.9352692282966228, 1.9182573008645099, 1.9014946531051511,
+	1.884967035707759, 1.8686611409944887, 1.8525645117280911, 1.836665460258446,
+	1.8209529965961255, 1.8054167642192285, 1.7900469825998586, 1.7748343955860695,
+	1.7597702248995934, 1.7448461281138004, 1.7300541605637305, 1.7153867407136676,
+	1.7008366185699169, 1.6863968467791681, 1.6720607540976009, 1.6578219209540241,
+	1.6436741568628686, 1.6296114794706347, 1.615628095043161, 1.6017183802213781,
+	1.5878768648905761, 1.5740982160230008, 1.5603772223661689, 1.5467087798599104,
+	1.5330878776740433, 1.5195095847659401, 1.5059690368632033, 1.492461423781354,
+	1.4789819769899242, 1.4655259573427108, 1.4520886428892246, 1.4386653166845635,
+	1.4252512545140601, 1.4118417124470577, 1.3984319141310053, 1.3850170377326518,
+	1.3715922024273426, 1.3581524543301435, 1.344692751753547, 1.3312079496656273,
+	1.3176927832094141, 1.3041418501286168, 1.2905495919261964, 1.2769102735601556,
+	1.2632179614546211, 1.2494664995730682, 1.2356494832633627, 1.2217602305399964,
+	1.2077917504159497, 1.1937367078331287, 1.1795873846639882, 1.1653356361647524,
+	1.1509728421488674, 1.1364898520131608, 1.1218769225825422, 1.107123647534036,
+	1.0922188769072774, 1.0771506248928957, 1.0619059636948243, 1.0464709007640454,
+	1.0308302360681956, 1.0149673952513305, 0.99886423349298359, 0.98250080351542901,
+	0.9658550794011499, 0.94890262551130644, 0.93161619661515083, 0.91396525102303228,
+	0.89591535258093769, 0.87742742911292337, 0.85845684319381321, 0.83895221429757738,
+	0.81885390670035729, 0.79809206064405691, 0.77658398789475991, 0.75423066445405562,
+	0.73091191064248884, 0.70647961133543646, 0.68074791866915463, 0.65347863873997525,
+	0.6243585973360507, 0.59296294247144832, 0.55869217840818519, 0.52065603876206057,
+	0.47743783729668982, 0.42654798635542351, 0.36287143109703196, 0.27232086481396467,
+	0,
+};
+
+static const double ziggurat_ratio[ 128 ] = {
+	0.92715860260966809, 0.93623028957388921, 0.95660799295292287, 0.96609638454488822,
+	0.97168148798278098, 0.97539385218210217, 0.97805411716851776, 0.98006069464048895,
+	0.98163153152396454, 0.98289638112718658, 0.98393754566633251, 0.98480987047335344,
+	0.98555137923289438, 0.98618930308197361, 0.98674367998678636, 0.98722959781119435,
+	0.98765864371032963, 0.98803987015701755, 0.98838045631210891, 0.98868617156930783,
+	0.98896170724285448, 0.98921091831302443, 0.98943700254369094, 0.98964263517811046,
+	0.98983007159696879, 0.99000122651835243, 0.99015773578346966, 0.99030100505080254,
+	0.99043224853369438, 0.99055252008432182, 0.99066273833585672, 0.99076370718921958,
+	0.99085613262097194, 0.99094063656071807, 0.99101776841657896, 0.99108801469971874,
+	0.99115180710216499, 0.99120952930818496, 0.99126152276245516, 0.99130809157396138,
+	0.99134950669991539, 0.99138600952667588, 0.9914178149430195, 0.99144511398384472,
+	0.99146807610853294, 0.99148685116701207, 0.99150157109748349, 0.9915123513923666,
+	0.99151929236293068, 0.99152248022806455, 0.99152198804846459, 0.99151787652404422,
+	0.99151019466943868, 0.99149898038000517, 0.99148426089860509, 0.9914660531916395,
+	0.99144436424122284, 0.99141919125900113, 0.99139052182587151, 0.99135833396074968,
+	0.99132259612049656, 0.99128326713214987, 0.9912402960576856, 0.991193621990624,
+	0.99114317378289896, 0.99108886969948096, 0.99103061699728945, 0.99096831142390407,
+	0.99090183663049125, 0.99083106349214667, 0.9907558493275227, 0.99067603700809548,
+	0.99059145394572945, 0.99050191094523621, 0.99040720090638834, 0.99030709735723799,
+	0.99020135279756305, 0.99008969682771364, 0.98997183403395694, 0.98984744159647786,
+	0.98971616658035255, 0.98957762286281981, 0.98943138764184679, 0.98927699746094222,
+	0.98911394367309524, 0.9889416672520418, 0.98875955284124373, 0.98856692190915973,
+	0.98836302485260341, 0.98814703185694575, 0.98791802228090508, 0.98767497228253098,
+	0.98741674033883642, 0.98714205023059953, 0.98684947096108866, 0.98653739294616549,
+	0.98620399964423899, 0.98584723357553894, 0.98546475539408995, 0.98505389429899071,
+	0.98461158757103473, 0.98413430634945731, 0.98361796385447464, 0.98305780101683371,
+	0.98244824275257281, 0.98178271570611264, 0.98105341485447561, 0.98025100142276667,
+	0.97936420732745055, 0.97837931059633121, 0.97727942988529215, 0.97604356093863154,
+	0.97464523783007639, 0.97305063687522453, 0.97121583268629852, 0.9690827290502092,
+	0.96657285378538182, 0.96357758631187951, 0.95994217656590097, 0.95543841882869618,
+	0.94971534788091627, 0.9422042060159378, 0.93191932674895062, 0.91699279707169312,
+	0.89341051972459762, 0.85071654937943442, 0.75046102138899429, 0,
+};
+
+static double random_normal_tail( random_stream_t* s, bool negative )
+{
+	double x, y;
+	do {
+		/* Both uniforms are in (0, 1] so that the logarithms are finite. */
+		x = log( (double) ((random_stream_next( s ) >> 11) + 1) * 0x1.0p-53 ) / ZIGGURAT_R;
+		y = log( (double) ((random_stream_next( s ) >> 11) + 1) * 0x1.0p-53 );
+	} while( -2 * y < x * x );
+
+	return negative ? x - ZIGGURAT_R : ZIGGURAT_R - x;
+}
+
+static inline double random_normal( random_stream_t* s )
+{
+	for( ;; )
+	{
+		/* The block comes from the low bits and u from the upper 53. */
+		const uint64_t bits = random_stream_next( s );
+		const unsigned int i = (unsigned int) (bits & 0x7f);
+		const double u = (double) (int64_t) (bits >> 11) * 0x1.0p-52 - 1.0;
+
+		if( fabs( u ) < ziggurat_ratio[ i ] )
+		{
+			return u * ziggurat_x[ i ];
+		}
+
+		if( i == 0 )
+		{
+			return random_normal_tail( s, u < 0 );
+		}
+
+		const double x  = u * ziggurat_x[ i ];
+		const double f0 = exp( -0.5 * (ziggurat_x[ i ] * ziggurat_x[ i ] - x * x) );
+		const double f1 = exp( -0.5 * (ziggurat_x[ i + 1 ] * ziggurat_x[ i + 1 ] - x * x) );
+
+		if( f1 + 0.5 * (random_stream_unit( s ) + 1.0) * (f0 - f1) < 1.0 )
+		{
+			return x;
+		}
+	}
+}
+
+void m3d_fill_guassianf( m3d_random_t* r, float* out, size_t count, float mean, float stddev )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+
+	if( count < RANDOM_SMALL )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			out[ i ] = m3d_random_guassianf( r, mean, stddev );
+		}
+		return;
+	}
+
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		out[ i ] = (float) (mean + stddev * random_normal( &s ));
+	}
+}
+
+void m3d_fill_guassiand( m3d_random_t* r, double* out, size_t count, double mean, double stddev )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+
+	if( count < RANDOM_SMALL )
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			out[ i ] = m3d_random_guassiand( r, mean, stddev );
+		}
+		return;
+	}
+
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		out[ i ] = mean + stddev * random_normal( &s );
+	}
+}
+
+/*
+ * The geometric fills sample by rejection. Candidates are converted a block
+ * at a time and accepted ones are kept by advancing the output index
+ * without a branch, since about a quarter (disk) to a half (ball) of them
+ * are rejected at random.
+ */
+void m3d_fill_unit_vec3( m3d_random_t* r, vec3_t* out, size_t count )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+	double u[ RANDOM_BLOCK ];
+
+	/* Marsaglia (1972): a point (a, b) in the unit disk maps to the sphere
+	 * without any trigonometry. */
+	for( size_t i = 0; i < count; )
+	{
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_doubles( u, s.block, 2.0, -1.0 );
+
+		for( size_t k = 0; k < RANDOM_BLOCK && i < count; k += 2 )
+		{
+			const double d = u[ k ] * u[ k ] + u[ k + 1 ] * u[ k + 1 ];
+			const double h = 2.0 * sqrt( fmax( 1.0 - d, 0.0 ) );
+			out[ i ] = VEC3( u[ k ] * h, u[ k + 1 ] * h, 1.0 - 2.0 * d );
+			i += d < 1.0;
+		}
+	}
+}
+
+void m3d_fill_in_disk( m3d_random_t* r, vec2_t* out, size_t count, scaler_t radius )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+	double u[ RANDOM_BLOCK ];
+
+	for( size_t i = 0; i < count; )
+	{
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_doubles( u, s.block, 2.0, -1.0 );
+
+		for( size_t k = 0; k < RANDOM_BLOCK && i < count; k += 2 )
+		{
+			out[ i ] = VEC2( u[ k ] * radius, u[ k + 1 ] * radius );
+			i += u[ k ] * u[ k ] + u[ k + 1 ] * u[ k + 1 ] < 1.0;
+		}
+	}
+}
+
+void m3d_fill_in_sphere( m3d_random_t* r, vec3_t* out, size_t count, scaler_t radius )
+{
+	r = random_state( r );
+	assert( out || count == 0 );
+	random_stream_t s;
+	random_stream_initialize( &s, r );
+	double u[ RANDOM_BLOCK ];
+
+	for( size_t i = 0; i < count; )
+	{
+		random_lanes_generate( &s.lanes, s.block, RANDOM_BLOCK );
+		random_doubles( u, s.block, 2.0, -1.0 );
+
+		/* 85 candidates per block; the last number is unused. */
+		for( size_t k = 0; k + 2 < RANDOM_BLOCK && i < count; k += 3 )
+		{
+			out[ i ] = VEC3( u[ k ] * radius, u[ k + 1 ] * radius, u[ k + 2 ] * radius );
+			i += u[ k ] * u[ k ] + u[ k + 1 ] * u[ k + 1 ] + u[ k + 2 ] * u[ k + 2 ] < 1.0;
+		}
+	}
+}
@@ -0,0 +1,161 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+#include <stdint.h>
+#include <float.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "vec2.h"
+#include "vec3.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pseudo-Random Number Generator
+ *
+ * A xoshiro256** generator. The state is 32 bytes, the period is 2^256 - 1,
+ * and a number costs a handful of shifts, rotates and one multiply. A state
+ * must not be shared between threads without locking; give each thread its
+ * own state instead. m3d_random_jump() advances a state by 2^128 numbers,
+ * so that seeding once and jumping k times gives thread k a stream that
+ * will not overlap the others.
+ *
+ * Every thread also has a default state, which is what m3d_uniformf(),
+ * m3d_guassiand() and the other mathematics.h functions use. Each thread's
+ * default state starts a jump further along the same seed, so threads get
+ * independent streams without any setup. m3d_seed() (in mathematics.h)
+ * reseeds the calling thread and sets the seed used by threads that start
+ * afterwards.
+ *
+ * Floating point numbers are uniform in [0, 1).
+ */
+typedef struct m3d_random {
+	uint64_t    s[ 4 ];
+	long double spare;     /* second value from the polar method */
+	bool        has_spare;
+} m3d_random_t;
+
+void          m3d_random_seed        ( m3d_random_t* r, uint64_t seed );
+void          m3d_random_jump        ( m3d_random_t* r ); /* skips 2^128 numbers */
+void          m3d_random_long_jump   ( m3d_random_t* r ); /* skips 2^192 numbers */
+m3d_random_t* m3d_random_default     ( void ); /* the calling thread's state */
+uint64_t      m3d_random_bounded     ( m3d_random_t* r, uint64_t bound ); /* [0, bound] */
+int           m3d_random_rangei      ( m3d_random_t* r, int min, int max ); /* [min, max] */
+long          m3d_random_rangel      ( m3d_random_t* r, long min, long max ); /* [min, max] */
+float         m3d_random_guassianf   ( m3d_random_t* r, float mean, float stddev );
+double        m3d_random_guassiand   ( m3d_random_t* r, double mean, double stddev );
+long double   m3d_random_guassianld  ( m3d_random_t* r, long double mean, long double stddev );
+
+/*
+ * Bulk Fills
+ *
+ * These write count values straight into out and are much faster than a
+ * loop over the functions above. Large fills generate several streams at
+ * once, seeded from r, and the normal deviates use the Ziggurat method. r
+ * may be NULL to use the calling thread's default state.
+ */
+void          m3d_fill_uniformf      ( m3d_random_t* r, float* out, size_t count ); /* [0, 1) */
+void          m3d_fill_uniformd      ( m3d_random_t* r, double* out, size_t count ); /* [0, 1) */
+void          m3d_fill_rangef        ( m3d_random_t* r, float* out, size_t count, float min, float max ); /* [min, max) */
+void          m3d_fill_ranged        ( m3d_random_t* r, double* out, size_t count, double min, double max ); /* [min, max) */
+void          m3d_fill_rangei        ( m3d_random_t* r, int* out, size_t count, int min, int max ); /* [min, max] */
+void          m3d_fill_guassianf     ( m3d_random_t* r, float* out, size_t count, float mean, float stddev );
+void          m3d_fill_guassiand     ( m3d_random_t* r, double* out, size_t count, double mean, double stddev );
+void          m3d_fill_unit_vec3     ( m3d_random_t* r, vec3_t* out, size_t count ); /* on the unit sphere */
+void          m3d_fill_in_disk       ( m3d_random_t* r, vec2_t* out, size_t count, scaler_t radius );
+void          m3d_fill_in_sphere     ( m3d_random_t* r, vec3_t* out, size_t count, scaler_t radius ); /* inside the ball */
+
+static inline uint64_t m3d_random_rotl( uint64_t x, int k )
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t m3d_random_next( m3d_random_t* r )
+{
+	uint64_t* s = r->s;
+	const uint64_t result = m3d_random_rotl( s[ 1 ] * 5, 7 ) * 9;
+	const uint64_t t = s[ 1 ] << 17;
+
+	s[ 2 ] ^= s[ 0 ];
+	s[ 3 ] ^= s[ 1 ];
+	s[ 1 ] ^= s[ 2 ];
+	s[ 0 ] ^= s[ 3 ];
+	s[ 2 ] ^= t;
+	s[ 3 ] = m3d_random_rotl( s[ 3 ], 45 );
+
+	return result;
+}
+
+static inline float m3d_random_uniformf( m3d_random_t* r )
+{
+	/* The upper bits are the best ones. */
+	return (float) (m3d_random_next( r ) >> 40) * 0x1.0p-24f;
+}
+
+static inline double m3d_random_uniformd( m3d_random_t* r )
+{
+	return (double) (m3d_random_next( r ) >> 11) * 0x1.0p-53;
+}
+
+static inline long double m3d_random_uniformld( m3d_random_t* r )
+{
+	#if LDBL_MANT_DIG >= 64
+	return (long double) m3d_random_next( r ) * 0x1.0p-64L;
+	#else
+	return (long double) (m3d_random_next( r ) >> 11) * 0x1.0p-53L;
+	#endif
+}
+
+static inline float m3d_random_rangef( m3d_random_t* r, float min, float max )
+{
+	return min + m3d_random_uniformf( r ) * (max - min);
+}
+
+static inline double m3d_random_ranged( m3d_random_t* r, double min, double max )
+{
+	return min + m3d_random_uniformd( r ) * (max - min);
+}
+
+static inline float m3d_random_unitf( m3d_random_t* r ) /* [-1, 1) */
+{
+	return 2 * m3d_random_uniformf( r ) - 1;
+}
+
+static inline double m3d_random_unitd( m3d_random_t* r ) /* [-1, 1) */
+{
+	return 2 * m3d_random_uniformd( r ) - 1;
+}
+
+static inline long double m3d_random_unitld( m3d_random_t* r ) /* [-1, 1) */
+{
+	return 2 * m3d_random_uniformld( r ) - 1;
+}
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _RANDOM_H_ */
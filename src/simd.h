@@ -0,0 +1,242 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _SIMD_H_
+#define _SIMD_H_
+#include <stddef.h>
+#include "mathematics.h"
+#if defined(__GNUC__) && defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+#endif
+
+/*
+ * Internal SIMD abstraction over lanes of scaler_t.
+ *
+ * This header is not installed. The instruction set is chosen at build
+ * time from the compiler's target macros, which are driven by the
+ * SIMD_FLAGS that AX_EXT detects in configure. Kernels are written once
+ * against simd_t and fall back to one scalar lane when no vector unit
+ * handles scaler_t (e.g. long double).
+ */
+#if defined(__SSE2__)
+# define M3D_SIMD_SSE2 1
+#endif
+#if defined(__AVX__)
+# define M3D_SIMD_AVX 1
+#endif
+#if defined(__AVX2__)
+# define M3D_SIMD_AVX2 1
+#endif
+#if defined(__AVX512F__)
+# define M3D_SIMD_AVX512F 1
+#endif
+#if defined(__FMA__)
+# define M3D_SIMD_FMA 1
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+# define M3D_SIMD_NEON 1
+#endif
+
+#if defined(LIBM3D_USE_LONG_DOUBLE)
+# define M3D_SIMD_SCALAR 1
+#elif defined(LIBM3D_USE_DOUBLE)
+# if defined(M3D_SIMD_AVX)
+#  define M3D_SIMD_DOUBLE_AVX 1
+# elif defined(M3D_SIMD_SSE2)
+#  define M3D_SIMD_DOUBLE_SSE2 1
+# elif defined(M3D_SIMD_NEON)
+#  define M3D_SIMD_DOUBLE_NEON 1
+# else
+#  define M3D_SIMD_SCALAR 1
+# endif
+#else
+# if defined(M3D_SIMD_AVX)
+#  define M3D_SIMD_FLOAT_AVX 1
+# elif defined(M3D_SIMD_SSE2)
+#  define M3D_SIMD_FLOAT_SSE2 1
+# elif defined(M3D_SIMD_NEON)
+#  define M3D_SIMD_FLOAT_NEON 1
+# else
+#  define M3D_SIMD_SCALAR 1
+# endif
+#endif
+
+/* Alignment used for all batch storage. It covers a cache line and the
+ * widest vector register that we use.
+ */
+#define M3D_SIMD_ALIGNMENT    (64)
+
+#if defined(M3D_SIMD_FLOAT_AVX)
+typedef __m256 simd_t;
+typedef __m256 simd_mask_t;
+# define SIMD_WIDTH  (8)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return _mm256_set1_ps( s ); }
+static inline simd_t simd_load  ( const scaler_t* p )           { return _mm256_loadu_ps( p ); }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { _mm256_storeu_ps( p, v ); }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return _mm256_add_ps( a, b ); }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return _mm256_sub_ps( a, b ); }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return _mm256_mul_ps( a, b ); }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return _mm256_div_ps( a, b ); }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return _mm256_sqrt_ps( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return _mm256_min_ps( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return _mm256_max_ps( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return _mm256_blendv_ps( b, a, m ); }
+# if defined(M3D_SIMD_FMA)
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm256_fmadd_ps( a, b, c ); }
+# else
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm256_add_ps( _mm256_mul_ps( a, b ), c ); }
+# endif
+
+#elif defined(M3D_SIMD_FLOAT_SSE2)
+typedef __m128 simd_t;
+typedef __m128 simd_mask_t;
+# define SIMD_WIDTH  (4)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return _mm_set1_ps( s ); }
+static inline simd_t simd_load  ( const scaler_t* p )           { return _mm_loadu_ps( p ); }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { _mm_storeu_ps( p, v ); }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return _mm_add_ps( a, b ); }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return _mm_sub_ps( a, b ); }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return _mm_mul_ps( a, b ); }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return _mm_div_ps( a, b ); }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return _mm_sqrt_ps( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return _mm_min_ps( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return _mm_max_ps( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return _mm_cmpgt_ps( a, b ); }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return _mm_or_ps( _mm_and_ps( m, a ), _mm_andnot_ps( m, b ) ); }
+# if defined(M3D_SIMD_FMA)
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm_fmadd_ps( a, b, c ); }
+# else
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+# endif
+
+#elif defined(M3D_SIMD_FLOAT_NEON)
+typedef float32x4_t simd_t;
+typedef uint32x4_t  simd_mask_t;
+# define SIMD_WIDTH  (4)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return vdupq_n_f32( s ); }
+static inline simd_t simd_load  ( const scaler_t* p )           { return vld1q_f32( p ); }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { vst1q_f32( p, v ); }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return vaddq_f32( a, b ); }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return vsubq_f32( a, b ); }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return vmulq_f32( a, b ); }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return vdivq_f32( a, b ); }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return vsqrtq_f32( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return vminq_f32( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return vmaxq_f32( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return vcgtq_f32( a, b ); }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return vbslq_f32( m, a, b ); }
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return vfmaq_f32( c, a, b ); }
+
+#elif defined(M3D_SIMD_DOUBLE_AVX)
+typedef __m256d simd_t;
+typedef __m256d simd_mask_t;
+# define SIMD_WIDTH  (4)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return _mm256_set1_pd( s ); }
+static inline simd_t simd_load  ( const scaler_t* p )           { return _mm256_loadu_pd( p ); }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { _mm256_storeu_pd( p, v ); }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return _mm256_add_pd( a, b ); }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return _mm256_sub_pd( a, b ); }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return _mm256_mul_pd( a, b ); }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return _mm256_div_pd( a, b ); }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return _mm256_sqrt_pd( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return _mm256_min_pd( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return _mm256_max_pd( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return _mm256_cmp_pd( a, b, _CMP_GT_OQ ); }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return _mm256_blendv_pd( b, a, m ); }
+# if defined(M3D_SIMD_FMA)
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm256_fmadd_pd( a, b, c ); }
+# else
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm256_add_pd( _mm256_mul_pd( a, b ), c ); }
+# endif
+
+#elif defined(M3D_SIMD_DOUBLE_SSE2)
+typedef __m128d simd_t;
+typedef __m128d simd_mask_t;
+# define SIMD_WIDTH  (2)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return _mm_set1_pd( s ); }
+static inline simd_t simd_load  ( const scaler_t* p )           { return _mm_loadu_pd( p ); }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { _mm_storeu_pd( p, v ); }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return _mm_add_pd( a, b ); }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return _mm_sub_pd( a, b ); }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return _mm_mul_pd( a, b ); }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return _mm_div_pd( a, b ); }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return _mm_sqrt_pd( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return _mm_min_pd( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return _mm_max_pd( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return _mm_cmpgt_pd( a, b ); }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return _mm_or_pd( _mm_and_pd( m, a ), _mm_andnot_pd( m, b ) ); }
+# if defined(M3D_SIMD_FMA)
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm_fmadd_pd( a, b, c ); }
+# else
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return _mm_add_pd( _mm_mul_pd( a, b ), c ); }
+# endif
+
+#elif defined(M3D_SIMD_DOUBLE_NEON)
+typedef float64x2_t simd_t;
+typedef uint64x2_t  simd_mask_t;
+# define SIMD_WIDTH  (2)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return vdupq_n_f64( s ); }
+static inline simd_t simd_load  ( const scaler_t* p )           { return vld1q_f64( p ); }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { vst1q_f64( p, v ); }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return vaddq_f64( a, b ); }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return vsubq_f64( a, b ); }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return vmulq_f64( a, b ); }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return vdivq_f64( a, b ); }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return vsqrtq_f64( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return vminq_f64( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return vmaxq_f64( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return vcgtq_f64( a, b ); }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return vbslq_f64( m, a, b ); }
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return vfmaq_f64( c, a, b ); }
+
+#else /* scalar fallback */
+typedef scaler_t simd_t;
+typedef bool     simd_mask_t;
+# define SIMD_WIDTH  (1)
+
+static inline simd_t simd_set1  ( scaler_t s )                  { return s; }
+static inline simd_t simd_load  ( const scaler_t* p )           { return *p; }
+static inline void   simd_store ( scaler_t* p, simd_t v )       { *p = v; }
+static inline simd_t simd_add   ( simd_t a, simd_t b )          { return a + b; }
+static inline simd_t simd_sub   ( simd_t a, simd_t b )          { return a - b; }
+static inline simd_t simd_mul   ( simd_t a, simd_t b )          { return a * b; }
+static inline simd_t simd_div   ( simd_t a, simd_t b )          { return a / b; }
+static inline simd_t simd_sqrt  ( simd_t a )                    { return scaler_sqrt( a ); }
+static inline simd_t simd_min   ( simd_t a, simd_t b )          { return scaler_min( a, b ); }
+static inline simd_t simd_max   ( simd_t a, simd_t b )          { return scaler_max( a, b ); }
+static inline simd_mask_t simd_gt ( simd_t a, simd_t b )        { return a > b; }
+static inline simd_t simd_select( simd_mask_t m, simd_t a, simd_t b ) { return m ? a : b; }
+static inline simd_t simd_madd  ( simd_t a, simd_t b, simd_t c ) { return a * b + c; }
+#endif
+
+/* Number of elements that can be processed in whole vectors. */
+static inline size_t simd_floor( size_t count )
+{
+	return count - (count % SIMD_WIDTH);
+}
+
+#endif /* _SIMD_H_ */
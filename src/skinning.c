@@ -0,0 +1,191 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <assert.h>
+#include "batch-math.h"
+#include "skinning.h"
+
+size_t skinning_palette_size( skinning_layout_t layout, size_t count )
+{
+	return (layout == SKINNING_LAYOUT_MAT3X4 ? 12 : 16) * count * sizeof(float);
+}
+
+/*
+ * The top three rows of T * R, by columns, for n joints from first. The
+ * first nine are R from the quaternion, as in quat_to_mat4(), and the last
+ * three are the translation. Called with n = BATCH_BLOCK, the loop has a
+ * constant count and vectorizes.
+ */
+BATCH_INLINE void local_block( scaler_t local[ 12 ][ BATCH_BLOCK ], const quat_array_t* rotations, const vec3_array_t* translations, size_t first, size_t n )
+{
+	const scaler_t* restrict qx = rotations->x + first;
+	const scaler_t* restrict qy = rotations->y + first;
+	const scaler_t* restrict qz = rotations->z + first;
+	const scaler_t* restrict qw = rotations->w + first;
+	const scaler_t* restrict tx = translations->x + first;
+	const scaler_t* restrict ty = translations->y + first;
+	const scaler_t* restrict tz = translations->z + first;
+
+	for( size_t j = 0; j < n; j++ )
+	{
+		const scaler_t x = qx[ j ], y = qy[ j ], z = qz[ j ], w = qw[ j ];
+		const scaler_t x2 = x + x, y2 = y + y, z2 = z + z;
+
+		local[  0 ][ j ] = 1 - y * y2 - z * z2;
+		local[  1 ][ j ] = x * y2 + w * z2;
+		local[  2 ][ j ] = x * z2 - w * y2;
+		local[  3 ][ j ] = x * y2 - w * z2;
+		local[  4 ][ j ] = 1 - x * x2 - z * z2;
+		local[  5 ][ j ] = y * z2 + w * x2;
+		local[  6 ][ j ] = x * z2 + w * y2;
+		local[  7 ][ j ] = y * z2 - w * x2;
+		local[  8 ][ j ] = 1 - x * x2 - y * y2;
+		local[  9 ][ j ] = tx[ j ];
+		local[ 10 ][ j ] = ty[ j ];
+		local[ 11 ][ j ] = tz[ j ];
+	}
+}
+
+/* Scales the rotation columns, which makes T * R into T * R * S. */
+BATCH_INLINE void scale_block( scaler_t local[ 12 ][ BATCH_BLOCK ], const vec3_array_t* scales, size_t first, size_t n )
+{
+	const scaler_t* restrict sx = scales->x + first;
+	const scaler_t* restrict sy = scales->y + first;
+	const scaler_t* restrict sz = scales->z + first;
+
+	for( size_t j = 0; j < n; j++ )
+	{
+		local[ 0 ][ j ] *= sx[ j ];
+		local[ 1 ][ j ] *= sx[ j ];
+		local[ 2 ][ j ] *= sx[ j ];
+		local[ 3 ][ j ] *= sy[ j ];
+		local[ 4 ][ j ] *= sy[ j ];
+		local[ 5 ][ j ] *= sy[ j ];
+		local[ 6 ][ j ] *= sz[ j ];
+		local[ 7 ][ j ] *= sz[ j ];
+		local[ 8 ][ j ] *= sz[ j ];
+	}
+}
+
+/* The rotation part of affine a times (x, y, z). */
+#define AFFINE_ROW( a, r, x, y, z )   ((a)[ (r) ] * (x) + (a)[ 4 + (r) ] * (y) + (a)[ 8 + (r) ] * (z))
+
+/*
+ * world = parent * local for joint j of the block, or local for a root,
+ * also kept in copy for the skinning matrix. Both are written a scaler at
+ * a time: reading back a matrix that was just written that way, or
+ * copying it through a mat4_t temporary, stalls on store forwarding.
+ */
+static inline void world_store( scaler_t* restrict world, scaler_t* restrict copy, const scaler_t* restrict parent, const scaler_t local[ 12 ][ BATCH_BLOCK ], size_t j )
+{
+	for( size_t c = 0; c < 4; c++ )
+	{
+		const scaler_t x = local[ 3 * c ][ j ], y = local[ 3 * c + 1 ][ j ], z = local[ 3 * c + 2 ][ j ];
+		const scaler_t t = c == 3;
+
+		if( parent )
+		{
+			world[ 4 * c + 0 ] = copy[ 4 * c + 0 ] = AFFINE_ROW( parent, 0, x, y, z ) + t * parent[ 12 ];
+			world[ 4 * c + 1 ] = copy[ 4 * c + 1 ] = AFFINE_ROW( parent, 1, x, y, z ) + t * parent[ 13 ];
+			world[ 4 * c + 2 ] = copy[ 4 * c + 2 ] = AFFINE_ROW( parent, 2, x, y, z ) + t * parent[ 14 ];
+		}
+		else
+		{
+			world[ 4 * c + 0 ] = copy[ 4 * c + 0 ] = x;
+			world[ 4 * c + 1 ] = copy[ 4 * c + 1 ] = y;
+			world[ 4 * c + 2 ] = copy[ 4 * c + 2 ] = z;
+		}
+		world[ 4 * c + 3 ] = copy[ 4 * c + 3 ] = t;
+	}
+}
+
+/* The skinning matrix world * inverse_bind, written as floats. */
+static inline void palette_store( float* restrict out, const scaler_t* restrict world, const scaler_t* restrict inverse_bind, skinning_layout_t layout )
+{
+	for( size_t c = 0; c < 4; c++ )
+	{
+		const scaler_t x = inverse_bind[ 4 * c ], y = inverse_bind[ 4 * c + 1 ], z = inverse_bind[ 4 * c + 2 ];
+		const scaler_t t = c == 3;
+
+		for( size_t r = 0; r < 3; r++ )
+		{
+			const float skin = (float) (AFFINE_ROW( world, r, x, y, z ) + t * world[ 12 + r ]);
+
+			if( layout == SKINNING_LAYOUT_MAT3X4 )
+			{
+				out[ 4 * r + c ] = skin;
+			}
+			else
+			{
+				out[ 4 * c + r ] = skin;
+			}
+		}
+		if( layout == SKINNING_LAYOUT_MAT4 )
+		{
+			out[ 4 * c + 3 ] = (float) t;
+		}
+	}
+}
+
+void skinning_palette_build( const int parents[], const quat_array_t* rotations, const vec3_array_t* translations,
+                             const vec3_array_t* scales, const mat4_t inverse_binds[], mat4_t world[],
+                             float palette[], skinning_layout_t layout )
+{
+	assert( parents && rotations && translations && inverse_binds && world && palette );
+	assert( translations->count == rotations->count );
+	assert( !scales || scales->count == rotations->count );
+	const size_t count  = rotations->count;
+	const size_t stride = skinning_palette_size( layout, 1 ) / sizeof(float);
+	scaler_t local[ 12 ][ BATCH_BLOCK ];
+
+	for( size_t first = 0; first < count; first += BATCH_BLOCK )
+	{
+		const size_t n = count - first < BATCH_BLOCK ? count - first : BATCH_BLOCK;
+
+		if( n == BATCH_BLOCK )
+		{
+			local_block( local, rotations, translations, first, BATCH_BLOCK );
+			if( scales )
+			{
+				scale_block( local, scales, first, BATCH_BLOCK );
+			}
+		}
+		else
+		{
+			local_block( local, rotations, translations, first, n );
+			if( scales )
+			{
+				scale_block( local, scales, first, n );
+			}
+		}
+
+		/* The parents are finished, either in an earlier block or earlier
+		 * in this one. */
+		for( size_t j = 0; j < n; j++ )
+		{
+			const size_t i = first + j;
+			assert( parents[ i ] < (int) i );
+
+			scaler_t joint[ 16 ];
+			world_store( world[ i ].m, joint, parents[ i ] >= 0 ? world[ parents[ i ] ].m : NULL, local, j );
+			palette_store( palette + i * stride, joint, inverse_binds[ i ].m, layout );
+		}
+	}
+}
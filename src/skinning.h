@@ -0,0 +1,73 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _SKINNING_H_
+#define _SKINNING_H_
+#include <stddef.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "mat4.h"
+#include "vec3-array.h"
+#include "quat-array.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Skinning Palettes
+ *
+ * A skeleton of count joints is posed by a local rotation, translation
+ * and (optionally) scale per joint, as structures of arrays, e.g. the
+ * output of quat_array_blend(). Every joint's parent must come before it
+ * (parents[ i ] < i), with a negative parent for roots, which is the order
+ * most exporters already use.
+ *
+ * The palette builder turns a pose into the world matrix of each joint,
+ *
+ *   world[ i ] = world[ parents[ i ] ] * T * R * S
+ *
+ * and the skinning matrix world[ i ] * inverse_binds[ i ] that vertices
+ * are multiplied by. The local matrices of a block of joints are built
+ * together so that the quaternion conversion vectorizes, and each joint
+ * is then finished while its inputs are still in cache. The rotations
+ * must be unit quaternions and the inverse bind matrices affine.
+ *
+ * The skinning matrices are written as tightly packed floats, whatever
+ * scaler_t is, so the palette can be copied as is into a uniform or
+ * storage buffer.
+ */
+typedef enum skinning_layout {
+	SKINNING_LAYOUT_MAT4 = 0, /* 16 floats by columns, like a GLSL mat4 */
+	SKINNING_LAYOUT_MAT3X4,   /* 12 floats, the top three rows, like a GLSL vec4[ 3 ] */
+} skinning_layout_t;
+
+size_t skinning_palette_size  ( skinning_layout_t layout, size_t count ); /* in bytes */
+void   skinning_palette_build ( const int parents[], const quat_array_t* rotations, const vec3_array_t* translations,
+                                const vec3_array_t* scales, const mat4_t inverse_binds[], mat4_t world[],
+                                float palette[], skinning_layout_t layout ); /* scales may be NULL */
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _SKINNING_H_ */
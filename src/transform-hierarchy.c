@@ -0,0 +1,281 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "transform-hierarchy.h"
+
+#define TRANSFORM_HIERARCHY_ROOT    (SIZE_MAX)
+
+/*
+ * The children of every node, grouped by parent: the children of id are
+ * children[ first[ id ] ] to children[ first[ id + 1 ] - 1 ], in id order.
+ * False if a parent is out of range or a node is its own parent.
+ */
+static bool transform_hierarchy_children( const int parents[], size_t count, size_t* children, size_t* first )
+{
+	memset( first, 0, (count + 1) * sizeof(size_t) );
+	for( size_t id = 0; id < count; id++ )
+	{
+		if( parents[ id ] >= (int) count || parents[ id ] == (int) id )
+		{
+			return false;
+		}
+		if( parents[ id ] >= 0 )
+		{
+			first[ parents[ id ] + 1 ] += 1;
+		}
+	}
+	for( size_t id = 0; id < count; id++ )
+	{
+		first[ id + 1 ] += first[ id ];
+	}
+
+	/* Each first[ parent ] is advanced to the end of its children, which
+	 * is the start of the next parent's, and then shifted back. */
+	for( size_t id = 0; id < count; id++ )
+	{
+		if( parents[ id ] >= 0 )
+		{
+			children[ first[ parents[ id ] ]++ ] = id;
+		}
+	}
+	for( size_t id = count; id > 0; id-- )
+	{
+		first[ id ] = first[ id - 1 ];
+	}
+	first[ 0 ] = 0;
+	return true;
+}
+
+/* The breadth first order of the nodes, roots first, and where each level
+ * starts. False if some nodes are not reachable from a root (a cycle). */
+static bool transform_hierarchy_order( transform_hierarchy_t* hierarchy, const int parents[], const size_t* children, const size_t* first )
+{
+	const size_t count = hierarchy->count;
+	size_t tail = 0;
+
+	for( size_t id = 0; id < count; id++ )
+	{
+		if( parents[ id ] < 0 )
+		{
+			hierarchy->ids[ tail++ ] = id;
+		}
+	}
+
+	hierarchy->level_count = 0;
+	if( tail > 0 )
+	{
+		hierarchy->levels[ hierarchy->level_count++ ] = 0;
+	}
+
+	size_t level_end = tail;
+	for( size_t slot = 0; slot < tail; slot++ )
+	{
+		if( slot == level_end )
+		{
+			hierarchy->levels[ hierarchy->level_count++ ] = slot;
+			level_end = tail;
+		}
+
+		const size_t id = hierarchy->ids[ slot ];
+		for( size_t c = first[ id ]; c < first[ id + 1 ]; c++ )
+		{
+			hierarchy->ids[ tail++ ] = children[ c ];
+		}
+	}
+	hierarchy->levels[ hierarchy->level_count ] = tail;
+
+	return tail == count;
+}
+
+bool transform_hierarchy_create( transform_hierarchy_t* hierarchy, const int parents[], size_t count )
+{
+	assert( hierarchy );
+	assert( parents || count == 0 );
+	memset( hierarchy, 0, sizeof(*hierarchy) );
+
+	const size_t size = count > 0 ? count : 1;
+	hierarchy->locals  = malloc( size * sizeof(mat4_t) );
+	hierarchy->worlds  = malloc( size * sizeof(mat4_t) );
+	hierarchy->parents = malloc( size * sizeof(size_t) );
+	hierarchy->ids     = malloc( size * sizeof(size_t) );
+	hierarchy->dirty   = malloc( size * sizeof(uint8_t) );
+	hierarchy->slots   = malloc( size * sizeof(size_t) );
+	hierarchy->levels  = malloc( (count + 1) * sizeof(size_t) );
+	hierarchy->count   = count;
+
+	size_t* children = malloc( size * sizeof(size_t) );
+	size_t* first    = malloc( (count + 1) * sizeof(size_t) );
+
+	bool result = hierarchy->locals && hierarchy->worlds && hierarchy->parents && hierarchy->ids &&
+	              hierarchy->dirty && hierarchy->slots && hierarchy->levels && children && first &&
+	              transform_hierarchy_children( parents, count, children, first ) &&
+	              transform_hierarchy_order( hierarchy, parents, children, first );
+	free( children );
+	free( first );
+
+	if( !result )
+	{
+		transform_hierarchy_destroy( hierarchy );
+		return false;
+	}
+
+	/* A parent's slot is always assigned before its children's. */
+	for( size_t slot = 0; slot < count; slot++ )
+	{
+		const size_t id = hierarchy->ids[ slot ];
+		hierarchy->slots[ id ]     = slot;
+		hierarchy->parents[ slot ] = parents[ id ] < 0 ? TRANSFORM_HIERARCHY_ROOT : hierarchy->slots[ parents[ id ] ];
+		hierarchy->locals[ slot ]  = MAT4_IDENTITY;
+		hierarchy->worlds[ slot ]  = MAT4_IDENTITY;
+		hierarchy->dirty[ slot ]   = 1;
+	}
+	hierarchy->first_dirty = 0;
+	return true;
+}
+
+void transform_hierarchy_destroy( transform_hierarchy_t* hierarchy )
+{
+	assert( hierarchy );
+	free( hierarchy->locals );
+	free( hierarchy->worlds );
+	free( hierarchy->parents );
+	free( hierarchy->ids );
+	free( hierarchy->dirty );
+	free( hierarchy->slots );
+	free( hierarchy->levels );
+	memset( hierarchy, 0, sizeof(*hierarchy) );
+}
+
+size_t transform_hierarchy_count( const transform_hierarchy_t* hierarchy )
+{
+	assert( hierarchy );
+	return hierarchy->count;
+}
+
+size_t transform_hierarchy_slot( const transform_hierarchy_t* hierarchy, size_t id )
+{
+	assert( hierarchy && id < hierarchy->count );
+	return hierarchy->slots[ id ];
+}
+
+void transform_hierarchy_set_local( transform_hierarchy_t* hierarchy, size_t id, const mat4_t* local )
+{
+	assert( hierarchy && local && id < hierarchy->count );
+	const size_t slot = hierarchy->slots[ id ];
+
+	hierarchy->locals[ slot ] = *local;
+	hierarchy->dirty[ slot ]  = 1;
+	if( slot < hierarchy->first_dirty )
+	{
+		hierarchy->first_dirty = slot;
+	}
+}
+
+const mat4_t* transform_hierarchy_local( const transform_hierarchy_t* hierarchy, size_t id )
+{
+	assert( hierarchy && id < hierarchy->count );
+	return &hierarchy->locals[ hierarchy->slots[ id ] ];
+}
+
+const mat4_t* transform_hierarchy_world( const transform_hierarchy_t* hierarchy, size_t id )
+{
+	assert( hierarchy && id < hierarchy->count );
+	return &hierarchy->worlds[ hierarchy->slots[ id ] ];
+}
+
+const mat4_t* transform_hierarchy_worlds( const transform_hierarchy_t* hierarchy )
+{
+	assert( hierarchy );
+	return hierarchy->worlds;
+}
+
+const size_t* transform_hierarchy_ids( const transform_hierarchy_t* hierarchy )
+{
+	assert( hierarchy );
+	return hierarchy->ids;
+}
+
+/*
+ * Recomputes the dirty slots from start to end of one level, marking the
+ * children of dirty nodes dirty on the way. The parents are all in the
+ * level above, which is finished, so the slots are independent. The
+ * dirty nodes of a level tend to be runs of siblings, hence the dynamic
+ * schedule.
+ */
+static size_t transform_hierarchy_level( transform_hierarchy_t* hierarchy, size_t start, size_t end )
+{
+	const mat4_t* locals  = hierarchy->locals;
+	const size_t* parents = hierarchy->parents;
+	mat4_t*  worlds = hierarchy->worlds;
+	uint8_t* dirty  = hierarchy->dirty;
+	size_t updated  = 0;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic, 1024) if( end - start >= TRANSFORM_HIERARCHY_PARALLEL_COUNT ) reduction(+:updated)
+	#endif
+	for( size_t slot = start; slot < end; slot++ )
+	{
+		const size_t parent = parents[ slot ];
+
+		if( parent != TRANSFORM_HIERARCHY_ROOT && dirty[ parent ] )
+		{
+			dirty[ slot ] = 1;
+		}
+		if( dirty[ slot ] )
+		{
+			worlds[ slot ] = parent == TRANSFORM_HIERARCHY_ROOT ? locals[ slot ] : mat4_mult_matrix( &worlds[ parent ], &locals[ slot ] );
+			updated += 1;
+		}
+	}
+	return updated;
+}
+
+size_t transform_hierarchy_update( transform_hierarchy_t* hierarchy )
+{
+	assert( hierarchy );
+	const size_t first = hierarchy->first_dirty;
+	size_t updated = 0;
+
+	if( first >= hierarchy->count )
+	{
+		return 0;
+	}
+
+	/* Every slot before the first dirty one is clean, and so are their
+	 * parents, so those levels (and that part of the first one) are
+	 * skipped. */
+	for( size_t d = 0; d < hierarchy->level_count; d++ )
+	{
+		const size_t start = hierarchy->levels[ d ];
+		const size_t end   = hierarchy->levels[ d + 1 ];
+
+		if( end > first )
+		{
+			updated += transform_hierarchy_level( hierarchy, start > first ? start : first, end );
+		}
+	}
+
+	memset( hierarchy->dirty + first, 0, hierarchy->count - first );
+	hierarchy->first_dirty = hierarchy->count;
+	return updated;
+}
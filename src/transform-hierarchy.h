@@ -0,0 +1,99 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _TRANSFORM_HIERARCHY_H_
+#define _TRANSFORM_HIERARCHY_H_
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "mat4.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Transform Hierarchies
+ *
+ * A forest of nodes, each with a local matrix, and the world matrices
+ *
+ *   world[ node ] = world[ parent ] * local[ node ]
+ *
+ * kept up to date incrementally. Nodes are identified by the ids they
+ * were created with (0 to count - 1, with parents[ id ] negative for a
+ * root), in any order, but are stored breadth first: every level of the
+ * forest is contiguous, after the level above it, and the children of a
+ * node are contiguous. The position of a node in that order is its slot.
+ *
+ * Setting a local matrix marks the node dirty, and an update recomputes
+ * the world matrices of the dirty nodes and everything below them, and
+ * nothing else, in one pass over the levels from the first dirty slot.
+ * The nodes of a level only depend on the level above, so a level of at
+ * least TRANSFORM_HIERARCHY_PARALLEL_COUNT nodes is split across threads
+ * with OpenMP.
+ *
+ * The world matrices are an array of count mat4_t by slot, which can be
+ * used in place (e.g. copied into a GPU buffer) along with the id of each
+ * slot, and stay valid until the hierarchy is destroyed. They are current
+ * after an update. Nodes start with identity local matrices, all dirty.
+ *
+ * The fields are private.
+ */
+#define TRANSFORM_HIERARCHY_PARALLEL_COUNT    (1 << 13)
+
+typedef struct transform_hierarchy {
+	/* By slot */
+	mat4_t*  locals;
+	mat4_t*  worlds;
+	size_t*  parents; /* slot of the parent, or SIZE_MAX for a root */
+	size_t*  ids;
+	uint8_t* dirty;
+
+	/* By id */
+	size_t*  slots;
+
+	/* The slots of level d are levels[ d ] to levels[ d + 1 ] - 1. */
+	size_t*  levels;
+	size_t   level_count;
+	size_t   count;
+	size_t   first_dirty; /* count when nothing is dirty */
+} transform_hierarchy_t;
+
+bool          transform_hierarchy_create    ( transform_hierarchy_t* hierarchy, const int parents[], size_t count ); /* false if parents is not a forest */
+void          transform_hierarchy_destroy   ( transform_hierarchy_t* hierarchy );
+size_t        transform_hierarchy_count     ( const transform_hierarchy_t* hierarchy );
+size_t        transform_hierarchy_slot      ( const transform_hierarchy_t* hierarchy, size_t id );
+void          transform_hierarchy_set_local ( transform_hierarchy_t* hierarchy, size_t id, const mat4_t* local );
+const mat4_t* transform_hierarchy_local     ( const transform_hierarchy_t* hierarchy, size_t id );
+const mat4_t* transform_hierarchy_world     ( const transform_hierarchy_t* hierarchy, size_t id );
+size_t        transform_hierarchy_update    ( transform_hierarchy_t* hierarchy ); /* returns the number of world matrices recomputed */
+
+/* Zero-copy views by slot, count elements each. */
+const mat4_t* transform_hierarchy_worlds    ( const transform_hierarchy_t* hierarchy );
+const size_t* transform_hierarchy_ids       ( const transform_hierarchy_t* hierarchy );
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _TRANSFORM_HIERARCHY_H_ */
@@ -23,6 +23,7 @@
 #include <math.h>
 #include <limits.h>
 #include <string.h>
+#include "format.h"
 #include "vec2.h"
 
 const vec2_t VEC2_ZERO  = { .x = 0.0f, .y = 0.0f };
@@ -31,17 +32,28 @@ const vec2_t VEC2_XUNIT = { .x = 1.0f, .y = 0.0f };
 const vec2_t VEC2_YUNIT = { .x = 0.0f, .y = 1.0f };
 
 
-const char* vec2_to_string( const vec2_t* v ) /* not thread safe */
+size_t vec2_to_string_r( const vec2_t* v, char* buffer, size_t size )
 {
-	static char string_buffer[ 128 ];
+	int length;
 #if defined(LIBM3D_USE_LONG_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1, "(%08.1Lf, %08.1Lf)", v->x, v->y );
+	length = snprintf( buffer, size, "(%08.1Lf, %08.1Lf)", v->x, v->y );
 #elif defined(LIBM3D_USE_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1, "(%08.1lf, %08.1lf)", v->x, v->y );
+	length = snprintf( buffer, size, "(%08.1lf, %08.1lf)", v->x, v->y );
 #else
-	snprintf( string_buffer, sizeof(string_buffer) - 1, "(%08.1f, %08.1f)", v->x, v->y );
+	length = snprintf( buffer, size, "(%08.1f, %08.1f)", v->x, v->y );
 #endif
-	string_buffer[ sizeof(string_buffer) - 1 ] = '\0';
+	return length < 0 ? 0 : (size_t) length;
+}
+
+const char* vec2_to_string( const vec2_t* v )
+{
+	static _Thread_local char string_buffer[ 128 ];
+	vec2_to_string_r( v, string_buffer, sizeof(string_buffer) );
 	return string_buffer;
 }
 
+size_t vec2_format( char* restrict buffer, size_t size, const vec2_t* restrict v, size_t count, int precision, size_t* restrict length )
+{
+	return m3d_format_elements( buffer, size, (const scaler_t*) v, sizeof(vec2_t) / sizeof(scaler_t), count, 1, 2, precision, length );
+}
+
@@ -22,6 +22,7 @@
 #define _VEC2_H_
 #include <float.h>
 #include <limits.h>
+#include <stddef.h>
 #include "mathematics.h"
 #ifdef __cplusplus
 extern "C" {
@@ -55,7 +56,17 @@ extern const vec2_t VEC2_ONE;
 extern const vec2_t VEC2_XUNIT;
 extern const vec2_t VEC2_YUNIT;
 
-const char* vec2_to_string     ( const vec2_t* v ); /* not thread safe */
+const char* vec2_to_string     ( const vec2_t* v ); /* uses a thread-local buffer */
+size_t      vec2_to_string_r   ( const vec2_t* v, char* buffer, size_t size ); /* returns the length like snprintf() */
+
+/*
+ * Writes count vectors as "(x, y)", one per line, with precision
+ * decimals (at most 9). This does not use snprintf() and is meant for
+ * dumping large arrays. Only whole vectors are written and the buffer is
+ * always terminated. Returns the number of vectors written and stores the
+ * number of characters in length (if not NULL).
+ */
+size_t vec2_format( char* restrict buffer, size_t size, const vec2_t* restrict v, size_t count, int precision, size_t* restrict length );
 
 /* |a|
  * |b|
@@ -0,0 +1,316 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "simd.h"
+#include "vec3-array.h"
+
+bool vec3_array_create( vec3_array_t* array, size_t count )
+{
+	assert( array );
+	/* Pad each stream so the next one starts on an aligned boundary. */
+	const size_t lanes  = M3D_SIMD_ALIGNMENT / sizeof(scaler_t);
+	const size_t stride = ((count + lanes - 1) / lanes) * lanes;
+
+	array->count = count;
+
+	if( count == 0 )
+	{
+		array->x = NULL;
+		array->y = NULL;
+		array->z = NULL;
+		return true;
+	}
+
+	scaler_t* block = aligned_alloc( M3D_SIMD_ALIGNMENT, 3 * stride * sizeof(scaler_t) );
+
+	if( !block )
+	{
+		array->count = 0;
+		array->x = NULL;
+		array->y = NULL;
+		array->z = NULL;
+		return false;
+	}
+
+	memset( block, 0, 3 * stride * sizeof(scaler_t) );
+	array->x = block;
+	array->y = block + stride;
+	array->z = block + 2 * stride;
+	return true;
+}
+
+void vec3_array_destroy( vec3_array_t* array )
+{
+	assert( array );
+	free( array->x ); /* x is the start of the block */
+	array->x     = NULL;
+	array->y     = NULL;
+	array->z     = NULL;
+	array->count = 0;
+}
+
+void vec3_array_from_vec3( vec3_array_t* restrict array, const vec3_t* restrict v, size_t count )
+{
+	assert( array && v );
+	assert( count <= array->count );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		array->x[ i ] = v[ i ].x;
+		array->y[ i ] = v[ i ].y;
+		array->z[ i ] = v[ i ].z;
+	}
+}
+
+void vec3_array_to_vec3( const vec3_array_t* restrict array, vec3_t* restrict v, size_t count )
+{
+	assert( array && v );
+	assert( count <= array->count );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		v[ i ].x = array->x[ i ];
+		v[ i ].y = array->y[ i ];
+		v[ i ].z = array->z[ i ];
+	}
+}
+
+void vec3_array_add( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b )
+{
+	assert( result && a && b );
+	assert( a->count == b->count && result->count == a->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_store( result->x + i, simd_add( simd_load( a->x + i ), simd_load( b->x + i ) ) );
+		simd_store( result->y + i, simd_add( simd_load( a->y + i ), simd_load( b->y + i ) ) );
+		simd_store( result->z + i, simd_add( simd_load( a->z + i ), simd_load( b->z + i ) ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		result->x[ i ] = a->x[ i ] + b->x[ i ];
+		result->y[ i ] = a->y[ i ] + b->y[ i ];
+		result->z[ i ] = a->z[ i ] + b->z[ i ];
+	}
+}
+
+void vec3_array_subtract( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b )
+{
+	assert( result && a && b );
+	assert( a->count == b->count && result->count == a->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_store( result->x + i, simd_sub( simd_load( a->x + i ), simd_load( b->x + i ) ) );
+		simd_store( result->y + i, simd_sub( simd_load( a->y + i ), simd_load( b->y + i ) ) );
+		simd_store( result->z + i, simd_sub( simd_load( a->z + i ), simd_load( b->z + i ) ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		result->x[ i ] = a->x[ i ] - b->x[ i ];
+		result->y[ i ] = a->y[ i ] - b->y[ i ];
+		result->z[ i ] = a->z[ i ] - b->z[ i ];
+	}
+}
+
+void vec3_array_multiply( vec3_array_t* result, const vec3_array_t* a, scaler_t s )
+{
+	assert( result && a );
+	assert( result->count == a->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	const simd_t vs    = simd_set1( s );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_store( result->x + i, simd_mul( simd_load( a->x + i ), vs ) );
+		simd_store( result->y + i, simd_mul( simd_load( a->y + i ), vs ) );
+		simd_store( result->z + i, simd_mul( simd_load( a->z + i ), vs ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		result->x[ i ] = a->x[ i ] * s;
+		result->y[ i ] = a->y[ i ] * s;
+		result->z[ i ] = a->z[ i ] * s;
+	}
+}
+
+void vec3_array_scale( vec3_array_t* array, scaler_t s )
+{
+	vec3_array_multiply( array, array, s );
+}
+
+void vec3_array_dot_product( const vec3_array_t* a, const vec3_array_t* b, scaler_t* restrict result )
+{
+	assert( a && b && result );
+	assert( a->count == b->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_t d = simd_mul( simd_load( a->x + i ), simd_load( b->x + i ) );
+		d = simd_madd( simd_load( a->y + i ), simd_load( b->y + i ), d );
+		d = simd_madd( simd_load( a->z + i ), simd_load( b->z + i ), d );
+		simd_store( result + i, d );
+	}
+
+	for( ; i < count; i++ )
+	{
+		result[ i ] = a->x[ i ] * b->x[ i ] + a->y[ i ] * b->y[ i ] + a->z[ i ] * b->z[ i ];
+	}
+}
+
+void vec3_array_cross_product( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b )
+{
+	assert( result && a && b );
+	assert( a->count == b->count && result->count == a->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		/* Every input is loaded before anything is stored so that the
+		 * result can alias either input. */
+		simd_t ax = simd_load( a->x + i );
+		simd_t ay = simd_load( a->y + i );
+		simd_t az = simd_load( a->z + i );
+		simd_t bx = simd_load( b->x + i );
+		simd_t by = simd_load( b->y + i );
+		simd_t bz = simd_load( b->z + i );
+
+		simd_store( result->x + i, simd_sub( simd_mul( ay, bz ), simd_mul( az, by ) ) );
+		simd_store( result->y + i, simd_sub( simd_mul( az, bx ), simd_mul( ax, bz ) ) );
+		simd_store( result->z + i, simd_sub( simd_mul( ax, by ), simd_mul( ay, bx ) ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		scaler_t ax = a->x[ i ], ay = a->y[ i ], az = a->z[ i ];
+		scaler_t bx = b->x[ i ], by = b->y[ i ], bz = b->z[ i ];
+
+		result->x[ i ] = ay * bz - az * by;
+		result->y[ i ] = az * bx - ax * bz;
+		result->z[ i ] = ax * by - ay * bx;
+	}
+}
+
+void vec3_array_magnitude( const vec3_array_t* array, scaler_t* restrict result )
+{
+	assert( array && result );
+	const size_t count = array->count;
+	const size_t n     = simd_floor( count );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_t x = simd_load( array->x + i );
+		simd_t y = simd_load( array->y + i );
+		simd_t z = simd_load( array->z + i );
+		simd_t d = simd_madd( z, z, simd_madd( y, y, simd_mul( x, x ) ) );
+		simd_store( result + i, simd_sqrt( d ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		result[ i ] = scaler_sqrt( array->x[ i ] * array->x[ i ] + array->y[ i ] * array->y[ i ] + array->z[ i ] * array->z[ i ] );
+	}
+}
+
+void vec3_array_normalize( vec3_array_t* array )
+{
+	assert( array );
+	const size_t count = array->count;
+	const size_t n     = simd_floor( count );
+	const simd_t zero  = simd_set1( 0 );
+	const simd_t one   = simd_set1( 1 );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_t x = simd_load( array->x + i );
+		simd_t y = simd_load( array->y + i );
+		simd_t z = simd_load( array->z + i );
+		simd_t length = simd_sqrt( simd_madd( z, z, simd_madd( y, y, simd_mul( x, x ) ) ) );
+
+		/* Zero length vectors are left untouched, like vec3_normalize(). */
+		simd_t inverse = simd_select( simd_gt( length, zero ), simd_div( one, length ), one );
+
+		simd_store( array->x + i, simd_mul( x, inverse ) );
+		simd_store( array->y + i, simd_mul( y, inverse ) );
+		simd_store( array->z + i, simd_mul( z, inverse ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		scaler_t length = scaler_sqrt( array->x[ i ] * array->x[ i ] + array->y[ i ] * array->y[ i ] + array->z[ i ] * array->z[ i ] );
+
+		if( length > 0 )
+		{
+			scaler_t inverse = 1 / length;
+			array->x[ i ] *= inverse;
+			array->y[ i ] *= inverse;
+			array->z[ i ] *= inverse;
+		}
+	}
+}
+
+void vec3_array_lerp( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b, scaler_t s )
+{
+	assert( result && a && b );
+	assert( a->count == b->count && result->count == a->count );
+	const size_t count = a->count;
+	const size_t n     = simd_floor( count );
+	const simd_t vs    = simd_set1( s );
+	size_t i = 0;
+
+	for( ; i < n; i += SIMD_WIDTH )
+	{
+		simd_t ax = simd_load( a->x + i );
+		simd_t ay = simd_load( a->y + i );
+		simd_t az = simd_load( a->z + i );
+
+		simd_store( result->x + i, simd_madd( vs, simd_sub( simd_load( b->x + i ), ax ), ax ) );
+		simd_store( result->y + i, simd_madd( vs, simd_sub( simd_load( b->y + i ), ay ), ay ) );
+		simd_store( result->z + i, simd_madd( vs, simd_sub( simd_load( b->z + i ), az ), az ) );
+	}
+
+	for( ; i < count; i++ )
+	{
+		result->x[ i ] = a->x[ i ] + s * (b->x[ i ] - a->x[ i ]);
+		result->y[ i ] = a->y[ i ] + s * (b->y[ i ] - a->y[ i ]);
+		result->z[ i ] = a->z[ i ] + s * (b->z[ i ] - a->z[ i ]);
+	}
+}
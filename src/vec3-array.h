@@ -0,0 +1,82 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _VEC3_ARRAY_H_
+#define _VEC3_ARRAY_H_
+#include <stddef.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#include "mathematics.h"
+#include "vec3.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Arrays of Three Dimensional Vectors
+ *
+ * The components are stored as a structure of arrays (i.e. separate x, y
+ * and z streams) so that the batch functions below can process several
+ * vectors per instruction. Each stream is 64-byte aligned.
+ *
+ * Unless noted otherwise, the result array may be the same array as any
+ * of the inputs and every array must have the same count.
+ */
+typedef struct vec3_array {
+	scaler_t* x;
+	scaler_t* y;
+	scaler_t* z;
+	size_t count;
+} vec3_array_t;
+
+bool vec3_array_create        ( vec3_array_t* array, size_t count );
+void vec3_array_destroy       ( vec3_array_t* array );
+void vec3_array_from_vec3     ( vec3_array_t* restrict array, const vec3_t* restrict v, size_t count ); /* count <= array->count */
+void vec3_array_to_vec3       ( const vec3_array_t* restrict array, vec3_t* restrict v, size_t count ); /* count <= array->count */
+
+void vec3_array_add           ( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b );
+void vec3_array_subtract      ( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b );
+void vec3_array_multiply      ( vec3_array_t* result, const vec3_array_t* a, scaler_t s );
+void vec3_array_scale         ( vec3_array_t* array, scaler_t s );
+void vec3_array_dot_product   ( const vec3_array_t* a, const vec3_array_t* b, scaler_t* restrict result );
+void vec3_array_cross_product ( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b );
+void vec3_array_magnitude     ( const vec3_array_t* array, scaler_t* restrict result );
+void vec3_array_normalize     ( vec3_array_t* array );
+void vec3_array_lerp          ( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b, scaler_t s ); /* a + s * (b - a) */
+
+static inline vec3_t vec3_array_get( const vec3_array_t* array, size_t i )
+{
+	return VEC3( array->x[ i ], array->y[ i ], array->z[ i ] );
+}
+
+static inline void vec3_array_set( vec3_array_t* array, size_t i, const vec3_t* v )
+{
+	array->x[ i ] = v->x;
+	array->y[ i ] = v->y;
+	array->z[ i ] = v->z;
+}
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _VEC3_ARRAY_H_ */
@@ -20,6 +20,7 @@
  */
 #ifndef _VEC3_H_
 #define _VEC3_H_
+#include <stddef.h>
 #include "mathematics.h"
 #ifdef __cplusplus
 extern "C" {
@@ -62,7 +63,17 @@ extern const vec3_t VEC3_XUNIT;
 extern const vec3_t VEC3_YUNIT;
 extern const vec3_t VEC3_ZUNIT;
 
-const char* vec3_to_string     ( const vec3_t* v ); /* not thread safe */
+const char* vec3_to_string     ( const vec3_t* v ); /* uses a thread-local buffer */
+size_t      vec3_to_string_r   ( const vec3_t* v, char* buffer, size_t size ); /* returns the length like snprintf() */
+
+/*
+ * Writes count vectors as "(x, y, z)", one per line, with precision
+ * decimals (at most 9). This does not use snprintf() and is meant for
+ * dumping large arrays. Only whole vectors are written and the buffer is
+ * always terminated. Returns the number of vectors written and stores the
+ * number of characters in length (if not NULL).
+ */
+size_t vec3_format( char* restrict buffer, size_t size, const vec3_t* restrict v, size_t count, int precision, size_t* restrict length );
 
 /* |a|
  * |b|
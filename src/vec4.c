@@ -24,6 +24,7 @@
 #include <limits.h>
 #include <string.h>
 #include <assert.h>
+#include "format.h"
 #include "vec4.h"
 #include "vec3.h"
 
@@ -35,16 +36,27 @@ const vec4_t VEC4_ZUNIT = { .x = 0.0f, .y = 0.0f, .z = 1.0f, .w = 0.0f };
 const vec4_t VEC4_WUNIT = { .x = 0.0f, .y = 0.0f, .z = 0.0f, .w = 1.0f };
 
 
-const char* vec4_to_string( const vec4_t* v ) /* not thread safe */
+size_t vec4_to_string_r( const vec4_t* v, char* buffer, size_t size )
 {
-	static char string_buffer[ 128 ];
+	int length;
 #if defined(LIBM3D_USE_LONG_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1, "(%.2Lf, %.2Lf, %.2Lf, %.2Lf)", v->x, v->y, v->z, v->w );
+	length = snprintf( buffer, size, "(%.2Lf, %.2Lf, %.2Lf, %.2Lf)", v->x, v->y, v->z, v->w );
 #elif defined(LIBM3D_USE_DOUBLE)
-	snprintf( string_buffer, sizeof(string_buffer) - 1, "(%.2lf, %.2lf, %.2lf, %.2lf)", v->x, v->y, v->z, v->w );
+	length = snprintf( buffer, size, "(%.2lf, %.2lf, %.2lf, %.2lf)", v->x, v->y, v->z, v->w );
 #else
-	snprintf( string_buffer, sizeof(string_buffer) - 1, "(%.2f, %.2f, %.2f, %.2f)", v->x, v->y, v->z, v->w );
+	length = snprintf( buffer, size, "(%.2f, %.2f, %.2f, %.2f)", v->x, v->y, v->z, v->w );
 #endif
-	string_buffer[ sizeof(string_buffer) - 1 ] = '\0';
+	return length < 0 ? 0 : (size_t) length;
+}
+
+const char* vec4_to_string( const vec4_t* v )
+{
+	static _Thread_local char string_buffer[ 128 ];
+	vec4_to_string_r( v, string_buffer, sizeof(string_buffer) );
 	return string_buffer;
 }
+
+size_t vec4_format( char* restrict buffer, size_t size, const vec4_t* restrict v, size_t count, int precision, size_t* restrict length )
+{
+	return m3d_format_elements( buffer, size, (const scaler_t*) v, sizeof(vec4_t) / sizeof(scaler_t), count, 1, 4, precision, length );
+}
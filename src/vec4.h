@@ -20,6 +20,7 @@
  */
 #ifndef _VEC4_H_
 #define _VEC4_H_
+#include <stddef.h>
 #include "mathematics.h"
 #include "vec3.h"
 #ifdef __cplusplus
@@ -68,7 +69,17 @@ extern const vec4_t VEC4_YUNIT;
 extern const vec4_t VEC4_ZUNIT;
 extern const vec4_t VEC4_WUNIT;
 
-const char* vec4_to_string      ( const vec4_t* v ); /* not thread safe */
+const char* vec4_to_string      ( const vec4_t* v ); /* uses a thread-local buffer */
+size_t      vec4_to_string_r    ( const vec4_t* v, char* buffer, size_t size ); /* returns the length like snprintf() */
+
+/*
+ * Writes count vectors as "(x, y, z, w)", one per line, with precision
+ * decimals (at most 9). This does not use snprintf() and is meant for
+ * dumping large arrays. Only whole vectors are written and the buffer is
+ * always terminated. Returns the number of vectors written and stores the
+ * number of characters in length (if not NULL).
+ */
+size_t vec4_format( char* restrict buffer, size_t size, const vec4_t* restrict v, size_t count, int precision, size_t* restrict length );
 
 /* |a|
  * |b|
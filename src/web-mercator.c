@@ -0,0 +1,412 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "web-mercator.h"
+#include "batch-math.h"
+
+#define DEGREES_TO_RADIANS(degs)     ((degs) * M_PI / 180.0)
+#define RADIANS_TO_DEGREES(rads)     ((rads) * 180.0 / M_PI)
+
+/* Arrays with at least this many points are split across threads. */
+#define WEB_MERCATOR_PARALLEL_COUNT  (1 << 16)
+/* The largest double below 1. Map coordinates are clamped to it so that
+ * points on the south and east edges stay in the last tile. */
+#define WEB_MERCATOR_BELOW_ONE       (0x1.fffffffffffffp-1)
+
+/*
+ * The northing of a latitude on the unit sphere,
+ * ln(tan(pi / 4 + lat / 2)) = ln((1 + sin(lat)) / cos(lat)). At southern
+ * latitudes 1 + sin(lat) cancels, so the northing is found for |lat|,
+ * where it does not, and given the sign of lat, as it is an odd function.
+ */
+BATCH_INLINE double web_mercator_northing( double lat )
+{
+	const double magnitude = fabs( lat );
+	const double clamped   = magnitude > WEB_MERCATOR_MAX_LATITUDE ? WEB_MERCATOR_MAX_LATITUDE : magnitude;
+	double s, c;
+	batch_sincos_degrees( clamped, &s, &c );
+	return copysign( batch_log( (1.0 + s) / c ), lat );
+}
+
+/* Map coordinates in [0, 1), from the north west corner. */
+BATCH_INLINE void web_mercator_normalized( double lon, double lat, double* u, double* v )
+{
+	double x = lon / 360.0 + 0.5;
+	x -= batch_floor( x );
+	*u = x < WEB_MERCATOR_BELOW_ONE ? x : WEB_MERCATOR_BELOW_ONE;
+
+	const double y = 0.5 - web_mercator_northing( lat ) * (0.5 / BATCH_PI);
+	*v = y < 0.0 ? 0.0 : (y < WEB_MERCATOR_BELOW_ONE ? y : WEB_MERCATOR_BELOW_ONE);
+}
+
+BATCH_INLINE void web_mercator_meters( double lon, double lat, double* x, double* y )
+{
+	/* Wraps to [-180, 180], keeping both ends. */
+	const double wrapped = lon - 360.0 * batch_round( lon / 360.0 );
+	*x = WEB_MERCATOR_RADIUS * (BATCH_PI / 180.0) * wrapped;
+	*y = WEB_MERCATOR_RADIUS * web_mercator_northing( lat );
+}
+
+/* A map coordinate scaled by the number of tiles, split into the tile and
+ * the pixel offset within it. The tile fits in 30 bits. */
+BATCH_INLINE uint32_t web_mercator_split( double scaled, double tile_size, double* pixel )
+{
+	const double tile = batch_floor( scaled );
+	*pixel = (scaled - tile) * tile_size;
+	return (uint32_t) (int32_t) tile;
+}
+
+void web_mercator_from_geographic( double lon, double lat, double* x, double* y )
+{
+	web_mercator_meters( lon, lat, x, y );
+}
+
+void web_mercator_to_geographic( double x, double y, double* lon, double* lat )
+{
+	*lon = RADIANS_TO_DEGREES(x / WEB_MERCATOR_RADIUS);
+	*lat = RADIANS_TO_DEGREES(atan( sinh( y / WEB_MERCATOR_RADIUS ) ));
+}
+
+void web_mercator_tile( double lon, double lat, unsigned int zoom, unsigned int tile_size, uint32_t* tile_x, uint32_t* tile_y, double* pixel_x, double* pixel_y )
+{
+	assert( zoom <= WEB_MERCATOR_MAX_ZOOM );
+	const double tiles = (double) (UINT32_C(1) << zoom);
+	double u, v;
+	web_mercator_normalized( lon, lat, &u, &v );
+	*tile_x = web_mercator_split( u * tiles, tile_size, pixel_x );
+	*tile_y = web_mercator_split( v * tiles, tile_size, pixel_y );
+}
+
+void web_mercator_tile_to_geographic( unsigned int zoom, uint32_t tile_x, uint32_t tile_y, double pixel_x, double pixel_y, unsigned int tile_size, double* lon, double* lat )
+{
+	assert( zoom <= WEB_MERCATOR_MAX_ZOOM );
+	const double tiles = (double) (UINT32_C(1) << zoom);
+	const double u = (tile_x + pixel_x / tile_size) / tiles;
+	const double v = (tile_y + pixel_y / tile_size) / tiles;
+	*lon = 360.0 * u - 180.0;
+	*lat = RADIANS_TO_DEGREES(atan( sinh( M_PI * (1.0 - 2.0 * v) ) ));
+}
+
+/*
+ * Batch Projection
+ *
+ * Like the geographic batch conversions, the kernels work on blocks of
+ * BATCH_BLOCK points, with a zero padded block for the remainder.
+ */
+static inline void from_geographic_block( const double* restrict lon, const double* restrict lat, double* restrict x, double* restrict y )
+{
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		web_mercator_meters( lon[ i ], lat[ i ], &x[ i ], &y[ i ] );
+	}
+}
+
+static inline void tile_block( const double* restrict lon, const double* restrict lat, double tiles, double tile_size, uint32_t* restrict tile_x, uint32_t* restrict tile_y, double* restrict pixel_x, double* restrict pixel_y )
+{
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		double u, v;
+		web_mercator_normalized( lon[ i ], lat[ i ], &u, &v );
+		tile_x[ i ] = web_mercator_split( u * tiles, tile_size, &pixel_x[ i ] );
+		tile_y[ i ] = web_mercator_split( v * tiles, tile_size, &pixel_y[ i ] );
+	}
+}
+
+static inline void key_block( const double* restrict lon, const double* restrict lat, double tiles, uint64_t* restrict keys )
+{
+	for( size_t i = 0; i < BATCH_BLOCK; i++ )
+	{
+		double u, v;
+		web_mercator_normalized( lon[ i ], lat[ i ], &u, &v );
+		const uint64_t x = (uint32_t) (int32_t) batch_floor( u * tiles );
+		const uint64_t y = (uint32_t) (int32_t) batch_floor( v * tiles );
+		keys[ i ] = web_mercator_spread_bits( x ) | (web_mercator_spread_bits( y ) << 1);
+	}
+}
+
+/* Copies the last rest points into zero padded blocks. */
+static inline void web_mercator_pad( const double* lon, const double* lat, size_t rest, double in_lon[ BATCH_BLOCK ], double in_lat[ BATCH_BLOCK ] )
+{
+	memset( in_lon, 0, BATCH_BLOCK * sizeof(double) );
+	memset( in_lat, 0, BATCH_BLOCK * sizeof(double) );
+	memcpy( in_lon, lon, rest * sizeof(double) );
+	memcpy( in_lat, lat, rest * sizeof(double) );
+}
+
+void web_mercator_from_geographic_array( const double lon[], const double lat[], double x[], double y[], size_t count )
+{
+	const size_t blocks = count / BATCH_BLOCK;
+	const size_t rest   = count % BATCH_BLOCK;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( count >= WEB_MERCATOR_PARALLEL_COUNT )
+	#endif
+	for( size_t k = 0; k < blocks; k++ )
+	{
+		const size_t i = k * BATCH_BLOCK;
+		from_geographic_block( lon + i, lat + i, x + i, y + i );
+	}
+
+	if( rest > 0 )
+	{
+		const size_t i = blocks * BATCH_BLOCK;
+		double in[ 2 ][ BATCH_BLOCK ];
+		double out[ 2 ][ BATCH_BLOCK ];
+
+		web_mercator_pad( lon + i, lat + i, rest, in[ 0 ], in[ 1 ] );
+		from_geographic_block( in[ 0 ], in[ 1 ], out[ 0 ], out[ 1 ] );
+		memcpy( x + i, out[ 0 ], rest * sizeof(double) );
+		memcpy( y + i, out[ 1 ], rest * sizeof(double) );
+	}
+}
+
+void web_mercator_tile_array( const double lon[], const double lat[], size_t count, unsigned int zoom, unsigned int tile_size, uint32_t tile_x[], uint32_t tile_y[], double pixel_x[], double pixel_y[] )
+{
+	assert( zoom <= WEB_MERCATOR_MAX_ZOOM );
+	const double tiles  = (double) (UINT32_C(1) << zoom);
+	const size_t blocks = count / BATCH_BLOCK;
+	const size_t rest   = count % BATCH_BLOCK;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( count >= WEB_MERCATOR_PARALLEL_COUNT )
+	#endif
+	for( size_t k = 0; k < blocks; k++ )
+	{
+		const size_t i = k * BATCH_BLOCK;
+		tile_block( lon + i, lat + i, tiles, tile_size, tile_x + i, tile_y + i, pixel_x + i, pixel_y + i );
+	}
+
+	if( rest > 0 )
+	{
+		const size_t i = blocks * BATCH_BLOCK;
+		double in[ 2 ][ BATCH_BLOCK ];
+		uint32_t out_tiles[ 2 ][ BATCH_BLOCK ];
+		double out_pixels[ 2 ][ BATCH_BLOCK ];
+
+		web_mercator_pad( lon + i, lat + i, rest, in[ 0 ], in[ 1 ] );
+		tile_block( in[ 0 ], in[ 1 ], tiles, tile_size, out_tiles[ 0 ], out_tiles[ 1 ], out_pixels[ 0 ], out_pixels[ 1 ] );
+		memcpy( tile_x + i, out_tiles[ 0 ], rest * sizeof(uint32_t) );
+		memcpy( tile_y + i, out_tiles[ 1 ], rest * sizeof(uint32_t) );
+		memcpy( pixel_x + i, out_pixels[ 0 ], rest * sizeof(double) );
+		memcpy( pixel_y + i, out_pixels[ 1 ], rest * sizeof(double) );
+	}
+}
+
+/*
+ * Tile Buckets
+ *
+ * The points are sorted by key with a least significant digit radix sort
+ * of WEB_MERCATOR_RADIX_BITS per pass. The input is split into a fixed
+ * number of chunks, and each pass counts the digits in every chunk, finds
+ * where each chunk's points with each digit go, and scatters the chunks,
+ * so the chunks can be counted and scattered by different threads.
+ */
+#define WEB_MERCATOR_RADIX_BITS      (8)
+#define WEB_MERCATOR_RADIX           (1 << WEB_MERCATOR_RADIX_BITS)
+#define WEB_MERCATOR_CHUNKS          (32)
+
+/* Finds the keys and returns the bits that are not the same in all of them. */
+static uint64_t web_mercator_keys( const double lon[], const double lat[], size_t count, unsigned int zoom, uint64_t keys[] )
+{
+	const double tiles  = (double) (UINT32_C(1) << zoom);
+	const size_t blocks = count / BATCH_BLOCK;
+	const size_t rest   = count % BATCH_BLOCK;
+	uint64_t any = 0;
+	uint64_t all = ~UINT64_C(0);
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) reduction(|:any) reduction(&:all) if( count >= WEB_MERCATOR_PARALLEL_COUNT )
+	#endif
+	for( size_t k = 0; k < blocks; k++ )
+	{
+		const size_t i = k * BATCH_BLOCK;
+		key_block( lon + i, lat + i, tiles, keys + i );
+
+		for( size_t j = i; j < i + BATCH_BLOCK; j++ )
+		{
+			any |= keys[ j ];
+			all &= keys[ j ];
+		}
+	}
+
+	if( rest > 0 )
+	{
+		const size_t i = blocks * BATCH_BLOCK;
+		double in[ 2 ][ BATCH_BLOCK ];
+		uint64_t out[ BATCH_BLOCK ];
+
+		web_mercator_pad( lon + i, lat + i, rest, in[ 0 ], in[ 1 ] );
+		key_block( in[ 0 ], in[ 1 ], tiles, out );
+		memcpy( keys + i, out, rest * sizeof(uint64_t) );
+
+		for( size_t j = 0; j < rest; j++ )
+		{
+			any |= out[ j ];
+			all &= out[ j ];
+		}
+	}
+
+	return any ^ all;
+}
+
+static void web_mercator_radix_pass( const uint64_t* restrict keys, const size_t* restrict index, uint64_t* restrict keys_out, size_t* restrict index_out, size_t count, unsigned int shift, size_t counts[][ WEB_MERCATOR_RADIX ] )
+{
+	const size_t chunk = (count + WEB_MERCATOR_CHUNKS - 1) / WEB_MERCATOR_CHUNKS;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( count >= WEB_MERCATOR_PARALLEL_COUNT )
+	#endif
+	for( size_t c = 0; c < WEB_MERCATOR_CHUNKS; c++ )
+	{
+		const size_t begin = c * chunk < count ? c * chunk : count;
+		const size_t end   = begin + chunk < count ? begin + chunk : count;
+		size_t* n = counts[ c ];
+
+		memset( n, 0, WEB_MERCATOR_RADIX * sizeof(size_t) );
+		for( size_t i = begin; i < end; i++ )
+		{
+			n[ (keys[ i ] >> shift) & (WEB_MERCATOR_RADIX - 1) ]++;
+		}
+	}
+
+	/* A chunk's points with a digit go after all the points with smaller
+	 * digits and after the earlier chunks' points with the same digit,
+	 * which keeps the sort stable. */
+	size_t position = 0;
+	for( size_t d = 0; d < WEB_MERCATOR_RADIX; d++ )
+	{
+		for( size_t c = 0; c < WEB_MERCATOR_CHUNKS; c++ )
+		{
+			const size_t n = counts[ c ][ d ];
+			counts[ c ][ d ] = position;
+			position += n;
+		}
+	}
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if( count >= WEB_MERCATOR_PARALLEL_COUNT )
+	#endif
+	for( size_t c = 0; c < WEB_MERCATOR_CHUNKS; c++ )
+	{
+		const size_t begin = c * chunk < count ? c * chunk : count;
+		const size_t end   = begin + chunk < count ? begin + chunk : count;
+		size_t* next = counts[ c ];
+
+		for( size_t i = begin; i < end; i++ )
+		{
+			const size_t j = next[ (keys[ i ] >> shift) & (WEB_MERCATOR_RADIX - 1) ]++;
+			keys_out[ j ]  = keys[ i ];
+			index_out[ j ] = index[ i ];
+		}
+	}
+}
+
+size_t web_mercator_bucket_workspace_size( size_t count )
+{
+	/* The caller's tiles array holds the keys between passes. */
+	return count * (sizeof(uint64_t) + sizeof(size_t)) +
+	       WEB_MERCATOR_CHUNKS * WEB_MERCATOR_RADIX * sizeof(size_t);
+}
+
+bool web_mercator_bucket( const double lon[], const double lat[], size_t count, unsigned int zoom, uint64_t tiles[], size_t offsets[], size_t order[], size_t* tile_count, void* workspace )
+{
+	assert( zoom <= WEB_MERCATOR_MAX_ZOOM );
+	void* allocated = NULL;
+
+	*tile_count  = 0;
+	offsets[ 0 ] = 0;
+
+	if( count == 0 )
+	{
+		return true;
+	}
+
+	if( !workspace )
+	{
+		allocated = malloc( web_mercator_bucket_workspace_size( count ) );
+		if( !allocated )
+		{
+			return false;
+		}
+		workspace = allocated;
+	}
+
+	uint64_t* other_keys  = workspace;
+	size_t*   other_index = (size_t*) (other_keys + count);
+	size_t  (*counts)[ WEB_MERCATOR_RADIX ] = (size_t (*)[ WEB_MERCATOR_RADIX ]) (other_index + count);
+
+	uint64_t* keys  = tiles;
+	size_t*   index = order;
+	const uint64_t differing = web_mercator_keys( lon, lat, count, zoom, keys );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		index[ i ] = i;
+	}
+
+	for( unsigned int shift = 0; shift < 2 * zoom; shift += WEB_MERCATOR_RADIX_BITS )
+	{
+		/* A digit that is the same in every key would not move anything. */
+		if( ((differing >> shift) & (WEB_MERCATOR_RADIX - 1)) == 0 )
+		{
+			continue;
+		}
+
+		web_mercator_radix_pass( keys, index, other_keys, other_index, count, shift, counts );
+
+		uint64_t* swap_keys = keys;
+		keys = other_keys;
+		other_keys = swap_keys;
+
+		size_t* swap_index = index;
+		index = other_index;
+		other_index = swap_index;
+	}
+
+	if( index != order )
+	{
+		memcpy( order, index, count * sizeof(size_t) );
+	}
+
+	/* Compacts the sorted keys into tiles, which may be where they are. */
+	size_t t = 0;
+	uint64_t previous = keys[ 0 ];
+	tiles[ t++ ] = previous;
+
+	for( size_t i = 1; i < count; i++ )
+	{
+		if( keys[ i ] != previous )
+		{
+			previous = keys[ i ];
+			offsets[ t ] = i;
+			tiles[ t++ ] = previous;
+		}
+	}
+
+	offsets[ t ] = count;
+	*tile_count  = t;
+
+	free( allocated );
+	return true;
+}
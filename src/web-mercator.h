@@ -0,0 +1,137 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _WEB_MERCATOR_H_
+#define _WEB_MERCATOR_H_
+#include <stddef.h>
+#include <stdint.h>
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+#include <stdbool.h>
+#else
+#error "Need a C99 compiler."
+#endif
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Web Mercator
+ *
+ * The spherical Mercator projection used by web maps (EPSG:3857) and its
+ * tile pyramid. At zoom z the map is a grid of 2^z by 2^z tiles, with tile
+ * (0, 0) in the north west corner, and pixel offsets are measured from the
+ * north west corner of a tile. Latitudes are clamped to
+ * +/-WEB_MERCATOR_MAX_LATITUDE, where the map is square, and longitudes
+ * wrap around, so 180 is the west edge of tile 0.
+ *
+ * Unlike wgs84_geographic_to_mercator, which clamps latitudes at 89.5
+ * degrees and takes a central meridian, these match the tiles of web map
+ * servers.
+ */
+#define WEB_MERCATOR_RADIUS           (6378137.0)
+#define WEB_MERCATOR_MAX_LATITUDE     (85.0511287798066) /* atan(sinh(pi)) */
+#define WEB_MERCATOR_MAX_ZOOM         (30)
+
+void web_mercator_from_geographic    ( double lon, double lat, double* x, double* y );
+void web_mercator_to_geographic      ( double x, double y, double* lon, double* lat );
+void web_mercator_tile               ( double lon, double lat, unsigned int zoom, unsigned int tile_size, uint32_t* tile_x, uint32_t* tile_y, double* pixel_x, double* pixel_y );
+void web_mercator_tile_to_geographic ( unsigned int zoom, uint32_t tile_x, uint32_t tile_y, double pixel_x, double pixel_y, unsigned int tile_size, double* lon, double* lat );
+
+/*
+ * Batch Projection
+ *
+ * These project count points between structure of arrays buffers, which
+ * must not overlap. The kernels use a vectorized sine and logarithm, and
+ * arrays of 65536 or more points are split across threads when built with
+ * OpenMP. The results are the same as the single point functions, which
+ * share the kernels.
+ *
+ * web_mercator_tile_array writes the tile of each point at the given zoom
+ * and its pixel offset within the tile, in [0, tile_size).
+ */
+void web_mercator_from_geographic_array ( const double lon[], const double lat[], double x[], double y[], size_t count );
+void web_mercator_tile_array            ( const double lon[], const double lat[], size_t count, unsigned int zoom, unsigned int tile_size, uint32_t tile_x[], uint32_t tile_y[], double pixel_x[], double pixel_y[] );
+
+/*
+ * Tile Keys
+ *
+ * A key interleaves the bits of a tile's x and y, so its base 4 digits,
+ * from the most significant, are the tile's quadkey. Sorting by key puts
+ * the tiles that share a parent next to each other at every zoom.
+ */
+static inline uint64_t web_mercator_spread_bits( uint64_t v )
+{
+	v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+	v = (v | (v << 8))  & 0x00ff00ff00ff00ffULL;
+	v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+	v = (v | (v << 2))  & 0x3333333333333333ULL;
+	v = (v | (v << 1))  & 0x5555555555555555ULL;
+	return v;
+}
+
+static inline uint32_t web_mercator_gather_bits( uint64_t v )
+{
+	v &= 0x5555555555555555ULL;
+	v = (v | (v >> 1))  & 0x3333333333333333ULL;
+	v = (v | (v >> 2))  & 0x0f0f0f0f0f0f0f0fULL;
+	v = (v | (v >> 4))  & 0x00ff00ff00ff00ffULL;
+	v = (v | (v >> 8))  & 0x0000ffff0000ffffULL;
+	v = (v | (v >> 16)) & 0x00000000ffffffffULL;
+	return (uint32_t) v;
+}
+
+static inline uint64_t web_mercator_tile_key( uint32_t tile_x, uint32_t tile_y )
+{
+	return web_mercator_spread_bits( tile_x ) | (web_mercator_spread_bits( tile_y ) << 1);
+}
+
+static inline void web_mercator_tile_from_key( uint64_t key, uint32_t* tile_x, uint32_t* tile_y )
+{
+	*tile_x = web_mercator_gather_bits( key );
+	*tile_y = web_mercator_gather_bits( key >> 1 );
+}
+
+/*
+ * Tile Buckets
+ *
+ * web_mercator_bucket groups count points by their tile at the given zoom.
+ * It writes the keys of the tiles that have points to tiles, in increasing
+ * order, and their number to tile_count. The points in tiles[ t ] are
+ * order[ offsets[ t ] ] to order[ offsets[ t + 1 ] - 1 ], in increasing
+ * order. So tiles must have room for count keys, offsets for count + 1
+ * entries, and order for count indices.
+ *
+ * The keys are found in one vectorized pass, and then sorted with a stable
+ * radix sort that skips the bytes that are the same in every key. Points
+ * from a small region at a high zoom take one or two passes. Large inputs
+ * are split across threads when built with OpenMP, and the result does not
+ * depend on the number of threads.
+ *
+ * workspace may be NULL to allocate one for each call. Otherwise it should
+ * point to web_mercator_bucket_workspace_size( count ) bytes, aligned for
+ * 64 bit integers. Returns false if the workspace cannot be allocated.
+ */
+size_t web_mercator_bucket_workspace_size ( size_t count );
+bool   web_mercator_bucket                ( const double lon[], const double lat[], size_t count, unsigned int zoom, uint64_t tiles[], size_t offsets[], size_t order[], size_t* tile_count, void* workspace );
+
+#ifdef __cplusplus
+} /* C linkage */
+#endif
+#endif /* _WEB_MERCATOR_H_ */
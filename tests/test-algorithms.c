@@ -23,15 +23,27 @@
 #include <time.h>
 #include <float.h>
 #include <assert.h>
+#include "../src/mathematics.h"
 #include "../src/algorithms.h"
 #include "test.h"
 
 static double f(double x);
 
-bool test_hungarian_assignment          ( void );
+
+bool test_hungarian_assignment             ( void );
+bool test_hungarian_assignment_rectangular ( void );
+bool test_hungarian_assignment_random      ( void );
+bool test_hungarian_assignment_forbidden   ( void );
+bool test_sparse_assignment                ( void );
+bool test_sparse_assignment_large          ( void );
 
 const test_feature_t algorithms_tests[] = {
-	{ "Testing Hungarian Assignment",            test_hungarian_assignment },
+	{ "Testing Hungarian Assignment",                     test_hungarian_assignment },
+	{ "Testing Hungarian Assignment (rectangular)",       test_hungarian_assignment_rectangular },
+	{ "Testing Hungarian Assignment (random matrices)",   test_hungarian_assignment_random },
+	{ "Testing Hungarian Assignment (forbidden pairs)",   test_hungarian_assignment_forbidden },
+	{ "Testing Sparse Assignment",                        test_sparse_assignment },
+	{ "Testing Sparse Assignment (large and clustered)",  test_sparse_assignment_large },
 };
 
 size_t algorithms_test_suite_size( void )
@@ -43,70 +55,424 @@ size_t algorithms_test_suite_size( void )
 #ifdef TEST_ALGORITHMS_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "Algorithm Functions", algorithms_tests, algorithms_test_suite_size() );
 	return 0;
 }
 #endif
 
+/* Tries every assignment, for checking small problems. */
+static double brute_force_assignment( const double cost[], size_t workers, size_t tasks, bool maximal, size_t w, unsigned int taken, size_t skips )
+{
+	if( w == workers )
+	{
+		return 0.0;
+	}
 
-bool test_hungarian_assignment( void )
+	double best = maximal ? -INFINITY : INFINITY;
+
+	for( size_t t = 0; t < tasks; t++ )
+	{
+		if( !(taken & (1u << t)) )
+		{
+			double total = cost[ tasks * w + t ] + brute_force_assignment( cost, workers, tasks, maximal, w + 1, taken | (1u << t), skips );
+			if( maximal ? total > best : total < best ) best = total;
+		}
+	}
+
+	/* Workers may go without a task when there are more workers than tasks. */
+	if( skips > 0 )
+	{
+		double total = brute_force_assignment( cost, workers, tasks, maximal, w + 1, taken, skips - 1 );
+		if( maximal ? total > best : total < best ) best = total;
+	}
+
+	return best;
+}
+
+/* Checks that output is a complete assignment and sums its cost. */
+static bool assignment_cost( const double cost[], size_t workers, size_t tasks, const int output[], double* total )
 {
-	double root = 0.0;
-	bool result = true;
-	int output1[ 4 ] = {0};
+	unsigned int taken = 0;
+	size_t assigned = 0;
+	*total = 0.0;
 
+	for( size_t w = 0; w < workers; w++ )
+	{
+		if( output[ w ] < 0 ) continue;
+		if( output[ w ] >= (int) tasks || (taken & (1u << output[ w ])) ) return false;
+		taken |= 1u << output[ w ];
+		assigned += 1;
+		*total += cost[ tasks * w + output[ w ] ];
+	}
+
+	return assigned == (workers < tasks ? workers : tasks);
+}
+
+bool test_hungarian_assignment( void )
+{
 	int cost1[] = {
 		 4,  7,  3,  5,
 		 6,  2, 13,  2,
 		14,  8,  1,  0,
 		11,  9,  4, 13
 	};
-	int cost1_cpy[] = {
-		 4,  7,  3,  5,
-		 6,  2, 13,  2,
-		14,  8,  1,  0,
-		11,  9,  4, 13
+	int cost2[] = {
+		 6,  5,  2,  4,
+		 8,  8,  8, 12,
+		 2, 13, 10,  8,
+		 7,  9,  9, 11
 	};
+	int output1[ 4 ] = {0};
+	int output2[ 4 ] = {0};
 
 	hungarian_assignment( false, cost1, 4, 4, output1 );
+	hungarian_assignment( true, cost2, 4, 4, output2 );
 
-	printf( "output1 = [" );
 	int total_cost1 = 0;
+	int total_cost2 = 0;
 	for( size_t i = 0; i < 4; i++ )
 	{
-		printf( "%d ", output1[ i ] );
-		total_cost1 += cost1_cpy[ 4 * i + output1[ i ] ];
+		total_cost1 += cost1[ 4 * i + output1[ i ] ];
+		total_cost2 += cost2[ 4 * i + output2[ i ] ];
 	}
-	printf( "] ==> Cost = %d\n", total_cost1 );
-	printf( "-------------------------------\n" );
 
-	int output2[ 4 ] = {0};
-	int cost2[] = {
-		 6,  5,  2,  4,
-		 8,  8,  8, 12,
-		 2, 13, 10,  8,
-		 7,  9,  9, 11
+	return total_cost1 == 10 &&
+	       total_cost2 == 40 &&
+	       cost1[ 0 ] == 4 && cost2[ 0 ] == 6; /* the costs are not modified */
+}
+
+bool test_hungarian_assignment_rectangular( void )
+{
+	bool result = true;
+
+	for( size_t workers = 1; result && workers <= 6; workers++ )
+	{
+		for( size_t tasks = 1; result && tasks <= 6; tasks++ )
+		{
+			int cost[ 36 ];
+			double costd[ 36 ];
+			int output[ 6 ];
+
+			for( size_t i = 0; i < workers * tasks; i++ )
+			{
+				cost[ i ]  = m3d_uniform_rangei( 0, 20 );
+				costd[ i ] = cost[ i ];
+			}
+
+			const size_t skips = workers > tasks ? workers - tasks : 0;
+
+			for( int maximal = 0; result && maximal <= 1; maximal++ )
+			{
+				double total;
+				hungarian_assignment( maximal, cost, workers, tasks, output );
+				result = assignment_cost( costd, workers, tasks, output, &total ) &&
+				         total == brute_force_assignment( costd, workers, tasks, maximal, 0, 0, skips );
+			}
+		}
+	}
+
+	return result;
+}
+
+bool test_hungarian_assignment_random( void )
+{
+	bool result = true;
+	void* workspace = malloc( hungarian_workspace_size( 8, 8 ) );
+
+	for( int trial = 0; workspace && result && trial < 200; trial++ )
+	{
+		const size_t workers = m3d_uniform_rangei( 1, 8 );
+		const size_t tasks   = m3d_uniform_rangei( 1, 8 );
+		const size_t skips   = workers > tasks ? workers - tasks : 0;
+		const bool maximal   = trial & 1;
+		double costd[ 64 ];
+		float costf[ 64 ];
+		double rounded[ 64 ];
+		int output[ 8 ];
+		double total;
+
+		for( size_t i = 0; i < workers * tasks; i++ )
+		{
+			costd[ i ]   = m3d_uniform_ranged( -100.0, 100.0 );
+			costf[ i ]   = (float) costd[ i ];
+			rounded[ i ] = costf[ i ];
+		}
+
+		const double best = brute_force_assignment( costd, workers, tasks, maximal, 0, 0, skips );
+		result = hungarian_assignmentd( maximal, costd, workers, tasks, output, workspace ) &&
+		         assignment_cost( costd, workers, tasks, output, &total ) &&
+		         fabs( total - best ) < 1e-9;
+
+		const double bestf = brute_force_assignment( rounded, workers, tasks, maximal, 0, 0, skips );
+		result = result &&
+		         hungarian_assignmentf( maximal, costf, workers, tasks, output, NULL ) &&
+		         assignment_cost( rounded, workers, tasks, output, &total ) &&
+		         fabs( total - bestf ) < 1e-9;
+	}
+
+	/* A larger problem where the identity is the only optimal assignment. */
+	const size_t n = 300;
+	double* big = malloc( n * n * sizeof(double) );
+	int* output = malloc( n * sizeof(int) );
+
+	if( result && big && output )
+	{
+		for( size_t w = 0; w < n; w++ )
+		{
+			for( size_t t = 0; t < n; t++ )
+			{
+				big[ n * w + t ] = w == t ? 0.0 : 1.0 + m3d_uniformd( );
+			}
+		}
+
+		result = hungarian_assignmentd( false, big, n, n, output, NULL );
+		for( size_t w = 0; result && w < n; w++ )
+		{
+			result = output[ w ] == (int) w;
+		}
+	}
+	else
+	{
+		result = false;
+	}
+
+	free( big );
+	free( output );
+	free( workspace );
+	return result;
+}
+
+bool test_hungarian_assignment_forbidden( void )
+{
+	const double X = INFINITY;
+	const double cost[] = {
+		1, X, X,
+		2, 3, X,
+		9, 1, 4
 	};
-	int cost2_cpy[] = {
-		 6,  5,  2,  4,
-		 8,  8,  8, 12,
-		 2, 13, 10,  8,
-		 7,  9,  9, 11
+	const double impossible[] = {
+		1, X, X,
+		2, X, X,
+		9, 1, 4
 	};
+	const double maximal[] = {
+		 1, -X,
+		-X,  5,
+		 7,  6
+	};
+	int output[ 3 ];
 
-	hungarian_assignment( true, cost2, 4, 4, output2 );
+	bool result = hungarian_assignmentd( false, cost, 3, 3, output, NULL ) &&
+	              output[ 0 ] == 0 && output[ 1 ] == 1 && output[ 2 ] == 2;
 
-	printf( "output2 = [" );
-	int total_cost2 = 0;
-	for( size_t i = 0; i < 4; i++ )
+	result = result && !hungarian_assignmentd( false, impossible, 3, 3, output, NULL );
+
+	/* Worker 0 is left without a task. */
+	result = result &&
+	         hungarian_assignmentd( true, maximal, 3, 2, output, NULL ) &&
+	         output[ 0 ] == -1 && output[ 1 ] == 1 && output[ 2 ] == 0;
+
+	return result;
+}
+
+/* Tries every assignment where workers may also go unassigned. */
+static double brute_force_gated( const double cost[], size_t workers, size_t tasks, double unassigned, size_t w, unsigned int taken )
+{
+	if( w == workers )
+	{
+		return 0.0;
+	}
+
+	double best = unassigned + brute_force_gated( cost, workers, tasks, unassigned, w + 1, taken );
+
+	for( size_t t = 0; t < tasks; t++ )
+	{
+		if( !(taken & (1u << t)) && cost[ tasks * w + t ] < INFINITY )
+		{
+			double total = cost[ tasks * w + t ] + brute_force_gated( cost, workers, tasks, unassigned, w + 1, taken | (1u << t) );
+			if( total < best ) best = total;
+		}
+	}
+
+	return best;
+}
+
+/* Converts a dense matrix with INFINITY for forbidden pairs to sparse rows. */
+static size_t to_sparse( const double cost[], size_t workers, size_t tasks, size_t offsets[], int columns[], double costs[] )
+{
+	size_t e = 0;
+
+	for( size_t w = 0; w < workers; w++ )
+	{
+		offsets[ w ] = e;
+		for( size_t t = 0; t < tasks; t++ )
+		{
+			if( cost[ tasks * w + t ] < INFINITY )
+			{
+				columns[ e ] = (int) t;
+				costs[ e ]   = cost[ tasks * w + t ];
+				e += 1;
+			}
+		}
+	}
+
+	offsets[ workers ] = e;
+	return e;
+}
+
+bool test_sparse_assignment( void )
+{
+	bool result = true;
+
+	for( int trial = 0; result && trial < 300; trial++ )
+	{
+		const size_t workers = m3d_uniform_rangei( 1, 7 );
+		const size_t tasks   = m3d_uniform_rangei( 1, 7 );
+		const double unassigned = m3d_uniform_ranged( 0.0, 60.0 );
+		double cost[ 49 ];
+		size_t offsets[ 8 ];
+		int columns[ 49 ];
+		double costs[ 49 ];
+		float costsf[ 49 ];
+		int output[ 7 ];
+
+		for( size_t i = 0; i < workers * tasks; i++ )
+		{
+			cost[ i ] = m3d_uniformd( ) < 0.5 ? INFINITY : (double) m3d_uniform_rangei( 0, 50 );
+		}
+
+		const size_t edges = to_sparse( cost, workers, tasks, offsets, columns, costs );
+		for( size_t e = 0; e < edges; e++ )
+		{
+			costsf[ e ] = (float) costs[ e ];
+		}
+
+		const double best = brute_force_gated( cost, workers, tasks, unassigned, 0, 0 );
+
+		for( int variant = 0; result && variant < 3; variant++ )
+		{
+			bool solved;
+
+			if( variant < 2 )
+			{
+				solved = sparse_assignmentd( false, workers, tasks, offsets, columns, costs, unassigned, variant, output );
+			}
+			else
+			{
+				/* Maximizing the negated costs is the same problem. */
+				for( size_t e = 0; e < edges; e++ ) costsf[ e ] = -costsf[ e ];
+				solved = sparse_assignmentf( true, workers, tasks, offsets, columns, costsf, (float) -unassigned, true, output );
+			}
+
+			unsigned int taken = 0;
+			double total = 0.0;
+			result = solved;
+
+			for( size_t w = 0; result && w < workers; w++ )
+			{
+				if( output[ w ] < 0 )
+				{
+					total += unassigned;
+				}
+				else
+				{
+					result = output[ w ] < (int) tasks &&
+					         !(taken & (1u << output[ w ])) &&
+					         cost[ tasks * w + output[ w ] ] < INFINITY;
+					taken |= 1u << output[ w ];
+					total += cost[ tasks * w + output[ w ] ];
+				}
+			}
+
+			result = result && fabs( total - best ) < 1e-4;
+		}
+	}
+
+	/* Every worker must be assigned when unassigned is INFINITY. */
+	if( result )
 	{
-		printf( "%d ", output2[ i ] );
-		total_cost2 += cost2_cpy[ 4 * i + output2[ i ] ];
+		const size_t offsets[] = { 0, 1, 2, 4 };
+		const int columns[]    = { 0, 0, 1, 2 };
+		const double costs[]   = { 1, 2, 5, 1 };
+		int output[ 3 ];
+
+		result = !sparse_assignmentd( false, 3, 3, offsets, columns, costs, INFINITY, false, output ) &&
+		         sparse_assignmentd( false, 3, 3, offsets, columns, costs, 3.0, true, output ) &&
+		         output[ 0 ] == 0 && output[ 1 ] == -1 && output[ 2 ] == 2;
+	}
+
+	/* Empty problems: no workers, and workers with no tasks. */
+	if( result )
+	{
+		const size_t offsets[] = { 0, 0, 0 };
+		int output[ 2 ];
+
+		result = sparse_assignmentd( false, 0, 3, offsets, NULL, NULL, INFINITY, true, NULL ) &&
+		         sparse_assignmentd( false, 0, 0, offsets, NULL, NULL, INFINITY, false, NULL ) &&
+		         !sparse_assignmentd( false, 2, 0, offsets, NULL, NULL, INFINITY, false, output ) &&
+		         sparse_assignmentd( false, 2, 0, offsets, NULL, NULL, 1.0, true, output ) &&
+		         output[ 0 ] == -1 && output[ 1 ] == -1;
 	}
-	printf( "] ==> Cost = %d\n", total_cost2 );
 
-	//return result && relative_errord(1.36523, root) < 0.001;
 	return result;
 }
 
+bool test_sparse_assignment_large( void )
+{
+	/* Workers and tasks in clusters of 16, with 6 allowed pairs each. */
+	const size_t n = 4096;
+	const size_t k = 6;
+	size_t* offsets = malloc( (n + 1) * sizeof(size_t) );
+	int* columns    = malloc( n * k * sizeof(int) );
+	double* costs   = malloc( n * k * sizeof(double) );
+	int* output1    = malloc( n * sizeof(int) );
+	int* output2    = malloc( n * sizeof(int) );
+	bool result     = offsets && columns && costs && output1 && output2;
+
+	if( result )
+	{
+		for( size_t w = 0; w < n; w++ )
+		{
+			offsets[ w ] = w * k;
+			for( size_t e = 0; e < k; e++ )
+			{
+				/* Distinct tasks from the worker's cluster */
+				columns[ w * k + e ] = (int) ((w & ~(size_t) 15) + ((w + 3 * e) & 15));
+				costs[ w * k + e ]   = m3d_uniformd( );
+			}
+		}
+		offsets[ n ] = n * k;
+
+		result = sparse_assignmentd( false, n, n, offsets, columns, costs, 2.0, false, output1 ) &&
+		         sparse_assignmentd( false, n, n, offsets, columns, costs, 2.0, true, output2 );
+
+		double total1 = 0.0;
+		double total2 = 0.0;
+		unsigned char* taken = calloc( n, 1 );
+		result = result && taken;
+
+		for( size_t w = 0; result && w < n; w++ )
+		{
+			for( size_t e = offsets[ w ]; e < offsets[ w + 1 ]; e++ )
+			{
+				if( columns[ e ] == output1[ w ] ) total1 += costs[ e ];
+				if( columns[ e ] == output2[ w ] ) total2 += costs[ e ];
+			}
+
+			/* Every worker can be assigned below the cost of not being. */
+			result = output2[ w ] >= 0 && !taken[ output2[ w ] ];
+			if( result ) taken[ output2[ w ] ] = 1;
+		}
+
+		result = result && fabs( total1 - total2 ) < 1e-9;
+		free( taken );
+	}
+
+	free( offsets );
+	free( columns );
+	free( costs );
+	free( output1 );
+	free( output2 );
+	return result;
+}
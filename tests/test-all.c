@@ -32,6 +32,9 @@ size_t vec2_test_suite_size( void );
 extern const test_feature_t vec3_tests[];
 size_t vec3_test_suite_size( void );
 
+extern const test_feature_t vec3_array_tests[];
+size_t vec3_array_test_suite_size( void );
+
 extern const test_feature_t vec4_tests[];
 size_t vec4_test_suite_size( void );
 
@@ -47,6 +50,24 @@ size_t mat4_test_suite_size( void );
 extern const test_feature_t quat_tests[];
 size_t quat_test_suite_size( void );
 
+extern const test_feature_t quat_array_tests[];
+size_t quat_array_test_suite_size( void );
+
+extern const test_feature_t skinning_tests[];
+size_t skinning_test_suite_size( void );
+
+extern const test_feature_t dual_quat_tests[];
+size_t dual_quat_test_suite_size( void );
+
+extern const test_feature_t packed_transforms_tests[];
+size_t packed_transforms_test_suite_size( void );
+
+extern const test_feature_t transform_hierarchy_tests[];
+size_t transform_hierarchy_test_suite_size( void );
+
+extern const test_feature_t random_tests[];
+size_t random_test_suite_size( void );
+
 extern const test_feature_t numerical_methods_tests[];
 size_t numerical_methods_test_suite_size( void );
 
@@ -59,11 +80,18 @@ extern size_t geometric_tools_test_suite_size( void );
 extern const test_feature_t geographic_tests[];
 size_t geographic_test_suite_size( void );
 
+extern const test_feature_t geographic_index_tests[];
+size_t geographic_index_test_suite_size( void );
+
+extern const test_feature_t web_mercator_tests[];
+size_t web_mercator_test_suite_size( void );
+
 const test_suite_t suites[] = {
 	{ "Tests for mathematics.h", math_tests, math_test_suite_size },
 
 	{ "Tests for vec2.h", vec2_tests, vec2_test_suite_size },
 	{ "Tests for vec3.h", vec3_tests, vec3_test_suite_size },
+	{ "Tests for vec3-array.h", vec3_array_tests, vec3_array_test_suite_size },
 	{ "Tests for vec4.h", vec4_tests, vec4_test_suite_size },
 
 	{ "Tests for mat2.h", mat2_tests, mat2_test_suite_size },
@@ -71,16 +99,25 @@ const test_suite_t suites[] = {
 	{ "Tests for mat4.h", mat4_tests, mat4_test_suite_size },
 
 	//{ "Tests for quat.h", quat_tests, quat_test_suite_size },
+	{ "Tests for quat-array.h", quat_array_tests, quat_array_test_suite_size },
+	{ "Tests for skinning.h", skinning_tests, skinning_test_suite_size },
+	{ "Tests for dual-quat.h", dual_quat_tests, dual_quat_test_suite_size },
+	{ "Tests for packed-transforms.h", packed_transforms_tests, packed_transforms_test_suite_size },
+	{ "Tests for transform-hierarchy.h", transform_hierarchy_tests, transform_hierarchy_test_suite_size },
+	{ "Tests for random.h", random_tests, random_test_suite_size },
 	{ "Tests for numerical-methods.h", numerical_methods_tests, numerical_methods_test_suite_size },
 	{ "Tests for projections.h", projection_tests, projection_test_suite_size },
 	{ "Tests for geometric-tools.h", geometric_tools_tests, geometric_tools_test_suite_size },
 	{ "Tests for geographic.h", geographic_tests, geographic_test_suite_size },
+	{ "Tests for geographic-index.h", geographic_index_tests, geographic_index_test_suite_size },
+	{ "Tests for web-mercator.h", web_mercator_tests, web_mercator_test_suite_size },
 };
 
 
 int main( int argc, char* argv[] )
 {
 	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 
 	#if defined(LIBM3D_USE_LONG_DOUBLE)
 	printf( "%s: %s%-30s%s\n\n", COLOR_CYAN_STR("Type of scaler_t"), COLOR_GREEN, "long double", COLOR_END );
@@ -0,0 +1,297 @@
+/* Copyright (C) 2013-2015 by Joseph A. Marrero, http://www.manvscode.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "../src/quat.h"
+#include "../src/transforms.h"
+#include "../src/dual-quat.h"
+#include "test.h"
+
+/* More than one block of vertices, the last one partial. */
+#define DUAL_QUAT_TEST_VERTICES   (101)
+#define DUAL_QUAT_TEST_JOINTS     (20)
+#define DUAL_QUAT_TOLERANCE       (1e-4)
+
+bool test_dual_quat_transform ( void );
+bool test_dual_quat_from_mat4 ( void );
+bool test_dual_quat_multiply  ( void );
+bool test_dual_quat_normalize ( void );
+bool test_dual_quat_skin      ( void );
+
+const test_feature_t dual_quat_tests[] = {
+	{ "Testing dual quaternion transforms",     test_dual_quat_transform },
+	{ "Testing dual quaternion from mat4",      test_dual_quat_from_mat4 },
+	{ "Testing dual quaternion multiplication", test_dual_quat_multiply },
+	{ "Testing dual quaternion normalize",      test_dual_quat_normalize },
+	{ "Testing dual quaternion skinning",       test_dual_quat_skin },
+};
+
+size_t dual_quat_test_suite_size( void )
+{
+	return sizeof(dual_quat_tests) / sizeof(dual_quat_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	bool result = test_features( "Dual Quaternion Functions", dual_quat_tests, dual_quat_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+static bool nearly_equal( scaler_t a, scaler_t b )
+{
+	return fabs( (double) (a - b) ) < DUAL_QUAT_TOLERANCE;
+}
+
+static bool vec3_close( const vec3_t* a, const vec3_t* b )
+{
+	return nearly_equal( a->x, b->x ) && nearly_equal( a->y, b->y ) && nearly_equal( a->z, b->z );
+}
+
+static bool mat4_close( const mat4_t* a, const mat4_t* b )
+{
+	bool result = true;
+	for( size_t k = 0; result && k < 16; k++ )
+	{
+		result = nearly_equal( a->m[ k ], b->m[ k ] );
+	}
+	return result;
+}
+
+/* Equal as transforms, i.e. up to the sign of both parts. */
+static bool dual_quat_close( const dual_quat_t* a, const dual_quat_t* b )
+{
+	const scaler_t s = quat_dot_product( &a->real, &b->real ) < 0 ? -1 : 1;
+	return nearly_equal( a->real.x, s * b->real.x ) && nearly_equal( a->real.y, s * b->real.y ) &&
+	       nearly_equal( a->real.z, s * b->real.z ) && nearly_equal( a->real.w, s * b->real.w ) &&
+	       nearly_equal( a->dual.x, s * b->dual.x ) && nearly_equal( a->dual.y, s * b->dual.y ) &&
+	       nearly_equal( a->dual.z, s * b->dual.z ) && nearly_equal( a->dual.w, s * b->dual.w );
+}
+
+static vec3_t random_vec3( scaler_t extent )
+{
+	return VEC3( m3d_uniform_rangef( -extent, extent ), m3d_uniform_rangef( -extent, extent ), m3d_uniform_rangef( -extent, extent ) );
+}
+
+static dual_quat_t random_dual_quat( void )
+{
+	quat_t q = QUAT( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+	quat_normalize( &q );
+	const vec3_t t = random_vec3( 2 );
+	return dual_quat_from_quat_vec3( &q, &t );
+}
+
+/* T * R as a matrix, with the scalar functions. */
+static mat4_t reference_matrix( const quat_t* q, const vec3_t* t )
+{
+	const mat4_t T = m3d_translate( t );
+	const mat4_t R = quat_to_mat4( q );
+	return mat4_mult_matrix( &T, &R );
+}
+
+bool test_dual_quat_transform( void )
+{
+	bool result = true;
+
+	for( size_t i = 0; result && i < 100; i++ )
+	{
+		quat_t q = QUAT( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+		quat_normalize( &q );
+		const vec3_t t = random_vec3( 2 );
+		const vec3_t p = random_vec3( 1 );
+		const dual_quat_t dq = dual_quat_from_quat_vec3( &q, &t );
+		const mat4_t m = reference_matrix( &q, &t );
+
+		const vec4_t p4 = VEC4( p.x, p.y, p.z, 1 );
+		const vec4_t expected_point = mat4_mult_vector( &m, &p4 );
+		const vec4_t n4 = VEC4( p.x, p.y, p.z, 0 );
+		const vec4_t expected_vector = mat4_mult_vector( &m, &n4 );
+
+		const vec3_t point       = dual_quat_transform_point( &dq, &p );
+		const vec3_t vector      = dual_quat_transform_vec3( &dq, &p );
+		const vec3_t translation = dual_quat_translation( &dq );
+		const quat_t rotation    = dual_quat_rotation( &dq );
+		const mat4_t matrix      = dual_quat_to_mat4( &dq );
+
+		result = vec3_close( &point, &VEC3( expected_point.x, expected_point.y, expected_point.z ) ) &&
+		         vec3_close( &vector, &VEC3( expected_vector.x, expected_vector.y, expected_vector.z ) ) &&
+		         vec3_close( &translation, &t ) &&
+		         quat_dot_product( &rotation, &q ) > 1 - DUAL_QUAT_TOLERANCE &&
+		         mat4_close( &matrix, &m );
+	}
+
+	return result;
+}
+
+bool test_dual_quat_from_mat4( void )
+{
+	/* Half turns have a zero w, which takes the other branches. */
+	const quat_t half_turns[] = { QUAT( 1, 0, 0, 0 ), QUAT( 0, 1, 0, 0 ), QUAT( 0, 0, 1, 0 ), QUAT_WUNIT };
+	bool result = true;
+
+	for( size_t i = 0; result && i < 100; i++ )
+	{
+		dual_quat_t dq = random_dual_quat();
+		if( i < sizeof(half_turns) / sizeof(half_turns[0]) )
+		{
+			const vec3_t t = random_vec3( 2 );
+			dq = dual_quat_from_quat_vec3( &half_turns[ i ], &t );
+		}
+
+		const mat4_t m = dual_quat_to_mat4( &dq );
+		const dual_quat_t from = dual_quat_from_mat4( &m );
+		result = dual_quat_close( &from, &dq );
+	}
+
+	return result;
+}
+
+bool test_dual_quat_multiply( void )
+{
+	bool result = true;
+
+	for( size_t i = 0; result && i < 100; i++ )
+	{
+		const dual_quat_t a = random_dual_quat();
+		const dual_quat_t b = random_dual_quat();
+		const dual_quat_t ab = dual_quat_multiply( &a, &b );
+		const mat4_t ma = dual_quat_to_mat4( &a );
+		const mat4_t mb = dual_quat_to_mat4( &b );
+		const mat4_t expected = mat4_mult_matrix( &ma, &mb );
+		const mat4_t product = dual_quat_to_mat4( &ab );
+
+		const dual_quat_t inverse = dual_quat_conjugate( &a );
+		const dual_quat_t identity = dual_quat_multiply( &a, &inverse );
+
+		result = mat4_close( &product, &expected ) &&
+		         dual_quat_close( &identity, &DUAL_QUAT_IDENTITY );
+	}
+
+	return result;
+}
+
+bool test_dual_quat_normalize( void )
+{
+	bool result = true;
+
+	for( size_t i = 0; result && i < 100; i++ )
+	{
+		const dual_quat_t dq = random_dual_quat();
+		dual_quat_t scaled = dq;
+
+		/* Scaled, with some of the real part in the dual part. */
+		quat_scale( &scaled.real, 3 );
+		quat_scale( &scaled.dual, 3 );
+		scaled.dual.x += 0.1f * scaled.real.x;
+		scaled.dual.y += 0.1f * scaled.real.y;
+		scaled.dual.z += 0.1f * scaled.real.z;
+		scaled.dual.w += 0.1f * scaled.real.w;
+
+		dual_quat_normalize( &scaled );
+		result = dual_quat_close( &scaled, &dq ) &&
+		         nearly_equal( quat_dot_product( &scaled.real, &scaled.dual ), 0 );
+	}
+
+	return result;
+}
+
+bool test_dual_quat_skin( void )
+{
+	dual_quat_t palette[ 2 * DUAL_QUAT_TEST_JOINTS ];
+	uint16_t joints[ DUAL_QUAT_TEST_VERTICES ][ 4 ];
+	scaler_t weights[ DUAL_QUAT_TEST_VERTICES ][ 4 ];
+	vec3_array_t bind_positions, bind_normals, positions, normals;
+	bool result = vec3_array_create( &bind_positions, DUAL_QUAT_TEST_VERTICES ) &&
+	              vec3_array_create( &bind_normals, DUAL_QUAT_TEST_VERTICES ) &&
+	              vec3_array_create( &positions, DUAL_QUAT_TEST_VERTICES ) &&
+	              vec3_array_create( &normals, DUAL_QUAT_TEST_VERTICES );
+
+	/* The second half of the palette is the first half negated, i.e. the
+	 * same transforms on the other side. */
+	for( size_t k = 0; k < DUAL_QUAT_TEST_JOINTS; k++ )
+	{
+		palette[ k ] = random_dual_quat();
+		palette[ k + DUAL_QUAT_TEST_JOINTS ] = palette[ k ];
+		quat_scale( &palette[ k + DUAL_QUAT_TEST_JOINTS ].real, -1 );
+		quat_scale( &palette[ k + DUAL_QUAT_TEST_JOINTS ].dual, -1 );
+	}
+
+	for( size_t i = 0; result && i < DUAL_QUAT_TEST_VERTICES; i++ )
+	{
+		vec3_t p = random_vec3( 1 );
+		vec3_t n = random_vec3( 1 );
+		vec3_normalize( &n );
+		vec3_array_set( &bind_positions, i, &p );
+		vec3_array_set( &bind_normals, i, &n );
+
+		for( size_t k = 0; k < 4; k++ )
+		{
+			joints[ i ][ k ]  = (uint16_t) m3d_uniform_rangei( 0, 2 * DUAL_QUAT_TEST_JOINTS - 1 );
+			weights[ i ][ k ] = k < i % 4 + 1 ? m3d_uniform_rangef( 0.1, 1 ) : 0;
+		}
+	}
+	/* No influence at all */
+	weights[ 8 ][ 0 ] = 0;
+
+	if( result )
+	{
+		dual_quat_skin( &positions, &normals, &bind_positions, &bind_normals, palette, joints, weights );
+	}
+
+	for( size_t i = 0; result && i < DUAL_QUAT_TEST_VERTICES; i++ )
+	{
+		/* With the joints of the first half only, on the side of the first
+		 * joint, whichever half the vertex uses. */
+		const dual_quat_t* pivot = &palette[ joints[ i ][ 0 ] % DUAL_QUAT_TEST_JOINTS ];
+		dual_quat_t blend = DUAL_QUAT( QUAT( 0, 0, 0, 0 ), QUAT( 0, 0, 0, 0 ) );
+		for( size_t k = 0; k < 4; k++ )
+		{
+			const dual_quat_t* dq = &palette[ joints[ i ][ k ] % DUAL_QUAT_TEST_JOINTS ];
+			const scaler_t w = quat_dot_product( &dq->real, &pivot->real ) < 0 ? -weights[ i ][ k ] : weights[ i ][ k ];
+			quat_t real = dq->real, dual = dq->dual;
+			quat_scale( &real, w );
+			quat_scale( &dual, w );
+			blend.real = quat_add( &blend.real, &real );
+			blend.dual = quat_add( &blend.dual, &dual );
+		}
+		dual_quat_normalize( &blend );
+
+		const vec3_t p = vec3_array_get( &bind_positions, i );
+		const vec3_t n = vec3_array_get( &bind_normals, i );
+		vec3_t expected_position = i == 8 ? p : dual_quat_transform_point( &blend, &p );
+		vec3_t expected_normal   = i == 8 ? n : dual_quat_transform_vec3( &blend, &n );
+		const vec3_t position = vec3_array_get( &positions, i );
+		const vec3_t normal   = vec3_array_get( &normals, i );
+
+		result = vec3_close( &position, &expected_position ) && vec3_close( &normal, &expected_normal );
+	}
+
+	vec3_array_destroy( &bind_positions );
+	vec3_array_destroy( &bind_normals );
+	vec3_array_destroy( &positions );
+	vec3_array_destroy( &normals );
+	return result;
+}
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "../src/mathematics.h"
 #include "../src/fixed-point-decimal.h"
 #include "test.h"
 
@@ -44,7 +45,7 @@ size_t fixed_point_decimal_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	bool result = test_features( "Fixed Point Decimal Functions", fixed_point_decimal_tests, fixed_point_decimal_test_suite_size() );
 	return result ? 0 : 1;
 }
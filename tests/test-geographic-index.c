@@ -0,0 +1,315 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <float.h>
+#include <assert.h>
+#include "../src/mathematics.h"
+#include "../src/geographic-index.h"
+#include "test.h"
+
+
+bool test_geo_index_radius         ( void );
+bool test_geo_index_nearest        ( void );
+bool test_geo_index_insert_delete  ( void );
+bool test_geo_index_empty          ( void );
+
+const test_feature_t geographic_index_tests[] = {
+	{ "Testing geographic index radius queries",   test_geo_index_radius },
+	{ "Testing geographic index nearest queries",  test_geo_index_nearest },
+	{ "Testing geographic index insert and delete", test_geo_index_insert_delete },
+	{ "Testing empty geographic index",            test_geo_index_empty },
+};
+
+size_t geographic_index_test_suite_size( void )
+{
+	return sizeof(geographic_index_tests) / sizeof(geographic_index_tests[0]);
+}
+
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	test_features( "Geographic Index Functions", geographic_index_tests, geographic_index_test_suite_size() );
+	return 0;
+}
+#endif
+
+static double uniform( double min, double max )
+{
+	return min + (max - min) * rand() / (double) RAND_MAX;
+}
+
+/* Points in a few tight clusters, including one on the antimeridian and
+ * one at the north pole, and the rest spread over the globe. */
+static void random_coords( geo_coord_t coords[], size_t count )
+{
+	const double centers[][ 2 ] = { { -80.19, 25.76 }, { 179.9, -17.0 }, { 0.0, 89.9 }, { 2.35, 48.86 } };
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		if( i % 2 == 0 )
+		{
+			const double* c = centers[ (i / 2) % 4 ];
+			coords[ i ].lon = c[ 0 ] + uniform( -0.5, 0.5 );
+			coords[ i ].lat = m3d_clampd( c[ 1 ] + uniform( -0.5, 0.5 ), -90.0, 90.0 );
+		}
+		else
+		{
+			coords[ i ].lon = uniform( -180.0, 180.0 );
+			coords[ i ].lat = uniform( -90.0, 90.0 );
+		}
+		coords[ i ].lon = coords[ i ].lon > 180.0 ? coords[ i ].lon - 360.0 : coords[ i ].lon;
+		coords[ i ].alt = 0.0;
+	}
+}
+
+/* Distances from (lon, lat) to the live points within radius, sorted. */
+static size_t brute_force( const geo_coord_t coords[], const bool alive[], size_t count, double lon, double lat, double radius, wgs84_distance_method_t method, double distances[] )
+{
+	size_t found = 0;
+	for( size_t i = 0; i < count; i++ )
+	{
+		if( !alive || alive[ i ] )
+		{
+			double d = wgs84_geographic_geodesic_distance_with_method( lon, lat, coords[ i ].lon, coords[ i ].lat, method );
+			if( d <= radius )
+			{
+				distances[ found++ ] = d;
+			}
+		}
+	}
+
+	/* insertion sort */
+	for( size_t i = 1; i < found; i++ )
+	{
+		double d = distances[ i ];
+		size_t j = i;
+		for( ; j > 0 && distances[ j - 1 ] > d; j-- )
+		{
+			distances[ j ] = distances[ j - 1 ];
+		}
+		distances[ j ] = d;
+	}
+	return found;
+}
+
+/* Checks that the index results match a brute force search: the same
+ * distances, and ids whose distance is the reported one. */
+static bool matches( const geo_index_t* index, const geo_coord_t coords[], double lon, double lat, const size_t ids[], const double distances[], const double expected[], size_t n )
+{
+	for( size_t i = 0; i < n; i++ )
+	{
+		const geo_coord_t* c = geo_index_get( index, ids[ i ] );
+		if( !c || c->lon != coords[ ids[ i ] ].lon || c->lat != coords[ ids[ i ] ].lat || distances[ i ] != expected[ i ] ||
+		    wgs84_geographic_geodesic_distance_with_method( lon, lat, coords[ ids[ i ] ].lon, coords[ ids[ i ] ].lat, geo_index_method( index ) ) != distances[ i ] )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void query_point( size_t q, double* lon, double* lat )
+{
+	switch( q % 5 )
+	{
+		case 0: *lon = 180.0; *lat = -17.0; break; /* antimeridian cluster */
+		case 1: *lon = 12.0; *lat = 90.0; break;   /* north pole */
+		case 2: *lon = -80.0; *lat = 25.7; break;
+		default:
+			*lon = uniform( -180.0, 180.0 );
+			*lat = uniform( -90.0, 90.0 );
+			break;
+	}
+}
+
+bool test_geo_index_radius( void )
+{
+	const size_t count = 2000;
+	const double radii[] = { 1000.0, 50000.0, 2000000.0 };
+	geo_coord_t* coords = malloc( count * sizeof(geo_coord_t) );
+	size_t* ids         = malloc( count * sizeof(size_t) );
+	double* distances   = malloc( count * sizeof(double) );
+	double* expected    = malloc( count * sizeof(double) );
+	bool result = true;
+
+	srand( 2024 );
+	random_coords( coords, count );
+
+	for( int method = WGS84_DISTANCE_HAVERSINE; result && method <= WGS84_DISTANCE_VINCENTY; method++ )
+	{
+		geo_index_t index;
+		result = geo_index_create( &index, coords, count, (wgs84_distance_method_t) method );
+
+		for( size_t q = 0; result && q < 20; q++ )
+		{
+			double lon, lat;
+			query_point( q, &lon, &lat );
+
+			for( size_t r = 0; result && r < sizeof(radii) / sizeof(radii[0]); r++ )
+			{
+				size_t n = brute_force( coords, NULL, count, lon, lat, radii[ r ], geo_index_method( &index ), expected );
+
+				/* All of the results, and then only the nearest few. */
+				size_t found = geo_index_radius( &index, lon, lat, radii[ r ], ids, distances, count );
+				result = found == n && matches( &index, coords, lon, lat, ids, distances, expected, n );
+
+				found = geo_index_radius( &index, lon, lat, radii[ r ], ids, distances, 5 );
+				result = result && found == n && matches( &index, coords, lon, lat, ids, distances, expected, n < 5 ? n : 5 );
+
+				result = result && geo_index_radius( &index, lon, lat, radii[ r ], NULL, NULL, 0 ) == n;
+			}
+		}
+
+		geo_index_destroy( &index );
+	}
+
+	free( coords );
+	free( ids );
+	free( distances );
+	free( expected );
+	return result;
+}
+
+bool test_geo_index_nearest( void )
+{
+	const size_t count = 3000;
+	const size_t ks[] = { 1, 10, 100 };
+	geo_coord_t* coords = malloc( count * sizeof(geo_coord_t) );
+	size_t* ids         = malloc( count * sizeof(size_t) );
+	double* distances   = malloc( count * sizeof(double) );
+	double* expected    = malloc( count * sizeof(double) );
+	geo_index_t index;
+	bool result = true;
+
+	srand( 1999 );
+	random_coords( coords, count );
+	result = geo_index_create( &index, coords, count, WGS84_DISTANCE_HAVERSINE );
+
+	for( size_t q = 0; result && q < 30; q++ )
+	{
+		double lon, lat;
+		query_point( q, &lon, &lat );
+		brute_force( coords, NULL, count, lon, lat, INFINITY, geo_index_method( &index ), expected );
+
+		for( size_t k = 0; result && k < sizeof(ks) / sizeof(ks[0]); k++ )
+		{
+			size_t n = geo_index_nearest( &index, lon, lat, ks[ k ], ids, distances );
+			result = n == ks[ k ] && matches( &index, coords, lon, lat, ids, distances, expected, n );
+		}
+	}
+
+	geo_index_destroy( &index );
+	free( coords );
+	free( ids );
+	free( distances );
+	free( expected );
+	return result;
+}
+
+bool test_geo_index_insert_delete( void )
+{
+	const size_t initial = 500;
+	const size_t count = 3000;
+	geo_coord_t* coords = malloc( count * sizeof(geo_coord_t) );
+	bool* alive         = calloc( count, sizeof(bool) );
+	size_t* ids         = malloc( count * sizeof(size_t) );
+	double* distances   = malloc( count * sizeof(double) );
+	double* expected    = malloc( count * sizeof(double) );
+	geo_index_t index;
+	size_t live = initial;
+	bool result = true;
+
+	srand( 77 );
+	random_coords( coords, count );
+	for( size_t i = 0; i < initial; i++ ) alive[ i ] = true;
+	result = geo_index_create( &index, coords, initial, WGS84_DISTANCE_LAMBERTS );
+
+	for( size_t i = initial; result && i < count; i++ )
+	{
+		size_t id;
+		result = geo_index_insert( &index, &coords[ i ], &id ) && id == i;
+		alive[ i ] = true;
+		live++;
+
+		/* Delete about a third of the points, some from the tree and some
+		 * still waiting to be added to it. */
+		if( i % 3 == 0 )
+		{
+			size_t victim = (size_t) rand() % (i + 1);
+			bool was_alive = alive[ victim ];
+			result = result && geo_index_delete( &index, victim ) == was_alive && geo_index_get( &index, victim ) == NULL;
+			live -= was_alive;
+			alive[ victim ] = false;
+		}
+
+		if( i % 97 == 0 )
+		{
+			double lon, lat;
+			query_point( i, &lon, &lat );
+
+			size_t n = brute_force( coords, alive, i + 1, lon, lat, 3000000.0, geo_index_method( &index ), expected );
+			size_t found = geo_index_radius( &index, lon, lat, 3000000.0, ids, distances, count );
+			result = result && found == n && matches( &index, coords, lon, lat, ids, distances, expected, n );
+
+			n = brute_force( coords, alive, i + 1, lon, lat, INFINITY, geo_index_method( &index ), expected );
+			found = geo_index_nearest( &index, lon, lat, 7, ids, distances );
+			result = result && found == 7 && matches( &index, coords, lon, lat, ids, distances, expected, found );
+		}
+	}
+
+	result = result && geo_index_count( &index ) == live &&
+	         !geo_index_delete( &index, count ) &&
+	         geo_index_get( &index, count ) == NULL;
+
+	geo_index_destroy( &index );
+	free( coords );
+	free( alive );
+	free( ids );
+	free( distances );
+	free( expected );
+	return result;
+}
+
+bool test_geo_index_empty( void )
+{
+	geo_index_t index;
+	size_t ids[ 2 ];
+	double distances[ 2 ];
+	const geo_coord_t miami = { .lat = 25.7617, .lon = -80.1918, .alt = 0.0 };
+	size_t id = 99;
+
+	bool result = geo_index_create( &index, NULL, 0, WGS84_DISTANCE_VINCENTY ) &&
+	              geo_index_count( &index ) == 0 &&
+	              geo_index_nearest( &index, 0.0, 0.0, 2, ids, distances ) == 0 &&
+	              geo_index_radius( &index, 0.0, 0.0, 1e7, ids, distances, 2 ) == 0 &&
+	              geo_index_insert( &index, &miami, &id ) && id == 0 &&
+	              geo_index_nearest( &index, -0.1278, 51.5074, 2, ids, distances ) == 1 &&
+	              ids[ 0 ] == 0 && fabs( distances[ 0 ] - 7139196.814881 ) < 0.001 &&
+	              geo_index_delete( &index, 0 ) &&
+	              geo_index_nearest( &index, 0.0, 0.0, 2, ids, distances ) == 0;
+
+	geo_index_destroy( &index );
+	return result;
+}
@@ -23,6 +23,7 @@
 #include <time.h>
 #include <float.h>
 #include <assert.h>
+#include "../src/mathematics.h"
 #include "../src/geographic.h"
 #include "test.h"
 
@@ -32,6 +33,15 @@ bool test_cartesian_to_geographic   ( void );
 bool test_geographic_to_mercator    ( void );
 bool test_mercator_to_geographic    ( void );
 bool test_distance                  ( void );
+bool test_distance_vincenty_special ( void );
+bool test_distance_vincenty_batch   ( void );
+bool test_cartesian_to_geographic_methods ( void );
+bool test_geographic_array          ( void );
+bool test_geographic_array_poles    ( void );
+bool test_geographic_array_parallel ( void );
+bool test_geo_frame                 ( void );
+bool test_geo_frame_round_trip      ( void );
+bool test_geo_frame_array           ( void );
 
 const test_feature_t geographic_tests[] = {
 	{ "Testing WGS84 Geographic to Cartesian",     test_geographic_to_cartesian },
@@ -39,6 +49,15 @@ const test_feature_t geographic_tests[] = {
 	{ "Testing WGS84 Geographic to Mercator",      test_geographic_to_mercator },
 	{ "Testing WGS84 Mercator to Geographic",      test_mercator_to_geographic },
 	{ "Testing WGS84 Geodesic Distance",           test_distance },
+	{ "Testing WGS84 Vincenty Special Cases",      test_distance_vincenty_special },
+	{ "Testing WGS84 Batch Vincenty Distances",    test_distance_vincenty_batch },
+	{ "Testing WGS84 Cartesian to Geographic Methods", test_cartesian_to_geographic_methods },
+	{ "Testing WGS84 Batch Conversions",           test_geographic_array },
+	{ "Testing WGS84 Batch Conversions at Poles",  test_geographic_array_poles },
+	{ "Testing WGS84 Parallel Batch Conversions",  test_geographic_array_parallel },
+	{ "Testing ENU and NED Frames",                test_geo_frame },
+	{ "Testing ENU and NED Frame Round Trips",     test_geo_frame_round_trip },
+	{ "Testing ENU and NED Frame Batches",         test_geo_frame_array },
 };
 
 size_t geographic_test_suite_size( void )
@@ -50,7 +69,7 @@ size_t geographic_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "Geographic Functions", geographic_tests, geographic_test_suite_size() );
 	return 0;
 }
@@ -73,7 +92,7 @@ bool test_cartesian_to_geographic( void )
 {
 	double x = 977346.827769572;
 	double y = 5663479.56086437;
-	double z = 2756666.31765847;
+	double z = 2756666.31769752;
 	double lon = 0.0, lat = 0.0, alt = 0.0;
 	wgs84_cartesian_to_geographic( x, y, z, &lon, &lat, &alt );
 	//printf( "(%.4f, %.4f, %.4f) = Miami at (%.4f N, %.4f W)\n", x, y, z, lat, lon );
@@ -132,14 +151,387 @@ bool test_distance( void )
 	double london_lon = -0.1278;
 	double london_lat = 51.5074;
 
-	// TODO: Fix Vincenty method
-	double miami_london_distance = //wgs84_geographic_geodesic_distance_vincenty( miami_lon, miami_lat, london_lon, london_lat );
-	wgs84_geographic_geodesic_distance_lamberts( miami_lon, miami_lat, london_lon, london_lat );
+	double miami_london_distance = wgs84_geographic_geodesic_distance_vincenty( miami_lon, miami_lat, london_lon, london_lat );
 
 	// haversine 7134873.449671
 	// lamberts  7140928.774804
-	//           7122228.213423586
+	// geodesic  7139196.814881
 	//printf( "%lf", miami_london_distance);
 
-	return true;
+	return fabs( miami_london_distance - 7139196.814881 ) < 0.001;
+}
+
+bool test_distance_vincenty_special( void )
+{
+	/* Reference distances are from GeographicLib. */
+	const double cases[][ 5 ] = {
+		{ 10.0,  20.0,   10.0,  20.0,          0.0 }, /* coincident */
+		{  0.0,  90.0,    0.0, -90.0, 20003931.458625 }, /* pole to pole */
+		{  0.0,   0.0,   90.0,   0.0, 10018754.171395 }, /* equator */
+		{  0.0,   0.0,  179.7,   0.0, 19995624.889961 }, /* antipodal, equator */
+		{  0.0,  30.01, 180.0, -30.0, 20002822.933358 }, /* antipodal, meridian */
+		{  0.0,   0.0,  179.5,   0.5, 19936288.578965 }, /* nearly antipodal */
+		{ 170.0, 0.0, -170.0,   0.0,  2226389.815865 }, /* across the antimeridian */
+	};
+	const size_t count = sizeof(cases) / sizeof(cases[0]);
+	bool result = true;
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		double d = wgs84_geographic_geodesic_distance_vincenty( cases[ i ][ 0 ], cases[ i ][ 1 ], cases[ i ][ 2 ], cases[ i ][ 3 ] );
+		double p;
+		wgs84_geographic_geodesic_distance_vincenty_pairs( &cases[ i ][ 0 ], &cases[ i ][ 1 ], &cases[ i ][ 2 ], &cases[ i ][ 3 ], &p, 1 );
+		result = result && fabs( d - cases[ i ][ 4 ] ) < 0.01 && fabs( p - cases[ i ][ 4 ] ) < 0.01;
+	}
+
+	return result;
+}
+
+bool test_distance_vincenty_batch( void )
+{
+	const size_t count = 1037;
+	const size_t rows = 300;
+	double* lon1 = malloc( count * sizeof(double) );
+	double* lat1 = malloc( count * sizeof(double) );
+	double* lon2 = malloc( count * sizeof(double) );
+	double* lat2 = malloc( count * sizeof(double) );
+	double* distances = malloc( rows * count * sizeof(double) );
+	bool result = true;
+
+	m3d_seed( 4321 );
+	for( size_t i = 0; i < count; i++ )
+	{
+		lon1[ i ] = m3d_uniform_ranged( -180.0, 180.0 );
+		lat1[ i ] = m3d_uniform_ranged( -90.0, 90.0 );
+		/* Every fourth pair is nearly antipodal. */
+		lon2[ i ] = i % 4 == 0 ? lon1[ i ] + m3d_uniform_ranged( 179.0, 181.0 ) : m3d_uniform_ranged( -180.0, 180.0 );
+		lat2[ i ] = i % 4 == 0 ? -lat1[ i ] + m3d_uniform_ranged( 0.0, 0.01 ) : m3d_uniform_ranged( -90.0, 90.0 );
+	}
+
+	wgs84_geographic_geodesic_distance_vincenty_pairs( lon1, lat1, lon2, lat2, distances, count );
+	for( size_t i = 0; result && i < count; i++ )
+	{
+		result = fabs( distances[ i ] - wgs84_geographic_geodesic_distance_vincenty( lon1[ i ], lat1[ i ], lon2[ i ], lat2[ i ] ) ) < 1e-6;
+	}
+
+	wgs84_geographic_geodesic_distance_vincenty_one_to_many( lon1[ 0 ], lat1[ 0 ], lon2, lat2, distances, count );
+	for( size_t i = 0; result && i < count; i++ )
+	{
+		result = fabs( distances[ i ] - wgs84_geographic_geodesic_distance_vincenty( lon1[ 0 ], lat1[ 0 ], lon2[ i ], lat2[ i ] ) ) < 1e-6;
+	}
+
+	/* Large enough for the rows to be split across threads. */
+	result = result && wgs84_geographic_geodesic_distance_vincenty_matrix( lon1, lat1, rows, lon2, lat2, count, distances );
+	for( size_t r = 0; result && r < rows; r++ )
+	{
+		for( size_t c = 0; result && c < count; c++ )
+		{
+			result = fabs( distances[ r * count + c ] - wgs84_geographic_geodesic_distance_vincenty( lon1[ r ], lat1[ r ], lon2[ c ], lat2[ c ] ) ) < 1e-6;
+		}
+	}
+
+	free( lon1 );
+	free( lat1 );
+	free( lon2 );
+	free( lat2 );
+	free( distances );
+	return result;
+}
+
+bool test_cartesian_to_geographic_methods( void )
+{
+	const wgs84_geodetic_method_t methods[] = { WGS84_GEODETIC_ITERATIVE, WGS84_GEODETIC_BOWRING, WGS84_GEODETIC_VERMEILLE };
+	const double alts[] = { -10000.0, 0.0, 8848.0, 400000.0, 35786000.0 };
+	bool result = true;
+
+	for( size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++ )
+	{
+		for( double lat = -90.0; lat <= 90.0; lat += 7.5 )
+		{
+			for( double lon = -165.0; lon <= 180.0; lon += 15.0 )
+			{
+				for( size_t k = 0; k < sizeof(alts) / sizeof(alts[0]); k++ )
+				{
+					double x, y, z, lon2, lat2, alt2;
+					wgs84_geographic_to_cartesian( lon, lat, alts[ k ], &x, &y, &z );
+					wgs84_cartesian_to_geographic_with_method( x, y, z, &lon2, &lat2, &alt2, methods[ m ] );
+
+					result = result &&
+					         fabs( lat2 - lat ) < 1e-12 &&
+					         fabs( alt2 - alts[ k ] ) < 1e-7 &&
+					         (fabs( lat ) == 90.0 || fabs( remainder( lon2 - lon, 360.0 ) ) < 1e-12);
+				}
+			}
+		}
+	}
+
+	return result;
+}
+
+/*
+ * Converts count points to ECEF and back, checking the forward
+ * conversion against the scalar one and the round trip against
+ * the original coordinates. Longitudes are compared modulo 360
+ * since 180 and -180 are the same meridian.
+ */
+static bool geographic_array_round_trip( const double lon[], const double lat[], const double alt[], size_t count )
+{
+	double* x    = malloc( count * sizeof(double) );
+	double* y    = malloc( count * sizeof(double) );
+	double* z    = malloc( count * sizeof(double) );
+	double* lon2 = malloc( count * sizeof(double) );
+	double* lat2 = malloc( count * sizeof(double) );
+	double* alt2 = malloc( count * sizeof(double) );
+	bool result = true;
+
+	wgs84_geographic_to_cartesian_array( lon, lat, alt, x, y, z, count );
+	wgs84_cartesian_to_geographic_array( x, y, z, lon2, lat2, alt2, count );
+
+	for( size_t i = 0; result && i < count; i++ )
+	{
+		double sx, sy, sz;
+		wgs84_geographic_to_cartesian( lon[ i ], lat[ i ], alt[ i ], &sx, &sy, &sz );
+		result = fabs( x[ i ] - sx ) < 1e-7 &&
+		         fabs( y[ i ] - sy ) < 1e-7 &&
+		         fabs( z[ i ] - sz ) < 1e-7 &&
+		         fabs( lat2[ i ] - lat[ i ] ) < 1e-12 &&
+		         fabs( alt2[ i ] - alt[ i ] ) < 1e-7 &&
+		         (fabs( lat[ i ] ) == 90.0 || fabs( remainder( lon2[ i ] - lon[ i ], 360.0 ) ) < 1e-12);
+	}
+
+	free( x );
+	free( y );
+	free( z );
+	free( lon2 );
+	free( lat2 );
+	free( alt2 );
+	return result;
+}
+
+static bool geographic_array_random( size_t count )
+{
+	double* lon = malloc( count * sizeof(double) );
+	double* lat = malloc( count * sizeof(double) );
+	double* alt = malloc( count * sizeof(double) );
+
+	m3d_seed( 1234 );
+	for( size_t i = 0; i < count; i++ )
+	{
+		lon[ i ] = m3d_uniform_ranged( -180.0, 180.0 );
+		lat[ i ] = m3d_uniform_ranged( -90.0, 90.0 );
+		alt[ i ] = m3d_uniform_ranged( -10000.0, 35990000.0 );
+	}
+
+	bool result = geographic_array_round_trip( lon, lat, alt, count );
+
+	free( lon );
+	free( lat );
+	free( alt );
+	return result;
+}
+
+bool test_geographic_array( void )
+{
+	double lon[] = { -80.2089, -0.1278, 0.0, 180.0, -179.999 };
+	double lat[] = {  25.7753, 51.5074, 0.0, 0.0, -45.0 };
+	double alt[] = {      0.0,   35.0, 0.0, 8848.0, -10000.0 };
+
+	/* 1037 points leaves a partial block at the end. */
+	return geographic_array_round_trip( lon, lat, alt, sizeof(lon) / sizeof(lon[0]) ) &&
+	       geographic_array_random( 1037 );
+}
+
+bool test_geographic_array_poles( void )
+{
+	double lon[] = { 0.0, 45.0, 0.0, -120.0, 0.0, 10.0 };
+	double lat[] = { 90.0, 90.0, -90.0, -90.0, 89.999999, -89.999999 };
+	double alt[] = { 0.0, 1000.0, 0.0, -5000.0, 0.0, 100000.0 };
+
+	return geographic_array_round_trip( lon, lat, alt, sizeof(lon) / sizeof(lon[0]) );
+}
+
+bool test_geographic_array_parallel( void )
+{
+	/* Large enough for the conversions to be split across threads. */
+	return geographic_array_random( 70000 );
+}
+
+bool test_geo_frame( void )
+{
+	geo_frame_t enu, ned;
+	double e, n, u;
+	bool result = true;
+
+	/* At (0, 0) east is y and up is x. */
+	geo_frame_init( &enu, 0.0, 0.0, 0.0, GEO_FRAME_ENU );
+	geo_frame_init( &ned, 0.0, 0.0, 0.0, GEO_FRAME_NED );
+	geo_frame_from_cartesian( &enu, WGS84_SEMI_MAJOR_AXIS + 100.0, 0.0, 0.0, &e, &n, &u );
+	result = result && fabs( e ) < 1e-9 && fabs( n ) < 1e-9 && fabs( u - 100.0 ) < 1e-9;
+	geo_frame_from_cartesian( &enu, WGS84_SEMI_MAJOR_AXIS, 10.0, 20.0, &e, &n, &u );
+	result = result && fabs( e - 10.0 ) < 1e-9 && fabs( n - 20.0 ) < 1e-9 && fabs( u ) < 1e-9;
+	geo_frame_from_cartesian( &ned, WGS84_SEMI_MAJOR_AXIS, 10.0, 20.0, &n, &e, &u );
+	result = result && fabs( e - 10.0 ) < 1e-9 && fabs( n - 20.0 ) < 1e-9 && fabs( u ) < 1e-9;
+
+	/* At the north pole up is z. */
+	geo_frame_init( &enu, 0.0, 90.0, 0.0, GEO_FRAME_ENU );
+	geo_frame_from_cartesian( &enu, 0.0, 0.0, WGS84_SEMI_MINOR_AXIS + 5.0, &e, &n, &u );
+	result = result && fabs( e ) < 1e-6 && fabs( n ) < 1e-6 && fabs( u - 5.0 ) < 1e-6;
+
+	/* A point 1 km up and 0.01 degrees north of Miami. */
+	geo_frame_init( &enu, -80.2089, 25.7753, 0.0, GEO_FRAME_ENU );
+	geo_frame_init( &ned, -80.2089, 25.7753, 0.0, GEO_FRAME_NED );
+	geo_frame_from_geographic( &enu, -80.2089, 25.7853, 1000.0, &e, &n, &u );
+	result = result && fabs( e ) < 1e-6 && fabs( n - 1108.0209 ) < 1e-3 && fabs( u - 999.9033 ) < 1e-3;
+
+	/* NED is ENU with the first two axes swapped and up negated. */
+	m3d_seed( 2718 );
+	for( int i = 0; result && i < 1000; i++ )
+	{
+		const double lon = -80.2089 + m3d_uniform_unitd( );
+		const double lat = 25.7753 + m3d_uniform_unitd( );
+		const double alt = m3d_uniform_ranged( 0.0, 10000.0 );
+		double n2, e2, d;
+		geo_frame_from_geographic( &enu, lon, lat, alt, &e, &n, &u );
+		geo_frame_from_geographic( &ned, lon, lat, alt, &n2, &e2, &d );
+		result = fabs( n2 - n ) < 1e-9 && fabs( e2 - e ) < 1e-9 && fabs( d + u ) < 1e-9;
+	}
+
+	/* The rotation for rendering is orthonormal and matches the frame. */
+	const mat3_t R = geo_frame_rotation( &enu );
+	const mat3_t I = mat3_mult_matrix( &R, &(mat3_t){ .m = { R.m[ 0 ], R.m[ 3 ], R.m[ 6 ], R.m[ 1 ], R.m[ 4 ], R.m[ 7 ], R.m[ 2 ], R.m[ 5 ], R.m[ 8 ] } } );
+	for( int i = 0; i < 9; i++ )
+	{
+		result = result && fabs( I.m[ i ] - MAT3_IDENTITY.m[ i ] ) < 1e-5;
+	}
+
+	double x, y, z, ox, oy, oz;
+	wgs84_geographic_to_cartesian( -80.2089, 25.7753, 0.0, &ox, &oy, &oz );
+	wgs84_geographic_to_cartesian( -80.0, 25.9, 300.0, &x, &y, &z );
+	geo_frame_from_cartesian( &enu, x, y, z, &e, &n, &u );
+	const vec3_t d = VEC3( x - ox, y - oy, z - oz );
+	const vec3_t l = mat3_mult_vector( &R, &d );
+	result = result && fabs( l.x - e ) < 1e-5 * 30000.0 && fabs( l.y - n ) < 1e-5 * 30000.0 && fabs( l.z - u ) < 1e-5 * 30000.0;
+
+	return result;
+}
+
+bool test_geo_frame_round_trip( void )
+{
+	bool result = true;
+
+	m3d_seed( 3141 );
+	for( int i = 0; result && i < 10000; i++ )
+	{
+		const geo_frame_axes_t axes = i % 2 ? GEO_FRAME_NED : GEO_FRAME_ENU;
+		const double lon0 = m3d_uniform_ranged( -180.0, 180.0 );
+		const double lat0 = m3d_uniform_ranged( -90.0, 90.0 );
+		const double lon  = lon0 + m3d_uniform_unitd( );
+		const double lat  = m3d_clampd( lat0 + m3d_uniform_unitd( ), -90.0, 90.0 );
+		const double alt  = m3d_uniform_ranged( -1000.0, 19000.0 );
+		geo_frame_t frame;
+		double a, b, c, x, y, z, x2, y2, z2, lon2, lat2, alt2;
+
+		geo_frame_init( &frame, lon0, lat0, 100.0, axes );
+		wgs84_geographic_to_cartesian( lon, lat, alt, &x, &y, &z );
+
+		geo_frame_from_cartesian( &frame, x, y, z, &a, &b, &c );
+		geo_frame_to_cartesian( &frame, a, b, c, &x2, &y2, &z2 );
+		result = fabs( x2 - x ) < 1e-8 && fabs( y2 - y ) < 1e-8 && fabs( z2 - z ) < 1e-8;
+
+		geo_frame_from_geographic( &frame, lon, lat, alt, &a, &b, &c );
+		geo_frame_to_geographic( &frame, a, b, c, &lon2, &lat2, &alt2 );
+		result = result && fabs( lat2 - lat ) < 1e-11 && fabs( alt2 - alt ) < 1e-7 &&
+		         (fabs( lat ) > 89.9999 || fabs( remainder( lon2 - lon, 360.0 ) ) < 1e-11);
+	}
+
+	return result;
+}
+
+/*
+ * Converts count points within about 100 km of a random origin with the
+ * array functions and compares them with the scalar ones.
+ */
+static bool geo_frame_array( size_t count, geo_frame_axes_t axes )
+{
+	double* lon  = malloc( count * sizeof(double) );
+	double* lat  = malloc( count * sizeof(double) );
+	double* alt  = malloc( count * sizeof(double) );
+	double* x    = malloc( count * sizeof(double) );
+	double* y    = malloc( count * sizeof(double) );
+	double* z    = malloc( count * sizeof(double) );
+	double* a    = malloc( count * sizeof(double) );
+	double* b    = malloc( count * sizeof(double) );
+	double* c    = malloc( count * sizeof(double) );
+	double* a2   = malloc( count * sizeof(double) );
+	double* b2   = malloc( count * sizeof(double) );
+	double* c2   = malloc( count * sizeof(double) );
+	double* lon2 = malloc( count * sizeof(double) );
+	double* lat2 = malloc( count * sizeof(double) );
+	double* alt2 = malloc( count * sizeof(double) );
+	double* x2   = malloc( count * sizeof(double) );
+	double* y2   = malloc( count * sizeof(double) );
+	double* z2   = malloc( count * sizeof(double) );
+	geo_frame_t frame;
+	bool result = true;
+
+	m3d_seed( 1618 );
+	const double lon0 = m3d_uniform_ranged( -180.0, 180.0 );
+	const double lat0 = m3d_uniform_ranged( -89.0, 89.0 );
+	geo_frame_init( &frame, lon0, lat0, 0.0, axes );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		lon[ i ] = lon0 + m3d_uniform_unitd( );
+		lat[ i ] = lat0 + m3d_uniform_unitd( );
+		alt[ i ] = m3d_uniform_ranged( -500.0, 9500.0 );
+		wgs84_geographic_to_cartesian( lon[ i ], lat[ i ], alt[ i ], &x[ i ], &y[ i ], &z[ i ] );
+	}
+
+	geo_frame_from_cartesian_array( &frame, x, y, z, a, b, c, count );
+	geo_frame_from_geographic_array( &frame, lon, lat, alt, a2, b2, c2, count );
+	geo_frame_to_geographic_array( &frame, a, b, c, lon2, lat2, alt2, count );
+	geo_frame_to_cartesian_array( &frame, a, b, c, x2, y2, z2, count );
+
+	for( size_t i = 0; result && i < count; i++ )
+	{
+		double sa, sb, sc, slon, slat, salt;
+		geo_frame_from_cartesian( &frame, x[ i ], y[ i ], z[ i ], &sa, &sb, &sc );
+		geo_frame_to_geographic( &frame, sa, sb, sc, &slon, &slat, &salt );
+
+		result = fabs( a[ i ] - sa ) < 1e-9 && fabs( b[ i ] - sb ) < 1e-9 && fabs( c[ i ] - sc ) < 1e-9 &&
+		         fabs( a2[ i ] - sa ) < 1e-7 && fabs( b2[ i ] - sb ) < 1e-7 && fabs( c2[ i ] - sc ) < 1e-7 &&
+		         fabs( x2[ i ] - x[ i ] ) < 1e-8 && fabs( y2[ i ] - y[ i ] ) < 1e-8 && fabs( z2[ i ] - z[ i ] ) < 1e-8 &&
+		         fabs( lat2[ i ] - slat ) < 1e-12 && fabs( alt2[ i ] - salt ) < 1e-7 &&
+		         fabs( remainder( lon2[ i ] - slon, 360.0 ) ) < 1e-12 &&
+		         fabs( lat2[ i ] - lat[ i ] ) < 1e-11 && fabs( remainder( lon2[ i ] - lon[ i ], 360.0 ) ) < 1e-11;
+	}
+
+	free( lon );
+	free( lat );
+	free( alt );
+	free( x );
+	free( y );
+	free( z );
+	free( a );
+	free( b );
+	free( c );
+	free( a2 );
+	free( b2 );
+	free( c2 );
+	free( lon2 );
+	free( lat2 );
+	free( alt2 );
+	free( x2 );
+	free( y2 );
+	free( z2 );
+	return result;
+}
+
+bool test_geo_frame_array( void )
+{
+	/* 1037 points leaves a partial block at the end, and 70000 points are
+	 * split across threads. */
+	return geo_frame_array( 5, GEO_FRAME_ENU ) &&
+	       geo_frame_array( 1037, GEO_FRAME_NED ) &&
+	       geo_frame_array( 70000, GEO_FRAME_ENU );
 }
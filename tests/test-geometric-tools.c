@@ -42,7 +42,7 @@ size_t geometric_tools_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "Geometric Tools", geometric_tools_tests, geometric_tools_test_suite_size() );
 	return 0;
 }
@@ -53,7 +53,7 @@ size_t mat2_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "2x2 Matrix Functions", mat2_tests, mat2_test_suite_size() );
 	return 0;
 }
@@ -53,7 +53,7 @@ size_t mat3_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "3x3 Matrix Functions", mat3_tests, mat3_test_suite_size() );
 	return 0;
 }
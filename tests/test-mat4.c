@@ -20,6 +20,7 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../src/vec4.h"
 #include "../src/mat4.h"
 #include "test.h"
@@ -30,8 +31,15 @@ bool test_mat4_zero                  ( void );
 bool test_mat4_determinant           ( void );
 bool test_mat4_matrix_multiplication ( void );
 bool test_mat4_vector_multiplication ( void );
+bool test_mat4_multiplication_reference ( void );
+bool test_mat4_transform_points3     ( void );
+bool test_mat4_transform_vectors3    ( void );
+bool test_mat4_transform_normals3    ( void );
+bool test_mat4_transform_strided     ( void );
 bool test_mat4_inversion             ( void );
+bool test_mat4_inversion_paths       ( void );
 bool test_mat4_transpose             ( void );
+bool test_mat4_format                ( void );
 
 const test_feature_t mat4_tests[] = {
 	{ "Testing mat4 literals", test_mat4_literals },
@@ -40,8 +48,15 @@ const test_feature_t mat4_tests[] = {
 	{ "Testing mat4 determinants", test_mat4_determinant },
 	{ "Testing mat4 matrix multiplcation", test_mat4_matrix_multiplication },
 	{ "Testing mat4 vector multiplcation", test_mat4_vector_multiplication },
+	{ "Testing mat4 multiplication against reference", test_mat4_multiplication_reference },
+	{ "Testing mat4 bulk point transform", test_mat4_transform_points3 },
+	{ "Testing mat4 bulk vector transform", test_mat4_transform_vectors3 },
+	{ "Testing mat4 bulk normal transform", test_mat4_transform_normals3 },
+	{ "Testing mat4 bulk strided and in-place transform", test_mat4_transform_strided },
 	{ "Testing mat4 inversion", test_mat4_inversion },
+	{ "Testing mat4 affine, rigid and general inversion", test_mat4_inversion_paths },
 	{ "Testing mat4 transpose", test_mat4_transpose },
+	{ "Testing mat4 bulk formatting", test_mat4_format },
 };
 
 size_t mat4_test_suite_size( void )
@@ -53,7 +68,7 @@ size_t mat4_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "4x4 Matrix Functions", mat4_tests, mat4_test_suite_size() );
 	return 0;
 }
@@ -286,6 +301,190 @@ bool test_mat4_vector_multiplication( void )
 	return r1 && r2 && r3;
 }
 
+bool test_mat4_multiplication_reference( void )
+{
+	bool result = true;
+
+	for( int k = 0; k < 100 && result; k++ )
+	{
+		mat4_t a;
+		mat4_t b;
+		vec4_t v = VEC4( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+
+		for( int i = 0; i < 16; i++ )
+		{
+			a.m[ i ] = m3d_uniform_rangef( -1, 1 );
+			b.m[ i ] = m3d_uniform_rangef( -1, 1 );
+		}
+
+		mat4_t ab = mat4_mult_matrix( &a, &b );
+		vec4_t av = mat4_mult_vector( &a, &v );
+		scaler_t avs[ 4 ] = { av.x, av.y, av.z, av.w };
+
+		for( int c = 0; c < 4; c++ )
+		{
+			for( int r = 0; r < 4; r++ )
+			{
+				scaler_t expected = 0;
+				for( int i = 0; i < 4; i++ )
+				{
+					expected += a.m[ 4 * i + r ] * b.m[ 4 * c + i ];
+				}
+				result = result && scaler_abs( ab.m[ 4 * c + r ] - expected ) < 1e-5;
+			}
+		}
+
+		for( int r = 0; r < 4; r++ )
+		{
+			scaler_t expected = a.m[ r ] * v.x + a.m[ 4 + r ] * v.y + a.m[ 8 + r ] * v.z + a.m[ 12 + r ] * v.w;
+			result = result && scaler_abs( avs[ r ] - expected ) < 1e-5;
+		}
+	}
+
+	return result;
+}
+
+static bool close3( const vec3_t* v, scaler_t x, scaler_t y, scaler_t z )
+{
+	return scaler_abs( v->x - x ) < 1e-5 && scaler_abs( v->y - y ) < 1e-5 && scaler_abs( v->z - z ) < 1e-5;
+}
+
+bool test_mat4_transform_points3( void )
+{
+	/* scale by (2, 3, 4) then translate by (1, -1, 5) */
+	mat4_t a = MAT4(
+		2,  0,  0,  0,
+		0,  3,  0,  0,
+		0,  0,  4,  0,
+		1, -1,  5,  1
+	);
+	vec3_t in[ 5 ];
+	vec3_t out[ 5 ];
+	for( int i = 0; i < 5; i++ )
+	{
+		in[ i ] = VEC3( i, i + 1, i - 1 );
+	}
+	mat4_transform_points3( &a, out, 0, in, 0, 5 );
+
+	bool r1 = mat4_is_affine( &a );
+	for( int i = 0; i < 5; i++ )
+	{
+		r1 = r1 && close3( &out[ i ], 2 * i + 1, 3 * (i + 1) - 1, 4 * (i - 1) + 5 );
+	}
+
+	/* projective: w' = z, so points are divided by their depth */
+	mat4_t b = MAT4(
+		1,  0,  0,  0,
+		0,  1,  0,  0,
+		0,  0,  1,  1,
+		0,  0,  0,  0
+	);
+	vec3_t p[ 2 ] = { VEC3( 2, 4, 2 ), VEC3( -3, 6, 3 ) };
+	mat4_transform_points3( &b, p, 0, p, 0, 2 );
+	bool r2 = !mat4_is_affine( &b ) &&
+	          close3( &p[ 0 ], 1, 2, 1 ) &&
+	          close3( &p[ 1 ], -1, 2, 1 );
+
+	return r1 && r2;
+}
+
+bool test_mat4_transform_vectors3( void )
+{
+	mat4_t a = MAT4(
+		0,  1,  0,  0,
+		-1, 0,  0,  0,
+		0,  0,  1,  0,
+		7,  8,  9,  1
+	);
+	vec3_t in[ 3 ] = { VEC3( 1, 0, 0 ), VEC3( 0, 1, 0 ), VEC3( 1, 2, 3 ) };
+	vec3_t out[ 3 ];
+	mat4_transform_vectors3( &a, out, 0, in, 0, 3 );
+
+	/* The translation must not affect directions */
+	return close3( &out[ 0 ], 0, 1, 0 ) &&
+	       close3( &out[ 1 ], -1, 0, 0 ) &&
+	       close3( &out[ 2 ], -2, 1, 3 );
+}
+
+bool test_mat4_transform_normals3( void )
+{
+	/* Non-uniform scale: the normal of the plane x + y = 0 must stay
+	 * perpendicular to the scaled plane. */
+	mat4_t a = MAT4(
+		2,  0,  0,  0,
+		0,  1,  0,  0,
+		0,  0,  1,  0,
+		5,  5,  5,  1
+	);
+	scaler_t k = 1 / scaler_sqrt( 2 );
+	vec3_t n = VEC3( k, k, 0 );
+	vec3_t tangent = VEC3( -1, 1, 0 );
+	vec3_t t;
+	mat4_transform_normals3( &a, &n, 0, &n, 0, 1 );
+	mat4_transform_vectors3( &a, &t, 0, &tangent, 0, 1 );
+
+	scaler_t e = 1 / scaler_sqrt( 1.25 );
+	return close3( &n, 0.5 * e, e, 0 ) &&
+	       scaler_abs( vec3_dot_product( &n, &t ) ) < 1e-5 &&
+	       scaler_abs( vec3_dot_product( &n, &n ) - 1 ) < 1e-5;
+}
+
+bool test_mat4_transform_strided( void )
+{
+	typedef struct vertex {
+		vec3_t position;
+		vec3_t normal;
+		scaler_t uv[ 2 ];
+	} vertex_t;
+
+	mat4_t a = MAT4(
+		1,  0,  0,  0,
+		0,  1,  0,  0,
+		0,  0,  1,  0,
+		10, 20, 30, 1
+	);
+	vertex_t vertices[ 7 ];
+	for( int i = 0; i < 7; i++ )
+	{
+		vertices[ i ].position = VEC3( i, -i, 2 * i );
+		vertices[ i ].normal   = VEC3( 0, 0, 1 );
+		vertices[ i ].uv[ 0 ]  = i;
+		vertices[ i ].uv[ 1 ]  = -i;
+	}
+	mat4_transform_points3( &a, &vertices[ 0 ].position, sizeof(vertex_t), &vertices[ 0 ].position, sizeof(vertex_t), 7 );
+
+	bool r1 = true;
+	for( int i = 0; i < 7; i++ )
+	{
+		/* Neighbouring attributes must be left alone */
+		r1 = r1 && close3( &vertices[ i ].position, i + 10, -i + 20, 2 * i + 30 ) &&
+		           close3( &vertices[ i ].normal, 0, 0, 1 ) &&
+		           vertices[ i ].uv[ 0 ] == i && vertices[ i ].uv[ 1 ] == -i;
+	}
+
+	mat4_t b;
+	for( int i = 0; i < 16; i++ ) b.m[ i ] = m3d_uniform_rangef( -1, 1 );
+	vec4_t v[ 9 ];
+	vec4_t r[ 9 ];
+	for( int i = 0; i < 9; i++ )
+	{
+		v[ i ] = VEC4( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+	}
+	mat4_transform_vectors4( &b, r, 0, v, 0, 9 );
+
+	bool r2 = true;
+	for( int i = 0; i < 9; i++ )
+	{
+		vec4_t expected = mat4_mult_vector( &b, &v[ i ] );
+		r2 = r2 && scaler_abs( r[ i ].x - expected.x ) < 1e-5 &&
+		           scaler_abs( r[ i ].y - expected.y ) < 1e-5 &&
+		           scaler_abs( r[ i ].z - expected.z ) < 1e-5 &&
+		           scaler_abs( r[ i ].w - expected.w ) < 1e-5;
+	}
+
+	return r1 && r2;
+}
+
 bool test_mat4_inversion( void )
 {
 	mat4_t a = MAT4(
@@ -347,6 +546,97 @@ bool test_mat4_inversion( void )
 	return r1 && r2 && r3;
 }
 
+static bool close16( const mat4_t* a, const mat4_t* b, scaler_t tolerance )
+{
+	bool result = true;
+	for( int i = 0; i < 16; i++ )
+	{
+		result = result && scaler_abs( a->m[ i ] - b->m[ i ] ) < tolerance;
+	}
+	return result;
+}
+
+bool test_mat4_inversion_paths( void )
+{
+	/* An exact rotation (a permutation) with a translation */
+	mat4_t a = MAT4(
+		 0,  0, -1,  0,
+		-1,  0,  0,  0,
+		 0,  1,  0,  0,
+		 3, -2,  7,  1
+	);
+	mat4_t a_general = a;
+	mat4_invert_general( &a_general );
+	mat4_t a_rigid = a;
+	mat4_invert_rigid( &a_rigid );
+	mat4_t a_auto = a;
+	bool r1 = mat4_classify( &a ) == MAT4_CLASS_RIGID &&
+	          mat4_invert( &a_auto ) &&
+	          close16( &a_rigid, &a_general, 1e-5 ) &&
+	          close16( &a_auto, &a_general, 1e-5 );
+
+	bool r2 = true;
+	bool r3 = true;
+	bool r4 = true;
+	for( int k = 0; k < 100; k++ )
+	{
+		vec3_t axis = VEC3( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( 0.1, 1 ) );
+		mat4_t rotation = mat4_from_axis3_angle( &axis, m3d_uniform_rangef( -3, 3 ) );
+		rotation.m[12] = m3d_uniform_rangef( -10, 10 );
+		rotation.m[13] = m3d_uniform_rangef( -10, 10 );
+		rotation.m[14] = m3d_uniform_rangef( -10, 10 );
+
+		/* Rigid */
+		mat4_t b_general = rotation;
+		mat4_t b_rigid = rotation;
+		mat4_t b_auto = rotation;
+		mat4_invert_general( &b_general );
+		mat4_invert_rigid( &b_rigid );
+		r2 = r2 && mat4_classify( &rotation ) != MAT4_CLASS_GENERAL &&
+		           mat4_invert( &b_auto ) &&
+		           close16( &b_rigid, &b_general, 1e-4 ) &&
+		           close16( &b_auto, &b_general, 1e-4 );
+
+		/* Affine: non-uniform scale, then rotate and translate */
+		mat4_t c = rotation;
+		for( int i = 0; i < 3; i++ )
+		{
+			scaler_t scale = m3d_uniform_rangef( 0.5, 2 );
+			c.m[ 4 * i + 0 ] *= scale;
+			c.m[ 4 * i + 1 ] *= scale;
+			c.m[ 4 * i + 2 ] *= scale;
+		}
+		mat4_t c_general = c;
+		mat4_t c_affine = c;
+		mat4_t c_auto = c;
+		mat4_invert_general( &c_general );
+		r3 = r3 && mat4_invert_affine( &c_affine ) &&
+		           mat4_invert( &c_auto ) &&
+		           close16( &c_affine, &c_general, 1e-4 ) &&
+		           close16( &c_auto, &c_general, 1e-4 );
+
+		/* General: diagonally dominant so that it is well conditioned */
+		mat4_t d;
+		for( int i = 0; i < 16; i++ ) d.m[ i ] = m3d_uniform_rangef( -1, 1 );
+		d.m[ 0] += 4; d.m[ 5] += 4; d.m[10] += 4; d.m[15] += 4;
+		mat4_t d_inverse = d;
+		r4 = r4 && mat4_classify( &d ) == MAT4_CLASS_GENERAL && mat4_invert( &d_inverse );
+		mat4_t identity = mat4_mult_matrix( &d, &d_inverse );
+		r4 = r4 && close16( &identity, &MAT4_IDENTITY, 1e-5 );
+	}
+
+	/* Singular affine matrices are rejected */
+	mat4_t e = MAT4(
+		1,  0,  0,  0,
+		0,  0,  0,  0,
+		0,  0,  1,  0,
+		4,  5,  6,  1
+	);
+	bool r5 = mat4_classify( &e ) == MAT4_CLASS_AFFINE && mat4_invert( &e ) == false;
+
+	return r1 && r2 && r3 && r4 && r5;
+}
+
 bool test_mat4_transpose( void )
 {
 	mat4_t a = MAT4(
@@ -375,3 +665,25 @@ bool test_mat4_transpose( void )
 
 	return r1;
 }
+
+bool test_mat4_format( void )
+{
+	/* Column-major storage is written in row order. */
+	mat4_t m[ 2 ] = {
+		MAT4( 1, 2, 3, 4,
+		      5, 6, 7, 8,
+		      9, 10, 11, 12,
+		      13, 14, 15, 16 ),
+		MAT4_IDENTITY,
+	};
+	char buffer[ 512 ];
+	size_t length = 0;
+
+	size_t count = mat4_format( buffer, sizeof(buffer), m, 2, 1, &length );
+
+	return count == 2 &&
+	       length == strlen( buffer ) &&
+	       strcmp( buffer,
+	               "[1.0, 5.0, 9.0, 13.0; 2.0, 6.0, 10.0, 14.0; 3.0, 7.0, 11.0, 15.0; 4.0, 8.0, 12.0, 16.0]\n"
+	               "[1.0, 0.0, 0.0, 0.0; 0.0, 1.0, 0.0, 0.0; 0.0, 0.0, 1.0, 0.0; 0.0, 0.0, 0.0, 1.0]\n" ) == 0;
+}
@@ -102,6 +102,7 @@ size_t math_test_suite_size( void )
 int main( int argc, char* argv[] )
 {
 	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "Math Functions", math_tests, math_test_suite_size() );
 	return 0;
 }
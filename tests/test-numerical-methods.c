@@ -32,15 +32,39 @@ static double f(double x);
 bool test_bissection_method          ( void );
 bool test_fixed_point_iteration      ( void );
 bool test_secant_method              ( void );
+bool test_brent_method               ( void );
+bool test_newton_raphson_method      ( void );
+bool test_newton_raphson_safeguard   ( void );
+bool test_bissection_method_batch    ( void );
+bool test_fixed_point_iteration_batch( void );
+bool test_secant_method_batch        ( void );
 bool test_least_squares_linear       ( void );
 bool test_least_squares_quadratic    ( void );
+bool test_least_squares_accumulator  ( void );
+bool test_least_squares_sliding_window( void );
+bool test_least_squares_merge        ( void );
+bool test_least_squares_solve        ( void );
+bool test_least_squares_polynomial   ( void );
+bool test_least_squares_polynomial_batch( void );
 
 const test_feature_t numerical_methods_tests[] = {
 	{ "Testing Bissection Method for Root Finding",     test_bissection_method },
 	{ "Testing Fixed Point Iteration for Root Finding", test_fixed_point_iteration },
 	{ "Testing Secant Method for Root Finding",         test_secant_method },
+	{ "Testing Brent's Method for Root Finding",        test_brent_method },
+	{ "Testing Newton-Raphson Method for Root Finding", test_newton_raphson_method },
+	{ "Testing Newton-Raphson Method Safeguards",       test_newton_raphson_safeguard },
+	{ "Testing Batch Bissection Method",                test_bissection_method_batch },
+	{ "Testing Batch Fixed Point Iteration",            test_fixed_point_iteration_batch },
+	{ "Testing Batch Secant Method",                    test_secant_method_batch },
 	{ "Testing Least Squares for Linear",               test_least_squares_linear },
 	{ "Testing Least Squares for Quadratic",            test_least_squares_quadratic },
+	{ "Testing Least Squares Accumulator",              test_least_squares_accumulator },
+	{ "Testing Least Squares over a Sliding Window",    test_least_squares_sliding_window },
+	{ "Testing Merging Least Squares Accumulators",     test_least_squares_merge },
+	{ "Testing Dense Least Squares",                    test_least_squares_solve },
+	{ "Testing Polynomial Least Squares",               test_least_squares_polynomial },
+	{ "Testing Batch Polynomial Least Squares",         test_least_squares_polynomial_batch },
 };
 
 size_t numerical_methods_test_suite_size( void )
@@ -52,7 +76,7 @@ size_t numerical_methods_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "Numerical Analysis Functions", numerical_methods_tests, numerical_methods_test_suite_size() );
 	return 0;
 }
@@ -93,6 +117,269 @@ bool test_secant_method( void )
 	return result && m3d_relative_errord(1.36523, root) < 0.001;
 }
 
+static size_t counted;
+
+static double counted_f( double x )
+{
+	counted++;
+	return f( x );
+}
+
+static double df( double x )
+{
+	return 3*x*x + 8*x;
+}
+
+static void fdf( double x, double* fx, double* dfx )
+{
+	*fx  = f( x );
+	*dfx = df( x );
+}
+
+bool test_brent_method( void )
+{
+	m3d_root_stats_t stats;
+	double root = 0.0;
+	double bissection_root = 0.0;
+
+	counted = 0;
+	bool result = m3d_brent_method( 1.0, 2.0, 1e-12, 100, counted_f, &root, &stats );
+	bool same   = stats.evaluations == counted && stats.derivatives == 0 && stats.iterations > 0;
+
+	/* Bisection needs about 40 evaluations to get within 1e-12. */
+	counted = 0;
+	m3d_bissection_method( 1.0, 2.0, 1e-12, 100, counted_f, &bissection_root );
+
+	/* [2, 3] does not bracket a root, and stats may be NULL. */
+	bool rejected = !m3d_brent_method( 2.0, 3.0, 1e-12, 100, f, &root, NULL );
+
+	return result && same && rejected &&
+	       fabs(root - 1.3652300134140969) < 1e-12 &&
+	       stats.evaluations < counted / 3;
+}
+
+bool test_newton_raphson_method( void )
+{
+	m3d_root_stats_t stats;
+	m3d_root_stats_t stats_fdf;
+	double root = 0.0;
+	double root_fdf = 0.0;
+
+	bool result     = m3d_newton_raphson_method( 1.0, 2.0, 1e-12, 100, f, df, &root, &stats );
+	bool result_fdf = m3d_newton_raphson_method_fdf( 1.0, 2.0, 1e-12, 100, fdf, &root_fdf, &stats_fdf );
+
+	/* Both variants take the same steps, but the fdf variant also gets the
+	 * derivative at a and b. */
+	return result && result_fdf && root == root_fdf &&
+	       fabs(root - 1.3652300134140969) < 1e-12 &&
+	       stats.iterations == stats_fdf.iterations &&
+	       stats.evaluations == stats_fdf.evaluations &&
+	       stats.derivatives + 2 == stats_fdf.derivatives &&
+	       stats.evaluations < 10 &&
+	       !m3d_newton_raphson_method( 2.0, 3.0, 1e-12, 100, f, df, &root, NULL );
+}
+
+static double flat( double x )
+{
+	return atan( x );
+}
+
+static double flat_derivative( double x )
+{
+	return 1.0 / (1.0 + x * x);
+}
+
+static double cycle( double x )
+{
+	return x*x*x - 2*x + 2;
+}
+
+static double cycle_derivative( double x )
+{
+	return 3*x*x - 2;
+}
+
+bool test_newton_raphson_safeguard( void )
+{
+	double root_flat  = 1.0;
+	double root_cycle = 0.0;
+
+	/* Newton's method diverges on atan(x) from x = 9, and cycles between 0
+	 * and 1 on x^3 - 2x + 2. The bracket stops both. From [-1, 1] the
+	 * first estimate is 0 where the derivative of x^3 - 2x + 2 is -2. */
+	bool result_flat  = m3d_newton_raphson_method( -2.0, 20.0, 1e-12, 100, flat, flat_derivative, &root_flat, NULL );
+	bool result_cycle = m3d_newton_raphson_method( -3.0, 1.0, 1e-12, 100, cycle, cycle_derivative, &root_cycle, NULL );
+
+	return result_flat && fabs(root_flat) < 1e-12 &&
+	       result_cycle && fabs(root_cycle - -1.7692923542386314) < 1e-12;
+}
+
+/*
+ * The batch tests solve x^3 + 4x^2 - c = 0 for many c, and compare each
+ * equation with the scalar method on the same equation. Every fourth
+ * equation uses c = -1, which has no root in [1, 2] and makes the secant
+ * method divide by zero from [1, 1]. The callback counts the evaluations
+ * so the tests can check that converged equations are not evaluated again.
+ */
+#define BATCH_EQUATIONS     (1000)
+
+static struct {
+	double c[ BATCH_EQUATIONS ];
+	size_t evaluations;
+	size_t calls;
+} batch;
+
+static double scalar_c;
+
+static double scalar_f( double x )
+{
+	return x * x * x + 4 * x * x - scalar_c;
+}
+
+static double scalar_g( double x )
+{
+	return sqrt( scalar_c / (x + 4) );
+}
+
+static void batch_f( const double x[], double y[], size_t count, const size_t equations[], void* context )
+{
+	const double* c = context;
+	for( size_t k = 0; k < count; k++ )
+	{
+		y[ k ] = x[ k ] * x[ k ] * x[ k ] + 4 * x[ k ] * x[ k ] - c[ equations[ k ] ];
+	}
+	batch.evaluations += count;
+	batch.calls += 1;
+}
+
+static void batch_g( const double x[], double y[], size_t count, const size_t equations[], void* context )
+{
+	const double* c = context;
+	for( size_t k = 0; k < count; k++ )
+	{
+		y[ k ] = sqrt( c[ equations[ k ] ] / (x[ k ] + 4) );
+	}
+	batch.evaluations += count;
+	batch.calls += 1;
+}
+
+static void batch_equations( double a[], double b[] )
+{
+	batch.evaluations = 0;
+	batch.calls = 0;
+	for( size_t i = 0; i < BATCH_EQUATIONS; i++ )
+	{
+		batch.c[ i ] = i % 4 == 3 ? -1.0 : 5.0 + 20.0 * rand() / (double) RAND_MAX;
+		a[ i ] = 1.0;
+		b[ i ] = i % 4 == 3 ? 1.0 : 2.0;
+	}
+}
+
+bool test_bissection_method_batch( void )
+{
+	static double a[ BATCH_EQUATIONS ], b[ BATCH_EQUATIONS ], roots[ BATCH_EQUATIONS ];
+	static m3d_root_status_t status[ BATCH_EQUATIONS ];
+	void* workspace = malloc( m3d_root_batch_workspace_size( BATCH_EQUATIONS ) );
+	bool result = workspace != NULL;
+
+	batch_equations( a, b );
+	for( size_t i = 0; i < BATCH_EQUATIONS; i++ )
+	{
+		b[ i ] = 3.0; /* brackets every root with c in [5, 25] */
+	}
+
+	result = result && m3d_bissection_method_batch( a, b, BATCH_EQUATIONS, 1e-12, 100, batch_f, batch.c, roots, status, workspace );
+
+	/* Near a root |f| is about 30 times the distance to it, so many
+	 * equations stall, for both methods, when the bracket is narrower
+	 * than epsilon. */
+	for( size_t i = 0; result && i < BATCH_EQUATIONS; i++ )
+	{
+		double root = NAN;
+		scalar_c = batch.c[ i ];
+		const bool found = m3d_bissection_method( a[ i ], b[ i ], 1e-12, 100, scalar_f, &root );
+
+		result = found == (status[ i ] == M3D_ROOT_CONVERGED) &&
+		         (!found || roots[ i ] == root) &&
+		         (i % 4 == 3 ? status[ i ] == M3D_ROOT_STALLED :
+		          status[ i ] != M3D_ROOT_MAX_ITERATIONS && fabs( scalar_f( roots[ i ] ) ) < 1e-9);
+	}
+
+	/* One call for the lower ends, then one per iteration with only the
+	 * equations that are left. About 42 halvings bring a bracket of 2 below
+	 * 1e-12. */
+	result = result && batch.calls <= 44 && batch.evaluations <= 44 * BATCH_EQUATIONS;
+
+	/* No iterations */
+	result = result && m3d_bissection_method_batch( a, b, 4, 1e-12, 0, batch_f, batch.c, roots, status, NULL ) &&
+	         status[ 0 ] == M3D_ROOT_MAX_ITERATIONS && roots[ 0 ] == 2.0;
+
+	free( workspace );
+	return result;
+}
+
+bool test_fixed_point_iteration_batch( void )
+{
+	static double a[ BATCH_EQUATIONS ], b[ BATCH_EQUATIONS ], roots[ BATCH_EQUATIONS ];
+	static m3d_root_status_t status[ BATCH_EQUATIONS ];
+
+	/* sqrt(c / (x + 4)) = x has a fixed point for c > 0, and is NaN for
+	 * c = -1. */
+	batch_equations( a, b );
+	bool result = m3d_fixed_point_iteration_batch( a, BATCH_EQUATIONS, 1e-12, 1000, batch_g, batch.c, roots, status, NULL );
+
+	size_t iterations = 0;
+	for( size_t i = 0; result && i < BATCH_EQUATIONS; i++ )
+	{
+		double root = NAN;
+		scalar_c = batch.c[ i ];
+		const bool found = m3d_fixed_point_iteration( a[ i ], 1e-12, 1000, scalar_g, &root );
+
+		result = found == (status[ i ] == M3D_ROOT_CONVERGED) &&
+		         (i % 4 == 3 ? status[ i ] == M3D_ROOT_NOT_FINITE : found && roots[ i ] == root &&
+		          fabs( root * root * root + 4 * root * root - batch.c[ i ] ) < 1e-9);
+
+		/* Each equation converges at its own pace. */
+		for( double x = a[ i ]; i % 4 != 3 && fabs( scalar_g( x ) - x ) >= 1e-12; x = scalar_g( x ) )
+		{
+			iterations++;
+		}
+		iterations += 1;
+	}
+
+	return result && batch.evaluations == iterations;
+}
+
+bool test_secant_method_batch( void )
+{
+	static double a[ BATCH_EQUATIONS ], b[ BATCH_EQUATIONS ], roots[ BATCH_EQUATIONS ];
+	static m3d_root_status_t status[ BATCH_EQUATIONS ];
+
+	batch_equations( a, b );
+	bool result = m3d_secant_method_batch( a, b, BATCH_EQUATIONS, 1e-12, 100, batch_f, batch.c, roots, status, NULL );
+
+	for( size_t i = 0; result && i < BATCH_EQUATIONS; i++ )
+	{
+		double root = NAN;
+		scalar_c = batch.c[ i ];
+		const bool found = m3d_secant_method( a[ i ], b[ i ], 1e-12, 100, scalar_f, &root );
+
+		result = found == (status[ i ] == M3D_ROOT_CONVERGED) &&
+		         (i % 4 == 3 ? status[ i ] == M3D_ROOT_NOT_FINITE : found && roots[ i ] == root);
+	}
+
+	/* The secant method converges in a few iterations, far fewer than the
+	 * limit, so the calls stop early. */
+	result = result && batch.calls < 20 && batch.evaluations < 20 * BATCH_EQUATIONS;
+
+	/* Iteration limits */
+	result = result && m3d_secant_method_batch( a, b, 3, 1e-12, 2, batch_f, batch.c, roots, status, NULL ) &&
+	         status[ 0 ] == M3D_ROOT_MAX_ITERATIONS && status[ 1 ] == M3D_ROOT_MAX_ITERATIONS &&
+	         m3d_secant_method_batch( a, b, 0, 1e-12, 100, batch_f, batch.c, roots, status, NULL );
+
+	return result;
+}
+
 bool test_least_squares_linear( void )
 {
 	double x1[] = {
@@ -148,5 +435,398 @@ bool test_least_squares_quadratic( void )
 	             m3d_relative_errord( 0.864, b ) < 0.001 &&
 		         m3d_relative_errord( 1.005, c ) < 0.001;
 
-	return test1;
+	/* Samples at only two distinct values of x, and at only one. */
+	double x2[] = {
+		 0.1,  0.7,  0.1,  0.7,  0.7
+	};
+	double x3[] = {
+		 3.0,  3.0,  3.0,  3.0,  3.0
+	};
+
+	m3d_least_squares_quadratic( x2, y, 5, &a, &b, &c );
+	bool test2 = isnan( a ) && isnan( b ) && isnan( c );
+
+	m3d_least_squares_quadratic( x3, y, 5, &a, &b, &c );
+	bool test3 = isnan( a ) && isnan( b ) && isnan( c );
+
+	return test1 && test2 && test3;
+}
+
+/* Small deterministic noise in [-0.5, 0.5]. */
+static double noise( size_t i )
+{
+	double n = sin( (double) i * 12.9898 ) * 43758.5453;
+	return n - floor( n ) - 0.5;
+}
+
+/* A two pass fit about the mean, as a reference. */
+static void reference_linear( const double x[], const double y[], size_t count, double* m, double* b )
+{
+	double mean_x = 0.0;
+	double mean_y = 0.0;
+	for( size_t i = 0; i < count; i++ )
+	{
+		mean_x += x[ i ];
+		mean_y += y[ i ];
+	}
+	mean_x /= count;
+	mean_y /= count;
+
+	double xx = 0.0;
+	double xy = 0.0;
+	for( size_t i = 0; i < count; i++ )
+	{
+		xx += (x[ i ] - mean_x) * (x[ i ] - mean_x);
+		xy += (x[ i ] - mean_x) * (y[ i ] - mean_y);
+	}
+	*m = xy / xx;
+	*b = mean_y - *m * mean_x;
+}
+
+bool test_least_squares_accumulator( void )
+{
+	double x1[] = { 6, 7, 8, 10, 12, 14, 15, 16 };
+	double y1[] = { 4, 5, 7,  6,  8,  8,  7, 10 };
+	m3d_least_squares_accumulator_t accumulator;
+	double m  = 0.0;
+	double b  = 0.0;
+	double rm = 0.0;
+	double rb = 0.0;
+
+	m3d_least_squares_accumulator_init( &accumulator );
+	m3d_least_squares_accumulator_add( &accumulator, x1[ 0 ], y1[ 0 ] );
+	bool too_few = !m3d_least_squares_accumulator_linear( &accumulator, &m, &b );
+	m3d_least_squares_accumulator_add_array( &accumulator, x1 + 1, y1 + 1, 7 );
+
+	bool result = m3d_least_squares_accumulator_linear( &accumulator, &m, &b );
+	reference_linear( x1, y1, 8, &rm, &rb );
+	double error = m3d_least_squares_accumulator_linear_error( &accumulator, m, b );
+	double reference_error = m3d_least_squares_linear_error( x1, y1, 8, m, b );
+
+	bool linear = too_few && result &&
+	              fabs(m - rm) < 1e-12 && fabs(b - rb) < 1e-12 &&
+	              fabs(error - reference_error) < 1e-12 * reference_error;
+
+	/* A quadratic is fitted exactly, even away from the origin. */
+	double x[ 50 ];
+	double y[ 50 ];
+	double a = 0.0;
+	double c = 0.0;
+	for( size_t i = 0; i < 50; i++ )
+	{
+		x[ i ] = 1000.0 + 0.5 * i;
+		y[ i ] = 0.003 * x[ i ] * x[ i ] - 2.0 * x[ i ] + 5.0;
+	}
+	m3d_least_squares_accumulator_init( &accumulator );
+	m3d_least_squares_accumulator_add_array( &accumulator, x, y, 50 );
+	bool quadratic = m3d_least_squares_accumulator_quadratic( &accumulator, &a, &b, &c ) &&
+	                 fabs(a - 0.003) < 1e-12 && fabs(b + 2.0) < 1e-9 && fabs(c - 5.0) < 1e-5 &&
+	                 m3d_least_squares_accumulator_quadratic_error( &accumulator, 0.003, -2.0, 5.0 ) < 1e-6;
+
+	/* Every x the same has no fit. */
+	m3d_least_squares_accumulator_init( &accumulator );
+	for( size_t i = 0; i < 10; i++ )
+	{
+		m3d_least_squares_accumulator_add( &accumulator, 3.0, (double) i );
+	}
+	bool degenerate = !m3d_least_squares_accumulator_linear( &accumulator, &m, &b ) &&
+	                  !m3d_least_squares_accumulator_quadratic( &accumulator, &a, &b, &c );
+
+	return linear && quadratic && degenerate;
+}
+
+bool test_least_squares_sliding_window( void )
+{
+	/* Timestamps far from zero, with a spread of one second in a window,
+	 * would lose most of their digits in plain sums of x^2. */
+	#define WINDOW   (100)
+	#define SAMPLES  (20000)
+	static double x[ SAMPLES ];
+	static double y[ SAMPLES ];
+	m3d_least_squares_accumulator_t accumulator;
+	bool result = true;
+
+	for( size_t i = 0; i < SAMPLES; i++ )
+	{
+		x[ i ] = 1.7e9 + 0.01 * i;
+		y[ i ] = 0.5 * (x[ i ] - 1.7e9) + 2.0 + 0.1 * noise( i );
+	}
+
+	m3d_least_squares_accumulator_init( &accumulator );
+	for( size_t i = 0; i < SAMPLES; i++ )
+	{
+		m3d_least_squares_accumulator_add( &accumulator, x[ i ], y[ i ] );
+		if( i >= WINDOW )
+		{
+			m3d_least_squares_accumulator_remove( &accumulator, x[ i - WINDOW ], y[ i - WINDOW ] );
+		}
+		if( i % 5000 == 4999 )
+		{
+			/* The window has moved 50 seconds from the first sample. */
+			m3d_least_squares_accumulator_recenter( &accumulator );
+		}
+
+		if( i % 1000 == 999 )
+		{
+			const double* wx = x + i + 1 - WINDOW;
+			const double* wy = y + i + 1 - WINDOW;
+			double m;
+			double b;
+			double rm;
+			double rb;
+			reference_linear( wx, wy, WINDOW, &rm, &rb );
+			result = result && accumulator.count == WINDOW &&
+			         m3d_least_squares_accumulator_linear( &accumulator, &m, &b ) &&
+			         fabs(m - rm) < 1e-9 &&
+			         /* The predictions, since b is at x = 0. */
+			         fabs((m * wx[ 0 ] + b) - (rm * wx[ 0 ] + rb)) < 1e-6;
+		}
+	}
+
+	/* Removing every sample starts over. */
+	for( size_t i = SAMPLES - WINDOW; i < SAMPLES; i++ )
+	{
+		m3d_least_squares_accumulator_remove( &accumulator, x[ i ], y[ i ] );
+	}
+	result = result && accumulator.count == 0 && accumulator.sums[ 0 ] == 0.0;
+	#undef WINDOW
+	#undef SAMPLES
+
+	return result;
+}
+
+bool test_least_squares_merge( void )
+{
+	#define SAMPLES  (1000)
+	#define SHARDS   (4)
+	m3d_least_squares_accumulator_t whole;
+	m3d_least_squares_accumulator_t merged;
+	m3d_least_squares_accumulator_t shards[ SHARDS ];
+
+	m3d_least_squares_accumulator_init( &whole );
+	m3d_least_squares_accumulator_init( &merged );
+	for( size_t s = 0; s < SHARDS; s++ )
+	{
+		m3d_least_squares_accumulator_init( &shards[ s ] );
+	}
+
+	for( size_t i = 0; i < SAMPLES; i++ )
+	{
+		double x = 100.0 + 0.1 * i;
+		double y = 0.25 * x * x - 3.0 * x + 1.0 + noise( i );
+		m3d_least_squares_accumulator_add( &whole, x, y );
+		/* Each shard gets samples from all over, about a different x0. */
+		m3d_least_squares_accumulator_add( &shards[ (i * 7) % SHARDS ], x, y );
+	}
+
+	/* Merging into an empty accumulator, and merging an empty one. */
+	m3d_least_squares_accumulator_t empty;
+	m3d_least_squares_accumulator_init( &empty );
+	for( size_t s = SHARDS; s > 0; s-- )
+	{
+		m3d_least_squares_accumulator_merge( &merged, &shards[ s - 1 ] );
+	}
+	m3d_least_squares_accumulator_merge( &merged, &empty );
+
+	double a1, b1, c1;
+	double a2, b2, c2;
+	double m1, n1;
+	double m2, n2;
+	bool result = merged.count == SAMPLES &&
+	              m3d_least_squares_accumulator_quadratic( &whole, &a1, &b1, &c1 ) &&
+	              m3d_least_squares_accumulator_quadratic( &merged, &a2, &b2, &c2 ) &&
+	              m3d_least_squares_accumulator_linear( &whole, &m1, &n1 ) &&
+	              m3d_least_squares_accumulator_linear( &merged, &m2, &n2 );
+	#undef SAMPLES
+	#undef SHARDS
+
+	return result &&
+	       fabs(a1 - a2) < 1e-12 && fabs(b1 - b2) < 1e-10 && fabs(c1 - c2) < 1e-8 &&
+	       fabs(m1 - m2) < 1e-10 && fabs(n1 - n2) < 1e-8 &&
+	       fabs(a1 - 0.25) < 1e-3 && fabs(b1 + 3.0) < 0.1;
+}
+
+bool test_least_squares_solve( void )
+{
+	#define ROWS     (50)
+	#define COLUMNS  (4)
+	#define RHS      (3)
+	static double A[ ROWS * COLUMNS ];
+	static double Y[ ROWS * RHS ];
+	static unsigned char workspace[ ROWS * (COLUMNS + RHS) * sizeof(double) ];
+	const double truth[ COLUMNS ] = { 1.5, -2.0, 0.25, 3.0 };
+	double coefficients[ COLUMNS * RHS ];
+	double errors[ RHS ];
+	bool result = m3d_least_squares_workspace_size( ROWS, COLUMNS, RHS ) == sizeof(workspace);
+
+	for( size_t i = 0; i < ROWS; i++ )
+	{
+		double exact = 0.0;
+		for( size_t j = 0; j < COLUMNS; j++ )
+		{
+			A[ i * COLUMNS + j ] = noise( i * COLUMNS + j + 1 ) * (j + 1);
+			exact += A[ i * COLUMNS + j ] * truth[ j ];
+		}
+		/* The first right-hand side is exact; the others have noise. */
+		Y[ i * RHS + 0 ] = exact;
+		Y[ i * RHS + 1 ] = exact + 0.01 * noise( 1000 + i );
+		Y[ i * RHS + 2 ] = noise( 2000 + i );
+	}
+
+	result = result && m3d_least_squares_solve( A, Y, ROWS, COLUMNS, RHS, coefficients, errors, workspace );
+
+	for( size_t j = 0; j < COLUMNS; j++ )
+	{
+		result = result && fabs(coefficients[ j * RHS ] - truth[ j ]) < 1e-12 &&
+		                   fabs(coefficients[ j * RHS + 1 ] - truth[ j ]) < 0.01;
+	}
+
+	/* The residuals of a least squares solution are orthogonal to the
+	 * columns, and their squares add up to the error. */
+	for( size_t r = 0; r < RHS; r++ )
+	{
+		double error = 0.0;
+		double orthogonal[ COLUMNS ] = { 0.0 };
+		for( size_t i = 0; i < ROWS; i++ )
+		{
+			double residual = Y[ i * RHS + r ];
+			for( size_t j = 0; j < COLUMNS; j++ )
+			{
+				residual -= A[ i * COLUMNS + j ] * coefficients[ j * RHS + r ];
+			}
+			error += residual * residual;
+			for( size_t j = 0; j < COLUMNS; j++ )
+			{
+				orthogonal[ j ] += A[ i * COLUMNS + j ] * residual;
+			}
+		}
+		result = result && fabs(error - errors[ r ]) <= 1e-10 * (1.0 + error);
+		for( size_t j = 0; j < COLUMNS; j++ )
+		{
+			result = result && fabs(orthogonal[ j ]) < 1e-12;
+		}
+	}
+
+	/* A column that is twice another has no unique solution. */
+	for( size_t i = 0; i < ROWS; i++ )
+	{
+		A[ i * COLUMNS + 3 ] = 2.0 * A[ i * COLUMNS + 1 ];
+	}
+	result = result && !m3d_least_squares_solve( A, Y, ROWS, COLUMNS, RHS, coefficients, NULL, NULL ) &&
+	         !m3d_least_squares_solve( A, Y, COLUMNS - 1, COLUMNS, RHS, coefficients, NULL, NULL );
+	#undef ROWS
+	#undef COLUMNS
+	#undef RHS
+
+	return result;
+}
+
+bool test_least_squares_polynomial( void )
+{
+	double x[ 40 ];
+	double y[ 40 ];
+	double c[ 6 ];
+	double error = 1.0;
+	bool result = true;
+
+	/* A cubic is fitted exactly, with degree 3 and with degree 5. */
+	for( size_t i = 0; i < 40; i++ )
+	{
+		x[ i ] = -2.0 + 0.1 * i;
+		y[ i ] = 1.0 - 2.0 * x[ i ] + 0.5 * x[ i ] * x[ i ] + 0.125 * x[ i ] * x[ i ] * x[ i ];
+	}
+	for( size_t degree = 3; degree <= 5; degree += 2 )
+	{
+		result = result && m3d_least_squares_polynomial( x, y, 40, degree, c, &error, NULL ) &&
+		         fabs(c[ 0 ] - 1.0) < 1e-12 && fabs(c[ 1 ] + 2.0) < 1e-12 &&
+		         fabs(c[ 2 ] - 0.5) < 1e-12 && fabs(c[ 3 ] - 0.125) < 1e-12 &&
+		         error < 1e-20;
+		for( size_t j = 4; j <= degree; j++ )
+		{
+			result = result && fabs(c[ j ]) < 1e-12;
+		}
+	}
+
+	/* Degrees 1 and 2 are the linear and quadratic fits. */
+	double x1[] = { 6, 7, 8, 10, 12, 14, 15, 16 };
+	double y1[] = { 4, 5, 7,  6,  8,  8,  7, 10 };
+	double m, b, a;
+	m3d_least_squares_linear( x1, y1, 8, &m, &b );
+	result = result && m3d_least_squares_polynomial( x1, y1, 8, 1, c, NULL, NULL ) &&
+	         fabs(c[ 0 ] - b) < 1e-12 && fabs(c[ 1 ] - m) < 1e-12;
+	m3d_least_squares_quadratic( x1, y1, 8, &a, &b, &m );
+	result = result && m3d_least_squares_polynomial( x1, y1, 8, 2, c, &error, NULL ) &&
+	         fabs(c[ 0 ] - m) < 1e-10 && fabs(c[ 1 ] - b) < 1e-10 && fabs(c[ 2 ] - a) < 1e-10 &&
+	         fabs(error - m3d_least_squares_quadratic_error( x1, y1, 8, a, b, m )) < 1e-10;
+
+	/* Too few points, or too few distinct x. */
+	double same[] = { 3, 3, 3, 3 };
+	result = result && !m3d_least_squares_polynomial( x1, y1, 3, 3, c, NULL, NULL ) &&
+	         !m3d_least_squares_polynomial( same, y1, 4, 1, c, NULL, NULL ) &&
+	         m3d_least_squares_polynomial( same, y1, 4, 0, c, NULL, NULL ) && fabs(c[ 0 ] - 5.5) < 1e-12;
+
+	return result;
+}
+
+bool test_least_squares_polynomial_batch( void )
+{
+	#define POINTS   (30)
+	#define SERIES   (25)
+	#define DEGREE   (3)
+	static double x[ SERIES * POINTS ];
+	static double y[ SERIES * POINTS ];
+	double coefficients[ SERIES * (DEGREE + 1) ];
+	double shared[ SERIES * (DEGREE + 1) ];
+	double errors[ SERIES ];
+	double shared_errors[ SERIES ];
+	double c[ DEGREE + 1 ];
+	double error;
+	bool result = true;
+
+	for( size_t s = 0; s < SERIES; s++ )
+	{
+		for( size_t i = 0; i < POINTS; i++ )
+		{
+			double t = 0.1 * i;
+			x[ s * POINTS + i ] = s + t;
+			y[ s * POINTS + i ] = s - 0.5 * t + 0.01 * s * t * t * t + 0.001 * noise( s * POINTS + i );
+		}
+	}
+
+	/* Each series against a fit of its own. */
+	result = result && m3d_least_squares_polynomial_batch( x, y, POINTS, SERIES, DEGREE, false, coefficients, errors );
+	for( size_t s = 0; s < SERIES; s++ )
+	{
+		result = result && m3d_least_squares_polynomial( x + s * POINTS, y + s * POINTS, POINTS, DEGREE, c, &error, NULL ) &&
+		         error == errors[ s ];
+		for( size_t j = 0; j <= DEGREE; j++ )
+		{
+			result = result && c[ j ] == coefficients[ s * (DEGREE + 1) + j ];
+		}
+	}
+
+	/* Every series at the x of the first one. */
+	result = result && m3d_least_squares_polynomial_batch( x, y, POINTS, SERIES, DEGREE, true, shared, shared_errors );
+	for( size_t s = 0; s < SERIES; s++ )
+	{
+		result = result && m3d_least_squares_polynomial( x, y + s * POINTS, POINTS, DEGREE, c, &error, NULL ) &&
+		         fabs(error - shared_errors[ s ]) < 1e-12;
+		for( size_t j = 0; j <= DEGREE; j++ )
+		{
+			result = result && fabs(c[ j ] - shared[ s * (DEGREE + 1) + j ]) < 1e-9;
+		}
+	}
+
+	/* A series with one x is not fitted, and the others are. */
+	for( size_t i = 0; i < POINTS; i++ )
+	{
+		x[ 2 * POINTS + i ] = 1.0;
+	}
+	result = result && !m3d_least_squares_polynomial_batch( x, y, POINTS, SERIES, DEGREE, false, coefficients, NULL ) &&
+	         isnan( coefficients[ 2 * (DEGREE + 1) ] ) && !isnan( coefficients[ 3 * (DEGREE + 1) ] );
+	#undef POINTS
+	#undef SERIES
+	#undef DEGREE
+
+	return result;
 }
@@ -0,0 +1,238 @@
+/* Copyright (C) 2013-2015 by Joseph A. Marrero, http://www.manvscode.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "../src/quat.h"
+#include "../src/packed-transforms.h"
+#include "test.h"
+
+/* More than two blocks, the last one partial. */
+#define PACKED_TEST_COUNT   (150)
+#define PACKED_TEST_DEGREES (180 / 3.14159265358979323846)
+
+bool test_quat_pack32          ( void );
+bool test_quat_pack48          ( void );
+bool test_quat_pack_octahedral ( void );
+bool test_quat_unpack_batch    ( void );
+bool test_vec3_pack48          ( void );
+
+const test_feature_t packed_transforms_tests[] = {
+	{ "Testing 32-bit smallest three quaternions", test_quat_pack32 },
+	{ "Testing 48-bit smallest three quaternions", test_quat_pack48 },
+	{ "Testing 32-bit octahedral quaternions",     test_quat_pack_octahedral },
+	{ "Testing batch quaternion unpacking",        test_quat_unpack_batch },
+	{ "Testing 48-bit translations",               test_vec3_pack48 },
+};
+
+size_t packed_transforms_test_suite_size( void )
+{
+	return sizeof(packed_transforms_tests) / sizeof(packed_transforms_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	bool result = test_features( "Packed Transform Functions", packed_transforms_tests, packed_transforms_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+/* Random rotations, and the edge cases: ties and near ties for the
+ * largest component (the worst case for smallest three), a component of
+ * zero, and either sign of the same rotation. */
+static quat_t random_rotation( size_t i )
+{
+	quat_t q = QUAT( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+
+	switch( i % 8 )
+	{
+		case 1: q = QUAT( 1, 1, 1, 1 ); break;
+		case 2: q.y = 0; break;
+		case 3: q = QUAT( 0, 0, -1, 0 ); break;
+		case 4: q = QUAT( 1, -1, 0, 0 ); break;
+		case 5: q = QUAT( m3d_uniform_rangef( 0.49, 0.51 ), m3d_uniform_rangef( 0.49, 0.51 ),
+		                  m3d_uniform_rangef( 0.49, 0.51 ), m3d_uniform_rangef( 0.49, 0.51 ) ); break;
+		default: break;
+	}
+	if( i % 3 == 0 )
+	{
+		quat_scale( &q, -1 );
+	}
+	quat_normalize( &q );
+	return q;
+}
+
+/* Whether p is q (or -q) to within the component and angle bounds. */
+static bool rotation_close( const quat_t* q, const quat_t* p, double component, double degrees )
+{
+	const double dot  = (double) q->x * p->x + (double) q->y * p->y + (double) q->z * p->z + (double) q->w * p->w;
+	const double sign = dot < 0 ? -1 : 1;
+	const double dx = q->x - sign * p->x, dy = q->y - sign * p->y, dz = q->z - sign * p->z, dw = q->w - sign * p->w;
+	/* The rotation angle from the chord between the unit quaternions,
+	 * which unlike acos( dot ) is accurate for small angles. */
+	const double chord = sqrt( dx * dx + dy * dy + dz * dz + dw * dw );
+
+	return fabs( dx ) <= component && fabs( dy ) <= component &&
+	       fabs( dz ) <= component && fabs( dw ) <= component &&
+	       4 * asin( chord / 2 ) * PACKED_TEST_DEGREES <= degrees &&
+	       fabs( quat_magnitude( p ) - 1 ) < 1e-5;
+}
+
+bool test_quat_pack32( void )
+{
+	bool result = true;
+	for( size_t i = 0; result && i < 10000; i++ )
+	{
+		quat_t q = random_rotation( i );
+		quat_t p = quat_unpack32( quat_pack32( &q ) );
+		result = rotation_close( &q, &p, 2.1e-3, 0.28 );
+	}
+	return result;
+}
+
+bool test_quat_pack48( void )
+{
+	bool result = true;
+	for( size_t i = 0; result && i < 10000; i++ )
+	{
+		quat_t q = random_rotation( i );
+		quat_t p = quat_unpack48( quat_pack48( &q ) );
+		result = rotation_close( &q, &p, 6.5e-5, 0.009 );
+	}
+	return result;
+}
+
+bool test_quat_pack_octahedral( void )
+{
+	bool result = true;
+	for( size_t i = 0; result && i < 10000; i++ )
+	{
+		quat_t q = random_rotation( i );
+		quat_t p = quat_unpack_octahedral( quat_pack_octahedral( &q ) );
+		result = rotation_close( &q, &p, 4.2e-3, 0.53 );
+	}
+	return result;
+}
+
+/* Compared by component, as a long double quat_t has padding. */
+static bool quats_are( const quat_t q[], const quat_t expected[] )
+{
+	bool result = true;
+	for( size_t i = 0; result && i < PACKED_TEST_COUNT; i++ )
+	{
+		result = q[ i ].x == expected[ i ].x && q[ i ].y == expected[ i ].y &&
+		         q[ i ].z == expected[ i ].z && q[ i ].w == expected[ i ].w;
+	}
+	return result;
+}
+
+static bool quat_array_is( const quat_array_t* array, const quat_t expected[] )
+{
+	bool result = true;
+	for( size_t i = 0; result && i < PACKED_TEST_COUNT; i++ )
+	{
+		result = array->x[ i ] == expected[ i ].x && array->y[ i ] == expected[ i ].y &&
+		         array->z[ i ] == expected[ i ].z && array->w[ i ] == expected[ i ].w;
+	}
+	return result;
+}
+
+bool test_quat_unpack_batch( void )
+{
+	quat_packed32_t     packed32[ PACKED_TEST_COUNT ];
+	quat_packed48_t     packed48[ PACKED_TEST_COUNT ];
+	quat_octahedral32_t octahedral[ PACKED_TEST_COUNT ];
+	quat_t expected32[ PACKED_TEST_COUNT ], expected48[ PACKED_TEST_COUNT ], expected_octahedral[ PACKED_TEST_COUNT ];
+	quat_t batch[ PACKED_TEST_COUNT ];
+	quat_array_t array;
+	bool result = true;
+
+	for( size_t i = 0; i < PACKED_TEST_COUNT; i++ )
+	{
+		quat_t q = random_rotation( i );
+		packed32[ i ]   = quat_pack32( &q );
+		packed48[ i ]   = quat_pack48( &q );
+		octahedral[ i ] = quat_pack_octahedral( &q );
+		expected32[ i ] = quat_unpack32( packed32[ i ] );
+		expected48[ i ] = quat_unpack48( packed48[ i ] );
+		expected_octahedral[ i ] = quat_unpack_octahedral( octahedral[ i ] );
+	}
+
+	/* The batch decoders give exactly what the scalar ones do. */
+	quat_array_create( &array, PACKED_TEST_COUNT );
+
+	quat_unpack32_batch( batch, packed32, PACKED_TEST_COUNT );
+	quat_unpack32_array( &array, packed32, PACKED_TEST_COUNT );
+	result = result && quats_are( batch, expected32 ) && quat_array_is( &array, expected32 );
+
+	quat_unpack48_batch( batch, packed48, PACKED_TEST_COUNT );
+	quat_unpack48_array( &array, packed48, PACKED_TEST_COUNT );
+	result = result && quats_are( batch, expected48 ) && quat_array_is( &array, expected48 );
+
+	quat_unpack_octahedral_batch( batch, octahedral, PACKED_TEST_COUNT );
+	quat_unpack_octahedral_array( &array, octahedral, PACKED_TEST_COUNT );
+	result = result && quats_are( batch, expected_octahedral ) && quat_array_is( &array, expected_octahedral );
+
+	quat_array_destroy( &array );
+	return result;
+}
+
+bool test_vec3_pack48( void )
+{
+	const vec3_t min = VEC3( -2, 0, -0.5 );
+	const vec3_t max = VEC3( 2, 3, 0.5 );
+	vec3_packed48_t packed[ PACKED_TEST_COUNT ];
+	vec3_t expected[ PACKED_TEST_COUNT ];
+	vec3_t batch[ PACKED_TEST_COUNT ];
+	vec3_array_t array;
+	bool result = true;
+
+	for( size_t i = 0; result && i < PACKED_TEST_COUNT; i++ )
+	{
+		vec3_t v = VEC3( m3d_uniform_rangef( min.x, max.x ), m3d_uniform_rangef( min.y, max.y ), m3d_uniform_rangef( min.z, max.z ) );
+		packed[ i ]   = vec3_pack48( &v, &min, &max );
+		expected[ i ] = vec3_unpack48( packed[ i ], &min, &max );
+
+		result = fabs( v.x - expected[ i ].x ) <= (max.x - min.x) / 131070 * 1.01 &&
+		         fabs( v.y - expected[ i ].y ) <= (max.y - min.y) / 131070 * 1.01 &&
+		         fabs( v.z - expected[ i ].z ) <= (max.z - min.z) / 131070 * 1.01;
+	}
+
+	/* Outside the box is clamped to it, and the ends are exact. */
+	vec3_t outside = VEC3( -3, 4, 0.5 );
+	vec3_t clamped = vec3_unpack48( vec3_pack48( &outside, &min, &max ), &min, &max );
+	result = result && clamped.x == min.x && clamped.y == max.y && fabs( clamped.z - max.z ) < 1e-6;
+
+	vec3_array_create( &array, PACKED_TEST_COUNT );
+	vec3_unpack48_batch( batch, packed, PACKED_TEST_COUNT, &min, &max );
+	vec3_unpack48_array( &array, packed, PACKED_TEST_COUNT, &min, &max );
+	for( size_t i = 0; result && i < PACKED_TEST_COUNT; i++ )
+	{
+		result = batch[ i ].x == expected[ i ].x && batch[ i ].y == expected[ i ].y && batch[ i ].z == expected[ i ].z &&
+		         array.x[ i ] == expected[ i ].x && array.y[ i ] == expected[ i ].y && array.z[ i ] == expected[ i ].z;
+	}
+	vec3_array_destroy( &array );
+	return result;
+}
@@ -52,7 +52,7 @@ size_t projection_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	test_features( "Projection Transformations", projection_tests, projection_test_suite_size() );
 	return 0;
 }
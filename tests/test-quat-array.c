@@ -0,0 +1,405 @@
+/* Copyright (C) 2013-2015 by Joseph A. Marrero, http://www.manvscode.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <float.h>
+#include <math.h>
+#include "../src/quat.h"
+#include "../src/quat-array.h"
+#include "test.h"
+
+/* Longer than one slerp block, and odd, so that both the vector body and
+ * the scalar tail run. */
+#define QUAT_ARRAY_TEST_COUNT   (101)
+
+/* Slerp is computed in double, even for long double. */
+#define QUAT_ARRAY_TOLERANCE    (64 * (SCALAR_EPSILON > DBL_EPSILON ? SCALAR_EPSILON : DBL_EPSILON))
+
+bool test_quat_array_create     ( void );
+bool test_quat_array_conversion ( void );
+bool test_quat_array_normalize  ( void );
+bool test_quat_array_nlerp      ( void );
+bool test_quat_array_slerp      ( void );
+bool test_quat_array_slerp_edges( void );
+bool test_quat_array_blend      ( void );
+
+const test_feature_t quat_array_tests[] = {
+	{ "Testing quat array creation",           test_quat_array_create },
+	{ "Testing quat array conversion",         test_quat_array_conversion },
+	{ "Testing quat array normalize",          test_quat_array_normalize },
+	{ "Testing quat array nlerp",              test_quat_array_nlerp },
+	{ "Testing quat array slerp",              test_quat_array_slerp },
+	{ "Testing quat array slerp edge cases",   test_quat_array_slerp_edges },
+	{ "Testing quat array layer blending",     test_quat_array_blend },
+};
+
+size_t quat_array_test_suite_size( void )
+{
+	return sizeof(quat_array_tests) / sizeof(quat_array_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	bool result = test_features( "Quaternion Array Functions", quat_array_tests, quat_array_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+static inline bool quat_close( const quat_t* a, const quat_t* b, double tolerance )
+{
+	return fabs( (double) (a->x - b->x) ) < tolerance &&
+	       fabs( (double) (a->y - b->y) ) < tolerance &&
+	       fabs( (double) (a->z - b->z) ) < tolerance &&
+	       fabs( (double) (a->w - b->w) ) < tolerance;
+}
+
+static void quat_fill( quat_t q[], size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+	{
+		q[ i ] = QUAT( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+		quat_normalize( &q[ i ] );
+	}
+}
+
+/* Shortest path slerp in double with the C library. */
+static quat_t reference_slerp( const quat_t* a, const quat_t* b, double t )
+{
+	double d = (double) a->x * b->x + (double) a->y * b->y + (double) a->z * b->z + (double) a->w * b->w;
+	double sign = d < 0 ? -1.0 : 1.0;
+	d = fabs( d ) > 1.0 ? 1.0 : fabs( d );
+
+	double theta = acos( d );
+	double alpha = 1.0 - t;
+	double beta  = t;
+	if( sin( theta ) > 1e-9 )
+	{
+		alpha = sin( (1.0 - t) * theta ) / sin( theta );
+		beta  = sin( t * theta ) / sin( theta );
+	}
+	beta *= sign;
+
+	return QUAT( alpha * a->x + beta * b->x, alpha * a->y + beta * b->y,
+	             alpha * a->z + beta * b->z, alpha * a->w + beta * b->w );
+}
+
+static quat_t reference_nlerp( const quat_t* a, const quat_t* b, double t )
+{
+	double s = quat_dot_product( a, b ) < 0 ? -t : t;
+	quat_t q = QUAT( (1 - t) * a->x + s * b->x, (1 - t) * a->y + s * b->y,
+	                 (1 - t) * a->z + s * b->z, (1 - t) * a->w + s * b->w );
+	quat_normalize( &q );
+	return q;
+}
+
+bool test_quat_array_create( void )
+{
+	quat_array_t array;
+	bool result = quat_array_create( &array, QUAT_ARRAY_TEST_COUNT );
+
+	result = result &&
+	         array.count == QUAT_ARRAY_TEST_COUNT &&
+	         ((uintptr_t) array.x) % 64 == 0 &&
+	         ((uintptr_t) array.y) % 64 == 0 &&
+	         ((uintptr_t) array.z) % 64 == 0 &&
+	         ((uintptr_t) array.w) % 64 == 0;
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t q = quat_array_get( &array, i );
+		quat_t identity = QUAT_WUNIT;
+		result = quat_close( &q, &identity, QUAT_ARRAY_TOLERANCE );
+	}
+
+	quat_array_destroy( &array );
+	return result && array.count == 0 && array.x == NULL;
+}
+
+bool test_quat_array_conversion( void )
+{
+	quat_t input[ QUAT_ARRAY_TEST_COUNT ];
+	quat_t output[ QUAT_ARRAY_TEST_COUNT ];
+	quat_array_t array;
+	bool result = true;
+
+	quat_fill( input, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array, input, QUAT_ARRAY_TEST_COUNT );
+	quat_array_to_quat( &array, output, QUAT_ARRAY_TEST_COUNT );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t q = quat_array_get( &array, i );
+		result = vec4_compare( &input[ i ], &output[ i ] ) &&
+		         vec4_compare( &input[ i ], &q );
+	}
+
+	quat_array_destroy( &array );
+	return result;
+}
+
+bool test_quat_array_normalize( void )
+{
+	quat_t input[ QUAT_ARRAY_TEST_COUNT ];
+	quat_array_t array;
+	bool result = true;
+
+	quat_fill( input, QUAT_ARRAY_TEST_COUNT );
+	for( size_t i = 0; i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_scale( &input[ i ], 0.5 + i );
+	}
+	input[ 3 ] = QUAT( 0, 0, 0, 0 );
+
+	quat_array_create( &array, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array, input, QUAT_ARRAY_TEST_COUNT );
+	quat_array_normalize( &array );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t expected = input[ i ];
+		quat_normalize( &expected );
+		quat_t actual = quat_array_get( &array, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	quat_array_destroy( &array );
+	return result;
+}
+
+bool test_quat_array_nlerp( void )
+{
+	quat_t a[ QUAT_ARRAY_TEST_COUNT ];
+	quat_t b[ QUAT_ARRAY_TEST_COUNT ];
+	quat_array_t array_a;
+	quat_array_t array_b;
+	quat_array_t array_r;
+	bool result = true;
+
+	quat_fill( a, QUAT_ARRAY_TEST_COUNT );
+	quat_fill( b, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_a, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_b, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_r, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_a, a, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_b, b, QUAT_ARRAY_TEST_COUNT );
+
+	quat_array_nlerp( &array_r, &array_a, &array_b, 0.3 );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t expected = reference_nlerp( &a[ i ], &b[ i ], 0.3 );
+		quat_t actual   = quat_array_get( &array_r, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	/* The result may alias an input. */
+	quat_array_nlerp( &array_b, &array_a, &array_b, 0.3 );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t expected = quat_array_get( &array_r, i );
+		quat_t actual   = quat_array_get( &array_b, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	quat_array_destroy( &array_a );
+	quat_array_destroy( &array_b );
+	quat_array_destroy( &array_r );
+	return result;
+}
+
+bool test_quat_array_slerp( void )
+{
+	const double ts[] = { 0.0, 0.25, 0.5, 0.9, 1.0, -0.5, 1.5 };
+	quat_t a[ QUAT_ARRAY_TEST_COUNT ];
+	quat_t b[ QUAT_ARRAY_TEST_COUNT ];
+	quat_array_t array_a;
+	quat_array_t array_b;
+	quat_array_t array_r;
+	bool result = true;
+
+	quat_fill( a, QUAT_ARRAY_TEST_COUNT );
+	quat_fill( b, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_a, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_b, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_r, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_a, a, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_b, b, QUAT_ARRAY_TEST_COUNT );
+
+	for( size_t k = 0; result && k < sizeof(ts) / sizeof(ts[0]); k++ )
+	{
+		quat_array_slerp( &array_r, &array_a, &array_b, ts[ k ] );
+
+		for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+		{
+			quat_t expected = reference_slerp( &a[ i ], &b[ i ], ts[ k ] );
+			quat_t actual   = quat_array_get( &array_r, i );
+			result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE ) &&
+			         fabs( (double) quat_magnitude( &actual ) - 1.0 ) < QUAT_ARRAY_TOLERANCE;
+		}
+	}
+
+	/* Where the quaternions are on the same side, it is quat_slerp(). */
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		if( quat_dot_product( &a[ i ], &b[ i ] ) < 0 )
+		{
+			quat_scale( &b[ i ], -1 );
+		}
+		quat_array_set( &array_b, i, &b[ i ] );
+	}
+	quat_array_slerp( &array_a, &array_a, &array_b, 0.7 );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t expected = quat_slerp( &a[ i ], &b[ i ], 0.7 );
+		quat_t actual   = quat_array_get( &array_a, i );
+		result = quat_close( &expected, &actual, 0.0001 );
+	}
+
+	quat_array_destroy( &array_a );
+	quat_array_destroy( &array_b );
+	quat_array_destroy( &array_r );
+	return result;
+}
+
+bool test_quat_array_slerp_edges( void )
+{
+	const scaler_t angle = 1e-4;
+	quat_t a[ 4 ];
+	quat_t b[ 4 ];
+	quat_array_t array_a;
+	quat_array_t array_b;
+	bool result = true;
+
+	quat_fill( a, 4 );
+	b[ 0 ] = a[ 0 ];                         /* the same rotation */
+	b[ 1 ] = a[ 1 ];                         /* the same rotation, other side */
+	quat_scale( &b[ 1 ], -1 );
+	b[ 2 ] = QUAT( 0, 0, scaler_sin( angle ), scaler_cos( angle ) ); /* nearly the same */
+	a[ 2 ] = QUAT_WUNIT;
+	b[ 3 ] = QUAT( 1, 0, 0, 0 );             /* half a turn apart */
+	a[ 3 ] = QUAT_WUNIT;
+
+	quat_array_create( &array_a, 4 );
+	quat_array_create( &array_b, 4 );
+	quat_array_from_quat( &array_a, a, 4 );
+	quat_array_from_quat( &array_b, b, 4 );
+	quat_array_slerp( &array_b, &array_a, &array_b, 0.25 );
+
+	for( size_t i = 0; result && i < 4; i++ )
+	{
+		quat_t expected = reference_slerp( &a[ i ], &b[ i ], 0.25 );
+		quat_t actual   = quat_array_get( &array_b, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	quat_array_destroy( &array_a );
+	quat_array_destroy( &array_b );
+	return result;
+}
+
+bool test_quat_array_blend( void )
+{
+	quat_t a[ QUAT_ARRAY_TEST_COUNT ];
+	quat_t b[ QUAT_ARRAY_TEST_COUNT ];
+	quat_t c[ QUAT_ARRAY_TEST_COUNT ];
+	scaler_t mask[ QUAT_ARRAY_TEST_COUNT ];
+	quat_array_t array_a;
+	quat_array_t array_b;
+	quat_array_t array_c;
+	quat_array_t array_r;
+	bool result = true;
+
+	quat_fill( a, QUAT_ARRAY_TEST_COUNT );
+	quat_fill( b, QUAT_ARRAY_TEST_COUNT );
+	quat_fill( c, QUAT_ARRAY_TEST_COUNT );
+	for( size_t i = 0; i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		mask[ i ] = (i % 3) * 0.5;
+	}
+	quat_array_create( &array_a, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_b, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_c, QUAT_ARRAY_TEST_COUNT );
+	quat_array_create( &array_r, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_a, a, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_b, b, QUAT_ARRAY_TEST_COUNT );
+	quat_array_from_quat( &array_c, c, QUAT_ARRAY_TEST_COUNT );
+
+	/* Two layers are nlerp. */
+	quat_array_layer_t pair[] = {
+		{ &array_a, 0.6, NULL },
+		{ &array_b, 0.4, NULL },
+	};
+	quat_array_blend( &array_r, pair, 2, true );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t expected = reference_nlerp( &a[ i ], &b[ i ], 0.4 );
+		quat_t actual   = quat_array_get( &array_r, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	/* Masked layers, without renormalization, into the first pose. */
+	quat_array_layer_t layers[] = {
+		{ &array_a, 0.0, NULL },
+		{ &array_b, 1.0, mask },
+		{ &array_c, 0.5, NULL },
+	};
+	quat_array_blend( &array_a, layers, 3, false );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		double wb = mask[ i ];
+		double wc = 0.5;
+		double sb = quat_dot_product( &a[ i ], &b[ i ] ) < 0 ? -wb : wb;
+		double sc = quat_dot_product( &a[ i ], &c[ i ] ) < 0 ? -wc : wc;
+		double total = wb + wc;
+		quat_t expected = QUAT( (sb * b[ i ].x + sc * c[ i ].x) / total, (sb * b[ i ].y + sc * c[ i ].y) / total,
+		                        (sb * b[ i ].z + sc * c[ i ].z) / total, (sb * b[ i ].w + sc * c[ i ].w) / total );
+		quat_t actual = quat_array_get( &array_a, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	/* Rotations with no weight are the identity. */
+	quat_array_layer_t masked[] = {
+		{ &array_b, 1.0, mask },
+	};
+	quat_array_blend( &array_r, masked, 1, true );
+
+	for( size_t i = 0; result && i < QUAT_ARRAY_TEST_COUNT; i++ )
+	{
+		quat_t expected = i % 3 ? b[ i ] : QUAT_WUNIT;
+		quat_t actual   = quat_array_get( &array_r, i );
+		result = quat_close( &expected, &actual, QUAT_ARRAY_TOLERANCE );
+	}
+
+	quat_array_destroy( &array_a );
+	quat_array_destroy( &array_b );
+	quat_array_destroy( &array_c );
+	quat_array_destroy( &array_r );
+	return result;
+}
@@ -20,37 +20,376 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <time.h>
-#include <assert.h>
-#include "../src/mathematics.h"
+#include "../src/random.h"
+#include "test.h"
 
-#define MAX  40
+bool test_random_reference    ( void );
+bool test_random_seed         ( void );
+bool test_random_jump         ( void );
+bool test_random_uniform      ( void );
+bool test_random_range        ( void );
+bool test_random_guassian     ( void );
+bool test_random_fill_uniform ( void );
+bool test_random_fill_guassian( void );
+bool test_random_fill_shapes  ( void );
+bool test_random_default      ( void );
 
+const test_feature_t random_tests[] = {
+	{ "Testing xoshiro256** reference output", test_random_reference },
+	{ "Testing random seeding", test_random_seed },
+	{ "Testing random jump ahead", test_random_jump },
+	{ "Testing random uniform distribution", test_random_uniform },
+	{ "Testing random integer ranges", test_random_range },
+	{ "Testing random guassian distribution", test_random_guassian },
+	{ "Testing random uniform fills", test_random_fill_uniform },
+	{ "Testing random guassian fills", test_random_fill_guassian },
+	{ "Testing random disk, sphere and ball fills", test_random_fill_shapes },
+	{ "Testing default random state", test_random_default },
+};
+
+size_t random_test_suite_size( void )
+{
+	return sizeof(random_tests) / sizeof(random_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
+	bool result = test_features( "Random Numbers", random_tests, random_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+bool test_random_reference( void )
+{
+	/* From the reference implementation with the state {1, 2, 3, 4}. */
+	m3d_random_t r = { .s = { 1, 2, 3, 4 } };
+
+	return m3d_random_next( &r ) == 0x2d00ULL &&
+	       m3d_random_next( &r ) == 0x0ULL &&
+	       m3d_random_next( &r ) == 0x5a007080ULL &&
+	       m3d_random_next( &r ) == 0x10e0000000009d80ULL;
+}
+
+bool test_random_seed( void )
+{
+	m3d_random_t a, b, c;
+	m3d_random_seed( &a, 42 );
+	m3d_random_seed( &b, 42 );
+	m3d_random_seed( &c, 43 );
+	bool same      = true;
+	bool different = false;
+
+	for( int i = 0; i < 100; i++ )
+	{
+		uint64_t x = m3d_random_next( &a );
+		same      = same && x == m3d_random_next( &b );
+		different = different || x != m3d_random_next( &c );
+	}
+
+	return same && different;
+}
+
+bool test_random_jump( void )
+{
+	m3d_random_t a, b, c;
+	m3d_random_seed( &a, 7 );
+	b = a;
+	c = a;
+	m3d_random_jump( &b );
+	m3d_random_long_jump( &c );
+
+	m3d_random_t d = a;
+	m3d_random_jump( &d );
+
+	bool deterministic = true;
+	bool different     = true;
+	for( int i = 0; i < 100; i++ )
+	{
+		uint64_t x = m3d_random_next( &a );
+		uint64_t y = m3d_random_next( &b );
+		uint64_t z = m3d_random_next( &c );
+		deterministic = deterministic && y == m3d_random_next( &d );
+		different     = different && x != y && x != z && y != z;
+	}
+
+	return deterministic && different;
+}
+
+bool test_random_uniform( void )
+{
+	m3d_random_t r;
+	m3d_random_seed( &r, 1 );
+	const int count = 100000;
+	double sum = 0;
+
+	for( int i = 0; i < count; i++ )
+	{
+		float f       = m3d_random_uniformf( &r );
+		double d      = m3d_random_uniformd( &r );
+		long double l = m3d_random_uniformld( &r );
+		double u      = m3d_random_unitd( &r );
+
+		if( f < 0.0f || f >= 1.0f || d < 0.0 || d >= 1.0 || l < 0.0L || l >= 1.0L || u < -1.0 || u >= 1.0 )
+		{
+			return false;
+		}
+		sum += d;
+	}
+
+	return fabs( sum / count - 0.5 ) < 0.01;
+}
+
+bool test_random_range( void )
+{
+	m3d_random_t r;
+	m3d_random_seed( &r, 2 );
+	int hits[ 71 ] = { 0 };
+
+	for( int i = 0; i < 100000; i++ )
+	{
+		int n = m3d_random_rangei( &r, 30, 100 );
+		if( n < 30 || n > 100 ) return false;
+		hits[ n - 30 ] += 1;
+	}
+
+	/* Every value, including both ends, comes up. */
+	for( int i = 0; i < 71; i++ )
+	{
+		if( hits[ i ] == 0 ) return false;
+	}
+
+	bool extremes = m3d_random_bounded( &r, 0 ) == 0 &&
+	                m3d_random_rangei( &r, INT_MIN, INT_MIN ) == INT_MIN &&
+	                m3d_random_rangel( &r, LONG_MAX, LONG_MAX ) == LONG_MAX;
+
+	for( int i = 0; extremes && i < 1000; i++ )
+	{
+		int n  = m3d_random_rangei( &r, INT_MIN, INT_MAX );
+		long l = m3d_random_rangel( &r, -5, 5 );
+		extremes = n >= INT_MIN && n <= INT_MAX && l >= -5 && l <= 5;
+	}
+
+	return extremes;
+}
+
+bool test_random_guassian( void )
+{
+	m3d_random_t r;
+	m3d_random_seed( &r, 3 );
+	const int count = 100000;
+	double sum = 0;
+	double sum_squares = 0;
+
+	for( int i = 0; i < count; i++ )
+	{
+		double x = m3d_random_guassiand( &r, 5.0, 2.0 );
+		sum += x;
+		sum_squares += x * x;
+	}
+
+	double mean   = sum / count;
+	double stddev = sqrt( sum_squares / count - mean * mean );
+
+	return fabs( mean - 5.0 ) < 0.03 &&
+	       fabs( stddev - 2.0 ) < 0.03;
+}
+
+bool test_random_default( void )
+{
+	m3d_seed( 1234 );
+	double a = m3d_uniformd( );
+	float b  = m3d_guassianf( 0, 1 );
+
+	m3d_seed( 1234 );
+	double c = m3d_uniformd( );
+	float d  = m3d_guassianf( 0, 1 );
+
+	m3d_random_t r;
+	m3d_random_seed( &r, 1234 );
+	bool passed = a == c && b == d && a == m3d_random_uniformd( &r );
+
+	m3d_seed( time(NULL) );
+	return passed;
+}
+
+bool test_random_fill_uniform( void )
+{
+	/* Odd sizes around the block size exercise the remainder paths. */
+	const size_t sizes[] = { 0, 1, 31, 32, 511, 512, 513, 100003 };
+	const size_t count = 100003;
+	float* f  = malloc( count * sizeof(float) );
+	double* d = malloc( count * sizeof(double) );
+	int* n    = malloc( count * sizeof(int) );
+	bool result = f && d && n;
+	m3d_random_t r;
+	m3d_random_seed( &r, 4 );
+
+	for( size_t k = 0; result && k < sizeof(sizes) / sizeof(sizes[0]); k++ )
+	{
+		m3d_fill_rangef( &r, f, sizes[ k ], -2.0f, 3.0f );
+		m3d_fill_ranged( &r, d, sizes[ k ], -2.0, 3.0 );
+		m3d_fill_rangei( &r, n, sizes[ k ], -3, 3 );
+
+		double sum_f = 0;
+		double sum_d = 0;
+		int counts[ 7 ] = { 0 };
+
+		for( size_t i = 0; result && i < sizes[ k ]; i++ )
+		{
+			result = f[ i ] >= -2.0f && f[ i ] < 3.0f &&
+			         d[ i ] >= -2.0 && d[ i ] < 3.0 &&
+			         n[ i ] >= -3 && n[ i ] <= 3;
+			sum_f += f[ i ];
+			sum_d += d[ i ];
+			if( result ) counts[ n[ i ] + 3 ] += 1;
+		}
+
+		if( result && sizes[ k ] == count )
+		{
+			result = fabs( sum_f / count - 0.5 ) < 0.02 &&
+			         fabs( sum_d / count - 0.5 ) < 0.02;
+
+			for( int i = 0; result && i < 7; i++ )
+			{
+				result = abs( counts[ i ] - (int) (count / 7) ) < 600;
+			}
+		}
+	}
+
+	/* The same state gives the same fill. */
+	if( result )
+	{
+		m3d_random_t a;
+		m3d_random_t b;
+		m3d_random_seed( &a, 5 );
+		m3d_random_seed( &b, 5 );
+		m3d_fill_uniformd( &a, d, 1000 );
+		double first = d[ 999 ];
+		m3d_fill_uniformd( &b, d, 1000 );
+		result = d[ 999 ] == first;
+	}
+
+	free( f );
+	free( d );
+	free( n );
+	return result;
+}
+
+bool test_random_fill_guassian( void )
+{
+	const size_t count = 200000;
+	double* d = malloc( count * sizeof(double) );
+	float* f  = malloc( count * sizeof(float) );
+	bool result = d && f;
 
-	for( int i = 0; i < 10; i++ )
+	if( result )
 	{
-		float r = m3d_uniform_unitf( );
-		assert( r >= -1.0f && r <= 1.0f );
-		printf( "uniform random = %.3f\n", r );
+		m3d_random_t r;
+		m3d_random_seed( &r, 6 );
+		m3d_fill_guassiand( &r, d, count, 5.0, 2.0 );
+		m3d_fill_guassianf( &r, f, count, -1.0f, 0.5f );
+
+		double sum = 0, sum_squares = 0, sum_f = 0, sum_squares_f = 0;
+		size_t tail = 0;
+		size_t within_one = 0;
+
+		for( size_t i = 0; i < count; i++ )
+		{
+			double z = (d[ i ] - 5.0) / 2.0;
+			sum += z;
+			sum_squares += z * z;
+			sum_f += f[ i ];
+			sum_squares_f += (double) f[ i ] * f[ i ];
+			if( fabs( z ) > 3.5 ) tail += 1;
+			if( fabs( z ) < 1.0 ) within_one += 1;
+		}
+
+		double mean     = sum / count;
+		double stddev   = sqrt( sum_squares / count - mean * mean );
+		double mean_f   = sum_f / count;
+		double stddev_f = sqrt( sum_squares_f / count - mean_f * mean_f );
+
+		/* P(|z| > 3.5) = 4.65e-4, which lies beyond the Ziggurat's base
+		 * strip, and P(|z| < 1) = 0.6827. */
+		result = fabs( mean ) < 0.01 &&
+		         fabs( stddev - 1.0 ) < 0.01 &&
+		         fabs( mean_f + 1.0 ) < 0.005 &&
+		         fabs( stddev_f - 0.5 ) < 0.005 &&
+		         tail > 60 && tail < 130 &&
+		         fabs( (double) within_one / count - 0.6827 ) < 0.005;
 	}
 
-	for( int i = 0; i < 10; i++ )
+	free( d );
+	free( f );
+	return result;
+}
+
+bool test_random_fill_shapes( void )
+{
+	const size_t count = 20000;
+	vec3_t* v = malloc( count * sizeof(vec3_t) );
+	vec2_t* p = malloc( count * sizeof(vec2_t) );
+	bool result = v && p;
+	m3d_random_t r;
+	m3d_random_seed( &r, 7 );
+
+	if( result )
 	{
-		float r = m3d_guassianf( 0, 2.0 );
-		printf( "guassian random = %.3f\n", r );
+		vec3_t sum = VEC3( 0, 0, 0 );
+		m3d_fill_unit_vec3( &r, v, count );
+
+		for( size_t i = 0; result && i < count; i++ )
+		{
+			scaler_t length = sqrt( v[ i ].x * v[ i ].x + v[ i ].y * v[ i ].y + v[ i ].z * v[ i ].z );
+			result = fabs( length - 1 ) < 1e-5;
+			sum.x += v[ i ].x;
+			sum.y += v[ i ].y;
+			sum.z += v[ i ].z;
+		}
+
+		result = result &&
+		         fabs( sum.x / count ) < 0.02 &&
+		         fabs( sum.y / count ) < 0.02 &&
+		         fabs( sum.z / count ) < 0.02;
 	}
 
-	for( int i = 0; i < 10; i++ )
+	if( result )
 	{
-		int r = m3d_uniform_rangei( 30, 100 );
-		assert( r >= 30 && r <= 100 );
-		printf( "random integer between 30 and 100 = %d\n", r );
+		size_t inner = 0;
+		m3d_fill_in_disk( &r, p, count, 2 );
+
+		for( size_t i = 0; result && i < count; i++ )
+		{
+			scaler_t d2 = p[ i ].x * p[ i ].x + p[ i ].y * p[ i ].y;
+			result = d2 < 4;
+			if( d2 < 1 ) inner += 1;
+		}
+
+		/* A quarter of the area lies within half the radius. */
+		result = result && fabs( (double) inner / count - 0.25 ) < 0.02;
 	}
 
+	if( result )
+	{
+		size_t inner = 0;
+		m3d_fill_in_sphere( &r, v, count, 2 );
+
+		for( size_t i = 0; result && i < count; i++ )
+		{
+			scaler_t d2 = v[ i ].x * v[ i ].x + v[ i ].y * v[ i ].y + v[ i ].z * v[ i ].z;
+			result = d2 < 4;
+			if( d2 < 1 ) inner += 1;
+		}
+
+		/* An eighth of the volume lies within half the radius. */
+		result = result && fabs( (double) inner / count - 0.125 ) < 0.015;
+	}
 
-	printf( "done.\n" );
-	return 0;
+	free( v );
+	free( p );
+	return result;
 }
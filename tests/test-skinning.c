@@ -0,0 +1,189 @@
+/* Copyright (C) 2013-2015 by Joseph A. Marrero, http://www.manvscode.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "../src/quat.h"
+#include "../src/transforms.h"
+#include "../src/skinning.h"
+#include "test.h"
+
+/* More than two blocks of joints, the last one partial. */
+#define SKINNING_TEST_JOINTS   (150)
+
+bool test_skinning_palette_mat4     ( void );
+bool test_skinning_palette_mat3x4   ( void );
+bool test_skinning_palette_bind_pose( void );
+
+const test_feature_t skinning_tests[] = {
+	{ "Testing skinning palette as mat4",      test_skinning_palette_mat4 },
+	{ "Testing skinning palette as mat3x4",    test_skinning_palette_mat3x4 },
+	{ "Testing skinning palette in bind pose", test_skinning_palette_bind_pose },
+};
+
+size_t skinning_test_suite_size( void )
+{
+	return sizeof(skinning_tests) / sizeof(skinning_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	bool result = test_features( "Skinning Functions", skinning_tests, skinning_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+typedef struct skeleton {
+	int parents[ SKINNING_TEST_JOINTS ];
+	quat_t rotations[ SKINNING_TEST_JOINTS ];
+	vec3_t translations[ SKINNING_TEST_JOINTS ];
+	vec3_t scales[ SKINNING_TEST_JOINTS ];
+	mat4_t inverse_binds[ SKINNING_TEST_JOINTS ];
+	quat_array_t rotation_array;
+	vec3_array_t translation_array;
+	vec3_array_t scale_array;
+} skeleton_t;
+
+static void skeleton_create( skeleton_t* s )
+{
+	for( size_t i = 0; i < SKINNING_TEST_JOINTS; i++ )
+	{
+		/* Mostly chains, with a few branches and a second root. */
+		s->parents[ i ] = i == 0 || i == 70 ? -1 : (i % 5 == 0 ? m3d_uniform_rangei( 0, i - 1 ) : (int) i - 1);
+
+		vec3_t axis = VEC3( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+		vec3_normalize( &axis );
+		s->rotations[ i ]    = quat_from_axis3_angle( &axis, m3d_uniform_rangef( -0.5, 0.5 ) );
+		s->translations[ i ] = VEC3( m3d_uniform_rangef( -0.2, 0.2 ), m3d_uniform_rangef( 0, 0.3 ), m3d_uniform_rangef( -0.2, 0.2 ) );
+		s->scales[ i ]       = VEC3( m3d_uniform_rangef( 0.98, 1.02 ), m3d_uniform_rangef( 0.98, 1.02 ), m3d_uniform_rangef( 0.98, 1.02 ) );
+
+		vec3_t offset = VEC3( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ) );
+		s->inverse_binds[ i ] = m3d_translate( &offset );
+	}
+
+	quat_array_create( &s->rotation_array, SKINNING_TEST_JOINTS );
+	vec3_array_create( &s->translation_array, SKINNING_TEST_JOINTS );
+	vec3_array_create( &s->scale_array, SKINNING_TEST_JOINTS );
+	quat_array_from_quat( &s->rotation_array, s->rotations, SKINNING_TEST_JOINTS );
+	vec3_array_from_vec3( &s->translation_array, s->translations, SKINNING_TEST_JOINTS );
+	vec3_array_from_vec3( &s->scale_array, s->scales, SKINNING_TEST_JOINTS );
+}
+
+static void skeleton_destroy( skeleton_t* s )
+{
+	quat_array_destroy( &s->rotation_array );
+	vec3_array_destroy( &s->translation_array );
+	vec3_array_destroy( &s->scale_array );
+}
+
+/* The world matrices from one joint at a time, with the scalar functions. */
+static void skeleton_world( const skeleton_t* s, bool scaled, mat4_t world[] )
+{
+	for( size_t i = 0; i < SKINNING_TEST_JOINTS; i++ )
+	{
+		mat4_t T = m3d_translate( &s->translations[ i ] );
+		mat4_t R = quat_to_mat4( &s->rotations[ i ] );
+		mat4_t S = scaled ? m3d_scale( &s->scales[ i ] ) : MAT4_IDENTITY;
+		mat4_t TR = mat4_mult_matrix( &T, &R );
+		mat4_t local = mat4_mult_matrix( &TR, &S );
+
+		world[ i ] = s->parents[ i ] >= 0 ? mat4_mult_matrix( &world[ s->parents[ i ] ], &local ) : local;
+	}
+}
+
+static bool test_skinning_palette( skinning_layout_t layout, bool scaled )
+{
+	const size_t floats = skinning_palette_size( layout, 1 ) / sizeof(float);
+	skeleton_t s;
+	mat4_t expected[ SKINNING_TEST_JOINTS ];
+	mat4_t world[ SKINNING_TEST_JOINTS ];
+	float* palette = malloc( skinning_palette_size( layout, SKINNING_TEST_JOINTS ) );
+	bool result = palette != NULL && (floats == 12 || floats == 16);
+
+	skeleton_create( &s );
+	skeleton_world( &s, scaled, expected );
+	skinning_palette_build( s.parents, &s.rotation_array, &s.translation_array, scaled ? &s.scale_array : NULL,
+	                        s.inverse_binds, world, palette, layout );
+
+	for( size_t i = 0; result && i < SKINNING_TEST_JOINTS; i++ )
+	{
+		mat4_t skin = mat4_mult_matrix( &expected[ i ], &s.inverse_binds[ i ] );
+		const float* p = palette + i * floats;
+
+		for( size_t k = 0; result && k < 16; k++ )
+		{
+			result = fabs( (double) (world[ i ].m[ k ] - expected[ i ].m[ k ]) ) < 1e-4;
+		}
+		for( size_t r = 0; result && r < (floats == 12 ? 3 : 4); r++ )
+		{
+			for( size_t c = 0; result && c < 4; c++ )
+			{
+				float value = floats == 12 ? p[ 4 * r + c ] : p[ 4 * c + r ];
+				result = fabs( value - (double) skin.m[ 4 * c + r ] ) < 1e-4;
+			}
+		}
+	}
+
+	skeleton_destroy( &s );
+	free( palette );
+	return result;
+}
+
+bool test_skinning_palette_mat4( void )
+{
+	return test_skinning_palette( SKINNING_LAYOUT_MAT4, true ) &&
+	       test_skinning_palette( SKINNING_LAYOUT_MAT4, false );
+}
+
+bool test_skinning_palette_mat3x4( void )
+{
+	return test_skinning_palette( SKINNING_LAYOUT_MAT3X4, true ) &&
+	       test_skinning_palette( SKINNING_LAYOUT_MAT3X4, false );
+}
+
+bool test_skinning_palette_bind_pose( void )
+{
+	skeleton_t s;
+	mat4_t world[ SKINNING_TEST_JOINTS ];
+	float palette[ 16 * SKINNING_TEST_JOINTS ];
+	bool result = true;
+
+	/* With the pose as the bind pose, every skinning matrix is the identity. */
+	skeleton_create( &s );
+	skeleton_world( &s, true, s.inverse_binds );
+	for( size_t i = 0; i < SKINNING_TEST_JOINTS; i++ )
+	{
+		mat4_invert_affine( &s.inverse_binds[ i ] );
+	}
+	skinning_palette_build( s.parents, &s.rotation_array, &s.translation_array, &s.scale_array,
+	                        s.inverse_binds, world, palette, SKINNING_LAYOUT_MAT4 );
+
+	for( size_t i = 0; result && i < 16 * SKINNING_TEST_JOINTS; i++ )
+	{
+		result = fabs( palette[ i ] - (double) MAT4_IDENTITY.m[ i % 16 ] ) < 1e-4;
+	}
+
+	skeleton_destroy( &s );
+	return result;
+}
@@ -0,0 +1,311 @@
+/* Copyright (C) 2013-2015 by Joseph A. Marrero, http://www.manvscode.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "../src/transforms.h"
+#include "../src/transform-hierarchy.h"
+#include "test.h"
+
+/* A few hundred nodes in chains and branches, and a forest with a level
+ * wide enough to be split across threads. */
+#define HIERARCHY_TEST_NODES   (300)
+#define HIERARCHY_TEST_WIDE    (TRANSFORM_HIERARCHY_PARALLEL_COUNT + 1000)
+
+bool test_transform_hierarchy_order       ( void );
+bool test_transform_hierarchy_update      ( void );
+bool test_transform_hierarchy_incremental ( void );
+bool test_transform_hierarchy_parallel    ( void );
+bool test_transform_hierarchy_invalid     ( void );
+
+const test_feature_t transform_hierarchy_tests[] = {
+	{ "Testing transform hierarchy order",          test_transform_hierarchy_order },
+	{ "Testing transform hierarchy update",         test_transform_hierarchy_update },
+	{ "Testing transform hierarchy dirty subtrees", test_transform_hierarchy_incremental },
+	{ "Testing transform hierarchy wide levels",    test_transform_hierarchy_parallel },
+	{ "Testing transform hierarchy invalid parents", test_transform_hierarchy_invalid },
+};
+
+size_t transform_hierarchy_test_suite_size( void )
+{
+	return sizeof(transform_hierarchy_tests) / sizeof(transform_hierarchy_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	bool result = test_features( "Transform Hierarchy Functions", transform_hierarchy_tests, transform_hierarchy_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+/*
+ * A random forest of count nodes, with ids shuffled so that parents come
+ * after their children as often as not. Built with every parent before
+ * its child, then relabeled.
+ */
+static void random_forest( int parents[], size_t count, size_t roots )
+{
+	int* ordered = malloc( count * sizeof(int) );
+	int* ids     = malloc( count * sizeof(int) );
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		ordered[ i ] = i < roots ? -1 : (i % 4 == 0 ? m3d_uniform_rangei( 0, i - 1 ) : (int) i - 1);
+		ids[ i ] = (int) i;
+	}
+	for( size_t i = count - 1; i > 0; i-- )
+	{
+		size_t j = m3d_uniform_rangei( 0, i );
+		int t = ids[ i ]; ids[ i ] = ids[ j ]; ids[ j ] = t;
+	}
+	for( size_t i = 0; i < count; i++ )
+	{
+		parents[ ids[ i ] ] = ordered[ i ] < 0 ? -1 : ids[ ordered[ i ] ];
+	}
+
+	free( ordered );
+	free( ids );
+}
+
+static mat4_t random_local( void )
+{
+	vec3_t axis = VEC3( m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( -1, 1 ), m3d_uniform_rangef( 0.5, 1 ) );
+	vec3_t t    = VEC3( m3d_uniform_rangef( -0.1, 0.1 ), m3d_uniform_rangef( -0.1, 0.1 ), m3d_uniform_rangef( -0.1, 0.1 ) );
+	vec3_normalize( &axis );
+
+	mat4_t R = mat4_from_axis3_angle( &axis, m3d_uniform_rangef( -0.3, 0.3 ) );
+	mat4_t T = m3d_translate( &t );
+	return mat4_mult_matrix( &T, &R );
+}
+
+/* The world matrix of id from scratch, by walking up to its root. */
+static mat4_t reference_world( const int parents[], const mat4_t locals[], size_t id )
+{
+	mat4_t world = locals[ id ];
+	for( int p = parents[ id ]; p >= 0; p = parents[ p ] )
+	{
+		world = mat4_mult_matrix( &locals[ p ], &world );
+	}
+	return world;
+}
+
+static bool worlds_match( const transform_hierarchy_t* h, const int parents[], const mat4_t locals[], size_t count )
+{
+	bool result = true;
+	for( size_t id = 0; result && id < count; id++ )
+	{
+		const mat4_t expected = reference_world( parents, locals, id );
+		const mat4_t* world   = transform_hierarchy_world( h, id );
+
+		for( size_t k = 0; result && k < 16; k++ )
+		{
+			result = fabs( (double) (world->m[ k ] - expected.m[ k ]) ) < 1e-4;
+		}
+	}
+	return result;
+}
+
+static void set_random_locals( transform_hierarchy_t* h, mat4_t locals[], size_t count )
+{
+	for( size_t id = 0; id < count; id++ )
+	{
+		locals[ id ] = random_local( );
+		transform_hierarchy_set_local( h, id, &locals[ id ] );
+	}
+}
+
+bool test_transform_hierarchy_order( void )
+{
+	int parents[ HIERARCHY_TEST_NODES ];
+	transform_hierarchy_t h;
+	size_t depths[ HIERARCHY_TEST_NODES ];
+
+	random_forest( parents, HIERARCHY_TEST_NODES, 3 );
+	bool result = transform_hierarchy_create( &h, parents, HIERARCHY_TEST_NODES ) &&
+	              transform_hierarchy_count( &h ) == HIERARCHY_TEST_NODES;
+
+	/* Parents come first, depths never decrease, and the children of a
+	 * node are contiguous, in the order of their parents. */
+	const size_t* ids = transform_hierarchy_ids( &h );
+	size_t last_parent = 0;
+	for( size_t slot = 0; result && slot < HIERARCHY_TEST_NODES; slot++ )
+	{
+		const size_t id = ids[ slot ];
+		result = transform_hierarchy_slot( &h, id ) == slot;
+
+		if( parents[ id ] < 0 )
+		{
+			depths[ slot ] = 0;
+			result = result && (slot == 0 || depths[ slot - 1 ] == 0);
+		}
+		else
+		{
+			const size_t parent = transform_hierarchy_slot( &h, parents[ id ] );
+			depths[ slot ] = depths[ parent ] + 1;
+			result = result && parent < slot && depths[ slot ] >= depths[ slot - 1 ] && parent >= last_parent;
+			last_parent = parent;
+		}
+	}
+
+	transform_hierarchy_destroy( &h );
+	return result;
+}
+
+bool test_transform_hierarchy_update( void )
+{
+	int parents[ HIERARCHY_TEST_NODES ];
+	mat4_t locals[ HIERARCHY_TEST_NODES ];
+	transform_hierarchy_t h;
+
+	random_forest( parents, HIERARCHY_TEST_NODES, 3 );
+	bool result = transform_hierarchy_create( &h, parents, HIERARCHY_TEST_NODES );
+
+	/* Everything starts dirty, with identity locals. */
+	result = result && transform_hierarchy_update( &h ) == HIERARCHY_TEST_NODES;
+	for( size_t k = 0; result && k < 16; k++ )
+	{
+		result = transform_hierarchy_world( &h, HIERARCHY_TEST_NODES - 1 )->m[ k ] == MAT4_IDENTITY.m[ k ];
+	}
+
+	set_random_locals( &h, locals, HIERARCHY_TEST_NODES );
+	result = result && transform_hierarchy_update( &h ) == HIERARCHY_TEST_NODES &&
+	         worlds_match( &h, parents, locals, HIERARCHY_TEST_NODES ) &&
+	         transform_hierarchy_update( &h ) == 0;
+
+	/* The world matrices are the same array, by slot. */
+	const mat4_t* worlds = transform_hierarchy_worlds( &h );
+	const size_t* ids    = transform_hierarchy_ids( &h );
+	for( size_t slot = 0; result && slot < HIERARCHY_TEST_NODES; slot++ )
+	{
+		result = &worlds[ slot ] == transform_hierarchy_world( &h, ids[ slot ] ) &&
+		         transform_hierarchy_local( &h, ids[ slot ] )->m[ 12 ] == locals[ ids[ slot ] ].m[ 12 ];
+	}
+
+	transform_hierarchy_destroy( &h );
+	return result;
+}
+
+/* The number of nodes in the subtree of id, which are what changes. */
+static size_t subtree_size( const int parents[], size_t count, size_t id, const bool marked[] )
+{
+	size_t size = 0;
+	for( size_t other = 0; other < count; other++ )
+	{
+		bool below = false;
+		for( int p = (int) other; !below && p >= 0; p = parents[ p ] )
+		{
+			below = (size_t) p == id || (marked && marked[ p ]);
+		}
+		size += below;
+	}
+	return size;
+}
+
+bool test_transform_hierarchy_incremental( void )
+{
+	int parents[ HIERARCHY_TEST_NODES ];
+	mat4_t locals[ HIERARCHY_TEST_NODES ];
+	bool marked[ HIERARCHY_TEST_NODES ] = { false };
+	transform_hierarchy_t h;
+
+	random_forest( parents, HIERARCHY_TEST_NODES, 3 );
+	bool result = transform_hierarchy_create( &h, parents, HIERARCHY_TEST_NODES );
+	set_random_locals( &h, locals, HIERARCHY_TEST_NODES );
+	transform_hierarchy_update( &h );
+
+	/* One node, then a few, with one inside another's subtree. */
+	const size_t one = m3d_uniform_rangei( 0, HIERARCHY_TEST_NODES - 1 );
+	locals[ one ] = random_local( );
+	transform_hierarchy_set_local( &h, one, &locals[ one ] );
+	result = result && transform_hierarchy_update( &h ) == subtree_size( parents, HIERARCHY_TEST_NODES, one, NULL ) &&
+	         worlds_match( &h, parents, locals, HIERARCHY_TEST_NODES );
+
+	for( size_t k = 0; k < 5; k++ )
+	{
+		const size_t id = m3d_uniform_rangei( 0, HIERARCHY_TEST_NODES - 1 );
+		locals[ id ] = random_local( );
+		marked[ id ] = true;
+		transform_hierarchy_set_local( &h, id, &locals[ id ] );
+	}
+	if( parents[ one ] >= 0 )
+	{
+		marked[ parents[ one ] ] = true;
+		transform_hierarchy_set_local( &h, parents[ one ], &locals[ parents[ one ] ] );
+	}
+	result = result && transform_hierarchy_update( &h ) == subtree_size( parents, HIERARCHY_TEST_NODES, HIERARCHY_TEST_NODES, marked ) &&
+	         worlds_match( &h, parents, locals, HIERARCHY_TEST_NODES );
+
+	transform_hierarchy_destroy( &h );
+	return result;
+}
+
+bool test_transform_hierarchy_parallel( void )
+{
+	/* Ten roots with a wide level of children each and a few grandchildren. */
+	int* parents   = malloc( HIERARCHY_TEST_WIDE * sizeof(int) );
+	mat4_t* locals = malloc( HIERARCHY_TEST_WIDE * sizeof(mat4_t) );
+	transform_hierarchy_t h;
+	bool result = parents && locals;
+
+	for( size_t id = 0; result && id < HIERARCHY_TEST_WIDE; id++ )
+	{
+		parents[ id ] = id < 10 ? -1 : (id < HIERARCHY_TEST_WIDE - 100 ? (int) (id % 10) : (int) (id - 500));
+	}
+	result = result && transform_hierarchy_create( &h, parents, HIERARCHY_TEST_WIDE );
+	if( result )
+	{
+		set_random_locals( &h, locals, HIERARCHY_TEST_WIDE );
+		result = transform_hierarchy_update( &h ) == HIERARCHY_TEST_WIDE &&
+		         worlds_match( &h, parents, locals, HIERARCHY_TEST_WIDE );
+
+		/* A root moves everything below it. */
+		locals[ 3 ] = random_local( );
+		transform_hierarchy_set_local( &h, 3, &locals[ 3 ] );
+		result = result && transform_hierarchy_update( &h ) == subtree_size( parents, HIERARCHY_TEST_WIDE, 3, NULL ) &&
+		         worlds_match( &h, parents, locals, HIERARCHY_TEST_WIDE );
+		transform_hierarchy_destroy( &h );
+	}
+
+	free( parents );
+	free( locals );
+	return result;
+}
+
+bool test_transform_hierarchy_invalid( void )
+{
+	const int cycle[]        = { -1, 2, 1 };
+	const int self[]         = { -1, 1 };
+	const int out_of_range[] = { -1, 5 };
+	const int empty[]        = { 0 };
+	transform_hierarchy_t h;
+
+	bool result = !transform_hierarchy_create( &h, cycle, 3 ) &&
+	              !transform_hierarchy_create( &h, self, 2 ) &&
+	              !transform_hierarchy_create( &h, out_of_range, 2 ) &&
+	              transform_hierarchy_create( &h, empty, 0 );
+
+	result = result && transform_hierarchy_count( &h ) == 0 && transform_hierarchy_update( &h ) == 0;
+	transform_hierarchy_destroy( &h );
+	return result;
+}
@@ -62,7 +62,7 @@ size_t vec2_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	bool result = test_features( "2D Vector Functions", vec2_tests, vec2_test_suite_size() );
 	return result ? 0 : 1;
 }
@@ -0,0 +1,295 @@
+/* Copyright (C) 2013-2015 by Joseph A. Marrero, http://www.manvscode.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../src/vec3.h"
+#include "../src/vec3-array.h"
+#include "test.h"
+
+/* An odd count exercises both the vector body and the scalar tail. */
+#define VEC3_ARRAY_TEST_COUNT   (37)
+
+bool test_vec3_array_create        ( void );
+bool test_vec3_array_conversion    ( void );
+bool test_vec3_array_addition      ( void );
+bool test_vec3_array_subtraction   ( void );
+bool test_vec3_array_multiply      ( void );
+bool test_vec3_array_dot_product   ( void );
+bool test_vec3_array_cross_product ( void );
+bool test_vec3_array_normalize     ( void );
+bool test_vec3_array_lerp          ( void );
+
+const test_feature_t vec3_array_tests[] = {
+	{ "Testing vec3 array creation",           test_vec3_array_create },
+	{ "Testing vec3 array conversion",         test_vec3_array_conversion },
+	{ "Testing vec3 array addition",           test_vec3_array_addition },
+	{ "Testing vec3 array subtraction",        test_vec3_array_subtraction },
+	{ "Testing vec3 array scaler multiply",    test_vec3_array_multiply },
+	{ "Testing vec3 array dot product",        test_vec3_array_dot_product },
+	{ "Testing vec3 array cross product",      test_vec3_array_cross_product },
+	{ "Testing vec3 array normalize",          test_vec3_array_normalize },
+	{ "Testing vec3 array lerp",               test_vec3_array_lerp },
+};
+
+size_t vec3_array_test_suite_size( void )
+{
+	return sizeof(vec3_array_tests) / sizeof(vec3_array_tests[0]);
+}
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	bool result = test_features( "3D Vector Array Functions", vec3_array_tests, vec3_array_test_suite_size() );
+	return result ? 0 : 1;
+}
+#endif
+
+static inline bool vec3_close( const vec3_t* a, const vec3_t* b )
+{
+	return scaler_abs( a->x - b->x ) < 0.0001 &&
+	       scaler_abs( a->y - b->y ) < 0.0001 &&
+	       scaler_abs( a->z - b->z ) < 0.0001;
+}
+
+static void vec3_fill( vec3_t v[], size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+	{
+		v[ i ] = VEC3( m3d_uniform_rangef( -10, 10 ), m3d_uniform_rangef( -10, 10 ), m3d_uniform_rangef( -10, 10 ) );
+	}
+}
+
+bool test_vec3_array_create( void )
+{
+	vec3_array_t array;
+	bool result = vec3_array_create( &array, VEC3_ARRAY_TEST_COUNT );
+
+	result = result &&
+	         array.count == VEC3_ARRAY_TEST_COUNT &&
+	         ((uintptr_t) array.x) % 64 == 0 &&
+	         ((uintptr_t) array.y) % 64 == 0 &&
+	         ((uintptr_t) array.z) % 64 == 0 &&
+	         scaler_compare( array.x[ VEC3_ARRAY_TEST_COUNT - 1 ], 0.0 );
+
+	vec3_array_destroy( &array );
+	return result && array.count == 0 && array.x == NULL;
+}
+
+bool test_vec3_array_conversion( void )
+{
+	vec3_t input[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_t output[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_array_t array;
+	bool result = true;
+
+	vec3_fill( input, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array, input, VEC3_ARRAY_TEST_COUNT );
+	output[ VEC3_ARRAY_TEST_COUNT - 1 ] = VEC3_ZERO;
+	vec3_array_to_vec3( &array, output, VEC3_ARRAY_TEST_COUNT - 1 );
+	result = vec3_compare( &output[ VEC3_ARRAY_TEST_COUNT - 1 ], &VEC3_ZERO );
+	vec3_array_to_vec3( &array, output, VEC3_ARRAY_TEST_COUNT );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		vec3_t v = vec3_array_get( &array, i );
+		result = vec3_compare( &input[ i ], &output[ i ] ) &&
+		         vec3_compare( &input[ i ], &v );
+	}
+
+	vec3_array_destroy( &array );
+	return result;
+}
+
+typedef void (*vec3_array_binary_fxn)( vec3_array_t* result, const vec3_array_t* a, const vec3_array_t* b );
+typedef vec3_t (*vec3_binary_fxn)( const vec3_t* restrict a, const vec3_t* restrict b );
+
+/* Checks a batch function against its single vector counterpart. */
+static bool test_vec3_array_binary( vec3_array_binary_fxn batch, vec3_binary_fxn single )
+{
+	vec3_t a[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_t b[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_array_t array_a;
+	vec3_array_t array_b;
+	vec3_array_t array_r;
+	bool result = true;
+
+	vec3_fill( a, VEC3_ARRAY_TEST_COUNT );
+	vec3_fill( b, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_b, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_r, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array_a, a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array_b, b, VEC3_ARRAY_TEST_COUNT );
+
+	batch( &array_r, &array_a, &array_b );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		vec3_t expected = single( &a[ i ], &b[ i ] );
+		vec3_t actual   = vec3_array_get( &array_r, i );
+		result = vec3_close( &expected, &actual );
+	}
+
+	/* The result may alias an input. */
+	batch( &array_a, &array_a, &array_b );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		vec3_t expected = single( &a[ i ], &b[ i ] );
+		vec3_t actual   = vec3_array_get( &array_a, i );
+		result = vec3_close( &expected, &actual );
+	}
+
+	vec3_array_destroy( &array_a );
+	vec3_array_destroy( &array_b );
+	vec3_array_destroy( &array_r );
+	return result;
+}
+
+static vec3_t vec3_add_fxn( const vec3_t* restrict a, const vec3_t* restrict b )           { return vec3_add( a, b ); }
+static vec3_t vec3_subtract_fxn( const vec3_t* restrict a, const vec3_t* restrict b )      { return vec3_subtract( a, b ); }
+static vec3_t vec3_cross_product_fxn( const vec3_t* restrict a, const vec3_t* restrict b ) { return vec3_cross_product( a, b ); }
+
+bool test_vec3_array_addition( void )
+{
+	return test_vec3_array_binary( vec3_array_add, vec3_add_fxn );
+}
+
+bool test_vec3_array_subtraction( void )
+{
+	return test_vec3_array_binary( vec3_array_subtract, vec3_subtract_fxn );
+}
+
+bool test_vec3_array_cross_product( void )
+{
+	return test_vec3_array_binary( vec3_array_cross_product, vec3_cross_product_fxn );
+}
+
+bool test_vec3_array_multiply( void )
+{
+	vec3_t a[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_array_t array;
+	bool result = true;
+
+	vec3_fill( a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array, a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_scale( &array, 0.5 );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		vec3_t expected = vec3_multiply( &a[ i ], 0.5 );
+		vec3_t actual   = vec3_array_get( &array, i );
+		result = vec3_close( &expected, &actual );
+	}
+
+	vec3_array_destroy( &array );
+	return result;
+}
+
+bool test_vec3_array_dot_product( void )
+{
+	vec3_t a[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_t b[ VEC3_ARRAY_TEST_COUNT ];
+	scaler_t dot[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_array_t array_a;
+	vec3_array_t array_b;
+	bool result = true;
+
+	vec3_fill( a, VEC3_ARRAY_TEST_COUNT );
+	vec3_fill( b, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_b, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array_a, a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array_b, b, VEC3_ARRAY_TEST_COUNT );
+
+	vec3_array_dot_product( &array_a, &array_b, dot );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		result = scaler_abs( dot[ i ] - vec3_dot_product( &a[ i ], &b[ i ] ) ) < 0.001;
+	}
+
+	vec3_array_destroy( &array_a );
+	vec3_array_destroy( &array_b );
+	return result;
+}
+
+bool test_vec3_array_normalize( void )
+{
+	vec3_t a[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_array_t array;
+	bool result = true;
+
+	vec3_fill( a, VEC3_ARRAY_TEST_COUNT );
+	a[ 3 ] = VEC3_ZERO; /* must be left alone */
+	vec3_array_create( &array, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array, a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_normalize( &array );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		vec3_t expected = a[ i ];
+		vec3_normalize( &expected );
+		vec3_t actual = vec3_array_get( &array, i );
+		result = vec3_close( &expected, &actual );
+	}
+
+	vec3_array_destroy( &array );
+	return result;
+}
+
+bool test_vec3_array_lerp( void )
+{
+	vec3_t a[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_t b[ VEC3_ARRAY_TEST_COUNT ];
+	vec3_array_t array_a;
+	vec3_array_t array_b;
+	bool result = true;
+
+	vec3_fill( a, VEC3_ARRAY_TEST_COUNT );
+	vec3_fill( b, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_create( &array_b, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array_a, a, VEC3_ARRAY_TEST_COUNT );
+	vec3_array_from_vec3( &array_b, b, VEC3_ARRAY_TEST_COUNT );
+
+	vec3_array_lerp( &array_a, &array_a, &array_b, 0.25 );
+
+	for( size_t i = 0; result && i < VEC3_ARRAY_TEST_COUNT; i++ )
+	{
+		vec3_t expected = VEC3(
+			a[ i ].x + 0.25 * (b[ i ].x - a[ i ].x),
+			a[ i ].y + 0.25 * (b[ i ].y - a[ i ].y),
+			a[ i ].z + 0.25 * (b[ i ].z - a[ i ].z)
+		);
+		vec3_t actual = vec3_array_get( &array_a, i );
+		result = vec3_close( &expected, &actual );
+	}
+
+	vec3_array_destroy( &array_a );
+	vec3_array_destroy( &array_b );
+	return result;
+}
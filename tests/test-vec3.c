@@ -21,6 +21,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <math.h>
 #include "../src/vec3.h"
 #include "test.h"
 
@@ -37,6 +39,8 @@ bool test_vec3_normalize       ( void );
 bool test_vec3_is_normalized   ( void );
 bool test_vec3_negate          ( void );
 bool test_vec3_zero            ( void );
+bool test_vec3_to_string       ( void );
+bool test_vec3_format          ( void );
 
 const test_feature_t vec3_tests[] = {
 	{ "Testing vec3 literals",                 test_vec3_literals },
@@ -52,6 +56,8 @@ const test_feature_t vec3_tests[] = {
 	{ "Testing vec3 is normalized",            test_vec3_is_normalized },
 	{ "Testing vec3 negation",                 test_vec3_negate },
 	{ "Testing vec3 zero",                     test_vec3_zero },
+	{ "Testing vec3 to string",                test_vec3_to_string },
+	{ "Testing vec3 bulk formatting",          test_vec3_format },
 };
 
 size_t vec3_test_suite_size( void )
@@ -62,7 +68,7 @@ size_t vec3_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	bool result = test_features( "3D Vector Functions", vec3_tests, vec3_test_suite_size() );
 	return result ? 0 : 1;
 }
@@ -213,3 +219,63 @@ bool test_vec3_zero( void )
 
 	return r1 && r2;
 }
+
+bool test_vec3_to_string( void )
+{
+	vec3_t a = VEC3( 1.5, -2.25, 300 );
+	char buffer[ 64 ];
+	char small[ 8 ];
+
+	size_t length = vec3_to_string_r( &a, buffer, sizeof(buffer) );
+	bool r1 = length == strlen( buffer ) &&
+	          strcmp( buffer, vec3_to_string( &a ) ) == 0;
+
+	/* Truncated output still reports the full length. */
+	size_t truncated = vec3_to_string_r( &a, small, sizeof(small) );
+	bool r2 = truncated == length &&
+	          strlen( small ) == sizeof(small) - 1 &&
+	          strncmp( small, buffer, sizeof(small) - 1 ) == 0;
+
+	return r1 && r2;
+}
+
+bool test_vec3_format( void )
+{
+	const vec3_t v[] = {
+		VEC3( 0, 1, -1 ),
+		VEC3( 0.125, -2.5, 1000.25 ),
+		VEC3( -0.0001, 123456.5, 9.995 ),
+	};
+	char buffer[ 256 ];
+	size_t length = 0;
+
+	size_t count = vec3_format( buffer, sizeof(buffer), v, 2, 3, &length );
+	bool r1 = count == 2 &&
+	          length == strlen( buffer ) &&
+	          strcmp( buffer, "(0.000, 1.000, -1.000)\n(0.125, -2.500, 1000.250)\n" ) == 0;
+
+	/* Every component reads back to within half a unit in the last place. */
+	count = vec3_format( buffer, sizeof(buffer), v, 3, 4, &length );
+	bool r2 = count == 3;
+	const char* p = buffer;
+	for( size_t i = 0; r2 && i < count; i++ )
+	{
+		char* end;
+		double x = strtod( p + 1, &end );
+		double y = strtod( end + 2, &end );
+		double z = strtod( end + 2, &end );
+		r2 = fabs( x - v[ i ].x ) <= 0.00005 + fabs( v[ i ].x ) * 1e-6 &&
+		     fabs( y - v[ i ].y ) <= 0.00005 + fabs( v[ i ].y ) * 1e-6 &&
+		     fabs( z - v[ i ].z ) <= 0.00005 + fabs( v[ i ].z ) * 1e-6 &&
+		     end[ 0 ] == ')' && end[ 1 ] == '\n';
+		p = end + 2;
+	}
+
+	/* Only whole vectors are written when the buffer is too small. */
+	char small[ 30 ];
+	count = vec3_format( small, sizeof(small), v, 3, 3, &length );
+	bool r3 = count == 1 &&
+	          strcmp( small, "(0.000, 1.000, -1.000)\n" ) == 0;
+
+	return r1 && r2 && r3;
+}
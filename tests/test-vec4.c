@@ -60,7 +60,7 @@ size_t vec4_test_suite_size( void )
 #ifdef TEST_STANDALONE
 int main( int argc, char* argv[] )
 {
-	srand( time(NULL) );
+	m3d_seed( time(NULL) );
 	bool result = test_features( "4D Vector Functions", vec4_tests, vec4_test_suite_size() );
 	return result ? 0 : 1;
 }
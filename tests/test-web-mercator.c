@@ -0,0 +1,328 @@
+/* Copyright (C) 2013-2025 by Joseph A. Marrero, http://joemarrero.com/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+#include "../src/mathematics.h"
+#include "../src/web-mercator.h"
+#include "test.h"
+
+
+bool test_web_mercator_known_values ( void );
+bool test_web_mercator_edges        ( void );
+bool test_web_mercator_round_trip   ( void );
+bool test_web_mercator_arrays       ( void );
+bool test_web_mercator_keys         ( void );
+bool test_web_mercator_bucket       ( void );
+
+const test_feature_t web_mercator_tests[] = {
+	{ "Testing web mercator known values",     test_web_mercator_known_values },
+	{ "Testing web mercator map edges",        test_web_mercator_edges },
+	{ "Testing web mercator round trips",      test_web_mercator_round_trip },
+	{ "Testing web mercator batch projection", test_web_mercator_arrays },
+	{ "Testing web mercator tile keys",        test_web_mercator_keys },
+	{ "Testing web mercator tile buckets",     test_web_mercator_bucket },
+};
+
+size_t web_mercator_test_suite_size( void )
+{
+	return sizeof(web_mercator_tests) / sizeof(web_mercator_tests[0]);
+}
+
+
+#ifdef TEST_STANDALONE
+int main( int argc, char* argv[] )
+{
+	m3d_seed( time(NULL) );
+	test_features( "Web Mercator Functions", web_mercator_tests, web_mercator_test_suite_size() );
+	return 0;
+}
+#endif
+
+static double uniform( double min, double max )
+{
+	return min + (max - min) * rand() / (double) RAND_MAX;
+}
+
+/* Half of the points are in a small area around Miami, the rest anywhere,
+ * including past the latitude limits and outside [-180, 180]. */
+static void random_points( double lon[], double lat[], size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+	{
+		if( i % 2 == 0 )
+		{
+			lon[ i ] = -80.19 + uniform( -0.05, 0.05 );
+			lat[ i ] = 25.76 + uniform( -0.05, 0.05 );
+		}
+		else
+		{
+			lon[ i ] = uniform( -540.0, 540.0 );
+			lat[ i ] = uniform( -90.0, 90.0 );
+		}
+	}
+}
+
+/* The position of a point in pixels from the north west corner of the map,
+ * with the C library. */
+static void reference_pixels( double lon, double lat, unsigned int zoom, unsigned int tile_size, double* x, double* y )
+{
+	const double pi = 3.14159265358979323846; /* M_PI is a float in float builds */
+	const double size = ldexp( tile_size, zoom );
+	const double t = tan( m3d_clampd( lat, -WEB_MERCATOR_MAX_LATITUDE, WEB_MERCATOR_MAX_LATITUDE ) * pi / 180.0 );
+	*x = fmod( fmod( lon + 180.0, 360.0 ) + 360.0, 360.0 ) / 360.0 * size;
+	*y = (0.5 - asinh( t ) / (2.0 * pi)) * size;
+}
+
+bool test_web_mercator_known_values( void )
+{
+	double x, y;
+	uint32_t tx, ty;
+	double px, py;
+	bool result = true;
+
+	web_mercator_from_geographic( -80.1918, 25.7617, &x, &y );
+	result = result && fabs( x - -8926910.341796037 ) < 1e-6 && fabs( y - 2969596.2785174837 ) < 1e-6;
+
+	web_mercator_from_geographic( 180.0, WEB_MERCATOR_MAX_LATITUDE, &x, &y );
+	result = result && fabs( x - 20037508.342789244 ) < 1e-6 && fabs( y - 20037508.342789244 ) < 1e-6;
+
+	web_mercator_from_geographic( -180.0, -WEB_MERCATOR_MAX_LATITUDE, &x, &y );
+	result = result && fabs( x + 20037508.342789244 ) < 1e-6 && fabs( y + 20037508.342789244 ) < 1e-6;
+
+	web_mercator_tile( -80.1918, 25.7617, 10, 256, &tx, &ty, &px, &py );
+	result = result && tx == 283 && ty == 436 && fabs( px - 230.11328 ) < 1e-6 && fabs( py - 30.884024544226 ) < 1e-6;
+
+	web_mercator_tile( -0.1278, 51.5074, 14, 512, &tx, &ty, &px, &py );
+	result = result && tx == 8186 && ty == 5448 && fabs( px - 94.04416 ) < 1e-6 && fabs( py - 50.259217555635 ) < 1e-6;
+
+	web_mercator_tile( 151.2093, -33.8688, 30, 256, &tx, &ty, &px, &py );
+	result = result && tx == 987870216 && ty == 644344148 && fabs( px - 105.076 ) < 1e-3 && fabs( py - 166.3009 ) < 1e-3;
+
+	return result;
+}
+
+bool test_web_mercator_edges( void )
+{
+	uint32_t tx, ty;
+	double px, py;
+	bool result = true;
+
+	/* The whole world is one tile at zoom 0. */
+	web_mercator_tile( 179.999, -89.0, 0, 256, &tx, &ty, &px, &py );
+	result = result && tx == 0 && ty == 0 && px < 256.0 && py < 256.0;
+
+	/* The antimeridian is the west edge of the map. */
+	web_mercator_tile( 180.0, 0.0, 3, 256, &tx, &ty, &px, &py );
+	result = result && tx == 0 && px == 0.0 && ty == 4 && py == 0.0;
+	web_mercator_tile( -180.0, 0.0, 3, 256, &tx, &ty, &px, &py );
+	result = result && tx == 0 && px == 0.0;
+	web_mercator_tile( 540.0 - 1e-9, 0.0, 3, 256, &tx, &ty, &px, &py );
+	result = result && tx == 7 && px < 256.0;
+
+	/* The poles are clamped to the north and south edges, and stay in the
+	 * first and last rows. */
+	web_mercator_tile( 10.0, 90.0, 12, 256, &tx, &ty, &px, &py );
+	result = result && ty == 0 && py < 1e-6;
+	web_mercator_tile( 10.0, -90.0, 12, 256, &tx, &ty, &px, &py );
+	result = result && ty == 4095 && py < 256.0 && py > 255.999;
+	web_mercator_tile( 10.0, -90.0, WEB_MERCATOR_MAX_ZOOM, 256, &tx, &ty, &px, &py );
+	result = result && ty == (UINT32_C(1) << WEB_MERCATOR_MAX_ZOOM) - 1 && py < 256.0;
+
+	return result;
+}
+
+bool test_web_mercator_round_trip( void )
+{
+	bool result = true;
+
+	for( int i = 0; result && i < 10000; i++ )
+	{
+		const double lon = uniform( -180.0, 180.0 );
+		const double lat = uniform( -WEB_MERCATOR_MAX_LATITUDE, WEB_MERCATOR_MAX_LATITUDE );
+		const unsigned int zoom = rand() % (WEB_MERCATOR_MAX_ZOOM + 1);
+		uint32_t tx, ty;
+		double px, py, x, y, lon2, lat2;
+
+		web_mercator_tile( lon, lat, zoom, 256, &tx, &ty, &px, &py );
+		web_mercator_tile_to_geographic( zoom, tx, ty, px, py, 256, &lon2, &lat2 );
+		result = result && tx < (UINT32_C(1) << zoom) && ty < (UINT32_C(1) << zoom) &&
+		         px >= 0.0 && px < 256.0 && py >= 0.0 && py < 256.0 &&
+		         fabs( remainder( lon2 - lon, 360.0 ) ) < 1e-9 && fabs( lat2 - lat ) < 1e-9;
+
+		web_mercator_from_geographic( lon, lat, &x, &y );
+		web_mercator_to_geographic( x, y, &lon2, &lat2 );
+		result = result && fabs( lon2 - lon ) < 1e-9 && fabs( lat2 - lat ) < 1e-9;
+	}
+
+	return result;
+}
+
+static bool check_arrays( size_t count, unsigned int zoom, unsigned int tile_size )
+{
+	double*   lon = malloc( count * sizeof(double) );
+	double*   lat = malloc( count * sizeof(double) );
+	double*   x   = malloc( count * sizeof(double) );
+	double*   y   = malloc( count * sizeof(double) );
+	double*   px  = malloc( count * sizeof(double) );
+	double*   py  = malloc( count * sizeof(double) );
+	uint32_t* tx  = malloc( count * sizeof(uint32_t) );
+	uint32_t* ty  = malloc( count * sizeof(uint32_t) );
+	bool result = lon && lat && x && y && px && py && tx && ty;
+
+	if( result )
+	{
+		random_points( lon, lat, count );
+		web_mercator_from_geographic_array( lon, lat, x, y, count );
+		web_mercator_tile_array( lon, lat, count, zoom, tile_size, tx, ty, px, py );
+	}
+
+	for( size_t i = 0; result && i < count; i++ )
+	{
+		uint32_t stx, sty;
+		double sx, sy, spx, spy, rx, ry;
+
+		/* The same as one point at a time. */
+		web_mercator_from_geographic( lon[ i ], lat[ i ], &sx, &sy );
+		web_mercator_tile( lon[ i ], lat[ i ], zoom, tile_size, &stx, &sty, &spx, &spy );
+		result = x[ i ] == sx && y[ i ] == sy && tx[ i ] == stx && ty[ i ] == sty && px[ i ] == spx && py[ i ] == spy;
+
+		/* Close to the C library, except for points on the antimeridian,
+		 * which may be on either edge. Near the latitude limits a
+		 * rounding error in the latitude moves a point by about 12 ulps
+		 * of the map coordinates, which is a few thousandths of a pixel
+		 * at the highest zoom. */
+		const double size = ldexp( tile_size, zoom );
+		const double tolerance = 1e-6 + 1e-14 * size;
+		reference_pixels( lon[ i ], lat[ i ], zoom, tile_size, &rx, &ry );
+		const double dx = fabs( (double) tx[ i ] * tile_size + px[ i ] - rx );
+		const double dy = fabs( (double) ty[ i ] * tile_size + py[ i ] - ry );
+		result = result && (dx < tolerance || fabs( dx - size ) < tolerance) && dy < tolerance;
+	}
+
+	free( lon );
+	free( lat );
+	free( x );
+	free( y );
+	free( px );
+	free( py );
+	free( tx );
+	free( ty );
+	return result;
+}
+
+bool test_web_mercator_arrays( void )
+{
+	/* The larger array is split across threads when built with OpenMP. */
+	return check_arrays( 0, 4, 256 ) &&
+	       check_arrays( 37, 0, 256 ) &&
+	       check_arrays( 1000, 14, 256 ) &&
+	       check_arrays( 1001, WEB_MERCATOR_MAX_ZOOM, 512 ) &&
+	       check_arrays( 70000, 18, 256 );
+}
+
+bool test_web_mercator_keys( void )
+{
+	bool result = web_mercator_tile_key( 0, 0 ) == 0 &&
+	              web_mercator_tile_key( 1, 0 ) == 1 &&
+	              web_mercator_tile_key( 0, 1 ) == 2 &&
+	              /* quadkey "213" */
+	              web_mercator_tile_key( 3, 5 ) == ((2 << 4) | (1 << 2) | 3);
+
+	for( int i = 0; result && i < 1000; i++ )
+	{
+		const uint32_t x = (uint32_t) rand() & ((UINT32_C(1) << WEB_MERCATOR_MAX_ZOOM) - 1);
+		const uint32_t y = (uint32_t) rand() & ((UINT32_C(1) << WEB_MERCATOR_MAX_ZOOM) - 1);
+		uint32_t x2, y2;
+		web_mercator_tile_from_key( web_mercator_tile_key( x, y ), &x2, &y2 );
+		result = x2 == x && y2 == y;
+	}
+
+	return result;
+}
+
+static bool check_bucket( size_t count, unsigned int zoom, bool own_workspace )
+{
+	double*   lon     = malloc( (count + 1) * sizeof(double) );
+	double*   lat     = malloc( (count + 1) * sizeof(double) );
+	uint64_t* tiles   = malloc( (count + 1) * sizeof(uint64_t) );
+	size_t*   offsets = malloc( (count + 1) * sizeof(size_t) );
+	size_t*   order   = malloc( (count + 1) * sizeof(size_t) );
+	bool*     seen    = calloc( count + 1, sizeof(bool) );
+	void*     workspace = own_workspace ? malloc( web_mercator_bucket_workspace_size( count ) ) : NULL;
+	size_t tile_count = 99;
+	bool result = lon && lat && tiles && offsets && order && seen && (!own_workspace || workspace);
+
+	if( result )
+	{
+		random_points( lon, lat, count );
+		result = web_mercator_bucket( lon, lat, count, zoom, tiles, offsets, order, &tile_count, workspace );
+	}
+
+	result = result && offsets[ 0 ] == 0 && offsets[ tile_count ] == count &&
+	         (count == 0) == (tile_count == 0);
+
+	for( size_t t = 0; result && t < tile_count; t++ )
+	{
+		result = offsets[ t ] < offsets[ t + 1 ] && (t == 0 || tiles[ t - 1 ] < tiles[ t ]);
+
+		for( size_t j = offsets[ t ]; result && j < offsets[ t + 1 ]; j++ )
+		{
+			const size_t i = order[ j ];
+			uint32_t tx, ty;
+			double px, py;
+
+			/* Every point once, in its tile, in increasing order. */
+			result = i < count && !seen[ i ] && (j == offsets[ t ] || order[ j - 1 ] < i);
+			if( result )
+			{
+				seen[ i ] = true;
+				web_mercator_tile( lon[ i ], lat[ i ], zoom, 256, &tx, &ty, &px, &py );
+				result = web_mercator_tile_key( tx, ty ) == tiles[ t ];
+			}
+		}
+	}
+
+	free( lon );
+	free( lat );
+	free( tiles );
+	free( offsets );
+	free( order );
+	free( seen );
+	free( workspace );
+	return result;
+}
+
+bool test_web_mercator_bucket( void )
+{
+	/* Zoom 0 has one tile, and every sort pass is skipped. The larger
+	 * inputs are split across threads when built with OpenMP. */
+	return check_bucket( 0, 10, false ) &&
+	       check_bucket( 1, 10, false ) &&
+	       check_bucket( 1000, 0, false ) &&
+	       check_bucket( 1000, 3, true ) &&
+	       check_bucket( 5000, 14, false ) &&
+	       check_bucket( 5001, WEB_MERCATOR_MAX_ZOOM, true ) &&
+	       check_bucket( 100000, 16, false );
+}